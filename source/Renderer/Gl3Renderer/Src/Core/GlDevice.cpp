@@ -570,6 +570,11 @@ namespace gl_renderer
 		glLogCall( gl::Finish );
 	}
 
+	renderer::CallStatistics Device::getCallStatistics( bool reset )const
+	{
+		return getCallCounters().getStatistics( reset );
+	}
+
 	void Device::swapBuffers()const
 	{
 		m_context->swapBuffers();
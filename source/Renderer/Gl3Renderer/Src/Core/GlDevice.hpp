@@ -129,6 +129,12 @@ namespace gl_renderer
 		*/
 		void waitIdle()const override;
 		/**
+		*\copydoc	renderer::Device::getCallStatistics
+		*\remarks
+		*	Les compteurs sont ceux de glLogCall, et sont donc partagés par tous les périphériques GL.
+		*/
+		renderer::CallStatistics getCallStatistics( bool reset )const override;
+		/**
 		*\brief
 		*	Echange les tampons.
 		*/
@@ -325,6 +325,10 @@ namespace gl_renderer
 		m_features.hasClearTexImage = false;
 		m_features.hasComputeShaders = false;
 		m_features.hasStorageBuffers = false;
+		m_features.hasBindlessTexture = false;
+		m_features.hasMultiBind = false;
+		m_features.hasPushConstantsBuffer = false;
+		m_features.hasPersistentMapping = false;
 	}
 
 	renderer::DevicePtr Renderer::createDevice( renderer::ConnectionPtr && connection )const
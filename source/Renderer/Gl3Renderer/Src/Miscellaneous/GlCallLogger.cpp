@@ -0,0 +1,15 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include "GlRendererPrerequisites.hpp"
+
+namespace gl_renderer
+{
+	renderer::CallCounters & getCallCounters()
+	{
+		// Never destroyed, the call sites counters being static objects too.
+		static renderer::CallCounters & result = *new renderer::CallCounters;
+		return result;
+	}
+}
@@ -596,6 +596,7 @@ namespace gl_renderer
 		, renderer::MemoryMapFlags flags )const
 	{
 		assert( m_impl && "Memory object was not bound to a resource object" );
+		doSetMapped( size, flags );
 		return m_impl->lock( offset, size, flags );
 	}
 
@@ -604,6 +605,7 @@ namespace gl_renderer
 	{
 		assert( m_impl && "Memory object was not bound to a resource object" );
 		m_impl->flush( offset, size );
+		getCallCounters().addUploadedBytes( doGetFlushedBytes( size ) );
 	}
 
 	void DeviceMemory::invalidate( uint32_t offset
@@ -617,6 +619,7 @@ namespace gl_renderer
 	{
 		assert( m_impl && "Memory object was not bound to a resource object" );
 		m_impl->unlock();
+		getCallCounters().addUploadedBytes( doGetUnmappedBytes() );
 	}
 
 	//************************************************************************************************
@@ -12,192 +12,123 @@ See LICENSE file in root folder.
 #include "Image/GlTexture.hpp"
 #include "Image/GlTextureView.hpp"
 #include "Buffer/GlUniformBuffer.hpp"
+#include "Core/GlDevice.hpp"
 
+#include <Core/Renderer.hpp>
 #include <Descriptor/DescriptorSetLayoutBinding.hpp>
 
 namespace gl_renderer
 {
 	namespace
 	{
-		renderer::TextureView const & getView( renderer::WriteDescriptorSet const & write, uint32_t index )
+		void bindTextures( TextureBindingTable const & table
+			, bool multiBind )
 		{
-			assert( index < write.imageInfo.size() );
-			return write.imageInfo[index].imageView.value().get();
-		}
-
-		renderer::Sampler const & getSampler( renderer::WriteDescriptorSet const & write, uint32_t index )
-		{
-			assert( index < write.imageInfo.size() );
-			return write.imageInfo[index].sampler.value().get();
-		}
-
-		renderer::BufferBase const & getBuffer( renderer::WriteDescriptorSet const & write, uint32_t index )
-		{
-			assert( index < write.bufferInfo.size() );
-			return write.bufferInfo[index].buffer.get();
-		}
-
-		void bindCombinedSampler( renderer::WriteDescriptorSet const & write )
-		{
-			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			if ( multiBind )
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & view = getView( write, i );
-				auto & sampler = getSampler( write, i );
-				glLogCall( gl::ActiveTexture
-					, GlTextureUnit( GL_TEXTURE0 + bindingIndex ) );
-				glLogCall( gl::BindTexture
-					, convert( view.getType() )
-					, static_cast< TextureView const & >( view ).getImage() );
-				glLogCall( gl::BindSampler
-					, bindingIndex
-					, static_cast< Sampler const & >( sampler ).getSampler() );
+				for ( auto & range : table.ranges )
+				{
+					glLogCall( gl::BindTextures
+						, range.first
+						, range.count
+						, &table.textures[range.index] );
+				}
 			}
-		}
-
-		void bindSampler( renderer::WriteDescriptorSet const & write )
-		{
-			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			else
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & sampler = getSampler( write, i );
-				glLogCall( gl::BindSampler
-					, bindingIndex
-					, static_cast< Sampler const & >( sampler ).getSampler() );
+				for ( size_t i = 0u; i < table.units.size(); ++i )
+				{
+					glLogCall( gl::ActiveTexture
+						, GlTextureUnit( GL_TEXTURE0 + table.units[i] ) );
+					glLogCall( gl::BindTexture
+						, table.targets[i]
+						, table.textures[i] );
+				}
 			}
 		}
 
-		void bindSampledTexture( renderer::WriteDescriptorSet const & write )
+		void bindSamplers( TextureBindingTable const & table
+			, bool multiBind )
 		{
-			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			if ( multiBind )
+			{
+				for ( auto & range : table.ranges )
+				{
+					glLogCall( gl::BindSamplers
+						, range.first
+						, range.count
+						, &table.samplers[range.index] );
+				}
+			}
+			else
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & view = getView( write, i );
-				glLogCall( gl::ActiveTexture
-					, GlTextureUnit( GL_TEXTURE0 + bindingIndex ) );
-				glLogCall( gl::BindTexture
-					, convert( view.getType() )
-					, static_cast< TextureView const & >( view ).getImage() );
+				for ( size_t i = 0u; i < table.units.size(); ++i )
+				{
+					glLogCall( gl::BindSampler
+						, table.units[i]
+						, table.samplers[i] );
+				}
 			}
 		}
 
-		void bindStorageTexture( renderer::WriteDescriptorSet const & write )
+		void bindImages( ImageBindingTable const & table )
 		{
-			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			for ( size_t i = 0u; i < table.units.size(); ++i )
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & view = getView( write, i );
-				auto & range = view.getSubResourceRange();
-				glLogCall( gl::ActiveTexture
-					, GlTextureUnit( GL_TEXTURE0 + bindingIndex ) );
 				glLogCall( gl::BindImageTexture
-					, bindingIndex
-					, static_cast< TextureView const & >( view ).getImage()
-					, range.baseMipLevel
-					, range.layerCount
-					, range.baseArrayLayer
+					, table.units[i]
+					, table.textures[i]
+					, table.levels[i]
+					, table.layered[i]
+					, table.layers[i]
 					, GL_ACCESS_TYPE_READ_WRITE
-					, getInternal( view.getFormat() ) );
+					, table.formats[i] );
 			}
 		}
 
-		void bindUniformBuffer( renderer::WriteDescriptorSet const & write )
+		void bindBuffers( GlBufferTarget target
+			, BufferBindingTable const & table
+			, std::vector< GLintptr > const & offsets
+			, bool multiBind )
 		{
-			for ( auto i = 0u; i < write.bufferInfo.size(); ++i )
+			if ( multiBind )
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & buffer = getBuffer( write, i );
-				glLogCall( gl::BindBufferRange
-					, GL_BUFFER_TARGET_UNIFORM
-					, bindingIndex
-					, static_cast< Buffer const & >( buffer ).getBuffer()
-					, GLintptr( write.bufferInfo[i].offset )
-					, GLsizeiptr( write.bufferInfo[i].range ) );
+				for ( auto & range : table.ranges )
+				{
+					glLogCall( gl::BindBuffersRange
+						, target
+						, range.first
+						, range.count
+						, &table.buffers[range.index]
+						, &offsets[range.index]
+						, &table.sizes[range.index] );
+				}
 			}
-		}
-
-		void bindStorageBuffer( renderer::WriteDescriptorSet const & write )
-		{
-			for ( auto i = 0u; i < write.bufferInfo.size(); ++i )
+			else
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & buffer = getBuffer( write, i );
-				glLogCall( gl::BindBufferRange
-					, GL_BUFFER_TARGET_SHADER_STORAGE
-					, bindingIndex
-					, static_cast< Buffer const & >( buffer ).getBuffer()
-					, GLintptr( write.bufferInfo[i].offset )
-					, GLsizeiptr( write.bufferInfo[i].range ) );
+				for ( size_t i = 0u; i < table.units.size(); ++i )
+				{
+					glLogCall( gl::BindBufferRange
+						, target
+						, table.units[i]
+						, table.buffers[i]
+						, offsets[i]
+						, table.sizes[i] );
+				}
 			}
 		}
 
-		void bindTexelBuffer( renderer::WriteDescriptorSet const & write )
+		std::vector< GLintptr > applyDynamicOffsets( BufferBindingTable const & table
+			, renderer::UInt32Array const & dynamicOffsets )
 		{
-			for ( auto i = 0u; i < write.bufferInfo.size(); ++i )
-			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & buffer = getBuffer( write, i );
-				glLogCall( gl::ActiveTexture
-					, GlTextureUnit( GL_TEXTURE0 + bindingIndex ) );
-				glLogCall( gl::BindTexture
-					, GL_BUFFER_TARGET_TEXTURE
-					, static_cast< BufferView const & >( write.texelBufferView[i].get() ).getImage() );
-			}
-		}
+			auto result = table.offsets;
 
-		void bindDynamicUniformBuffer( renderer::WriteDescriptorSet const & write, uint32_t offset )
-		{
-			for ( auto i = 0u; i < write.bufferInfo.size(); ++i )
+			for ( size_t i = 0u; i < result.size(); ++i )
 			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & buffer = getBuffer( write, i );
-				glLogCall( gl::BindBufferRange
-					, GL_BUFFER_TARGET_UNIFORM
-					, bindingIndex
-					, static_cast< Buffer const & >( buffer ).getBuffer()
-					, GLintptr( write.bufferInfo[i].offset + offset )
-					, GLsizeiptr( write.bufferInfo[i].range ) );
+				result[i] += GLintptr( dynamicOffsets[table.dynamicIndices[i]] );
 			}
-		}
 
-		void bindDynamicStorageBuffer( renderer::WriteDescriptorSet const & write, uint32_t offset )
-		{
-			for ( auto i = 0u; i < write.bufferInfo.size(); ++i )
-			{
-				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
-				auto & buffer = getBuffer( write, i );
-				glLogCall( gl::BindBufferRange
-					, GL_BUFFER_TARGET_SHADER_STORAGE
-					, bindingIndex
-					, static_cast< Buffer const & >( buffer ).getBuffer()
-					, GLintptr( write.bufferInfo[i].offset + offset )
-					, GLsizeiptr( write.bufferInfo[i].range ) );
-			}
-		}
-
-		void bindDynamicBuffers( renderer::WriteDescriptorSetArray const & writes
-			, renderer::UInt32Array const & offsets )
-		{
-			for ( auto i = 0u; i < offsets.size(); ++i )
-			{
-				auto & write = writes[i];
-
-				switch ( write.descriptorType )
-				{
-				case renderer::DescriptorType::eUniformBufferDynamic:
-					bindDynamicUniformBuffer( write, offsets[i] );
-					break;
-
-				case renderer::DescriptorType::eStorageBufferDynamic:
-					bindDynamicStorageBuffer( write, offsets[i] );
-					break;
-
-				default:
-					assert( false && "Unsupported dynamic descriptor type" );
-					throw std::runtime_error{ "Unsupported dynamic descriptor type" };
-					break;
-				}
-			}
+			return result;
 		}
 	}
 
@@ -209,50 +140,53 @@ namespace gl_renderer
 		, m_layout{ static_cast< PipelineLayout const & >( layout ) }
 		, m_bindingPoint{ bindingPoint }
 		, m_dynamicOffsets{ dynamicOffsets }
+		, m_multiBind{ m_descriptorSet.getDevice().getRenderer().getFeatures().hasMultiBind }
 	{
 		assert( m_descriptorSet.getDynamicBuffers().size() == m_dynamicOffsets.size()
 			&& "Dynamic descriptors and dynamic offsets sizes must match." );
+		m_dynamicUniformOffsets = applyDynamicOffsets( m_descriptorSet.getDynamicUniformBuffersTable()
+			, m_dynamicOffsets );
+		m_dynamicStorageOffsets = applyDynamicOffsets( m_descriptorSet.getDynamicStorageBuffersTable()
+			, m_dynamicOffsets );
 	}
 
 	void BindDescriptorSetCommand::apply()const
 	{
 		glLogCommand( "BindDescriptorSetCommand" );
-		for ( auto & write : m_descriptorSet.getCombinedTextureSamplers() )
-		{
-			bindCombinedSampler( write );
-		}
-
-		for ( auto & write : m_descriptorSet.getSamplers() )
-		{
-			bindSampler( write );
-		}
-
-		for ( auto & write : m_descriptorSet.getSampledTextures() )
-		{
-			bindSampledTexture( write );
-		}
-
-		for ( auto & write : m_descriptorSet.getStorageTextures() )
-		{
-			bindStorageTexture( write );
-		}
-
-		for ( auto & write : m_descriptorSet.getUniformBuffers() )
-		{
-			bindUniformBuffer( write );
-		}
-
-		for ( auto & write : m_descriptorSet.getStorageBuffers() )
-		{
-			bindStorageBuffer( write );
-		}
-
-		for ( auto & write : m_descriptorSet.getTexelBuffers() )
-		{
-			bindTexelBuffer( write );
-		}
 
-		bindDynamicBuffers( m_descriptorSet.getDynamicBuffers(), m_dynamicOffsets );
+		if ( m_descriptorSet.hasBindlessTextures() )
+		{
+			auto & handles = static_cast< Buffer const & >( m_descriptorSet.getBindlessHandlesBuffer() );
+			glLogCall( gl::BindBufferRange
+				, GL_BUFFER_TARGET_UNIFORM
+				, m_descriptorSet.getBindlessHandlesBinding()
+				, handles.getBuffer()
+				, GLintptr( 0 )
+				, GLsizeiptr( handles.getSize() ) );
+		}
+		else
+		{
+			auto & combined = m_descriptorSet.getCombinedTextureSamplersTable();
+			bindTextures( combined, m_multiBind );
+			bindSamplers( combined, m_multiBind );
+		}
+
+		bindSamplers( m_descriptorSet.getSamplersTable(), m_multiBind );
+		bindTextures( m_descriptorSet.getSampledTexturesTable(), m_multiBind );
+		bindImages( m_descriptorSet.getStorageTexturesTable() );
+		auto & uniformBuffers = m_descriptorSet.getUniformBuffersTable();
+		bindBuffers( GL_BUFFER_TARGET_UNIFORM, uniformBuffers, uniformBuffers.offsets, m_multiBind );
+		auto & storageBuffers = m_descriptorSet.getStorageBuffersTable();
+		bindBuffers( GL_BUFFER_TARGET_SHADER_STORAGE, storageBuffers, storageBuffers.offsets, m_multiBind );
+		bindTextures( m_descriptorSet.getTexelBuffersTable(), m_multiBind );
+		bindBuffers( GL_BUFFER_TARGET_UNIFORM
+			, m_descriptorSet.getDynamicUniformBuffersTable()
+			, m_dynamicUniformOffsets
+			, m_multiBind );
+		bindBuffers( GL_BUFFER_TARGET_SHADER_STORAGE
+			, m_descriptorSet.getDynamicStorageBuffersTable()
+			, m_dynamicStorageOffsets
+			, m_multiBind );
 	}
 
 	CommandPtr BindDescriptorSetCommand::clone()const
@@ -39,5 +39,8 @@ namespace gl_renderer
 		PipelineLayout const & m_layout;
 		renderer::PipelineBindPoint m_bindingPoint;
 		renderer::UInt32Array m_dynamicOffsets;
+		bool m_multiBind;
+		std::vector< GLintptr > m_dynamicUniformOffsets;
+		std::vector< GLintptr > m_dynamicStorageOffsets;
 	};
 }
@@ -0,0 +1,37 @@
+/*
+This file belongs to GlRenderer.
+See LICENSE file in root folder.
+*/
+#include "GlBindPushConstantsBufferCommand.hpp"
+
+#include "Buffer/GlBuffer.hpp"
+
+namespace gl_renderer
+{
+	BindPushConstantsBufferCommand::BindPushConstantsBufferCommand( renderer::BufferBase const & buffer
+		, GLuint binding
+		, uint32_t offset
+		, uint32_t size )
+		: m_buffer{ buffer }
+		, m_binding{ binding }
+		, m_offset{ GLintptr( offset ) }
+		, m_size{ GLsizeiptr( size ) }
+	{
+	}
+
+	void BindPushConstantsBufferCommand::apply()const
+	{
+		glLogCommand( "BindPushConstantsBufferCommand" );
+		glLogCall( gl::BindBufferRange
+			, GL_BUFFER_TARGET_UNIFORM
+			, m_binding
+			, static_cast< Buffer const & >( m_buffer ).getBuffer()
+			, m_offset
+			, m_size );
+	}
+
+	CommandPtr BindPushConstantsBufferCommand::clone()const
+	{
+		return std::make_unique< BindPushConstantsBufferCommand >( *this );
+	}
+}
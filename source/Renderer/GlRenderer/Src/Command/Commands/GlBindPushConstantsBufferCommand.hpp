@@ -0,0 +1,49 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#pragma once
+
+#include "GlCommandBase.hpp"
+
+namespace gl_renderer
+{
+	/**
+	*\brief
+	*	Commande d'attache d'une portion du tampon d'uniformes émulant les push constants.
+	*\remarks
+	*	Remplace la suite d'appels glUniform* de PushConstantsCommand par un seul glBindBufferRange.
+	*/
+	class BindPushConstantsBufferCommand
+		: public CommandBase
+	{
+	public:
+		/**
+		*\brief
+		*	Constructeur.
+		*\param[in] buffer
+		*	Le tampon de flux des push constants du tampon de commandes.
+		*\remarks
+		*	Le tampon n'est connu qu'à la fin de l'enregistrement, la commande est donc créée par CommandBuffer::end.
+		*\param[in] binding
+		*	Le point d'attache du tampon d'uniformes.
+		*\param[in] offset
+		*	Le décalage du bloc dans le tampon.
+		*\param[in] size
+		*	La taille du bloc.
+		*/
+		BindPushConstantsBufferCommand( renderer::BufferBase const & buffer
+			, GLuint binding
+			, uint32_t offset
+			, uint32_t size );
+
+		void apply()const override;
+		CommandPtr clone()const override;
+
+	private:
+		renderer::BufferBase const & m_buffer;
+		GLuint m_binding;
+		GLintptr m_offset;
+		GLsizeiptr m_size;
+	};
+}
@@ -26,6 +26,7 @@ See LICENSE file in root folder.
 #include "Commands/GlBindDescriptorSetCommand.hpp"
 #include "Commands/GlBindGeometryBuffersCommand.hpp"
 #include "Commands/GlBindPipelineCommand.hpp"
+#include "Commands/GlBindPushConstantsBufferCommand.hpp"
 #include "Commands/GlBlitImageCommand.hpp"
 #include "Commands/GlBufferMemoryBarrierCommand.hpp"
 #include "Commands/GlClearAttachmentsCommand.hpp"
@@ -54,13 +55,78 @@ See LICENSE file in root folder.
 #include "Commands/GlViewportCommand.hpp"
 #include "Commands/GlWriteTimestampCommand.hpp"
 
+#include <Buffer/PushConstantsBuffer.hpp>
 #include <Buffer/StagingBuffer.hpp>
 #include <Buffer/VertexBuffer.hpp>
+#include <Core/Renderer.hpp>
 
 #include <algorithm>
+#include <cstring>
 
 namespace gl_renderer
 {
+	namespace
+	{
+		uint32_t getStd140Alignment( renderer::PushConstant const & constant )
+		{
+			if ( constant.arraySize > 1u )
+			{
+				return 16u;
+			}
+
+			switch ( constant.format )
+			{
+			case renderer::ConstantFormat::eVec2f:
+			case renderer::ConstantFormat::eVec2i:
+			case renderer::ConstantFormat::eVec2ui:
+				return 8u;
+
+			case renderer::ConstantFormat::eVec3f:
+			case renderer::ConstantFormat::eVec4f:
+			case renderer::ConstantFormat::eVec3i:
+			case renderer::ConstantFormat::eVec4i:
+			case renderer::ConstantFormat::eVec3ui:
+			case renderer::ConstantFormat::eVec4ui:
+			case renderer::ConstantFormat::eColour:
+			case renderer::ConstantFormat::eMat2f:
+			case renderer::ConstantFormat::eMat3f:
+			case renderer::ConstantFormat::eMat4f:
+				return 16u;
+
+			default:
+				return 4u;
+			}
+		}
+
+		bool hasStd140Stride( renderer::PushConstant const & constant )
+		{
+			// std140 pads mat2/mat3 columns and array elements to 16 bytes,
+			// whereas push constants buffers are tightly packed.
+			if ( constant.format == renderer::ConstantFormat::eMat2f
+				|| constant.format == renderer::ConstantFormat::eMat3f )
+			{
+				return false;
+			}
+
+			return constant.arraySize <= 1u
+				|| ( getSize( constant.format ) % 16u ) == 0u;
+		}
+
+		void validateStd140( renderer::PushConstantsBufferBase const & pcb )
+		{
+			for ( auto & constant : pcb )
+			{
+				if ( ( constant.offset % getStd140Alignment( constant ) ) != 0u
+					|| !hasStd140Stride( constant ) )
+				{
+					renderer::Logger::logError( std::stringstream{} << "Push constant at offset " << constant.offset
+						<< ", of type " << renderer::getName( constant.format )
+						<< ", doesn't match the std140 layout of the push constants uniform buffer" );
+				}
+			}
+		}
+	}
+
 	CommandBuffer::CommandBuffer( Device const & device
 		, renderer::CommandPool const & pool
 		, bool primary )
@@ -81,6 +147,7 @@ namespace gl_renderer
 	{
 		m_afterSubmitActions.clear();
 		m_commands.clear();
+		m_pushConstantsStream.clear();
 		m_state = State{};
 		m_state.m_beginFlags = flags;
 		return true;
@@ -91,6 +158,7 @@ namespace gl_renderer
 	{
 		m_afterSubmitActions.clear();
 		m_commands.clear();
+		m_pushConstantsStream.clear();
 		m_state = State{};
 		m_state.m_beginFlags = flags;
 		return true;
@@ -99,6 +167,7 @@ namespace gl_renderer
 	bool CommandBuffer::end()const
 	{
 		m_state.m_pushConstantBuffers.clear();
+		doUploadPushConstantsBuffer();
 		return true;
 	}
 
@@ -106,6 +175,7 @@ namespace gl_renderer
 	{
 		m_afterSubmitActions.clear();
 		m_commands.clear();
+		m_pushConstantsStream.clear();
 		return true;
 	}
 
@@ -564,7 +634,11 @@ namespace gl_renderer
 	void CommandBuffer::pushConstants( renderer::PipelineLayout const & layout
 		, renderer::PushConstantsBufferBase const & pcb )const
 	{
-		if ( m_state.m_currentPipeline || m_state.m_currentComputePipeline )
+		if ( m_device.getRenderer().getFeatures().hasPushConstantsBuffer )
+		{
+			doPushConstantsToBuffer( static_cast< PipelineLayout const & >( layout ), pcb );
+		}
+		else if ( m_state.m_currentPipeline || m_state.m_currentComputePipeline )
 		{
 			m_commands.emplace_back( std::make_unique< PushConstantsCommand >( layout
 				, pcb ) );
@@ -659,4 +733,80 @@ namespace gl_renderer
 
 		m_commands.emplace_back( std::make_unique< BindGeometryBuffersCommand >( *m_state.m_boundVao ) );
 	}
+
+	void CommandBuffer::doPushConstantsToBuffer( PipelineLayout const & layout
+		, renderer::PushConstantsBufferBase const & pcb )const
+	{
+		if ( m_device.getRenderer().isValidationEnabled() )
+		{
+			validateStd140( pcb );
+		}
+
+		auto size = std::max( uint32_t( m_state.m_pushConstants.size() )
+			, layout.getPushConstantsSize() );
+		assert( pcb.getOffset() + pcb.getSize() <= size
+			&& "The push constants don't fit in the pipeline layout's push constant ranges" );
+		m_state.m_pushConstants.resize( size );
+		std::memcpy( m_state.m_pushConstants.data() + pcb.getOffset()
+			, pcb.getData()
+			, pcb.getSize() );
+
+		auto & bindings = m_state.m_pushConstantsBindings;
+
+		if ( !bindings.empty()
+			&& bindings.back().command + 1u == m_commands.size() )
+		{
+			// Nothing consumed the previous block, so we replace it instead of streaming a new one.
+			m_commands.pop_back();
+			m_pushConstantsStream.resize( bindings.back().offset );
+			bindings.pop_back();
+		}
+
+		auto alignment = uint32_t( m_device.getProperties().limits.minUniformBufferOffsetAlignment );
+		auto offset = ( ( uint32_t( m_pushConstantsStream.size() ) + alignment - 1u ) / alignment ) * alignment;
+		m_pushConstantsStream.resize( offset + size );
+		std::memcpy( m_pushConstantsStream.data() + offset
+			, m_state.m_pushConstants.data()
+			, size );
+		// The stream buffer is only sized in end(), where the command replaces this placeholder.
+		bindings.push_back( { m_commands.size(), offset, size } );
+		m_commands.emplace_back( nullptr );
+	}
+
+	void CommandBuffer::doUploadPushConstantsBuffer()const
+	{
+		if ( m_pushConstantsStream.empty() )
+		{
+			return;
+		}
+
+		auto size = uint32_t( m_pushConstantsStream.size() );
+
+		if ( !m_pushConstantsBuffer
+			|| m_pushConstantsBuffer->getSize() < size )
+		{
+			renderer::Device const & device = m_device;
+			m_pushConstantsBuffer = device.createBuffer( size
+				, renderer::BufferTarget::eUniformBuffer
+				, renderer::MemoryPropertyFlag::eHostVisible | renderer::MemoryPropertyFlag::eHostCoherent );
+		}
+
+		if ( auto * buffer = m_pushConstantsBuffer->lock( 0u
+			, size
+			, renderer::MemoryMapFlag::eWrite | renderer::MemoryMapFlag::eInvalidateRange ) )
+		{
+			std::memcpy( buffer, m_pushConstantsStream.data(), size );
+			m_pushConstantsBuffer->unlock();
+		}
+
+		for ( auto & binding : m_state.m_pushConstantsBindings )
+		{
+			m_commands[binding.command] = std::make_unique< BindPushConstantsBufferCommand >( *m_pushConstantsBuffer
+				, m_device.getPushConstantsBinding()
+				, binding.offset
+				, binding.size );
+		}
+
+		m_state.m_pushConstantsBindings.clear();
+	}
 }
@@ -258,11 +258,25 @@ namespace gl_renderer
 			, renderer::PipelineStageFlags before
 			, renderer::ImageMemoryBarrier const & transitionBarrier )const override;
 		void doBindVao()const;
+		void doPushConstantsToBuffer( PipelineLayout const & layout
+			, renderer::PushConstantsBufferBase const & pcb )const;
+		void doUploadPushConstantsBuffer()const;
 
 	private:
 	private:
 		Device const & m_device;
 		mutable CommandArray m_commands;
+		/**
+		*\brief
+		*	Une commande BindPushConstantsBufferCommand, créée à la fin de l'enregistrement.
+		*/
+		struct PushConstantsBinding
+		{
+			//! L'indice de la commande, dans m_commands.
+			size_t command;
+			uint32_t offset;
+			uint32_t size;
+		};
 		struct State
 		{
 			renderer::CommandBufferUsageFlags m_beginFlags{ 0u };
@@ -278,8 +292,12 @@ namespace gl_renderer
 			renderer::IndexType m_indexType;
 			GeometryBuffers * m_boundVao{ nullptr };
 			GeometryBuffersRefArray m_vaos;
+			renderer::ByteArray m_pushConstants;
+			std::vector< PushConstantsBinding > m_pushConstantsBindings;
 		};
 		mutable std::vector< std::function< void() > > m_afterSubmitActions;
 		mutable State m_state;
+		mutable renderer::ByteArray m_pushConstantsStream;
+		mutable renderer::BufferBasePtr m_pushConstantsBuffer;
 	};
 }
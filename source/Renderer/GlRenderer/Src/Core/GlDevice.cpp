@@ -339,6 +339,10 @@ namespace gl_renderer
 		m_dummyIndexed.geometryBuffers->initialise();
 
 		gl::GenFramebuffers( 2, m_blitFbos );
+		GLint maxBindings = 0;
+		glLogCall( gl::GetIntegerv, GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings );
+		m_pushConstantsBinding = GLuint( std::max( maxBindings, 1 ) - 1 );
+		m_bindlessHandlesBinding = GLuint( std::max( maxBindings, GLint( MaxBindlessSets + 1u ) ) - GLint( MaxBindlessSets + 1u ) );
 		disable();
 	}
 
@@ -528,11 +532,45 @@ namespace gl_renderer
 		glLogCall( gl::Finish );
 	}
 
+	renderer::CallStatistics Device::getCallStatistics( bool reset )const
+	{
+		return getCallCounters().getStatistics( reset );
+	}
+
 	void Device::swapBuffers()const
 	{
 		m_context->swapBuffers();
 	}
 
+	GLuint64 Device::acquireTextureHandle( GLuint texture
+		, GLuint sampler )const
+	{
+		auto handle = glLogCall( gl::GetTextureSamplerHandleARB
+			, texture
+			, sampler );
+		auto it = m_residentTextureHandles.emplace( handle, 0u ).first;
+
+		if ( !it->second )
+		{
+			glLogCall( gl::MakeTextureHandleResidentARB, handle );
+		}
+
+		++it->second;
+		return handle;
+	}
+
+	void Device::releaseTextureHandle( GLuint64 handle )const
+	{
+		auto it = m_residentTextureHandles.find( handle );
+		assert( it != m_residentTextureHandles.end() );
+
+		if ( !--it->second )
+		{
+			glLogCall( gl::MakeTextureHandleNonResidentARB, handle );
+			m_residentTextureHandles.erase( it );
+		}
+	}
+
 	void Device::doEnable()const
 	{
 		m_context->setCurrent();
@@ -18,6 +18,8 @@ See LICENSE file in root folder
 #include <Pipeline/TessellationState.hpp>
 #include <Pipeline/Viewport.hpp>
 
+#include <unordered_map>
+
 namespace gl_renderer
 {
 	/**
@@ -28,6 +30,8 @@ namespace gl_renderer
 		: public renderer::Device
 	{
 	public:
+		//! Le nombre de sets de descripteurs pouvant avoir un tampon de handles sans liaison.
+		static uint32_t constexpr MaxBindlessSets = 4u;
 		/**
 		*\brief
 		*	Constructeur.
@@ -129,6 +133,12 @@ namespace gl_renderer
 		*/
 		void waitIdle()const override;
 		/**
+		*\copydoc	renderer::Device::getCallStatistics
+		*\remarks
+		*	Les compteurs sont ceux de glLogCall, et sont donc partagés par tous les périphériques GL.
+		*/
+		renderer::CallStatistics getCallStatistics( bool reset )const override;
+		/**
 		*\brief
 		*	Echange les tampons.
 		*/
@@ -198,6 +208,53 @@ namespace gl_renderer
 		{
 			return m_blitFbos[1];
 		}
+		/**
+		*\brief
+		*	Le point d'attache du tampon d'uniformes émulant les push constants.
+		*\remarks
+		*	Il s'agit du dernier point d'attache de tampon d'uniformes, afin de ne pas entrer en conflit avec ceux des descripteurs.
+		*/
+		inline GLuint getPushConstantsBinding()const
+		{
+			return m_pushConstantsBinding;
+		}
+		/**
+		*\brief
+		*	Le point d'attache du tampon de handles sans liaison (GL_ARB_bindless_texture) d'un set de descripteurs.
+		*\remarks
+		*	Ces points d'attache précèdent celui des push constants, les shaders les reçoivent
+		*	en tant que RENDERER_BINDLESS_HANDLES_BINDING_<set>.
+		*\param[in] set
+		*	Le point d'attache du set, inférieur à MaxBindlessSets.
+		*/
+		inline GLuint getBindlessHandlesBinding( uint32_t set )const
+		{
+			assert( set < MaxBindlessSets );
+			return m_bindlessHandlesBinding + set;
+		}
+		/**
+		*\brief
+		*	Récupère le handle résident (GL_ARB_bindless_texture) du couple texture + échantillonneur.
+		*\remarks
+		*	Le handle est rendu résident au premier appel, puis compté par référence.
+		*\param[in] texture
+		*	La texture.
+		*\param[in] sampler
+		*	L'échantillonneur.
+		*\return
+		*	Le handle 64 bits.
+		*/
+		GLuint64 acquireTextureHandle( GLuint texture
+			, GLuint sampler )const;
+		/**
+		*\brief
+		*	Libère une référence sur un handle récupéré via acquireTextureHandle.
+		*\remarks
+		*	Le handle est rendu non résident quand il n'est plus référencé.
+		*\param[in] handle
+		*	Le handle 64 bits.
+		*/
+		void releaseTextureHandle( GLuint64 handle )const;
 
 	private:
 		/**
@@ -234,5 +291,8 @@ namespace gl_renderer
 		mutable renderer::InputAssemblyState m_iaState;
 		mutable GLuint m_currentProgram;
 		GLuint m_blitFbos[2];
+		GLuint m_pushConstantsBinding{ 0u };
+		GLuint m_bindlessHandlesBinding{ 0u };
+		mutable std::unordered_map< GLuint64, uint32_t > m_residentTextureHandles;
 	};
 }
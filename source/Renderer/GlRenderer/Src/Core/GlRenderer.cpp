@@ -324,6 +324,15 @@ namespace gl_renderer
 		m_features.hasBaseInstance = gpu.find( "GL_ARB_base_instance" );
 		m_features.hasClearTexImage = gpu.find( "GL_ARB_clear_texture" );
 		m_features.hasComputeShaders = gpu.find( "GL_ARB_compute_shader" );
+		m_features.hasStorageBuffers = gpu.find( "GL_ARB_shader_storage_buffer_object" );
+		m_features.hasBindlessTexture = m_configuration.enableBindlessTextures
+			&& gpu.find( "GL_ARB_bindless_texture" );
+		m_features.hasMultiBind = gpu.find( "GL_ARB_multi_bind" );
+		// The block is bound through layout( binding = RENDERER_PUSH_CONSTANTS_BINDING ).
+		m_features.hasPushConstantsBuffer = m_configuration.enablePushConstantsBuffer
+			&& ( gpu.getShaderVersion() >= 420u || gpu.find( "GL_ARB_shading_language_420pack" ) );
+		// MemoryMapFlag::ePersistent maps with GL_MAP_PERSISTENT_BIT, which needs the buffer storage.
+		m_features.hasPersistentMapping = gpu.find( "GL_ARB_buffer_storage" );
 	}
 
 	renderer::DevicePtr Renderer::createDevice( renderer::ConnectionPtr && connection )const
@@ -1,22 +1,142 @@
 #include "Descriptor/GlDescriptorSet.hpp"
 
 #include "Buffer/GlBuffer.hpp"
+#include "Buffer/GlBufferView.hpp"
+#include "Core/GlDevice.hpp"
 #include "Descriptor/GlDescriptorPool.hpp"
 #include "Image/GlSampler.hpp"
 #include "Image/GlTexture.hpp"
+#include "Image/GlTextureView.hpp"
 #include "Buffer/GlUniformBuffer.hpp"
 
+#include <Core/Renderer.hpp>
 #include <Descriptor/DescriptorSetLayoutBinding.hpp>
 
 #include <algorithm>
 
 namespace gl_renderer
 {
+	namespace
+	{
+		// std140 array stride of a bindless sampler, in GLuint64 units.
+		static uint32_t constexpr BindlessHandleStride = 2u;
+
+		struct TextureEntry
+		{
+			GLuint unit;
+			GLenum target;
+			GLuint texture;
+			GLuint sampler;
+		};
+
+		struct BufferEntry
+		{
+			GLuint unit;
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+			uint32_t dynamicIndex;
+		};
+
+		template< typename EntryT >
+		DescriptorBindingRangeArray doComputeRanges( std::vector< EntryT > & entries )
+		{
+			std::stable_sort( entries.begin()
+				, entries.end()
+				, []( EntryT const & lhs, EntryT const & rhs )
+				{
+					return lhs.unit < rhs.unit;
+				} );
+			DescriptorBindingRangeArray result;
+
+			for ( size_t i = 0u; i < entries.size(); ++i )
+			{
+				if ( result.empty()
+					|| entries[i].unit != result.back().first + GLuint( result.back().count ) )
+				{
+					result.push_back( { entries[i].unit, 1, i } );
+				}
+				else
+				{
+					++result.back().count;
+				}
+			}
+
+			return result;
+		}
+
+		TextureBindingTable doBuildTable( std::vector< TextureEntry > entries )
+		{
+			TextureBindingTable result;
+			result.ranges = doComputeRanges( entries );
+
+			for ( auto & entry : entries )
+			{
+				result.units.push_back( entry.unit );
+				result.targets.push_back( entry.target );
+				result.textures.push_back( entry.texture );
+				result.samplers.push_back( entry.sampler );
+			}
+
+			return result;
+		}
+
+		BufferBindingTable doBuildTable( std::vector< BufferEntry > entries )
+		{
+			BufferBindingTable result;
+			result.ranges = doComputeRanges( entries );
+
+			for ( auto & entry : entries )
+			{
+				result.units.push_back( entry.unit );
+				result.buffers.push_back( entry.buffer );
+				result.offsets.push_back( entry.offset );
+				result.sizes.push_back( entry.size );
+				result.dynamicIndices.push_back( entry.dynamicIndex );
+			}
+
+			return result;
+		}
+
+		TextureView const & getView( renderer::WriteDescriptorSet const & write, uint32_t index )
+		{
+			assert( index < write.imageInfo.size() );
+			return static_cast< TextureView const & >( write.imageInfo[index].imageView.value().get() );
+		}
+
+		Sampler const & getSampler( renderer::WriteDescriptorSet const & write, uint32_t index )
+		{
+			assert( index < write.imageInfo.size() );
+			return static_cast< Sampler const & >( write.imageInfo[index].sampler.value().get() );
+		}
+
+		void doAddBuffers( renderer::WriteDescriptorSet const & write
+			, uint32_t dynamicIndex
+			, std::vector< BufferEntry > & entries )
+		{
+			for ( auto i = 0u; i < write.bufferInfo.size(); ++i )
+			{
+				auto & info = write.bufferInfo[i];
+				entries.push_back( { write.dstBinding + write.dstArrayElement + i
+					, static_cast< Buffer const & >( info.buffer.get() ).getBuffer()
+					, GLintptr( info.offset )
+					, GLsizeiptr( info.range )
+					, dynamicIndex } );
+			}
+		}
+	}
+
 	DescriptorSet::DescriptorSet( renderer::DescriptorPool const & pool
 		, renderer::DescriptorSetLayout const & layout
 		, uint32_t bindingPoint )
 		: renderer::DescriptorSet{ pool, bindingPoint }
+		, m_device{ static_cast< Device const & >( pool.getDevice() ) }
+	{
+	}
+
+	DescriptorSet::~DescriptorSet()
 	{
+		doReleaseBindlessHandles();
 	}
 
 	void DescriptorSet::update()const
@@ -80,5 +200,202 @@ namespace gl_renderer
 		{
 			return lhs.dstBinding < rhs.dstBinding;
 		} );
+
+		doUpdateBindingTables();
+
+		if ( m_device.getRenderer().getFeatures().hasBindlessTexture
+			&& getBindingPoint() < Device::MaxBindlessSets
+			&& !m_combinedTextureSamplers.empty() )
+		{
+			doUpdateBindlessHandles();
+		}
+		else
+		{
+			doReleaseBindlessHandles();
+			m_bindlessHandles.reset();
+		}
+	}
+
+	uint32_t DescriptorSet::getBindlessHandlesBinding()const
+	{
+		return m_device.getBindlessHandlesBinding( getBindingPoint() );
+	}
+
+	void DescriptorSet::doUpdateBindingTables()const
+	{
+		std::vector< TextureEntry > entries;
+
+		for ( auto & write : m_combinedTextureSamplers )
+		{
+			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			{
+				auto & view = getView( write, i );
+				entries.push_back( { write.dstBinding + write.dstArrayElement + i
+					, GLenum( convert( view.getType() ) )
+					, view.getImage()
+					, getSampler( write, i ).getSampler() } );
+			}
+		}
+
+		m_combinedTextureSamplersTable = doBuildTable( std::move( entries ) );
+		entries.clear();
+
+		for ( auto & write : m_samplers )
+		{
+			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			{
+				entries.push_back( { write.dstBinding + write.dstArrayElement + i
+					, 0u
+					, 0u
+					, getSampler( write, i ).getSampler() } );
+			}
+		}
+
+		m_samplersTable = doBuildTable( std::move( entries ) );
+		entries.clear();
+
+		for ( auto & write : m_sampledTextures )
+		{
+			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			{
+				auto & view = getView( write, i );
+				entries.push_back( { write.dstBinding + write.dstArrayElement + i
+					, GLenum( convert( view.getType() ) )
+					, view.getImage()
+					, 0u } );
+			}
+		}
+
+		m_sampledTexturesTable = doBuildTable( std::move( entries ) );
+		entries.clear();
+
+		for ( auto & write : m_texelBuffers )
+		{
+			for ( auto i = 0u; i < write.texelBufferView.size(); ++i )
+			{
+				entries.push_back( { write.dstBinding + write.dstArrayElement + i
+					, GLenum( GL_BUFFER_TARGET_TEXTURE )
+					, static_cast< BufferView const & >( write.texelBufferView[i].get() ).getImage()
+					, 0u } );
+			}
+		}
+
+		m_texelBuffersTable = doBuildTable( std::move( entries ) );
+		m_storageTexturesTable = ImageBindingTable{};
+
+		for ( auto & write : m_storageTextures )
+		{
+			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			{
+				auto & view = getView( write, i );
+				auto & range = view.getSubResourceRange();
+				m_storageTexturesTable.units.push_back( write.dstBinding + write.dstArrayElement + i );
+				m_storageTexturesTable.textures.push_back( view.getImage() );
+				m_storageTexturesTable.levels.push_back( GLint( range.baseMipLevel ) );
+				m_storageTexturesTable.layered.push_back( GLboolean( range.layerCount ) );
+				m_storageTexturesTable.layers.push_back( GLint( range.baseArrayLayer ) );
+				m_storageTexturesTable.formats.push_back( getInternal( view.getFormat() ) );
+			}
+		}
+
+		std::vector< BufferEntry > buffers;
+
+		for ( auto & write : m_uniformBuffers )
+		{
+			doAddBuffers( write, 0u, buffers );
+		}
+
+		m_uniformBuffersTable = doBuildTable( std::move( buffers ) );
+		buffers.clear();
+
+		for ( auto & write : m_storageBuffers )
+		{
+			doAddBuffers( write, 0u, buffers );
+		}
+
+		m_storageBuffersTable = doBuildTable( std::move( buffers ) );
+		buffers.clear();
+		std::vector< BufferEntry > storageBuffers;
+
+		for ( auto i = 0u; i < m_dynamicBuffers.size(); ++i )
+		{
+			auto & write = m_dynamicBuffers[i];
+			doAddBuffers( write
+				, i
+				, ( write.descriptorType == renderer::DescriptorType::eUniformBufferDynamic
+					? buffers
+					: storageBuffers ) );
+		}
+
+		m_dynamicUniformBuffersTable = doBuildTable( std::move( buffers ) );
+		m_dynamicStorageBuffersTable = doBuildTable( std::move( storageBuffers ) );
+	}
+
+	void DescriptorSet::doUpdateBindlessHandles()const
+	{
+		// Acquire the new handles before releasing the old ones,
+		// so that unchanged texture + sampler pairs stay resident.
+		auto previous = std::move( m_residentHandles );
+		m_residentHandles.clear();
+		uint32_t maxBinding = 0u;
+
+		for ( auto & write : m_combinedTextureSamplers )
+		{
+			auto count = uint32_t( write.imageInfo.size() );
+
+			if ( count )
+			{
+				maxBinding = std::max( maxBinding, write.dstBinding + write.dstArrayElement + count - 1u );
+			}
+		}
+
+		// Indexed by binding, so that the shaders don't depend on the set's lowest one.
+		std::vector< GLuint64 > handles( ( maxBinding + 1u ) * BindlessHandleStride, 0u );
+
+		for ( auto & write : m_combinedTextureSamplers )
+		{
+			for ( auto i = 0u; i < write.imageInfo.size(); ++i )
+			{
+				uint32_t bindingIndex = write.dstBinding + write.dstArrayElement + i;
+				auto handle = m_device.acquireTextureHandle( getView( write, i ).getImage()
+					, getSampler( write, i ).getSampler() );
+				m_residentHandles.push_back( handle );
+				handles[bindingIndex * BindlessHandleStride] = handle;
+			}
+		}
+
+		for ( auto handle : previous )
+		{
+			m_device.releaseTextureHandle( handle );
+		}
+
+		auto size = uint32_t( handles.size() * sizeof( GLuint64 ) );
+
+		if ( !m_bindlessHandles
+			|| m_bindlessHandles->getSize() < size )
+		{
+			renderer::Device const & device = m_device;
+			m_bindlessHandles = device.createBuffer( size
+				, renderer::BufferTarget::eUniformBuffer
+				, renderer::MemoryPropertyFlag::eHostVisible | renderer::MemoryPropertyFlag::eHostCoherent );
+		}
+
+		if ( auto * buffer = m_bindlessHandles->lock( 0u
+			, size
+			, renderer::MemoryMapFlag::eWrite ) )
+		{
+			std::memcpy( buffer, handles.data(), size );
+			m_bindlessHandles->unlock();
+		}
+	}
+
+	void DescriptorSet::doReleaseBindlessHandles()const
+	{
+		for ( auto handle : m_residentHandles )
+		{
+			m_device.releaseTextureHandle( handle );
+		}
+
+		m_residentHandles.clear();
 	}
 }
@@ -16,6 +16,59 @@
 
 namespace gl_renderer
 {
+	/**
+	*\brief
+	*	Intervalle de points d'attache contigus, dans une table d'attaches.
+	*/
+	struct DescriptorBindingRange
+	{
+		//! Le premier point d'attache.
+		GLuint first;
+		//! Le nombre de points d'attache.
+		GLsizei count;
+		//! L'indice du premier élément dans les tableaux de la table.
+		size_t index;
+	};
+	using DescriptorBindingRangeArray = std::vector< DescriptorBindingRange >;
+	/**
+	*\brief
+	*	Table pré-calculée d'attaches de textures et/ou d'échantillonneurs, triée par point d'attache.
+	*/
+	struct TextureBindingTable
+	{
+		std::vector< GLuint > units;
+		std::vector< GLenum > targets;
+		std::vector< GLuint > textures;
+		std::vector< GLuint > samplers;
+		DescriptorBindingRangeArray ranges;
+	};
+	/**
+	*\brief
+	*	Table pré-calculée d'attaches d'images de stockage.
+	*/
+	struct ImageBindingTable
+	{
+		std::vector< GLuint > units;
+		std::vector< GLuint > textures;
+		std::vector< GLint > levels;
+		std::vector< GLboolean > layered;
+		std::vector< GLint > layers;
+		std::vector< GlInternal > formats;
+	};
+	/**
+	*\brief
+	*	Table pré-calculée d'attaches de tampons, triée par point d'attache.
+	*/
+	struct BufferBindingTable
+	{
+		std::vector< GLuint > units;
+		std::vector< GLuint > buffers;
+		std::vector< GLintptr > offsets;
+		std::vector< GLsizeiptr > sizes;
+		//! Pour les tampons dynamiques, l'indice du décalage dynamique à appliquer.
+		std::vector< uint32_t > dynamicIndices;
+		DescriptorBindingRangeArray ranges;
+	};
 	/**
 	*\brief
 	*	Set de descripteurs.
@@ -44,11 +97,46 @@ namespace gl_renderer
 			, renderer::DescriptorSetLayout const & layout
 			, uint32_t bindingPoint );
 		/**
+		*\~french
+		*\brief
+		*	Destructeur.
+		*\~english
+		*\brief
+		*	Destructor.
+		*/
+		~DescriptorSet();
+		/**
 		*\copydoc		renderer::DescriptorSet::update
 		*/
 		void update()const override;
 		/**
 		*\brief
+		*	Dit si les attaches sampler + texture sont résolues en handles sans liaison.
+		*/
+		inline bool hasBindlessTextures()const
+		{
+			return m_bindlessHandles != nullptr;
+		}
+		/**
+		*\brief
+		*	Le tampon uniforme contenant les handles sans liaison, un par élément de 16 octets (std140),
+		*	le handle de l'attache \p b se trouvant à l'indice \p b.
+		*/
+		inline renderer::BufferBase const & getBindlessHandlesBuffer()const
+		{
+			assert( m_bindlessHandles );
+			return *m_bindlessHandles;
+		}
+		/**
+		*\brief
+		*	Le point d'attache du tampon de handles sans liaison.
+		*\remarks
+		*	C'est un point d'attache réservé par le device pour le set, il ne peut donc pas entrer en conflit
+		*	avec les tampons d'uniformes des descripteurs.
+		*/
+		uint32_t getBindlessHandlesBinding()const;
+		/**
+		*\brief
 		*	Le tableau d'attaches de type sampler + texture.
 		*/
 		inline renderer::WriteDescriptorSetArray const & getCombinedTextureSamplers()const
@@ -111,8 +199,94 @@ namespace gl_renderer
 		{
 			return m_dynamicBuffers;
 		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type sampler + texture.
+		*/
+		inline TextureBindingTable const & getCombinedTextureSamplersTable()const
+		{
+			return m_combinedTextureSamplersTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type sampler.
+		*/
+		inline TextureBindingTable const & getSamplersTable()const
+		{
+			return m_samplersTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type texture échantillonnée.
+		*/
+		inline TextureBindingTable const & getSampledTexturesTable()const
+		{
+			return m_sampledTexturesTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type tampon de texels.
+		*/
+		inline TextureBindingTable const & getTexelBuffersTable()const
+		{
+			return m_texelBuffersTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type texture de stockage.
+		*/
+		inline ImageBindingTable const & getStorageTexturesTable()const
+		{
+			return m_storageTexturesTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type tampon uniforme.
+		*/
+		inline BufferBindingTable const & getUniformBuffersTable()const
+		{
+			return m_uniformBuffersTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type tampon de stockage.
+		*/
+		inline BufferBindingTable const & getStorageBuffersTable()const
+		{
+			return m_storageBuffersTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type tampon uniforme dynamique.
+		*/
+		inline BufferBindingTable const & getDynamicUniformBuffersTable()const
+		{
+			return m_dynamicUniformBuffersTable;
+		}
+		/**
+		*\brief
+		*	La table pré-calculée des attaches de type tampon de stockage dynamique.
+		*/
+		inline BufferBindingTable const & getDynamicStorageBuffersTable()const
+		{
+			return m_dynamicStorageBuffersTable;
+		}
+		/**
+		*\brief
+		*	Le périphérique logique.
+		*/
+		inline Device const & getDevice()const
+		{
+			return m_device;
+		}
+
+	private:
+		void doUpdateBindingTables()const;
+		void doUpdateBindlessHandles()const;
+		void doReleaseBindlessHandles()const;
 
 	private:
+		Device const & m_device;
 		mutable renderer::WriteDescriptorSetArray m_combinedTextureSamplers;
 		mutable renderer::WriteDescriptorSetArray m_samplers;
 		mutable renderer::WriteDescriptorSetArray m_sampledTextures;
@@ -123,6 +297,17 @@ namespace gl_renderer
 		mutable renderer::WriteDescriptorSetArray m_dynamicUniformBuffers;
 		mutable renderer::WriteDescriptorSetArray m_dynamicStorageBuffers;
 		mutable renderer::WriteDescriptorSetArray m_dynamicBuffers;
+		mutable TextureBindingTable m_combinedTextureSamplersTable;
+		mutable TextureBindingTable m_samplersTable;
+		mutable TextureBindingTable m_sampledTexturesTable;
+		mutable TextureBindingTable m_texelBuffersTable;
+		mutable ImageBindingTable m_storageTexturesTable;
+		mutable BufferBindingTable m_uniformBuffersTable;
+		mutable BufferBindingTable m_storageBuffersTable;
+		mutable BufferBindingTable m_dynamicUniformBuffersTable;
+		mutable BufferBindingTable m_dynamicStorageBuffersTable;
+		mutable std::vector< GLuint64 > m_residentHandles;
+		mutable renderer::BufferBasePtr m_bindlessHandles;
 	};
 }
 
@@ -33,7 +33,7 @@ namespace gl_renderer
 
 		if ( checkFlag( value, gl_renderer::GlMemoryPropertyFlag::GL_MEMORY_PROPERTY_PERSISTENT_BIT ) )
 		{
-			result += sep + "GL_MAP_INVALIDATE_RANGE_BIT";
+			result += sep + "GL_MAP_PERSISTENT_BIT";
 		}
 
 		return result;
@@ -43,6 +43,7 @@ namespace gl_renderer
 	{
 		GlMemoryPropertyFlags result{ 0 };
 
+		// Only the host coherent storage can be mapped persistently, the other ones are flushed explicitly.
 		if ( checkFlag( flags, renderer::MemoryPropertyFlag::eHostCoherent ) )
 		{
 			result = GL_MEMORY_PROPERTY_COHERENT_BIT
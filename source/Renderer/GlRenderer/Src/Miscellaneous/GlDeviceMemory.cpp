@@ -128,6 +128,7 @@ namespace gl_renderer
 				assert( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostVisible ) && "Unsupported action on a device local texture" );
 				glLogCall( gl::BindBuffer, GL_BUFFER_TARGET_PIXEL_UNPACK, m_pbo );
 				doSetupUpdateRegions( offset, size );
+				m_mapFlags = doGetMapFlags( flags );
 				auto result = glLogCall( gl::MapBufferRange, GL_BUFFER_TARGET_PIXEL_UNPACK, offset, size, m_mapFlags );
 				assertDebugValue( m_isLocked, false );
 				setDebugValue( m_isLocked, result != nullptr );
@@ -139,7 +140,12 @@ namespace gl_renderer
 			{
 				assert( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostVisible ) && "Unsupported action on a device local texture" );
 				assertDebugValue( m_isLocked, true );
-				glLogCall( gl::FlushMappedBufferRange, GL_BUFFER_TARGET_PIXEL_UNPACK, offset, size );
+
+				// Without GL_MAP_FLUSH_EXPLICIT_BIT, the writes are made visible at unmap, or continuously by a coherent mapping.
+				if ( checkFlag( m_mapFlags, GL_MEMORY_MAP_FLUSH_EXPLICIT_BIT ) )
+				{
+					glLogCall( gl::FlushMappedBufferRange, GL_BUFFER_TARGET_PIXEL_UNPACK, offset, size );
+				}
 			}
 
 			void invalidate( uint32_t offset
@@ -451,17 +457,26 @@ namespace gl_renderer
 				assert( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostVisible ) && "Unsupported action on a device local buffer" );
 				assertDebugValue( m_isLocked, false );
 				glLogCall( gl::BindBuffer, GL_BUFFER_TARGET_COPY_WRITE, m_boundResource );
+				m_mapFlags = doGetMapFlags( flags );
 				auto result = glLogCall( gl::MapBufferRange, GL_BUFFER_TARGET_COPY_WRITE, offset, size, m_mapFlags );
 				setDebugValue( m_isLocked, result != nullptr );
 				return reinterpret_cast< uint8_t * >( result );
 			}
 
+			// The buffer is bound again in the following functions, since persistent mappings
+			// can outlive other uses of the GL_BUFFER_TARGET_COPY_WRITE binding point.
 			void flush( uint32_t offset
 				, uint32_t size )const override
 			{
 				assert( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostVisible ) && "Unsupported action on a device local buffer" );
 				assertDebugValue( m_isLocked, true );
-				glLogCall( gl::FlushMappedBufferRange, GL_BUFFER_TARGET_COPY_WRITE, offset, size );
+				glLogCall( gl::BindBuffer, GL_BUFFER_TARGET_COPY_WRITE, m_boundResource );
+
+				// Without GL_MAP_FLUSH_EXPLICIT_BIT, the writes are made visible at unmap, or continuously by a coherent mapping.
+				if ( checkFlag( m_mapFlags, GL_MEMORY_MAP_FLUSH_EXPLICIT_BIT ) )
+				{
+					glLogCall( gl::FlushMappedBufferRange, GL_BUFFER_TARGET_COPY_WRITE, offset, size );
+				}
 			}
 
 			void invalidate( uint32_t offset
@@ -469,6 +484,7 @@ namespace gl_renderer
 			{
 				assert( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostVisible ) && "Unsupported action on a device local buffer" );
 				assertDebugValue( m_isLocked, true );
+				glLogCall( gl::BindBuffer, GL_BUFFER_TARGET_COPY_WRITE, m_boundResource );
 				glLogCall( gl::InvalidateBufferSubData, GL_BUFFER_TARGET_COPY_WRITE, offset, size );
 			}
 
@@ -476,6 +492,7 @@ namespace gl_renderer
 			{
 				assert( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostVisible ) && "Unsupported action on a device local buffer" );
 				assertDebugValue( m_isLocked, true );
+				glLogCall( gl::BindBuffer, GL_BUFFER_TARGET_COPY_WRITE, m_boundResource );
 				glLogCall( gl::UnmapBuffer, GL_BUFFER_TARGET_COPY_WRITE );
 				glLogCall( gl::BindBuffer, GL_BUFFER_TARGET_COPY_WRITE, 0u );
 				setDebugValue( m_isLocked, false );
@@ -498,15 +515,37 @@ namespace gl_renderer
 		, m_boundTarget{ boundTarget }
 		, m_flags{ flags }
 	{
-		if ( checkFlag( flags, renderer::MemoryPropertyFlag::eHostVisible ) )
+	}
+
+	GlMemoryMapFlags DeviceMemory::DeviceMemoryImpl::doGetMapFlags( renderer::MemoryMapFlags flags )const
+	{
+		auto result = convert( flags );
+
+		if ( checkFlag( m_flags, renderer::MemoryPropertyFlag::eHostCoherent ) )
 		{
-			m_mapFlags |= GL_MEMORY_MAP_READ_BIT | GL_MEMORY_MAP_WRITE_BIT | GL_MEMORY_MAP_FLUSH_EXPLICIT_BIT;
+			// Only host coherent storage is allocated persistent (see convert).
+			// Its persistent mappings are coherent, since nothing issues the client mapped buffer barriers,
+			// and GL needs coherent mappings to be persistent.
+			if ( checkFlag( flags, renderer::MemoryMapFlag::ePersistent )
+				|| checkFlag( flags, renderer::MemoryMapFlag::eCoherent ) )
+			{
+				result |= GL_MEMORY_MAP_PERSISTENT_BIT | GL_MEMORY_MAP_COHERENT_BIT;
+			}
 		}
-
-		if ( checkFlag( flags, renderer::MemoryPropertyFlag::eHostCoherent ) )
+		else
 		{
-			m_mapFlags |= GL_MEMORY_MAP_COHERENT_BIT;
+			assert( !checkFlag( flags, renderer::MemoryMapFlag::ePersistent )
+				&& !checkFlag( flags, renderer::MemoryMapFlag::eCoherent )
+				&& "Persistent and coherent mappings need host coherent memory" );
+
+			// Non coherent writes are made visible by flush only.
+			if ( checkFlag( flags, renderer::MemoryMapFlag::eWrite ) )
+			{
+				result |= GL_MEMORY_MAP_FLUSH_EXPLICIT_BIT;
+			}
 		}
+
+		return result;
 	}
 
 	//************************************************************************************************
@@ -543,6 +582,7 @@ namespace gl_renderer
 		, renderer::MemoryMapFlags flags )const
 	{
 		assert( m_impl && "Memory object was not bound to a resource object" );
+		doSetMapped( size, flags );
 		return m_impl->lock( offset, size, flags );
 	}
 
@@ -551,6 +591,7 @@ namespace gl_renderer
 	{
 		assert( m_impl && "Memory object was not bound to a resource object" );
 		m_impl->flush( offset, size );
+		getCallCounters().addUploadedBytes( doGetFlushedBytes( size ) );
 	}
 
 	void DeviceMemory::invalidate( uint32_t offset
@@ -564,6 +605,7 @@ namespace gl_renderer
 	{
 		assert( m_impl && "Memory object was not bound to a resource object" );
 		m_impl->unlock();
+		getCallCounters().addUploadedBytes( doGetUnmappedBytes() );
 	}
 
 	//************************************************************************************************
@@ -40,10 +40,13 @@ namespace gl_renderer
 				, uint32_t size )const = 0;
 			virtual void unlock()const = 0;
 
+		protected:
+			GlMemoryMapFlags doGetMapFlags( renderer::MemoryMapFlags flags )const;
+
 		protected:
 			renderer::MemoryRequirements m_requirements;
 			renderer::MemoryPropertyFlags m_flags;
-			GlMemoryMapFlags m_mapFlags;
+			mutable GlMemoryMapFlags m_mapFlags;
 			GLuint m_boundResource;
 			GLenum m_boundTarget;
 			declareDebugVariable( bool, m_isLocked, false );
@@ -4,6 +4,7 @@
 #include "Pipeline/GlPipelineLayout.hpp"
 #include "RenderPass/GlRenderPass.hpp"
 
+#include <Core/Renderer.hpp>
 #include <Pipeline/VertexInputAttributeDescription.hpp>
 #include <Pipeline/VertexInputState.hpp>
 
@@ -767,6 +768,26 @@ namespace gl_renderer
 				} );
 		}
 
+		void doValidatePushConstants( PipelineLayout const & layout
+			, GLuint program )
+		{
+			auto binding = GLint( layout.getDevice().getPushConstantsBinding() );
+			getProgramInterfaceInfos( program
+				, GLSL_INTERFACE_UNIFORM_BLOCK
+				, { GLSL_PROPERTY_BUFFER_BINDING, GLSL_PROPERTY_BUFFER_DATA_SIZE }
+				, [&layout, binding]( std::string const & name, std::vector< GLint > const & values )
+				{
+					if ( values[0] == binding
+						&& uint32_t( values[1] ) > layout.getPushConstantsSize() )
+					{
+						renderer::Logger::logError( std::stringstream{} << ValidationError
+							<< "Push constants block [" << name
+							<< "], of size: " << values[1]
+							<< " is larger than the pipeline layout's push constant ranges (" << layout.getPushConstantsSize() << ")" );
+					}
+				} );
+		}
+
 		void doValidateUniforms( GLuint program )
 		{
 			GLint numUniforms = 0;
@@ -799,6 +820,12 @@ namespace gl_renderer
 	{
 		doValidateInputs( program, vertexInputState );
 		doValidateOutputs( program, static_cast< RenderPass const & >( renderPass ) );
+
+		if ( layout.getDevice().getRenderer().getFeatures().hasPushConstantsBuffer )
+		{
+			doValidatePushConstants( layout, program );
+		}
+
 		//doValidateUbos( program );
 		//doValidateSsbos( program );
 		//doValidateUniforms( program );
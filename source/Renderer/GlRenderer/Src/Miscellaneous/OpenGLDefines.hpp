@@ -145,10 +145,13 @@ namespace gl_renderer
 	using PFN_glBindBuffer = void ( GLAPIENTRY * )( GLenum target, GLuint buffer );
 	using PFN_glBindBufferBase = void ( GLAPIENTRY * )( GLenum target, GLuint index, GLuint buffer );
 	using PFN_glBindBufferRange = void ( GLAPIENTRY * )( GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size );
+	using PFN_glBindBuffersRange = void ( GLAPIENTRY * )( GLenum target, GLuint first, GLsizei count, const GLuint * buffers, const GLintptr * offsets, const GLsizeiptr * sizes );
 	using PFN_glBindFramebuffer = void ( GLAPIENTRY * )( GLenum target, GLuint framebuffer );
 	using PFN_glBindImageTexture = void ( GLAPIENTRY * )( GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format );
 	using PFN_glBindSampler = void ( GLAPIENTRY * )( GLuint unit, GLuint sampler );
+	using PFN_glBindSamplers = void ( GLAPIENTRY * )( GLuint first, GLsizei count, const GLuint * samplers );
 	using PFN_glBindTexture = void ( GLAPIENTRY * )( GLenum target, GLuint texture );
+	using PFN_glBindTextures = void ( GLAPIENTRY * )( GLuint first, GLsizei count, const GLuint * textures );
 	using PFN_glBindVertexArray = void ( GLAPIENTRY * )( GLuint array );
 	using PFN_glBlendColor = void ( GLAPIENTRY * )( GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha );
 	using PFN_glBlendEquationSeparatei = void ( GLAPIENTRY * )( GLuint buf, GLenum modeRGB, GLenum modeAlpha );
@@ -236,10 +239,13 @@ namespace gl_renderer
 	using PFN_glGetTexLevelParameteriv = void ( GLAPIENTRY * )( GLenum target, GLint level, GLenum pname, GLint * params );
 	using PFN_glGetTexParameterfv = void ( GLAPIENTRY * )( GLenum target, GLenum pname, GLfloat * params );
 	using PFN_glGetTexParameteriv = void ( GLAPIENTRY * )( GLenum target, GLenum pname, GLint * params );
+	using PFN_glGetTextureSamplerHandleARB = GLuint64 ( GLAPIENTRY * )( GLuint texture, GLuint sampler );
 	using PFN_glInvalidateBufferSubData = void ( GLAPIENTRY * )( GLuint buffer, GLintptr offset, GLsizeiptr length );
 	using PFN_glLineWidth = void ( GLAPIENTRY * )( GLfloat width );
 	using PFN_glLinkProgram = void ( GLAPIENTRY * )( GLuint program );
 	using PFN_glLogicOp = void ( GLAPIENTRY * )( GLenum opcode );
+	using PFN_glMakeTextureHandleNonResidentARB = void ( GLAPIENTRY * )( GLuint64 handle );
+	using PFN_glMakeTextureHandleResidentARB = void ( GLAPIENTRY * )( GLuint64 handle );
 	using PFN_glMapBufferRange = void * ( GLAPIENTRY * )( GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access );
 	using PFN_glMemoryBarrier = void ( GLAPIENTRY * )( GLbitfield barriers );
 	using PFN_glMinSampleShading = void ( GLAPIENTRY * )( GLfloat value );
@@ -175,8 +175,14 @@ GL_LIB_FUNCTION( VertexAttribIPointer )
 #	define GL_LIB_FUNCTION_OPT( x )
 #endif
 
+GL_LIB_FUNCTION_OPT( BindBuffersRange )
+GL_LIB_FUNCTION_OPT( BindSamplers )
+GL_LIB_FUNCTION_OPT( BindTextures )
 GL_LIB_FUNCTION_OPT( ClearTexImage )
 GL_LIB_FUNCTION_OPT( DispatchComputeIndirect )
+GL_LIB_FUNCTION_OPT( GetTextureSamplerHandleARB )
+GL_LIB_FUNCTION_OPT( MakeTextureHandleNonResidentARB )
+GL_LIB_FUNCTION_OPT( MakeTextureHandleResidentARB )
 GL_LIB_FUNCTION_OPT( MinSampleShading )
 GL_LIB_FUNCTION_OPT( MultiDrawArraysIndirect )
 GL_LIB_FUNCTION_OPT( MultiDrawElementsIndirect )
@@ -5,6 +5,8 @@
 #include "Pipeline/GlComputePipeline.hpp"
 #include "Pipeline/GlPipeline.hpp"
 
+#include <algorithm>
+
 namespace gl_renderer
 {
 	PipelineLayout::PipelineLayout( Device const & device
@@ -13,6 +15,14 @@ namespace gl_renderer
 		: renderer::PipelineLayout{ device, setLayouts, pushConstantRanges }
 		, m_device{ device }
 	{
+		for ( auto & range : pushConstantRanges )
+		{
+			m_pushConstantRanges.push_back( range.get() );
+			m_pushConstantsSize = std::max( m_pushConstantsSize
+				, range.get().offset + range.get().size );
+		}
+
+		m_pushConstantsSize = ( m_pushConstantsSize + 15u ) & ~15u;
 	}
 
 	renderer::PipelinePtr PipelineLayout::createPipeline( renderer::GraphicsPipelineCreateInfo createInfo )const
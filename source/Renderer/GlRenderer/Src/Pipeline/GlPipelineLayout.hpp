@@ -6,6 +6,7 @@ See LICENSE file in root folder
 
 #include "GlRendererPrerequisites.hpp"
 
+#include <Miscellaneous/PushConstantRange.hpp>
 #include <Pipeline/PipelineLayout.hpp>
 
 namespace gl_renderer
@@ -49,8 +50,34 @@ namespace gl_renderer
 		*\copydoc	renderer::PipelineLayout::createPipeline
 		*/
 		renderer::ComputePipelinePtr createPipeline( renderer::ComputePipelineCreateInfo createInfo )const override;
+		/**
+		*\return
+		*	Le périphérique logique.
+		*/
+		inline Device const & getDevice()const
+		{
+			return m_device;
+		}
+		/**
+		*\return
+		*	Les intervalles de push constants.
+		*/
+		inline renderer::PushConstantRangeArray const & getPushConstantRanges()const
+		{
+			return m_pushConstantRanges;
+		}
+		/**
+		*\return
+		*	La taille du bloc de push constants, arrondie à 16 octets (std140).
+		*/
+		inline uint32_t getPushConstantsSize()const
+		{
+			return m_pushConstantsSize;
+		}
 
 	private:
 		Device const & m_device;
+		renderer::PushConstantRangeArray m_pushConstantRanges;
+		uint32_t m_pushConstantsSize{ 0u };
 	};
 }
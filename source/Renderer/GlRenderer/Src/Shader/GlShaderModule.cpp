@@ -7,6 +7,9 @@ See LICENSE file in root folder.
 #include "Core/GlDevice.hpp"
 #include "Core/GlPhysicalDevice.hpp"
 
+#include <Core/Renderer.hpp>
+
+#include <cstdlib>
 #include <iostream>
 #include <regex>
 
@@ -97,6 +100,44 @@ namespace gl_renderer
 $&)" );
 		}
 
+		auto & features = m_device.getRenderer().getFeatures();
+		std::string preamble;
+
+		if ( features.hasPushConstantsBuffer )
+		{
+			preamble += "#define RENDERER_PUSH_CONSTANTS_BINDING " + std::to_string( m_device.getPushConstantsBinding() ) + "\n";
+		}
+
+		if ( features.hasBindlessTexture )
+		{
+			// The handles blocks, indexed by sampler binding, one per descriptor set.
+			preamble = "#extension GL_ARB_bindless_texture : enable\n" + preamble;
+
+			for ( auto set = 0u; set < Device::MaxBindlessSets; ++set )
+			{
+				preamble += "#define RENDERER_BINDLESS_HANDLES_BINDING_" + std::to_string( set )
+					+ " " + std::to_string( m_device.getBindlessHandlesBinding( set ) ) + "\n";
+			}
+		}
+
+		if ( !preamble.empty() )
+		{
+			std::regex regex{ R"(#version[ \t]*(\d*)[^\n]*\n)" };
+			std::smatch match;
+
+			// The binding layout qualifier of uniform blocks needs GLSL 4.20.
+			if ( std::regex_search( source, match, regex )
+				&& std::atoi( match[1].str().c_str() ) < 420 )
+			{
+				preamble = "#extension GL_ARB_shading_language_420pack : enable\n" + preamble;
+			}
+
+			source = std::regex_replace( source
+				, regex
+				, "$&" + preamble
+				, std::regex_constants::format_first_only );
+		}
+
 		auto length = int( source.size() );
 		char const * data = source.data();
 		glLogCall( gl::ShaderSource, m_shader, 1, &data, &length );
@@ -0,0 +1,149 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#ifndef ___Renderer_InstanceRing_HPP___
+#define ___Renderer_InstanceRing_HPP___
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace renderer
+{
+	/**
+	*\~english
+	*\brief
+	*	A range of instances published in an InstanceRing.
+	*\remarks
+	*	The indices are monotonic, they are wrapped into the ring when accessing the storage.
+	*\~french
+	*\brief
+	*	Un intervalle d'instances publiées dans un InstanceRing.
+	*\remarks
+	*	Les indices sont monotones, ils sont ramenés dans l'anneau lors de l'accès au stockage.
+	*/
+	struct InstanceRange
+	{
+		uint32_t begin;
+		uint32_t end;
+	};
+	/**
+	*\~english
+	*\brief
+	*	The indices of a single producer, single consumer ring, independent from its storage.
+	*\remarks
+	*	The producer thread writes the records in the segments given by push, then publishes them.
+	*	The consumer thread acquires the records published since its last acquisition, and releases them once they are consumed.
+	*	The storage accesses are done through functors receiving the wrapped first index and the size of each contiguous segment.
+	*\~french
+	*\brief
+	*	Les indices d'un anneau à un seul producteur et un seul consommateur, indépendants de son stockage.
+	*\remarks
+	*	Le thread producteur écrit les enregistrements dans les segments donnés par push, puis les publie.
+	*	Le thread consommateur récupère les enregistrements publiés depuis sa dernière récupération, et les libère une fois consommés.
+	*	Les accès au stockage se font via des foncteurs recevant le premier indice ramené et la taille de chaque segment contigu.
+	*/
+	class InstanceRing
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] count
+		*	The minimal capacity, rounded up to the next power of two.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] count
+		*	La capacité minimale, arrondie à la puissance de deux supérieure.
+		*/
+		inline explicit InstanceRing( uint32_t count );
+		InstanceRing( InstanceRing const & ) = delete;
+		InstanceRing & operator=( InstanceRing const & ) = delete;
+		/**
+		*\~english
+		*\brief
+		*	Producer side: reserves as many records as possible, writes them, and publishes them.
+		*\param[in] count
+		*	The records count.
+		*\param[in] write
+		*	Writes a segment of records, called with the segment's first index and size.
+		*\return
+		*	The number of records actually published.
+		*\~french
+		*\brief
+		*	Côté producteur : réserve autant d'enregistrements que possible, les écrit, et les publie.
+		*\param[in] count
+		*	Le nombre d'enregistrements.
+		*\param[in] write
+		*	Ecrit un segment d'enregistrements, appelé avec le premier indice et la taille du segment.
+		*\return
+		*	Le nombre d'enregistrements réellement publiés.
+		*/
+		template< typename FuncT >
+		inline uint32_t push( uint32_t count
+			, FuncT write );
+		/**
+		*\~english
+		*\brief
+		*	Consumer side: retrieves the records published since the previous call.
+		*\~french
+		*\brief
+		*	Côté consommateur : récupère les enregistrements publiés depuis l'appel précédent.
+		*/
+		inline InstanceRange acquire();
+		/**
+		*\~english
+		*\brief
+		*	Consumer side: gives back to the producer the space used by an acquired range.
+		*\remarks
+		*	Ranges must be released in acquisition order.
+		*\~french
+		*\brief
+		*	Côté consommateur : rend au producteur l'espace utilisé par un intervalle récupéré.
+		*\remarks
+		*	Les intervalles doivent être libérés dans l'ordre de récupération.
+		*/
+		inline void release( InstanceRange const & range );
+		/**
+		*\~english
+		*\brief
+		*	Calls a functor on each contiguous segment of a range, with the segment's first index and size.
+		*\remarks
+		*	A range wrapping around the end of the ring has two segments.
+		*\~french
+		*\brief
+		*	Appelle un foncteur sur chaque segment contigu d'un intervalle, avec le premier indice et la taille du segment.
+		*\remarks
+		*	Un intervalle bouclant sur la fin de l'anneau a deux segments.
+		*/
+		template< typename FuncT >
+		inline void forEachSegment( InstanceRange const & range
+			, FuncT function )const;
+		/**
+		*\~english
+		*\return
+		*	The capacity.
+		*\~french
+		*\return
+		*	La capacité.
+		*/
+		inline uint32_t getCapacity()const
+		{
+			return m_capacity;
+		}
+
+	private:
+		uint32_t m_capacity;
+		uint32_t m_mask;
+		uint32_t m_acquired{ 0u };
+		alignas( 64 ) std::atomic< uint32_t > m_head{ 0u };
+		alignas( 64 ) std::atomic< uint32_t > m_tail{ 0u };
+	};
+}
+
+#include "InstanceRing.inl"
+
+#endif
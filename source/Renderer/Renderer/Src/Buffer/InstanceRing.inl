@@ -0,0 +1,80 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include <algorithm>
+#include <cassert>
+
+namespace renderer
+{
+	namespace details
+	{
+		inline uint32_t getNextPowerOfTwo( uint32_t value )
+		{
+			uint32_t result = 1u;
+
+			while ( result < value )
+			{
+				result <<= 1u;
+			}
+
+			return result;
+		}
+	}
+
+	inline InstanceRing::InstanceRing( uint32_t count )
+		: m_capacity{ details::getNextPowerOfTwo( std::max( count, 1u ) ) }
+		, m_mask{ m_capacity - 1u }
+	{
+	}
+
+	template< typename FuncT >
+	inline uint32_t InstanceRing::push( uint32_t count
+		, FuncT write )
+	{
+		auto head = m_head.load( std::memory_order_relaxed );
+		auto tail = m_tail.load( std::memory_order_acquire );
+		count = std::min( count, m_capacity - ( head - tail ) );
+
+		if ( count )
+		{
+			forEachSegment( { head, head + count }, write );
+			m_head.store( head + count, std::memory_order_release );
+		}
+
+		return count;
+	}
+
+	inline InstanceRange InstanceRing::acquire()
+	{
+		InstanceRange result{ m_acquired, m_head.load( std::memory_order_acquire ) };
+		m_acquired = result.end;
+		return result;
+	}
+
+	inline void InstanceRing::release( InstanceRange const & range )
+	{
+		assert( range.begin == m_tail.load( std::memory_order_relaxed )
+			&& "Instance ranges must be released in acquisition order" );
+		m_tail.store( range.end, std::memory_order_release );
+	}
+
+	template< typename FuncT >
+	inline void InstanceRing::forEachSegment( InstanceRange const & range
+		, FuncT function )const
+	{
+		auto count = range.end - range.begin;
+
+		if ( count )
+		{
+			auto first = range.begin & m_mask;
+			auto size = std::min( count, m_capacity - first );
+			function( first, size );
+
+			if ( size < count )
+			{
+				function( 0u, count - size );
+			}
+		}
+	}
+}
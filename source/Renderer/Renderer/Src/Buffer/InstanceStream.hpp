@@ -0,0 +1,196 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#ifndef ___Renderer_InstanceStream_HPP___
+#define ___Renderer_InstanceStream_HPP___
+#pragma once
+
+#include "Buffer/InstanceRing.hpp"
+#include "Buffer/VertexBuffer.hpp"
+
+namespace renderer
+{
+	/**
+	*\~english
+	*\brief
+	*	Single producer, single consumer stream of per-instance data.
+	*\remarks
+	*	The producer thread appends records, without locking, into a persistently mapped ring buffer (see InstanceRing).
+	*	The render thread acquires the records published since its last acquisition, draws them using firstInstance,
+	*	and releases them once the GPU is done with them (typically after the frame's fence has been waited).
+	*	No staging buffer is involved: the buffer lives in host visible memory and is read directly by the GPU.
+	*	On OpenGL, firstInstance requires RendererFeatures::hasBaseInstance.
+	*\~french
+	*\brief
+	*	Flux de données par instance, à un seul producteur et un seul consommateur.
+	*\remarks
+	*	Le thread producteur ajoute des enregistrements, sans verrou, dans un tampon circulaire mappé de manière persistante (voir InstanceRing).
+	*	Le thread de rendu récupère les enregistrements publiés depuis sa dernière récupération, les dessine via firstInstance,
+	*	et les libère une fois que le GPU en a fini avec eux (typiquement après l'attente de la fence de l'image).
+	*	Aucun tampon de transfert n'est utilisé : le tampon est en mémoire visible par l'hôte, et est lu directement par le GPU.
+	*	En OpenGL, firstInstance nécessite RendererFeatures::hasBaseInstance.
+	*/
+	template< typename T >
+	class InstanceStream
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor, creates the buffer and maps it persistently.
+		*\param[in] device
+		*	The logical device.
+		*\param[in] count
+		*	The minimal instances capacity, rounded up to the next power of two.
+		*\param[in] flags
+		*	The buffer memory flags, must contain MemoryPropertyFlag::eHostVisible and MemoryPropertyFlag::eHostCoherent.
+		*\~french
+		*\brief
+		*	Constructeur, crée le tampon et le mappe de manière persistante.
+		*\param[in] device
+		*	Le périphérique logique.
+		*\param[in] count
+		*	La capacité minimale en instances, arrondie à la puissance de deux supérieure.
+		*\param[in] flags
+		*	Les indicateurs de mémoire du tampon, doivent contenir MemoryPropertyFlag::eHostVisible et MemoryPropertyFlag::eHostCoherent.
+		*/
+		inline InstanceStream( Device const & device
+			, uint32_t count
+			, MemoryPropertyFlags flags = MemoryPropertyFlag::eHostVisible | MemoryPropertyFlag::eHostCoherent );
+		/**
+		*\~english
+		*\brief
+		*	Destructor, unmaps the buffer.
+		*\~french
+		*\brief
+		*	Destructeur, démappe le tampon.
+		*/
+		inline ~InstanceStream();
+		InstanceStream( InstanceStream const & ) = delete;
+		InstanceStream & operator=( InstanceStream const & ) = delete;
+		/**
+		*\~english
+		*\brief
+		*	Producer side: appends one instance.
+		*\return
+		*	\p false if the stream is full.
+		*\~french
+		*\brief
+		*	Côté producteur : ajoute une instance.
+		*\return
+		*	\p false si le flux est plein.
+		*/
+		inline bool push( T const & value );
+		/**
+		*\~english
+		*\brief
+		*	Producer side: appends as many instances as possible.
+		*\param[in] values
+		*	The instances.
+		*\param[in] count
+		*	The instances count.
+		*\return
+		*	The number of instances actually appended.
+		*\~french
+		*\brief
+		*	Côté producteur : ajoute autant d'instances que possible.
+		*\param[in] values
+		*	Les instances.
+		*\param[in] count
+		*	Le nombre d'instances.
+		*\return
+		*	Le nombre d'instances réellement ajoutées.
+		*/
+		inline uint32_t push( T const * values
+			, uint32_t count );
+		/**
+		*\~english
+		*\brief
+		*	Consumer side: retrieves the instances published since the previous call, and makes them visible to the GPU.
+		*\~french
+		*\brief
+		*	Côté consommateur : récupère les instances publiées depuis l'appel précédent, et les rend visibles au GPU.
+		*/
+		inline InstanceRange acquire();
+		/**
+		*\~english
+		*\brief
+		*	Consumer side: gives back to the producer the space used by an acquired range.
+		*\remarks
+		*	Ranges must be released in acquisition order, once the GPU doesn't read them anymore.
+		*\~french
+		*\brief
+		*	Côté consommateur : rend au producteur l'espace utilisé par un intervalle récupéré.
+		*\remarks
+		*	Les intervalles doivent être libérés dans l'ordre de récupération, une fois que le GPU ne les lit plus.
+		*/
+		inline void release( InstanceRange const & range );
+		/**
+		*\~english
+		*\brief
+		*	Records the non indexed draws of an acquired range.
+		*\remarks
+		*	Two draws are recorded if the range wraps around the end of the buffer.
+		*\~french
+		*\brief
+		*	Enregistre les dessins non indexés d'un intervalle récupéré.
+		*\remarks
+		*	Deux dessins sont enregistrés si l'intervalle boucle sur la fin du tampon.
+		*/
+		inline void draw( CommandBuffer const & commandBuffer
+			, InstanceRange const & range
+			, uint32_t vtxCount
+			, uint32_t firstVertex = 0u )const;
+		/**
+		*\~english
+		*\brief
+		*	Records the indexed draws of an acquired range.
+		*\remarks
+		*	Two draws are recorded if the range wraps around the end of the buffer.
+		*\~french
+		*\brief
+		*	Enregistre les dessins indexés d'un intervalle récupéré.
+		*\remarks
+		*	Deux dessins sont enregistrés si l'intervalle boucle sur la fin du tampon.
+		*/
+		inline void drawIndexed( CommandBuffer const & commandBuffer
+			, InstanceRange const & range
+			, uint32_t indexCount
+			, uint32_t firstIndex = 0u
+			, uint32_t vertexOffset = 0u )const;
+		/**
+		*\~english
+		*\return
+		*	The instances capacity.
+		*\~french
+		*\return
+		*	La capacité en instances.
+		*/
+		inline uint32_t getCapacity()const
+		{
+			return m_ring.getCapacity();
+		}
+		/**
+		*\~english
+		*\return
+		*	The vertex buffer to bind on the per-instance binding.
+		*\~french
+		*\return
+		*	Le tampon de sommets à attacher au point d'attache par instance.
+		*/
+		inline VertexBuffer< T > const & getVertexBuffer()const
+		{
+			return *m_buffer;
+		}
+
+	private:
+		InstanceRing m_ring;
+		VertexBufferPtr< T > m_buffer;
+		T * m_data{ nullptr };
+	};
+}
+
+#include "InstanceStream.inl"
+
+#endif
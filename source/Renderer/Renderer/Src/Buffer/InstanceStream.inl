@@ -0,0 +1,109 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include "Command/CommandBuffer.hpp"
+
+#include <cstring>
+
+namespace renderer
+{
+	template< typename T >
+	inline InstanceStream< T >::InstanceStream( Device const & device
+		, uint32_t count
+		, MemoryPropertyFlags flags )
+		: m_ring{ count }
+		, m_buffer{ makeVertexBuffer< T >( device
+			, m_ring.getCapacity()
+			, BufferTarget::eVertexBuffer
+			, flags ) }
+	{
+		assert( checkFlag( flags, MemoryPropertyFlag::eHostVisible )
+			&& checkFlag( flags, MemoryPropertyFlag::eHostCoherent )
+			&& "An instance stream needs host visible and coherent memory, to be mapped persistently" );
+		m_data = m_buffer->lock( 0u
+			, m_ring.getCapacity()
+			, MemoryMapFlag::eWrite | MemoryMapFlag::ePersistent );
+
+		if ( !m_data )
+		{
+			throw std::runtime_error{ "Couldn't map the instance stream buffer" };
+		}
+	}
+
+	template< typename T >
+	inline InstanceStream< T >::~InstanceStream()
+	{
+		m_buffer->unlock();
+	}
+
+	template< typename T >
+	inline bool InstanceStream< T >::push( T const & value )
+	{
+		return push( &value, 1u ) == 1u;
+	}
+
+	template< typename T >
+	inline uint32_t InstanceStream< T >::push( T const * values
+		, uint32_t count )
+	{
+		return m_ring.push( count
+			, [this, &values]( uint32_t first, uint32_t size )
+			{
+				std::memcpy( m_data + first, values, size * sizeof( T ) );
+				values += size;
+			} );
+	}
+
+	template< typename T >
+	inline InstanceRange InstanceStream< T >::acquire()
+	{
+		auto result = m_ring.acquire();
+		m_ring.forEachSegment( result
+			, [this]( uint32_t first, uint32_t size )
+			{
+				m_buffer->flush( first, size );
+			} );
+		return result;
+	}
+
+	template< typename T >
+	inline void InstanceStream< T >::release( InstanceRange const & range )
+	{
+		m_ring.release( range );
+	}
+
+	template< typename T >
+	inline void InstanceStream< T >::draw( CommandBuffer const & commandBuffer
+		, InstanceRange const & range
+		, uint32_t vtxCount
+		, uint32_t firstVertex )const
+	{
+		m_ring.forEachSegment( range
+			, [&commandBuffer, vtxCount, firstVertex]( uint32_t first, uint32_t size )
+			{
+				commandBuffer.draw( vtxCount
+					, size
+					, firstVertex
+					, first );
+			} );
+	}
+
+	template< typename T >
+	inline void InstanceStream< T >::drawIndexed( CommandBuffer const & commandBuffer
+		, InstanceRange const & range
+		, uint32_t indexCount
+		, uint32_t firstIndex
+		, uint32_t vertexOffset )const
+	{
+		m_ring.forEachSegment( range
+			, [&commandBuffer, indexCount, firstIndex, vertexOffset]( uint32_t first, uint32_t size )
+			{
+				commandBuffer.drawIndexed( indexCount
+					, size
+					, firstIndex
+					, vertexOffset
+					, first );
+			} );
+	}
+}
@@ -0,0 +1,422 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include "Command/IndirectDrawCuller.hpp"
+
+#include "Buffer/Buffer.hpp"
+#include "Command/CommandBuffer.hpp"
+#include "Core/Device.hpp"
+#include "Core/Renderer.hpp"
+#include "Descriptor/DescriptorSet.hpp"
+#include "Descriptor/DescriptorSetLayout.hpp"
+#include "Descriptor/DescriptorSetLayoutBinding.hpp"
+#include "Descriptor/DescriptorSetPool.hpp"
+#include "Pipeline/ComputePipeline.hpp"
+#include "Pipeline/PipelineLayout.hpp"
+#include "Pipeline/ShaderStageState.hpp"
+#include "Shader/ShaderModule.hpp"
+#include "Sync/BufferMemoryBarrier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace renderer
+{
+	namespace
+	{
+		static uint32_t constexpr GroupSize = 64u;
+
+		struct FrustumUbo
+		{
+			FrustumPlanes planes;
+			uint32_t objectCount;
+			uint32_t padding[3];
+		};
+
+		static_assert( sizeof( IndirectDrawObject ) == 48u, "IndirectDrawObject must match the std430 layout of the culling shader" );
+		static_assert( sizeof( FrustumUbo ) == 112u, "FrustumUbo must match the std140 layout of the culling shader" );
+
+		std::string const CullingShader = R"(
+layout( local_size_x = 64 ) in;
+
+struct DrawObject
+{
+	vec4 sphere;
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+	uint padding0;
+	uint padding1;
+	uint padding2;
+};
+
+struct DrawCommand
+{
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+layout( binding=0 ) uniform Frustum
+{
+	vec4 planes[6];
+	uint objectCount;
+};
+
+layout( binding=1, std430 ) readonly buffer Objects
+{
+	DrawObject objects[];
+};
+
+layout( binding=2, std430 ) writeonly buffer Commands
+{
+	DrawCommand commands[];
+};
+
+layout( binding=3, std430 ) buffer Count
+{
+	uint drawCount;
+};
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	if ( index >= objectCount )
+	{
+		return;
+	}
+
+#ifdef CULLING_RESET
+	commands[index] = DrawCommand( 0u, 0u, 0u, 0, 0u );
+
+	if ( index == 0u )
+	{
+		drawCount = 0u;
+	}
+#else
+	DrawObject object = objects[index];
+	bool visible = true;
+
+	for ( int i = 0; i < 6; ++i )
+	{
+		visible = visible
+			&& dot( planes[i].xyz, object.sphere.xyz ) + planes[i].w >= -object.sphere.w;
+	}
+
+	if ( visible )
+	{
+		uint slot = atomicAdd( drawCount, 1u );
+		commands[slot] = DrawCommand( object.indexCount
+			, object.instanceCount
+			, object.firstIndex
+			, object.vertexOffset
+			, object.firstInstance );
+	}
+#endif
+}
+)";
+
+		std::string getShaderSource( Device const & device
+			, bool reset )
+		{
+			// Compute shaders and storage buffers are core since GLSL 4.30, and available as extensions before.
+			auto version = device.getShaderVersion();
+			std::string result = "#version " + std::to_string( version ) + "\n";
+
+			if ( version < 430u )
+			{
+				result += "#extension GL_ARB_compute_shader : enable\n";
+				result += "#extension GL_ARB_shader_storage_buffer_object : enable\n";
+			}
+
+			if ( reset )
+			{
+				result += "#define CULLING_RESET\n";
+			}
+
+			return result + CullingShader;
+		}
+
+		bool isVisible( FrustumPlanes const & planes
+			, IndirectDrawObject const & object )
+		{
+			auto & sphere = object.boundingSphere;
+
+			for ( auto & plane : planes )
+			{
+				if ( plane[0] * sphere[0] + plane[1] * sphere[1] + plane[2] * sphere[2] + plane[3] < -sphere[3] )
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		template< typename T >
+		void doUpload( BufferBase const & buffer
+			, T const * data
+			, uint32_t size )
+		{
+			if ( !size )
+			{
+				return;
+			}
+
+			if ( auto * mapped = buffer.lock( 0u
+				, size
+				, MemoryMapFlag::eWrite ) )
+			{
+				std::memcpy( mapped, data, size );
+				buffer.flush( 0u, size );
+				buffer.unlock();
+			}
+		}
+	}
+
+	IndirectDrawCuller::IndirectDrawCuller( Device const & device
+		, uint32_t maxObjects )
+		: m_device{ device }
+		, m_maxObjects{ maxObjects }
+		, m_gpuDriven{ device.getRenderer().getFeatures().hasComputeShaders
+			&& device.getRenderer().getFeatures().hasStorageBuffers }
+	{
+		auto hostFlags = MemoryPropertyFlag::eHostVisible | MemoryPropertyFlag::eHostCoherent;
+		auto capacity = std::max( 1u, maxObjects );
+
+		if ( m_gpuDriven )
+		{
+			m_frustum = m_device.createBuffer( uint32_t( sizeof( FrustumUbo ) )
+				, BufferTarget::eUniformBuffer
+				, hostFlags );
+			m_objectsBuffer = m_device.createBuffer( uint32_t( capacity * sizeof( IndirectDrawObject ) )
+				, BufferTarget::eStorageBuffer
+				, hostFlags );
+			m_commands = m_device.createBuffer( uint32_t( capacity * sizeof( DrawIndexedIndirectCommand ) )
+				, BufferTarget::eStorageBuffer | BufferTarget::eDrawIndirectBuffer
+				, MemoryPropertyFlag::eDeviceLocal );
+			m_count = m_device.createBuffer( uint32_t( sizeof( uint32_t ) )
+				, BufferTarget::eStorageBuffer | BufferTarget::eTransferSrc
+				, MemoryPropertyFlag::eDeviceLocal );
+			doCreateComputePipelines();
+		}
+		else
+		{
+			m_commands = m_device.createBuffer( uint32_t( capacity * sizeof( DrawIndexedIndirectCommand ) )
+				, BufferTarget::eDrawIndirectBuffer
+				, hostFlags );
+			m_count = m_device.createBuffer( uint32_t( sizeof( uint32_t ) )
+				, BufferTarget::eTransferSrc
+				, hostFlags );
+		}
+	}
+
+	IndirectDrawCuller::~IndirectDrawCuller()
+	{
+	}
+
+	void IndirectDrawCuller::setObjects( IndirectDrawObjectArray const & objects )
+	{
+		assert( objects.size() <= m_maxObjects );
+		m_objects = objects;
+
+		if ( m_gpuDriven )
+		{
+			doUpload( *m_objectsBuffer
+				, m_objects.data()
+				, uint32_t( m_objects.size() * sizeof( IndirectDrawObject ) ) );
+		}
+
+		doUpdate();
+	}
+
+	void IndirectDrawCuller::setViewProjection( Mat4 const & viewProjection )
+	{
+		m_planes = getFrustumPlanes( viewProjection );
+		doUpdate();
+	}
+
+	void IndirectDrawCuller::cull( CommandBuffer const & commandBuffer )const
+	{
+		if ( !m_gpuDriven || m_objects.empty() )
+		{
+			return;
+		}
+
+		auto groups = ( uint32_t( m_objects.size() ) + GroupSize - 1u ) / GroupSize;
+		commandBuffer.bindPipeline( *m_resetPipeline );
+		commandBuffer.bindDescriptorSet( *m_descriptorSet
+			, *m_pipelineLayout
+			, PipelineBindPoint::eCompute );
+		commandBuffer.dispatch( groups, 1u, 1u );
+		commandBuffer.memoryBarrier( PipelineStageFlag::eComputeShader
+			, PipelineStageFlag::eComputeShader
+			, m_commands->makeMemoryTransitionBarrier( AccessFlag::eShaderWrite ) );
+		commandBuffer.memoryBarrier( PipelineStageFlag::eComputeShader
+			, PipelineStageFlag::eComputeShader
+			, m_count->makeMemoryTransitionBarrier( AccessFlag::eShaderRead | AccessFlag::eShaderWrite ) );
+		commandBuffer.bindPipeline( *m_cullPipeline );
+		commandBuffer.bindDescriptorSet( *m_descriptorSet
+			, *m_pipelineLayout
+			, PipelineBindPoint::eCompute );
+		commandBuffer.dispatch( groups, 1u, 1u );
+		commandBuffer.memoryBarrier( PipelineStageFlag::eComputeShader
+			, PipelineStageFlag::eDrawIndirect
+			, m_commands->makeMemoryTransitionBarrier( AccessFlag::eIndirectCommandRead ) );
+	}
+
+	void IndirectDrawCuller::draw( CommandBuffer const & commandBuffer )const
+	{
+		if ( m_objects.empty() )
+		{
+			return;
+		}
+
+		commandBuffer.drawIndexedIndirect( *m_commands
+			, 0u
+			, uint32_t( m_objects.size() )
+			, uint32_t( sizeof( DrawIndexedIndirectCommand ) ) );
+	}
+
+	FrustumPlanes IndirectDrawCuller::getFrustumPlanes( Mat4 const & viewProjection )
+	{
+		auto row = [&viewProjection]( size_t index )
+		{
+			return std::array< float, 4u >
+			{
+				viewProjection[0][index],
+				viewProjection[1][index],
+				viewProjection[2][index],
+				viewProjection[3][index],
+			};
+		};
+		auto combine = []( std::array< float, 4u > const & lhs
+			, std::array< float, 4u > const & rhs
+			, float sign )
+		{
+			std::array< float, 4u > result
+			{
+				lhs[0] + sign * rhs[0],
+				lhs[1] + sign * rhs[1],
+				lhs[2] + sign * rhs[2],
+				lhs[3] + sign * rhs[3],
+			};
+			auto length = std::sqrt( result[0] * result[0] + result[1] * result[1] + result[2] * result[2] );
+
+			if ( length > 0.0f )
+			{
+				for ( auto & value : result )
+				{
+					value /= length;
+				}
+			}
+
+			return result;
+		};
+		auto r0 = row( 0u );
+		auto r1 = row( 1u );
+		auto r2 = row( 2u );
+		auto r3 = row( 3u );
+		return FrustumPlanes
+		{
+			combine( r3, r0, 1.0f ),	// Left
+			combine( r3, r0, -1.0f ),	// Right
+			combine( r3, r1, 1.0f ),	// Bottom
+			combine( r3, r1, -1.0f ),	// Top
+			combine( r3, r2, 1.0f ),	// Near
+			combine( r3, r2, -1.0f ),	// Far
+		};
+	}
+
+	DrawIndexedIndirectCommandArray IndirectDrawCuller::cullObjects( FrustumPlanes const & planes
+		, IndirectDrawObjectArray const & objects )
+	{
+		DrawIndexedIndirectCommandArray result;
+		result.reserve( objects.size() );
+
+		for ( auto & object : objects )
+		{
+			if ( isVisible( planes, object ) )
+			{
+				result.push_back( object.command );
+			}
+		}
+
+		return result;
+	}
+
+	void IndirectDrawCuller::doUpdate()
+	{
+		if ( m_gpuDriven )
+		{
+			FrustumUbo frustum{ m_planes, uint32_t( m_objects.size() ), { 0u, 0u, 0u } };
+			doUpload( *m_frustum
+				, &frustum
+				, uint32_t( sizeof( FrustumUbo ) ) );
+		}
+		else
+		{
+			auto commands = cullObjects( m_planes, m_objects );
+			auto count = uint32_t( commands.size() );
+			commands.resize( m_objects.size(), DrawIndexedIndirectCommand{ 0u, 0u, 0u, 0, 0u } );
+			doUpload( *m_commands
+				, commands.data()
+				, uint32_t( commands.size() * sizeof( DrawIndexedIndirectCommand ) ) );
+			doUpload( *m_count
+				, &count
+				, uint32_t( sizeof( count ) ) );
+		}
+	}
+
+	void IndirectDrawCuller::doCreateComputePipelines()
+	{
+		DescriptorSetLayoutBindingArray bindings
+		{
+			DescriptorSetLayoutBinding{ 0u, DescriptorType::eUniformBuffer, ShaderStageFlag::eCompute },
+			DescriptorSetLayoutBinding{ 1u, DescriptorType::eStorageBuffer, ShaderStageFlag::eCompute },
+			DescriptorSetLayoutBinding{ 2u, DescriptorType::eStorageBuffer, ShaderStageFlag::eCompute },
+			DescriptorSetLayoutBinding{ 3u, DescriptorType::eStorageBuffer, ShaderStageFlag::eCompute },
+		};
+		m_descriptorLayout = m_device.createDescriptorSetLayout( std::move( bindings ) );
+		m_descriptorPool = m_descriptorLayout->createPool( 1u );
+		m_descriptorSet = m_descriptorPool->createDescriptorSet();
+		m_descriptorSet->createBinding( m_descriptorLayout->getBinding( 0u )
+			, *m_frustum
+			, 0u
+			, m_frustum->getSize() );
+		m_descriptorSet->createBinding( m_descriptorLayout->getBinding( 1u )
+			, *m_objectsBuffer
+			, 0u
+			, m_objectsBuffer->getSize() );
+		m_descriptorSet->createBinding( m_descriptorLayout->getBinding( 2u )
+			, *m_commands
+			, 0u
+			, m_commands->getSize() );
+		m_descriptorSet->createBinding( m_descriptorLayout->getBinding( 3u )
+			, *m_count
+			, 0u
+			, m_count->getSize() );
+		m_descriptorSet->update();
+		m_pipelineLayout = m_device.createPipelineLayout( *m_descriptorLayout );
+
+		auto createPipeline = [this]( bool reset )
+		{
+			ShaderStageState stage
+			{
+				m_device.createShaderModule( ShaderStageFlag::eCompute )
+			};
+			stage.module->loadShader( getShaderSource( m_device, reset ) );
+			return m_pipelineLayout->createPipeline( std::move( stage ) );
+		};
+		m_resetPipeline = createPipeline( true );
+		m_cullPipeline = createPipeline( false );
+	}
+}
@@ -0,0 +1,228 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#ifndef ___Renderer_IndirectDrawCuller_HPP___
+#define ___Renderer_IndirectDrawCuller_HPP___
+#pragma once
+
+#include "Miscellaneous/DrawIndexedIndirectCommand.hpp"
+#include "Utils/Mat4.hpp"
+
+#include <array>
+
+namespace renderer
+{
+	/**
+	*\~english
+	*\brief
+	*	An object submitted to the IndirectDrawCuller.
+	*\remarks
+	*	Matches the std430 layout of the culling shader's input (48 bytes stride).
+	*\~french
+	*\brief
+	*	Un objet soumis à l'IndirectDrawCuller.
+	*\remarks
+	*	Correspond à la disposition std430 de l'entrée du shader de culling (pas de 48 octets).
+	*/
+	struct IndirectDrawObject
+	{
+		//!\~french		La sphère englobante, en coordonnées monde (centre en xyz, rayon en w).
+		//!\~english	The bounding sphere, in world coordinates (center in xyz, radius in w).
+		std::array< float, 4u > boundingSphere;
+		//!\~french		Les paramètres de dessin de l'objet.
+		//!\~english	The object draw parameters.
+		DrawIndexedIndirectCommand command;
+		uint32_t padding[3]{ 0u, 0u, 0u };
+	};
+	using IndirectDrawObjectArray = std::vector< IndirectDrawObject >;
+	using DrawIndexedIndirectCommandArray = std::vector< DrawIndexedIndirectCommand >;
+	using FrustumPlanes = std::array< std::array< float, 4u >, 6u >;
+	/**
+	*\~english
+	*\brief
+	*	GPU driven draws generation.
+	*\remarks
+	*	Frustum culls objects in a compute shader, and writes the visible ones as compacted DrawIndexedIndirectCommand,
+	*	along with their count, for consumption by CommandBuffer::drawIndexedIndirect.
+	*	The commands past the visible count are zeroed, so the whole buffer can be drawn without reading the count back.
+	*	When compute shaders are not supported (RendererFeatures::hasComputeShaders), the CPU reference implementation is used.
+	*\~french
+	*\brief
+	*	Génération des dessins par le GPU.
+	*\remarks
+	*	Effectue le frustum culling des objets dans un compute shader, et écrit les objets visibles sous forme de
+	*	DrawIndexedIndirectCommand compactées, ainsi que leur nombre, pour consommation par CommandBuffer::drawIndexedIndirect.
+	*	Les commandes au-delà du nombre d'objets visibles sont mises à zéro, afin que le tampon entier puisse être dessiné sans relire le nombre.
+	*	Quand les compute shaders ne sont pas supportés (RendererFeatures::hasComputeShaders), l'implémentation CPU de référence est utilisée.
+	*/
+	class IndirectDrawCuller
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] device
+		*	The logical device, must be enabled.
+		*\param[in] maxObjects
+		*	The maximum objects count.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] device
+		*	Le périphérique logique, doit être activé.
+		*\param[in] maxObjects
+		*	Le nombre maximal d'objets.
+		*/
+		IndirectDrawCuller( Device const & device
+			, uint32_t maxObjects );
+		/**
+		*\~english
+		*\brief
+		*	Destructor.
+		*\~french
+		*\brief
+		*	Destructeur.
+		*/
+		~IndirectDrawCuller();
+		/**
+		*\~english
+		*\brief
+		*	Sets the objects to cull.
+		*\remarks
+		*	The objects are culled against the last view projection set, with the CPU implementation the culling happens here.
+		*\~french
+		*\brief
+		*	Définit les objets à culler.
+		*\remarks
+		*	Les objets sont cullés selon la dernière vue projection définie, avec l'implémentation CPU le culling se fait ici.
+		*/
+		void setObjects( IndirectDrawObjectArray const & objects );
+		/**
+		*\~english
+		*\brief
+		*	Sets the view projection matrix used to cull the objects.
+		*\remarks
+		*	With the CPU implementation, the culling happens here.
+		*\~french
+		*\brief
+		*	Définit la matrice vue projection utilisée pour culler les objets.
+		*\remarks
+		*	Avec l'implémentation CPU, le culling se fait ici.
+		*/
+		void setViewProjection( Mat4 const & viewProjection );
+		/**
+		*\~english
+		*\brief
+		*	Records the culling dispatches, and the barrier making their results available to indirect draws.
+		*\remarks
+		*	Must be recorded outside of a render pass. Does nothing with the CPU implementation.
+		*\~french
+		*\brief
+		*	Enregistre les dispatches de culling, et la barrière rendant leur résultat disponible aux dessins indirects.
+		*\remarks
+		*	Doit être enregistré en dehors d'une passe de rendu. Ne fait rien avec l'implémentation CPU.
+		*/
+		void cull( CommandBuffer const & commandBuffer )const;
+		/**
+		*\~english
+		*\brief
+		*	Records the indirect draw of the culled objects.
+		*\remarks
+		*	The graphics pipeline, descriptors, vertex and index buffers must already be bound.
+		*\~french
+		*\brief
+		*	Enregistre le dessin indirect des objets cullés.
+		*\remarks
+		*	Le pipeline graphique, les descripteurs, les tampons de sommets et d'indices doivent déjà être liés.
+		*/
+		void draw( CommandBuffer const & commandBuffer )const;
+		/**
+		*\~english
+		*\brief
+		*	Extracts the normalised frustum planes from a view projection matrix.
+		*\remarks
+		*	The near plane is the one of a [-1, 1] depth range, which is conservative for a [0, 1] depth range.
+		*\~french
+		*\brief
+		*	Extrait les plans normalisés du frustum d'une matrice vue projection.
+		*\remarks
+		*	Le plan proche est celui d'un intervalle de profondeur [-1, 1], ce qui est conservatif pour un intervalle [0, 1].
+		*/
+		static FrustumPlanes getFrustumPlanes( Mat4 const & viewProjection );
+		/**
+		*\~english
+		*\brief
+		*	CPU reference implementation of the culling shader, used as fallback and for validation.
+		*\return
+		*	The compacted draw commands of the visible objects.
+		*\~french
+		*\brief
+		*	Implémentation CPU de référence du shader de culling, utilisée comme solution de repli et pour la validation.
+		*\return
+		*	Les commandes de dessin compactées des objets visibles.
+		*/
+		static DrawIndexedIndirectCommandArray cullObjects( FrustumPlanes const & planes
+			, IndirectDrawObjectArray const & objects );
+		/**
+		*\~english
+		*\return
+		*	The compacted draw commands buffer.
+		*\~french
+		*\return
+		*	Le tampon des commandes de dessin compactées.
+		*/
+		inline BufferBase const & getCommandsBuffer()const
+		{
+			return *m_commands;
+		}
+		/**
+		*\~english
+		*\return
+		*	The buffer holding the visible objects count (one uint32_t).
+		*\~french
+		*\return
+		*	Le tampon contenant le nombre d'objets visibles (un uint32_t).
+		*/
+		inline BufferBase const & getCountBuffer()const
+		{
+			return *m_count;
+		}
+		/**
+		*\~english
+		*\return
+		*	\p true if the culling is done on the GPU.
+		*\~french
+		*\return
+		*	\p true si le culling est fait par le GPU.
+		*/
+		inline bool isGpuDriven()const
+		{
+			return m_gpuDriven;
+		}
+
+	private:
+		void doUpdate();
+		void doCreateComputePipelines();
+
+	private:
+		Device const & m_device;
+		uint32_t m_maxObjects;
+		bool m_gpuDriven;
+		IndirectDrawObjectArray m_objects;
+		FrustumPlanes m_planes{};
+		BufferBasePtr m_frustum;
+		BufferBasePtr m_objectsBuffer;
+		BufferBasePtr m_commands;
+		BufferBasePtr m_count;
+		DescriptorSetLayoutPtr m_descriptorLayout;
+		DescriptorSetPoolPtr m_descriptorPool;
+		DescriptorSetPtr m_descriptorSet;
+		PipelineLayoutPtr m_pipelineLayout;
+		ComputePipelinePtr m_resetPipeline;
+		ComputePipelinePtr m_cullPipeline;
+	};
+}
+
+#endif
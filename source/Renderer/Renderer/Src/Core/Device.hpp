@@ -12,6 +12,7 @@ See LICENSE file in root folder.
 #include "Core/PhysicalDevice.hpp"
 #include "Image/ImageCreateInfo.hpp"
 #include "Image/SamplerCreateInfo.hpp"
+#include "Miscellaneous/CallStatistics.hpp"
 #include "Pipeline/ColourBlendState.hpp"
 #include "Pipeline/RasterisationState.hpp"
 
@@ -767,6 +768,23 @@ namespace renderer
 		virtual void waitIdle()const = 0;
 		/**
 		*\~english
+		*\brief
+		*	Retrieves the statistics of the calls made to the backend API.
+		*\remarks
+		*	Called once per frame with \p reset set to \p true, gives the statistics of the frame.
+		*\param[in] reset
+		*	Tells if the counters are reset after being read.
+		*\~french
+		*\brief
+		*	Récupère les statistiques des appels faits à l'API du backend.
+		*\remarks
+		*	Appelée une fois par frame avec \p reset à \p true, donne les statistiques de la frame.
+		*\param[in] reset
+		*	Dit si les compteurs sont remis à zéro après leur lecture.
+		*/
+		virtual CallStatistics getCallStatistics( bool reset )const = 0;
+		/**
+		*\~english
 		*name
 		*	Getters.
 		*\~french
@@ -34,6 +34,12 @@ namespace renderer
 			//!\~french		Dit si la couche de validation doit être activée.
 			//!\~english	Tells if the validation layer must be enabled.
 			bool enableValidation;
+			//!\~french		Dit si les textures sans liaison (GL_ARB_bindless_texture) doivent être utilisées, quand elles sont supportées. Les shaders lisent alors les samplers du set N dans un bloc d'uniformes attaché à RENDERER_BINDLESS_HANDLES_BINDING_N, indexé par attache.
+			//!\~english	Tells if bindless textures (GL_ARB_bindless_texture) must be used, when supported. The shaders then read the set N samplers from a uniform block bound at RENDERER_BINDLESS_HANDLES_BINDING_N, indexed by binding.
+			bool enableBindlessTextures{ false };
+			//!\~french		Dit si les push constants doivent être émulées via un tampon d'uniformes, quand le renderer n'a pas de push constants natives (nécessite GLSL 4.20 ou GL_ARB_shading_language_420pack).
+			//!\~english	Tells if push constants must be emulated through a uniform buffer, when the renderer has no native push constants (needs GLSL 4.20 or GL_ARB_shading_language_420pack).
+			bool enablePushConstantsBuffer{ false };
 		};
 
 	protected:
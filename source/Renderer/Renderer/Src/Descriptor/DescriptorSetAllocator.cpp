@@ -0,0 +1,82 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include "Descriptor/DescriptorSetAllocator.hpp"
+
+#include "Core/Device.hpp"
+#include "Descriptor/DescriptorSetLayout.hpp"
+
+#include <algorithm>
+
+namespace renderer
+{
+	namespace
+	{
+		static uint32_t constexpr MaxPoolSets = 1024u;
+	}
+
+	DescriptorSetAllocator::DescriptorSetAllocator( Device const & device
+		, DescriptorSetLayout const & layout
+		, uint32_t setsCount )
+		: m_device{ device }
+		, m_layout{ layout }
+		, m_setsCount{ std::max( setsCount, 1u ) }
+	{
+	}
+
+	DescriptorSetPtr DescriptorSetAllocator::allocate( uint32_t bindingPoint )
+	{
+		auto it = std::find_if( m_released.begin()
+			, m_released.end()
+			, [bindingPoint]( DescriptorSetPtr const & lookup )
+			{
+				return lookup->getBindingPoint() == bindingPoint;
+			} );
+
+		if ( it != m_released.end() )
+		{
+			auto result = std::move( *it );
+			m_released.erase( it );
+			return result;
+		}
+
+		if ( !m_available )
+		{
+			doAddPool();
+		}
+
+		--m_available;
+		return m_pools.back()->createDescriptorSet( m_layout, bindingPoint );
+	}
+
+	void DescriptorSetAllocator::release( DescriptorSetPtr set )
+	{
+		if ( set )
+		{
+			set->setBindings( {} );
+			m_released.push_back( std::move( set ) );
+		}
+	}
+
+	void DescriptorSetAllocator::doAddPool()
+	{
+		if ( !m_pools.empty() )
+		{
+			m_setsCount = std::min( m_setsCount * 2u, MaxPoolSets );
+		}
+
+		DescriptorPoolSizeArray sizes;
+
+		for ( auto & binding : m_layout.getBindings() )
+		{
+			sizes.push_back( { binding.getDescriptorType(), binding.getDescriptorsCount() * m_setsCount } );
+		}
+
+		// The sets are never freed one by one, they are recycled until the pools destruction.
+		m_pools.push_back( m_device.createDescriptorPool( DescriptorPoolCreateFlag( 0u )
+			, m_setsCount
+			, sizes ) );
+		m_available = m_setsCount;
+	}
+}
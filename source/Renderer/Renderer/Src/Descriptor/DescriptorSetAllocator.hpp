@@ -0,0 +1,126 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#ifndef ___Renderer_DescriptorSetAllocator_HPP___
+#define ___Renderer_DescriptorSetAllocator_HPP___
+#pragma once
+
+#include "Descriptor/DescriptorPool.hpp"
+#include "Descriptor/DescriptorSet.hpp"
+
+#include <vector>
+
+namespace renderer
+{
+	/**
+	*\~english
+	*\brief
+	*	Allocates the descriptor sets of one layout, from a chain of pools that grows on demand.
+	*\remarks
+	*	Each new pool can hold twice as many sets as the previous one.
+	*	The released sets are kept, and given back by the next allocations with the same binding point.
+	*	The allocated sets must not outlive the allocator.
+	*\~french
+	*\brief
+	*	Alloue les sets de descripteurs d'un layout, depuis une chaîne de pools qui grandit à la demande.
+	*\remarks
+	*	Chaque nouveau pool peut contenir deux fois plus de sets que le précédent.
+	*	Les sets libérés sont gardés, et rendus par les allocations suivantes ayant le même point d'attache.
+	*	Les sets alloués ne doivent pas survivre à l'allocateur.
+	*/
+	class DescriptorSetAllocator
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] device
+		*	The logical device.
+		*\param[in] layout
+		*	The layout of the allocated sets.
+		*\param[in] setsCount
+		*	The sets count of the first pool.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] device
+		*	Le périphérique logique.
+		*\param[in] layout
+		*	Le layout des sets alloués.
+		*\param[in] setsCount
+		*	Le nombre de sets du premier pool.
+		*/
+		DescriptorSetAllocator( Device const & device
+			, DescriptorSetLayout const & layout
+			, uint32_t setsCount = 16u );
+		/**
+		*\~english
+		*\brief
+		*	Allocates a descriptor set, reusing a released one if possible.
+		*\param[in] bindingPoint
+		*	The binding point for the set.
+		*\return
+		*	The descriptor set, without bindings.
+		*\~french
+		*\brief
+		*	Alloue un set de descripteurs, en réutilisant un set libéré si possible.
+		*\param[in] bindingPoint
+		*	Le point d'attache du set.
+		*\return
+		*	Le set de descripteurs, sans attaches.
+		*/
+		DescriptorSetPtr allocate( uint32_t bindingPoint = 0u );
+		/**
+		*\~english
+		*\brief
+		*	Gives a descriptor set back to the allocator, for its next allocations.
+		*\remarks
+		*	The set must not be used anymore by a pending command buffer.
+		*\~french
+		*\brief
+		*	Rend un set de descripteurs à l'allocateur, pour ses allocations suivantes.
+		*\remarks
+		*	Le set ne doit plus être utilisé par un tampon de commandes en attente.
+		*/
+		void release( DescriptorSetPtr set );
+		/**
+		*\~english
+		*\return
+		*	The descriptor set layout.
+		*\~french
+		*\return
+		*	Le layout de set de descripteurs.
+		*/
+		inline DescriptorSetLayout const & getLayout()const
+		{
+			return m_layout;
+		}
+		/**
+		*\~english
+		*\return
+		*	The number of pools in the chain.
+		*\~french
+		*\return
+		*	Le nombre de pools dans la chaîne.
+		*/
+		inline size_t getPoolsCount()const
+		{
+			return m_pools.size();
+		}
+
+	private:
+		void doAddPool();
+
+	private:
+		Device const & m_device;
+		DescriptorSetLayout const & m_layout;
+		uint32_t m_setsCount;
+		uint32_t m_available{ 0u };
+		std::vector< DescriptorPoolPtr > m_pools;
+		std::vector< DescriptorSetPtr > m_released;
+	};
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include "Descriptor/DescriptorSetLayoutCache.hpp"
+
+#include "Core/Device.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace renderer
+{
+	namespace
+	{
+		void hashCombine( size_t & hash, uint32_t value )
+		{
+			hash ^= std::hash< uint32_t >{}( value ) + 0x9e3779b9 + ( hash << 6 ) + ( hash >> 2 );
+		}
+
+		size_t makeHash( DescriptorSetLayoutBindingArray const & bindings )
+		{
+			size_t result = bindings.size();
+
+			for ( auto & binding : bindings )
+			{
+				hashCombine( result, binding.getBindingPoint() );
+				hashCombine( result, uint32_t( binding.getDescriptorType() ) );
+				hashCombine( result, uint32_t( binding.getShaderStageFlags() ) );
+				hashCombine( result, binding.getDescriptorsCount() );
+			}
+
+			return result;
+		}
+
+		bool areEqual( DescriptorSetLayoutBindingArray const & lhs
+			, DescriptorSetLayoutBindingArray const & rhs )
+		{
+			return std::equal( lhs.begin()
+				, lhs.end()
+				, rhs.begin()
+				, rhs.end()
+				, []( DescriptorSetLayoutBinding const & lhs, DescriptorSetLayoutBinding const & rhs )
+				{
+					return lhs.getBindingPoint() == rhs.getBindingPoint()
+						&& lhs.getDescriptorType() == rhs.getDescriptorType()
+						&& lhs.getShaderStageFlags() == rhs.getShaderStageFlags()
+						&& lhs.getDescriptorsCount() == rhs.getDescriptorsCount();
+				} );
+		}
+	}
+
+	DescriptorSetLayoutCache::DescriptorSetLayoutCache( Device const & device )
+		: m_device{ device }
+	{
+	}
+
+	DescriptorSetLayout & DescriptorSetLayoutCache::getLayout( DescriptorSetLayoutBindingArray bindings )
+	{
+		std::sort( bindings.begin()
+			, bindings.end()
+			, []( DescriptorSetLayoutBinding const & lhs, DescriptorSetLayoutBinding const & rhs )
+			{
+				return lhs.getBindingPoint() < rhs.getBindingPoint();
+			} );
+		auto hash = makeHash( bindings );
+		auto range = m_entries.equal_range( hash );
+
+		for ( auto it = range.first; it != range.second; ++it )
+		{
+			if ( areEqual( it->second.layout->getBindings(), bindings ) )
+			{
+				return *it->second.layout;
+			}
+		}
+
+		Entry entry;
+		entry.layout = m_device.createDescriptorSetLayout( std::move( bindings ) );
+		entry.allocator = std::make_unique< DescriptorSetAllocator >( m_device, *entry.layout );
+		return *m_entries.emplace( hash, std::move( entry ) )->second.layout;
+	}
+
+	DescriptorSetAllocator & DescriptorSetLayoutCache::getAllocator( DescriptorSetLayout const & layout )
+	{
+		auto range = m_entries.equal_range( makeHash( layout.getBindings() ) );
+		auto it = std::find_if( range.first
+			, range.second
+			, [&layout]( std::pair< size_t const, Entry > const & lookup )
+			{
+				return lookup.second.layout.get() == &layout;
+			} );
+
+		if ( it == range.second )
+		{
+			throw std::runtime_error{ "The descriptor set layout doesn't come from this cache" };
+		}
+
+		return *it->second.allocator;
+	}
+}
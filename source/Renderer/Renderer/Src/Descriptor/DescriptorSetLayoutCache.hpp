@@ -0,0 +1,103 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#ifndef ___Renderer_DescriptorSetLayoutCache_HPP___
+#define ___Renderer_DescriptorSetLayoutCache_HPP___
+#pragma once
+
+#include "Descriptor/DescriptorSetAllocator.hpp"
+#include "Descriptor/DescriptorSetLayout.hpp"
+
+#include <unordered_map>
+
+namespace renderer
+{
+	/**
+	*\~english
+	*\brief
+	*	Shares the descriptor set layouts having the same bindings, with one descriptor set allocator per layout.
+	*\remarks
+	*	Meant to be owned once per logical device, it must be destroyed after the users of its layouts and sets.
+	*\~french
+	*\brief
+	*	Partage les layouts de sets de descripteurs ayant les mêmes attaches, avec un allocateur de sets par layout.
+	*\remarks
+	*	Prévu pour être possédé une fois par périphérique logique, il doit être détruit après les utilisateurs de ses layouts et sets.
+	*/
+	class DescriptorSetLayoutCache
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] device
+		*	The logical device.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] device
+		*	Le périphérique logique.
+		*/
+		explicit DescriptorSetLayoutCache( Device const & device );
+		/**
+		*\~english
+		*\brief
+		*	Retrieves the layout matching the given bindings, creating it if needed.
+		*\remarks
+		*	The bindings order does not matter.
+		*\param[in] bindings
+		*	The layout bindings.
+		*\return
+		*	The layout.
+		*\~french
+		*\brief
+		*	Récupère le layout correspondant aux attaches données, en le créant si besoin.
+		*\remarks
+		*	L'ordre des attaches n'importe pas.
+		*\param[in] bindings
+		*	Les attaches du layout.
+		*\return
+		*	Le layout.
+		*/
+		DescriptorSetLayout & getLayout( DescriptorSetLayoutBindingArray bindings );
+		/**
+		*\~english
+		*\param[in] layout
+		*	A layout retrieved from this cache.
+		*\return
+		*	The descriptor set allocator for this layout.
+		*\~french
+		*\param[in] layout
+		*	Un layout récupéré depuis ce cache.
+		*\return
+		*	L'allocateur de sets de descripteurs pour ce layout.
+		*/
+		DescriptorSetAllocator & getAllocator( DescriptorSetLayout const & layout );
+		/**
+		*\~english
+		*\return
+		*	The number of distinct layouts.
+		*\~french
+		*\return
+		*	Le nombre de layouts distincts.
+		*/
+		inline size_t getLayoutsCount()const
+		{
+			return m_entries.size();
+		}
+
+	private:
+		struct Entry
+		{
+			DescriptorSetLayoutPtr layout;
+			DescriptorSetAllocatorPtr allocator;
+		};
+
+		Device const & m_device;
+		std::unordered_multimap< size_t, Entry > m_entries;
+	};
+}
+
+#endif
@@ -135,9 +135,17 @@ namespace renderer
 	{
 		auto const width = int32_t( getDimensions().width );
 		auto const height = int32_t( getDimensions().height );
+		auto viewType = renderer::TextureViewType( getType() );
+
+		if ( getType() == renderer::TextureType::e2D
+			&& getLayerCount() > 1u )
+		{
+			// All the layers get their mipmaps.
+			viewType = renderer::TextureViewType::e2DArray;
+		}
 
 		auto srcView = createView( {
-			renderer::TextureViewType( getType() ),
+			viewType,
 			getFormat(),
 			renderer::ComponentMapping{},
 			{
@@ -145,7 +153,7 @@ namespace renderer
 				0,
 				1u,
 				0u,
-				1u
+				getLayerCount()
 			}
 		} );
 		commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eTransfer
@@ -159,7 +167,7 @@ namespace renderer
 
 			// Source
 			imageBlit.srcSubresource.aspectMask = renderer::ImageAspectFlag::eColour;
-			imageBlit.srcSubresource.layerCount = 1;
+			imageBlit.srcSubresource.layerCount = getLayerCount();
 			imageBlit.srcSubresource.mipLevel = i - 1;
 			imageBlit.srcOffset.x = 0;
 			imageBlit.srcOffset.y = 0;
@@ -170,7 +178,7 @@ namespace renderer
 
 			// Destination
 			imageBlit.dstSubresource.aspectMask = renderer::ImageAspectFlag::eColour;
-			imageBlit.dstSubresource.layerCount = 1;
+			imageBlit.dstSubresource.layerCount = getLayerCount();
 			imageBlit.dstSubresource.mipLevel = i;
 			imageBlit.dstOffset.x = 0;
 			imageBlit.dstOffset.y = 0;
@@ -185,7 +193,7 @@ namespace renderer
 				i,
 				1u,
 				0u,
-				1u
+				getLayerCount()
 			};
 
 			// Transiton current mip level to transfer dest
@@ -0,0 +1,242 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#include "CallStatistics.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace renderer
+{
+	namespace
+	{
+		bool doStartsWith( char const * name
+			, char const * prefix )
+		{
+			return std::strncmp( name, prefix, std::strlen( prefix ) ) == 0;
+		}
+
+		template< size_t N >
+		bool doStartsWithAny( char const * name
+			, char const * const ( &prefixes )[N] )
+		{
+			return std::any_of( prefixes
+				, prefixes + N
+				, [name]( char const * prefix )
+				{
+					return doStartsWith( name, prefix );
+				} );
+		}
+
+		CallCategory doGetGlCategory( char const * name )
+		{
+			static char const * const StateChanges[]
+			{
+				"Enable",
+				"Disable",
+				"Blend",
+				"ColorMask",
+				"CullFace",
+				"Depth",
+				"FrontFace",
+				"LineWidth",
+				"LogicOp",
+				"MinSampleShading",
+				"PatchParameter",
+				"PolygonMode",
+				"PolygonOffset",
+				"SampleMask",
+				"Scissor",
+				"Stencil",
+				"Viewport",
+			};
+			static char const * const Transfers[]
+			{
+				"BufferSubData",
+				"CompressedTexSubImage",
+				"CopyBufferSubData",
+				"CopyImageSubData",
+				"FlushMappedBufferRange",
+				"TexSubImage",
+			};
+
+			if ( ( doStartsWith( name, "Draw" ) && !doStartsWith( name, "DrawBuffer" ) )
+				|| doStartsWith( name, "MultiDraw" ) )
+			{
+				return CallCategory::eDraw;
+			}
+
+			if ( doStartsWith( name, "Dispatch" ) )
+			{
+				return CallCategory::eDispatch;
+			}
+
+			if ( doStartsWith( name, "Bind" )
+				|| doStartsWith( name, "UseProgram" )
+				|| doStartsWith( name, "ActiveTexture" ) )
+			{
+				return CallCategory::eBind;
+			}
+
+			if ( doStartsWithAny( name, Transfers ) )
+			{
+				return CallCategory::eTransfer;
+			}
+
+			if ( doStartsWithAny( name, StateChanges ) )
+			{
+				return CallCategory::eStateChange;
+			}
+
+			return CallCategory::eOther;
+		}
+
+		CallCategory doGetVkCategory( char const * name )
+		{
+			static char const * const Transfers[]
+			{
+				"CmdBlitImage",
+				"CmdCopy",
+				"CmdFillBuffer",
+				"CmdUpdateBuffer",
+				"FlushMappedMemoryRanges",
+			};
+
+			if ( doStartsWith( name, "CmdDraw" ) )
+			{
+				return CallCategory::eDraw;
+			}
+
+			if ( doStartsWith( name, "CmdDispatch" ) )
+			{
+				return CallCategory::eDispatch;
+			}
+
+			if ( doStartsWith( name, "CmdBind" ) )
+			{
+				return CallCategory::eBind;
+			}
+
+			if ( doStartsWith( name, "CmdSet" ) )
+			{
+				return CallCategory::eStateChange;
+			}
+
+			if ( doStartsWithAny( name, Transfers ) )
+			{
+				return CallCategory::eTransfer;
+			}
+
+			return CallCategory::eOther;
+		}
+
+		CallCategory doGetCategory( char const * name )
+		{
+			if ( doStartsWith( name, "gl::" ) )
+			{
+				return doGetGlCategory( name + 4u );
+			}
+
+			if ( doStartsWith( name, "gl" ) )
+			{
+				return doGetGlCategory( name + 2u );
+			}
+
+			if ( doStartsWith( name, "vk" ) )
+			{
+				return doGetVkCategory( name + 2u );
+			}
+
+			return CallCategory::eOther;
+		}
+	}
+
+	//*************************************************************************
+
+	CallCounter::CallCounter( CallCounters & counters
+		, char const * name )
+	{
+		counters.registerCounter( *this, name );
+	}
+
+	//*************************************************************************
+
+	void CallCounters::registerCounter( CallCounter & counter
+		, char const * name )
+	{
+		counter.m_name = name;
+		counter.m_category = doGetCategory( name );
+		std::lock_guard< std::mutex > lock{ m_mutex };
+		m_counters.push_back( &counter );
+	}
+
+	CallStatistics CallCounters::getStatistics( bool reset )
+	{
+		CallStatistics result;
+		result.uploadedBytes = reset
+			? m_uploadedBytes.exchange( 0u, std::memory_order_relaxed )
+			: m_uploadedBytes.load( std::memory_order_relaxed );
+		std::lock_guard< std::mutex > lock{ m_mutex };
+
+		for ( auto counter : m_counters )
+		{
+			auto count = reset
+				? counter->m_count.exchange( 0u, std::memory_order_relaxed )
+				: counter->m_count.load( std::memory_order_relaxed );
+
+			if ( count )
+			{
+				result.calls += count;
+
+				switch ( counter->m_category )
+				{
+				case CallCategory::eStateChange:
+					result.stateChanges += count;
+					break;
+				case CallCategory::eBind:
+					result.binds += count;
+					break;
+				case CallCategory::eDraw:
+					result.drawCalls += count;
+					break;
+				case CallCategory::eDispatch:
+					result.dispatches += count;
+					break;
+				case CallCategory::eTransfer:
+					result.transfers += count;
+					break;
+				default:
+					break;
+				}
+
+				// The same entry point may be counted by several call sites.
+				auto it = std::find_if( result.entryPoints.begin()
+					, result.entryPoints.end()
+					, [counter]( CallStatistics::EntryPoint const & lookup )
+					{
+						return lookup.name == counter->m_name;
+					} );
+
+				if ( it == result.entryPoints.end() )
+				{
+					result.entryPoints.push_back( { counter->m_name, count } );
+				}
+				else
+				{
+					it->count += count;
+				}
+			}
+		}
+
+		std::sort( result.entryPoints.begin()
+			, result.entryPoints.end()
+			, []( CallStatistics::EntryPoint const & lhs
+				, CallStatistics::EntryPoint const & rhs )
+			{
+				return lhs.count > rhs.count
+					|| ( lhs.count == rhs.count && lhs.name < rhs.name );
+			} );
+		return result;
+	}
+}
@@ -0,0 +1,233 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder.
+*/
+#ifndef ___Renderer_CallStatistics_HPP___
+#define ___Renderer_CallStatistics_HPP___
+#pragma once
+
+#include "RendererPrerequisites.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace renderer
+{
+	/**
+	*\~english
+	*\brief
+	*	The backend API entry points categories.
+	*\~french
+	*\brief
+	*	Les catégories de points d'entrée de l'API du backend.
+	*/
+	enum class CallCategory
+		: uint8_t
+	{
+		eOther,
+		eStateChange,
+		eBind,
+		eDraw,
+		eDispatch,
+		eTransfer,
+	};
+	/**
+	*\~english
+	*\brief
+	*	Backend API calls statistics.
+	*\~french
+	*\brief
+	*	Statistiques d'appels à l'API du backend.
+	*/
+	struct CallStatistics
+	{
+		struct EntryPoint
+		{
+			std::string name;
+			uint64_t count;
+		};
+		//! The total calls count.
+		uint64_t calls{ 0u };
+		//! The fixed function state changes (GL state setters, vkCmdSet*).
+		uint64_t stateChanges{ 0u };
+		//! The objects binds.
+		uint64_t binds{ 0u };
+		//! The draw calls.
+		uint64_t drawCalls{ 0u };
+		//! The compute dispatches.
+		uint64_t dispatches{ 0u };
+		//! The copies, uploads and mapped memory flushes.
+		uint64_t transfers{ 0u };
+		//! The bytes uploaded through flushed mapped memory.
+		uint64_t uploadedBytes{ 0u };
+		//! The calls count per entry point, sorted by decreasing count, the entry points not called are omitted.
+		std::vector< EntryPoint > entryPoints;
+	};
+
+	class CallCounters;
+	/**
+	*\~english
+	*\brief
+	*	The calls counter of one entry point.
+	*\remarks
+	*	Increments an atomic counter, without any lock.
+	*\~french
+	*\brief
+	*	Le compteur d'appels d'un point d'entrée.
+	*\remarks
+	*	Incrémente un compteur atomique, sans aucun verrou.
+	*/
+	class CallCounter
+	{
+		friend class CallCounters;
+
+	public:
+		CallCounter() = default;
+		CallCounter( CallCounter const & ) = delete;
+		CallCounter & operator=( CallCounter const & ) = delete;
+		/**
+		*\~english
+		*\brief
+		*	Constructor, registers the counter.
+		*\param[in] counters
+		*	The counters registry, must outlive the counter.
+		*\param[in] name
+		*	The entry point name, which gives the counter category. Must outlive the counter.
+		*\~french
+		*\brief
+		*	Constructeur, enregistre le compteur.
+		*\param[in] counters
+		*	Le registre de compteurs, doit survivre au compteur.
+		*\param[in] name
+		*	Le nom du point d'entrée, qui donne la catégorie du compteur. Doit survivre au compteur.
+		*/
+		CallCounter( CallCounters & counters
+			, char const * name );
+		/**
+		*\~english
+		*\brief
+		*	Counts one call.
+		*\~french
+		*\brief
+		*	Compte un appel.
+		*/
+		inline void increment()
+		{
+			m_count.fetch_add( 1u, std::memory_order_relaxed );
+		}
+
+	private:
+		char const * m_name{ nullptr };
+		CallCategory m_category{ CallCategory::eOther };
+		std::atomic< uint64_t > m_count{ 0u };
+	};
+	/**
+	*\~english
+	*\brief
+	*	A registry of calls counters.
+	*\~french
+	*\brief
+	*	Un registre de compteurs d'appels.
+	*/
+	class CallCounters
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Registers a counter.
+		*\param[in] counter
+		*	The counter, must outlive the registry.
+		*\param[in] name
+		*	The entry point name: "gl::Name", "glName", or "vkName".
+		*\~french
+		*\brief
+		*	Enregistre un compteur.
+		*\param[in] counter
+		*	Le compteur, doit survivre au registre.
+		*\param[in] name
+		*	Le nom du point d'entrée : "gl::Name", "glName", ou "vkName".
+		*/
+		void registerCounter( CallCounter & counter
+			, char const * name );
+		/**
+		*\~english
+		*\brief
+		*	Counts bytes uploaded to the device.
+		*\~french
+		*\brief
+		*	Compte des octets envoyés au périphérique.
+		*/
+		inline void addUploadedBytes( uint64_t size )
+		{
+			m_uploadedBytes.fetch_add( size, std::memory_order_relaxed );
+		}
+		/**
+		*\~english
+		*\brief
+		*	Gathers the counters values.
+		*\param[in] reset
+		*	Tells if the counters are reset to 0 while being read.
+		*\~french
+		*\brief
+		*	Rassemble les valeurs des compteurs.
+		*\param[in] reset
+		*	Dit si les compteurs sont remis à 0 pendant leur lecture.
+		*/
+		CallStatistics getStatistics( bool reset );
+
+	private:
+		std::mutex m_mutex;
+		std::vector< CallCounter * > m_counters;
+		std::atomic< uint64_t > m_uploadedBytes{ 0u };
+	};
+	/**
+	*\~english
+	*\brief
+	*	A function pointer counting its calls.
+	*\remarks
+	*	Converts to the function pointer, so the calls are written as for the raw function pointer,
+	*	with the exact parameter types. The counter is incremented by the conversion.
+	*\~french
+	*\brief
+	*	Un pointeur de fonction comptant ses appels.
+	*\remarks
+	*	Se convertit en pointeur de fonction, les appels s'écrivent donc comme pour le pointeur de fonction brut,
+	*	avec les types exacts des paramètres. Le compteur est incrémenté par la conversion.
+	*/
+	template< typename FuncT >
+	class CountedFunction
+	{
+	public:
+		CountedFunction() = default;
+		CountedFunction( CountedFunction const & ) = delete;
+		CountedFunction & operator=( CountedFunction const & ) = delete;
+		/**
+		*\~english
+		*\brief
+		*	Sets the function pointer, and registers the counter.
+		*\~french
+		*\brief
+		*	Définit le pointeur de fonction, et enregistre le compteur.
+		*/
+		inline void initialise( CallCounters & counters
+			, char const * name
+			, FuncT function )
+		{
+			m_function = function;
+			counters.registerCounter( m_counter, name );
+		}
+
+		inline operator FuncT()const
+		{
+			m_counter.increment();
+			return m_function;
+		}
+
+	private:
+		FuncT m_function{ nullptr };
+		mutable CallCounter m_counter;
+	};
+}
+
+#endif
@@ -110,9 +110,69 @@ namespace renderer
 		*/
 		virtual void unlock()const = 0;
 
+	protected:
+		/**
+		*\~english
+		*\brief
+		*	Remembers the mapped range, to count the bytes uploaded through it.
+		*\~french
+		*\brief
+		*	Retient l'intervalle mappé, pour compter les octets envoyés par son biais.
+		*/
+		inline void doSetMapped( uint32_t size
+			, MemoryMapFlags flags )const
+		{
+			m_mappedSize = size;
+			m_mappedFlags = flags;
+		}
+		/**
+		*\~english
+		*\return
+		*	The bytes uploaded by a flush.
+		*\remarks
+		*	Non coherent and persistently mapped writes reach the device at flush, the other coherent ones at unmap.
+		*\~french
+		*\return
+		*	Les octets envoyés par un flush.
+		*\remarks
+		*	Les écritures non cohérentes ou mappées de manière persistante atteignent le périphérique au flush, les autres écritures cohérentes à l'unmap.
+		*/
+		inline uint32_t doGetFlushedBytes( uint32_t size )const
+		{
+			return doIsUploadedOnFlush()
+				? size
+				: 0u;
+		}
+		/**
+		*\~english
+		*\return
+		*	The bytes uploaded by an unmap, the whole range written to coherent memory mapped without persistence.
+		*\~french
+		*\return
+		*	Les octets envoyés par un unmap, tout l'intervalle écrit dans une mémoire cohérente mappée sans persistance.
+		*/
+		inline uint32_t doGetUnmappedBytes()const
+		{
+			return ( doIsUploadedOnFlush() || !checkFlag( m_mappedFlags, MemoryMapFlag::eWrite ) )
+				? 0u
+				: m_mappedSize;
+		}
+
+	private:
+		inline bool doIsUploadedOnFlush()const
+		{
+			return !checkFlag( m_flags, MemoryPropertyFlag::eHostCoherent )
+				|| checkFlag( m_mappedFlags, MemoryMapFlag::ePersistent )
+				|| checkFlag( m_mappedFlags, MemoryMapFlag::eCoherent );
+		}
+
 	protected:
 		Device const & m_device;
 		MemoryPropertyFlags m_flags;
+
+	private:
+		mutable uint32_t m_mappedSize{ 0u };
+		mutable MemoryMapFlags m_mappedFlags;
 	};
 }
 
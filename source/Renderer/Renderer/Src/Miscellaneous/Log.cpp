@@ -1,13 +1,429 @@
 #include "Log.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace renderer
 {
 	namespace
 	{
+		//! La taille du tampon circulaire de chaque thread.
+		static size_t constexpr BufferSize = 1u << 20u;
+		//! Le remplissage à partir duquel le thread de vidage est réveillé.
+		static size_t constexpr WakeupThreshold = BufferSize / 2u;
+		//! La taille maximale d'un message sérialisé.
+		static size_t constexpr MaxRecordSize = 16u * 1024u;
+		//! La taille maximale d'une chaîne copiée, les chaînes loggées par doLogString sont découpées en plusieurs messages.
+		static uint32_t constexpr MaxStringSize = 1024u;
+		//! L'alignement des messages dans le tampon, les zones de remplissage peuvent donc toujours contenir un en-tête.
+		static size_t constexpr RecordAlign = 16u;
+		//! L'identifiant de format des zones de remplissage en fin de tampon.
+		static uint32_t constexpr PaddingFormat = ~( 0u );
+		//! Le délai maximal entre deux vidages.
+		static std::chrono::milliseconds constexpr FlushPeriod{ 10 };
+		static char const DumpMagic[4]{ 'R', 'L', 'O', 'G' };
+		static uint32_t constexpr DumpVersion = 1u;
+		static uint8_t constexpr DumpFormatTag = uint8_t( 'F' );
+		static uint8_t constexpr DumpRecordTag = uint8_t( 'R' );
+
+		struct RecordHeader
+		{
+			//! La taille du message, en-tête compris, sans l'alignement.
+			uint32_t size;
+			uint32_t format;
+			//! Le temps écoulé depuis le démarrage du logger, en nanosecondes.
+			uint64_t time;
+		};
+		static_assert( sizeof( RecordHeader ) <= RecordAlign, "The padding must be able to hold a header" );
+
+		/**
+		*\brief
+		*	Le tampon circulaire d'un thread.
+		*\remarks
+		*	Un seul producteur (le thread propriétaire) et un seul consommateur (le thread de vidage).
+		*	Les positions sont des compteurs d'octets croissants.
+		*/
+		struct LogBuffer
+		{
+			explicit LogBuffer( uint32_t index )
+				: index{ index }
+				, data( BufferSize )
+			{
+			}
+
+			uint32_t const index;
+			std::vector< uint8_t > data;
+			//! La position d'écriture, modifiée par le thread propriétaire.
+			std::atomic< uint64_t > head{ 0u };
+			//! La position de lecture, modifiée par le thread de vidage.
+			std::atomic< uint64_t > tail{ 0u };
+			//! Dit si le thread propriétaire est terminé.
+			std::atomic< bool > orphan{ false };
+		};
+		using LogBufferPtr = std::shared_ptr< LogBuffer >;
+		/**
+		*\remarks
+		*	Les registres ne sont jamais détruits, pour pouvoir logger pendant la destruction des variables statiques.
+		*/
+		struct FormatRegistry
+		{
+			std::mutex mutex;
+			std::vector< LogFormat const * > formats;
+		};
+
+		struct BufferRegistry
+		{
+			std::mutex mutex;
+			std::vector< LogBufferPtr > buffers;
+			uint32_t nextIndex{ 0u };
+			std::atomic< uint64_t > dropped{ 0u };
+			//! Mis à vrai lorsque le thread de vidage est arrêté, les messages sont alors vidés par le thread appelant.
+			std::atomic< bool > synchronous{ false };
+			//! Réveille le thread de vidage avant son délai lorsqu'un tampon se remplit.
+			std::condition_variable wakeup;
+		};
+
+		FormatRegistry & doGetFormats()
+		{
+			static FormatRegistry & result = *new FormatRegistry;
+			return result;
+		}
+
+		BufferRegistry & doGetBuffers()
+		{
+			static BufferRegistry & result = *new BufferRegistry;
+			return result;
+		}
+
+		struct ThreadBuffer
+		{
+			~ThreadBuffer()
+			{
+				if ( buffer )
+				{
+					buffer->orphan = true;
+				}
+			}
+
+			LogBufferPtr buffer;
+		};
+
+		//! Vrai sur le thread en train d'appeler les callbacks, pour éviter qu'un message d'erreur n'y provoque un vidage.
+		thread_local bool t_dispatching{ false };
+
+		LogBuffer & doGetThreadBuffer()
+		{
+			thread_local ThreadBuffer result;
+
+			if ( !result.buffer )
+			{
+				auto & registry = doGetBuffers();
+				std::lock_guard< std::mutex > lock{ registry.mutex };
+				result.buffer = std::make_shared< LogBuffer >( registry.nextIndex++ );
+				registry.buffers.push_back( result.buffer );
+			}
+
+			return *result.buffer;
+		}
+
+		uint64_t doGetTime()
+		{
+			using Clock = std::chrono::steady_clock;
+			static Clock::time_point const start = Clock::now();
+			return uint64_t( std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - start ).count() );
+		}
+
+		size_t doAlign( size_t size )
+		{
+			return ( size + RecordAlign - 1u ) & ~( RecordAlign - 1u );
+		}
+
+		uint8_t * doReserve( LogBuffer & buffer
+			, size_t size
+			, uint64_t & position )
+		{
+			size = doAlign( size );
+			auto head = buffer.head.load( std::memory_order_relaxed );
+			auto tail = buffer.tail.load( std::memory_order_acquire );
+			auto offset = size_t( head % BufferSize );
+			auto toEnd = BufferSize - offset;
+			auto needed = size > toEnd
+				? toEnd + size
+				: size;
+
+			if ( head + needed - tail > BufferSize )
+			{
+				return nullptr;
+			}
+
+			if ( size > toEnd )
+			{
+				RecordHeader padding{ uint32_t( toEnd ), PaddingFormat, 0u };
+				std::memcpy( &buffer.data[offset], &padding, sizeof( padding ) );
+				head += toEnd;
+				buffer.head.store( head, std::memory_order_release );
+				offset = 0u;
+			}
+
+			position = head;
+			return &buffer.data[offset];
+		}
+
+		/**
+		*\return
+		*	\p true si le tampon vient de dépasser le seuil de réveil.
+		*/
+		bool doCommit( LogBuffer & buffer
+			, size_t size
+			, uint64_t position )
+		{
+			auto head = position + doAlign( size );
+			buffer.head.store( head, std::memory_order_release );
+			auto used = head - buffer.tail.load( std::memory_order_relaxed );
+			return used >= WakeupThreshold
+				&& used - doAlign( size ) < WakeupThreshold;
+		}
+
+		uint32_t doGetStringSize( details::LogArg const & arg )
+		{
+			return std::min( arg.length, MaxStringSize );
+		}
+
+		size_t doGetArgSize( details::LogArg const & arg )
+		{
+			return arg.type == details::LogArgType::eString
+				? 1u + sizeof( uint32_t ) + doGetStringSize( arg )
+				: 1u + sizeof( uint64_t );
+		}
+
+		uint8_t * doWriteArg( uint8_t * data
+			, details::LogArg const & arg )
+		{
+			*data++ = uint8_t( arg.type );
+
+			switch ( arg.type )
+			{
+			case details::LogArgType::eString:
+				{
+					auto length = doGetStringSize( arg );
+					std::memcpy( data, &length, sizeof( length ) );
+					data += sizeof( length );
+					std::memcpy( data, arg.s, length );
+					data += length;
+				}
+				break;
+
+			case details::LogArgType::ePointer:
+				{
+					auto value = uint64_t( reinterpret_cast< uintptr_t >( arg.p ) );
+					std::memcpy( data, &value, sizeof( value ) );
+					data += sizeof( value );
+				}
+				break;
+
+			default:
+				std::memcpy( data, &arg.u, sizeof( uint64_t ) );
+				data += sizeof( uint64_t );
+				break;
+			}
+
+			return data;
+		}
+
+		template< typename T >
+		bool doRead( uint8_t const *& data
+			, uint8_t const * end
+			, T & value )
+		{
+			if ( size_t( end - data ) < sizeof( T ) )
+			{
+				return false;
+			}
+
+			std::memcpy( &value, data, sizeof( T ) );
+			data += sizeof( T );
+			return true;
+		}
+
+		bool doFormatArg( uint8_t const *& data
+			, uint8_t const * end
+			, std::string & result )
+		{
+			uint8_t type;
+			uint64_t value;
+			char buffer[32];
+
+			if ( !doRead( data, end, type ) )
+			{
+				return false;
+			}
+
+			switch ( details::LogArgType( type ) )
+			{
+			case details::LogArgType::eInt:
+				if ( !doRead( data, end, value ) )
+				{
+					return false;
+				}
+				result += std::to_string( int64_t( value ) );
+				break;
+
+			case details::LogArgType::eUInt:
+				if ( !doRead( data, end, value ) )
+				{
+					return false;
+				}
+				result += std::to_string( value );
+				break;
+
+			case details::LogArgType::eFloat:
+				{
+					double real;
+
+					if ( !doRead( data, end, real ) )
+					{
+						return false;
+					}
+
+					std::snprintf( buffer, sizeof( buffer ), "%g", real );
+					result += buffer;
+				}
+				break;
+
+			case details::LogArgType::ePointer:
+				if ( !doRead( data, end, value ) )
+				{
+					return false;
+				}
+
+				if ( value )
+				{
+					std::snprintf( buffer, sizeof( buffer ), "0x%llx", static_cast< unsigned long long >( value ) );
+					result += buffer;
+				}
+				else
+				{
+					result += "nullptr";
+				}
+				break;
+
+			case details::LogArgType::eString:
+				{
+					uint32_t length;
+
+					if ( !doRead( data, end, length )
+						|| size_t( end - data ) < length )
+					{
+						return false;
+					}
+
+					result.append( reinterpret_cast< char const * >( data ), length );
+					data += length;
+				}
+				break;
+
+			default:
+				return false;
+			}
+
+			return true;
+		}
+
+		bool doFormat( char const * text
+			, uint32_t flags
+			, uint8_t const * data
+			, size_t size
+			, std::string & result )
+		{
+			auto end = data + size;
+
+			if ( flags & LogFormat::Call )
+			{
+				result += text;
+				result += "(";
+
+				for ( auto first = true; data != end; first = false )
+				{
+					if ( !first )
+					{
+						result += ", ";
+					}
+
+					if ( !doFormatArg( data, end, result ) )
+					{
+						return false;
+					}
+				}
+
+				result += ")";
+				return true;
+			}
+
+			while ( *text )
+			{
+				if ( text[0] == '{' && text[1] == '}' && data != end )
+				{
+					if ( !doFormatArg( data, end, result ) )
+					{
+						return false;
+					}
+
+					text += 2;
+				}
+				else
+				{
+					result += *text++;
+				}
+			}
+
+			while ( data != end )
+			{
+				result += " ";
+
+				if ( !doFormatArg( data, end, result ) )
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		char const * doGetLevelName( LogLevel level )
+		{
+			switch ( level )
+			{
+			case LogLevel::eDebug:
+				return "Debug";
+			case LogLevel::eInfo:
+				return "Info";
+			case LogLevel::eWarning:
+				return "Warning";
+			case LogLevel::eError:
+				return "Error";
+			default:
+				return "Unknown";
+			}
+		}
+
+		template< typename T >
+		void doWrite( std::ostream & stream
+			, T const & value )
+		{
+			stream.write( reinterpret_cast< char const * >( &value ), sizeof( T ) );
+		}
+
 		void doLog( std::string const & message
 			, bool newLine
 			, std::ostream & stream )
@@ -21,92 +437,734 @@ namespace renderer
 		}
 	}
 
+	//*************************************************************************
+
+	LogFormat::LogFormat( LogLevel level
+		, char const * text
+		, uint32_t flags )
+		: level{ level }
+		, text{ text }
+		, flags{ flags }
+		, id{ [this]()
+			{
+				auto & registry = doGetFormats();
+				std::lock_guard< std::mutex > lock{ registry.mutex };
+				registry.formats.push_back( this );
+				return uint32_t( registry.formats.size() - 1u );
+			}() }
+	{
+	}
+
+	//*************************************************************************
+
+	bool details::writeLogRecord( LogFormat const & format
+		, LogArg const * args
+		, size_t count )
+	{
+		// Starts the flusher thread, and its flush at exit, with the first message.
+		Logger::doGetInstance();
+		size_t size = sizeof( RecordHeader );
+
+		for ( size_t index = 0u; index < count; ++index )
+		{
+			size += doGetArgSize( args[index] );
+		}
+
+		auto & registry = doGetBuffers();
+
+		if ( size > MaxRecordSize )
+		{
+			++registry.dropped;
+			return false;
+		}
+
+		auto & buffer = doGetThreadBuffer();
+		uint64_t position;
+		auto data = doReserve( buffer, size, position );
+
+		if ( !data && format.level >= LogLevel::eWarning )
+		{
+			Logger::flush();
+			data = doReserve( buffer, size, position );
+		}
+
+		if ( !data )
+		{
+			++registry.dropped;
+			return false;
+		}
+
+		RecordHeader header{ uint32_t( size ), format.id, doGetTime() };
+		std::memcpy( data, &header, sizeof( header ) );
+		data += sizeof( header );
+
+		for ( size_t index = 0u; index < count; ++index )
+		{
+			data = doWriteArg( data, args[index] );
+		}
+
+		if ( format.level == LogLevel::eError
+			|| registry.synchronous )
+		{
+			doCommit( buffer, size, position );
+			Logger::flush();
+		}
+		else if ( doCommit( buffer, size, position ) )
+		{
+			registry.wakeup.notify_one();
+		}
+
+		return true;
+	}
+
+	//*************************************************************************
+
+	/**
+	*\brief
+	*	Le thread de vidage, qui formate les messages et les envoie aux callbacks et au dump.
+	*\remarks
+	*	Les messages sont collectés et formatés sous m_mutex, puis envoyés aux callbacks sans verrou,
+	*	par un seul thread à la fois, afin de conserver leur ordre.
+	*/
+	class Logger::Worker
+	{
+	private:
+		struct Entry
+		{
+			uint64_t time;
+			uint32_t thread;
+			uint32_t format;
+			size_t offset;
+			size_t size;
+		};
+
+		struct Message
+		{
+			LogLevel level;
+			bool newLine;
+			//! La position du texte dans le tampon de textes.
+			size_t offset;
+			size_t size;
+		};
+
+	public:
+		explicit Worker( Logger & logger )
+			: m_logger{ logger }
+			, m_thread{ [this]()
+				{
+					doRun();
+				} }
+		{
+		}
+
+		~Worker()
+		{
+			stop();
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard< std::mutex > lock{ m_mutex };
+				m_stopped = true;
+			}
+
+			doGetBuffers().wakeup.notify_all();
+
+			if ( m_thread.joinable() )
+			{
+				m_thread.join();
+			}
+
+			doGetBuffers().synchronous = true;
+			flush();
+		}
+
+		void flush()
+		{
+			if ( !t_dispatching )
+			{
+				std::unique_lock< std::mutex > lock{ m_mutex };
+				doFlush( lock );
+			}
+		}
+
+		bool setDumpFile( std::string const & path )
+		{
+			std::unique_lock< std::mutex > lock{ m_mutex };
+			doFlush( lock );
+			m_dump.reset();
+			m_dumpedFormats.clear();
+
+			if ( path.empty() )
+			{
+				return true;
+			}
+
+			auto dump = std::make_unique< std::ofstream >( path, std::ios::binary | std::ios::trunc );
+
+			if ( !*dump )
+			{
+				return false;
+			}
+
+			dump->write( DumpMagic, sizeof( DumpMagic ) );
+			doWrite( *dump, DumpVersion );
+			m_dump = std::move( dump );
+			return true;
+		}
+
+		std::mutex & getMutex()
+		{
+			return m_mutex;
+		}
+
+	private:
+		void doRun()
+		{
+			std::unique_lock< std::mutex > lock{ m_mutex };
+
+			while ( !m_stopped )
+			{
+				doGetBuffers().wakeup.wait_for( lock, FlushPeriod );
+				doFlush( lock );
+			}
+		}
+
+		void doFlush( std::unique_lock< std::mutex > & lock )
+		{
+			m_entries.clear();
+			m_arena.clear();
+			doCollect();
+			// Sorts the messages from all the threads, each buffer being already sorted.
+			std::stable_sort( m_entries.begin()
+				, m_entries.end()
+				, []( Entry const & lhs, Entry const & rhs )
+				{
+					return lhs.time < rhs.time;
+				} );
+
+			for ( auto & entry : m_entries )
+			{
+				doFormatEntry( entry );
+			}
+
+			auto dropped = doGetBuffers().dropped.exchange( 0u );
+
+			if ( dropped )
+			{
+				auto offset = m_texts.size();
+				m_texts += std::to_string( dropped ) + " log message(s) dropped, the log buffer was full.";
+				m_messages.push_back( { LogLevel::eWarning, true, offset, m_texts.size() - offset } );
+				++m_queued;
+			}
+
+			if ( m_dump )
+			{
+				m_dump->flush();
+			}
+
+			if ( t_dispatching )
+			{
+				// Flushed from a callback, the messages are sent by the dispatch loop of this thread.
+				return;
+			}
+
+			if ( m_dispatching )
+			{
+				// Another thread is sending the messages, including ours.
+				auto queued = m_queued;
+				m_dispatched.wait( lock
+					, [this, queued]()
+					{
+						return m_dispatchedCount >= queued;
+					} );
+				return;
+			}
+
+			doDispatch( lock );
+		}
+
+		void doDispatch( std::unique_lock< std::mutex > & lock )
+		{
+			m_dispatching = true;
+
+			while ( !m_messages.empty() )
+			{
+				// Only the dispatching thread uses the swapped buffers, they can be read without the lock.
+				std::swap( m_messages, m_dispatchMessages );
+				std::swap( m_texts, m_dispatchTexts );
+				LogCallback const callbacks[]
+				{
+					m_logger.m_debug,
+					m_logger.m_info,
+					m_logger.m_warning,
+					m_logger.m_error,
+				};
+				lock.unlock();
+				t_dispatching = true;
+
+				for ( auto & message : m_dispatchMessages )
+				{
+					m_text.assign( m_dispatchTexts, message.offset, message.size );
+					callbacks[size_t( message.level )]( m_text, message.newLine );
+				}
+
+				t_dispatching = false;
+				lock.lock();
+				m_dispatchedCount += m_dispatchMessages.size();
+				m_dispatchMessages.clear();
+				m_dispatchTexts.clear();
+				m_dispatched.notify_all();
+			}
+
+			m_dispatching = false;
+		}
+
+		void doCollect()
+		{
+			auto & registry = doGetBuffers();
+			std::lock_guard< std::mutex > lock{ registry.mutex };
+
+			for ( auto & buffer : registry.buffers )
+			{
+				auto tail = buffer->tail.load( std::memory_order_relaxed );
+				auto head = buffer->head.load( std::memory_order_acquire );
+
+				while ( tail < head )
+				{
+					auto offset = size_t( tail % BufferSize );
+					RecordHeader header;
+					std::memcpy( &header, &buffer->data[offset], sizeof( header ) );
+
+					if ( header.format != PaddingFormat )
+					{
+						Entry entry
+						{
+							header.time,
+							buffer->index,
+							header.format,
+							m_arena.size(),
+							header.size - sizeof( header ),
+						};
+						auto begin = buffer->data.begin() + offset + sizeof( header );
+						m_arena.insert( m_arena.end(), begin, begin + entry.size );
+						m_entries.push_back( entry );
+					}
+
+					tail += doAlign( header.size );
+				}
+
+				buffer->tail.store( tail, std::memory_order_release );
+			}
+
+			registry.buffers.erase( std::remove_if( registry.buffers.begin()
+					, registry.buffers.end()
+					, []( LogBufferPtr const & buffer )
+					{
+						return buffer->orphan
+							&& buffer->tail.load() == buffer->head.load();
+					} )
+				, registry.buffers.end() );
+		}
+
+		void doFormatEntry( Entry const & entry )
+		{
+			LogFormat const * format;
+			{
+				auto & registry = doGetFormats();
+				std::lock_guard< std::mutex > lock{ registry.mutex };
+				format = registry.formats[entry.format];
+			}
+
+			auto args = m_arena.data() + entry.offset;
+
+			if ( format->flags & LogFormat::Partial )
+			{
+				doFormat( format->text, format->flags, args, entry.size, m_partials[entry.thread] );
+			}
+			else
+			{
+				auto offset = m_texts.size();
+				auto partial = m_partials.find( entry.thread );
+
+				if ( partial != m_partials.end() )
+				{
+					m_texts += partial->second;
+					m_partials.erase( partial );
+				}
+
+				doFormat( format->text, format->flags, args, entry.size, m_texts );
+				m_messages.push_back( { format->level
+					, !( format->flags & LogFormat::NoNewLine )
+					, offset
+					, m_texts.size() - offset } );
+				++m_queued;
+			}
+
+			if ( m_dump )
+			{
+				doDump( *format, entry, args );
+			}
+		}
+
+		void doDump( LogFormat const & format
+			, Entry const & entry
+			, uint8_t const * args )
+		{
+			if ( m_dumpedFormats.size() <= format.id )
+			{
+				m_dumpedFormats.resize( format.id + 1u, false );
+			}
+
+			if ( !m_dumpedFormats[format.id] )
+			{
+				auto length = uint32_t( std::strlen( format.text ) );
+				doWrite( *m_dump, DumpFormatTag );
+				doWrite( *m_dump, format.id );
+				doWrite( *m_dump, format.level );
+				doWrite( *m_dump, format.flags );
+				doWrite( *m_dump, length );
+				m_dump->write( format.text, length );
+				m_dumpedFormats[format.id] = true;
+			}
+
+			doWrite( *m_dump, DumpRecordTag );
+			doWrite( *m_dump, entry.format );
+			doWrite( *m_dump, entry.thread );
+			doWrite( *m_dump, entry.time );
+			doWrite( *m_dump, uint32_t( entry.size ) );
+			m_dump->write( reinterpret_cast< char const * >( args ), std::streamsize( entry.size ) );
+		}
+
+	private:
+		Logger & m_logger;
+		std::mutex m_mutex;
+		bool m_stopped{ false };
+		std::vector< Entry > m_entries;
+		std::vector< uint8_t > m_arena;
+		//! Les messages formatés, en attente d'envoi aux callbacks.
+		std::vector< Message > m_messages;
+		std::string m_texts;
+		//! Les débuts de messages découpés, par thread.
+		std::unordered_map< uint32_t, std::string > m_partials;
+		//! Les messages en cours d'envoi, utilisés sans verrou par le thread qui les envoie.
+		std::vector< Message > m_dispatchMessages;
+		std::string m_dispatchTexts;
+		std::string m_text;
+		bool m_dispatching{ false };
+		uint64_t m_queued{ 0u };
+		uint64_t m_dispatchedCount{ 0u };
+		std::condition_variable m_dispatched;
+		std::unique_ptr< std::ofstream > m_dump;
+		std::vector< bool > m_dumpedFormats;
+		std::thread m_thread;
+	};
+
+	//*************************************************************************
+
 	Logger::Logger()
 		: m_debug{ []( std::string const & msg, bool newLine ){ doLog( msg, newLine, std::clog ); } }
 		, m_info{ []( std::string const & msg, bool newLine ){ doLog( msg, newLine, std::cout ); } }
 		, m_warning{ []( std::string const & msg, bool newLine ){ doLog( msg, newLine, std::cout ); } }
 		, m_error{ []( std::string const & msg, bool newLine ){ doLog( msg, newLine, std::cerr ); } }
+		, m_worker{ std::make_unique< Worker >( *this ) }
+	{
+		// The instance is never destroyed, so that messages can still be logged
+		// during static destruction, but the flusher thread is stopped at exit.
+		std::atexit( []()
+			{
+				doGetInstance().m_worker->stop();
+			} );
+	}
+
+	Logger::~Logger()
 	{
 	}
 
 	void Logger::logDebug( std::string const & message, bool newLine )
 	{
-		doGetInstance().m_debug( message, newLine );
+		doLogString( LogLevel::eDebug, message, newLine );
 	}
 
 	void Logger::logInfo( std::string const & message, bool newLine )
 	{
-		doGetInstance().m_info( message, newLine );
+		doLogString( LogLevel::eInfo, message, newLine );
 	}
 
 	void Logger::logWarning( std::string const & message, bool newLine )
 	{
-		doGetInstance().m_warning( message, newLine );
+		doLogString( LogLevel::eWarning, message, newLine );
 	}
 
 	void Logger::logError( std::string const & message, bool newLine )
 	{
-		doGetInstance().m_error( message, newLine );
+		doLogString( LogLevel::eError, message, newLine );
 	}
 
 	void Logger::logDebug( std::ostream const & message, bool newLine )
 	{
-		auto sbuf = message.rdbuf();
-		std::stringstream ss;
-		ss << sbuf;
-		doGetInstance().m_debug( ss.str(), newLine );
+		if ( isEnabled( LogLevel::eDebug ) )
+		{
+			auto sbuf = message.rdbuf();
+			std::stringstream ss;
+			ss << sbuf;
+			doLogString( LogLevel::eDebug, ss.str(), newLine );
+		}
 	}
 
 	void Logger::logInfo( std::ostream const & message, bool newLine )
 	{
-		auto sbuf = message.rdbuf();
-		std::stringstream ss;
-		ss << sbuf;
-		doGetInstance().m_info( ss.str(), newLine );
+		if ( isEnabled( LogLevel::eInfo ) )
+		{
+			auto sbuf = message.rdbuf();
+			std::stringstream ss;
+			ss << sbuf;
+			doLogString( LogLevel::eInfo, ss.str(), newLine );
+		}
 	}
 
 	void Logger::logWarning( std::ostream const & message, bool newLine )
 	{
-		auto sbuf = message.rdbuf();
-		std::stringstream ss;
-		ss << sbuf;
-		doGetInstance().m_warning( ss.str(), newLine );
+		if ( isEnabled( LogLevel::eWarning ) )
+		{
+			auto sbuf = message.rdbuf();
+			std::stringstream ss;
+			ss << sbuf;
+			doLogString( LogLevel::eWarning, ss.str(), newLine );
+		}
 	}
 
 	void Logger::logError( std::ostream const & message, bool newLine )
 	{
-		auto sbuf = message.rdbuf();
-		std::stringstream ss;
-		ss << sbuf;
-		doGetInstance().m_error( ss.str(), newLine );
+		if ( isEnabled( LogLevel::eError ) )
+		{
+			auto sbuf = message.rdbuf();
+			std::stringstream ss;
+			ss << sbuf;
+			doLogString( LogLevel::eError, ss.str(), newLine );
+		}
 	}
 
 	void Logger::setDebugCallback( LogCallback callback )
 	{
-		doGetInstance().m_debug = std::move( callback );
+		auto & instance = doGetInstance();
+		std::lock_guard< std::mutex > lock{ instance.m_worker->getMutex() };
+		instance.m_debug = std::move( callback );
 	}
 
 	void Logger::setInfoCallback( LogCallback callback )
 	{
-		doGetInstance().m_info = std::move( callback );
+		auto & instance = doGetInstance();
+		std::lock_guard< std::mutex > lock{ instance.m_worker->getMutex() };
+		instance.m_info = std::move( callback );
 	}
 
 	void Logger::setWarningCallback( LogCallback callback )
 	{
-		doGetInstance().m_warning = std::move( callback );
+		auto & instance = doGetInstance();
+		std::lock_guard< std::mutex > lock{ instance.m_worker->getMutex() };
+		instance.m_warning = std::move( callback );
 	}
 
 	void Logger::setErrorCallback( LogCallback callback )
 	{
-		doGetInstance().m_error = std::move( callback );
+		auto & instance = doGetInstance();
+		std::lock_guard< std::mutex > lock{ instance.m_worker->getMutex() };
+		instance.m_error = std::move( callback );
 	}
 
-	Logger & Logger::doGetInstance()
+	void Logger::setLevel( LogLevel level )
+	{
+		details::getRuntimeLogLevel().store( level, std::memory_order_relaxed );
+	}
+
+	void Logger::flush()
+	{
+		doGetInstance().m_worker->flush();
+	}
+
+	bool Logger::setDumpFile( std::string const & path )
+	{
+		return doGetInstance().m_worker->setDumpFile( path );
+	}
+
+	bool Logger::decodeDump( std::istream & input
+		, std::ostream & output )
 	{
-		static Logger instance;
-		static std::mutex mutex;
+		struct Format
+		{
+			LogLevel level;
+			uint32_t flags;
+			std::string text;
+		};
+
+		char magic[sizeof( DumpMagic )];
+		uint32_t version;
+		input.read( magic, sizeof( magic ) );
+		input.read( reinterpret_cast< char * >( &version ), sizeof( version ) );
+
+		if ( !input
+			|| !std::equal( magic, magic + sizeof( magic ), DumpMagic )
+			|| version != DumpVersion )
+		{
+			return false;
+		}
+
+		std::vector< Format > formats;
+		std::vector< uint8_t > args;
+		std::unordered_map< uint32_t, std::string > partials;
+		std::string text;
+		char time[32];
+		uint8_t tag;
+
+		auto read = [&input]( auto & value )
+		{
+			input.read( reinterpret_cast< char * >( &value ), sizeof( value ) );
+			return bool( input );
+		};
+
+		while ( input.read( reinterpret_cast< char * >( &tag ), sizeof( tag ) ) )
+		{
+			if ( tag == DumpFormatTag )
+			{
+				uint32_t id;
+				Format format;
+				uint32_t length;
+
+				if ( !read( id )
+					|| !read( format.level )
+					|| !read( format.flags )
+					|| !read( length ) )
+				{
+					return false;
+				}
+
+				format.text.resize( length );
+
+				if ( !input.read( &format.text[0], length ) )
+				{
+					return false;
+				}
+
+				if ( formats.size() <= id )
+				{
+					formats.resize( id + 1u );
+				}
+
+				formats[id] = std::move( format );
+			}
+			else if ( tag == DumpRecordTag )
+			{
+				uint32_t id;
+				uint32_t thread;
+				uint64_t nanoseconds;
+				uint32_t size;
+
+				if ( !read( id )
+					|| !read( thread )
+					|| !read( nanoseconds )
+					|| !read( size )
+					|| id >= formats.size() )
+				{
+					return false;
+				}
+
+				args.resize( size );
+
+				if ( !input.read( reinterpret_cast< char * >( args.data() ), size ) )
+				{
+					return false;
+				}
+
+				auto & format = formats[id];
+
+				if ( format.flags & LogFormat::Partial )
+				{
+					if ( !doFormat( format.text.c_str(), format.flags, args.data(), args.size(), partials[thread] ) )
+					{
+						return false;
+					}
+
+					continue;
+				}
+
+				text.clear();
+				auto partial = partials.find( thread );
+
+				if ( partial != partials.end() )
+				{
+					text = std::move( partial->second );
+					partials.erase( partial );
+				}
+
+				if ( !doFormat( format.text.c_str(), format.flags, args.data(), args.size(), text ) )
+				{
+					return false;
+				}
+
+				std::snprintf( time, sizeof( time ), "%.6f", double( nanoseconds ) / 1.0e9 );
+				output << "[" << time << "] [" << thread << "] " << doGetLevelName( format.level ) << ": " << text << "\n";
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return input.eof();
+	}
 
-		std::unique_lock< std::mutex > lock{ mutex };
+	Logger & Logger::doGetInstance()
+	{
+		static Logger & instance = *new Logger;
 		return instance;
 	}
+
+	void Logger::doLogString( LogLevel level
+		, std::string const & message
+		, bool newLine )
+	{
+		static LogFormat const formats[]
+		{
+			{ LogLevel::eDebug, "{}" },
+			{ LogLevel::eDebug, "{}", LogFormat::NoNewLine },
+			{ LogLevel::eDebug, "{}", LogFormat::Partial },
+			{ LogLevel::eInfo, "{}" },
+			{ LogLevel::eInfo, "{}", LogFormat::NoNewLine },
+			{ LogLevel::eInfo, "{}", LogFormat::Partial },
+			{ LogLevel::eWarning, "{}" },
+			{ LogLevel::eWarning, "{}", LogFormat::NoNewLine },
+			{ LogLevel::eWarning, "{}", LogFormat::Partial },
+			{ LogLevel::eError, "{}" },
+			{ LogLevel::eError, "{}", LogFormat::NoNewLine },
+			{ LogLevel::eError, "{}", LogFormat::Partial },
+		};
+
+		if ( !isEnabled( level ) )
+		{
+			return;
+		}
+
+		// The strings longer than a record argument are split in partial records, joined back by the flusher thread.
+		auto levelFormats = formats + size_t( level ) * 3u;
+		details::LogArg arg{ details::LogArgType::eString, MaxStringSize, {} };
+		size_t offset = 0u;
+
+		while ( message.size() - offset > MaxStringSize )
+		{
+			arg.s = message.data() + offset;
+
+			if ( !details::writeLogRecord( levelFormats[2], &arg, 1u ) )
+			{
+				return;
+			}
+
+			offset += MaxStringSize;
+		}
+
+		arg.s = message.data() + offset;
+		arg.length = uint32_t( message.size() - offset );
+		details::writeLogRecord( levelFormats[newLine ? 0u : 1u], &arg, 1u );
+	}
 }
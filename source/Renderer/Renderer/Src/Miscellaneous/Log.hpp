@@ -4,20 +4,269 @@ See LICENSE file in root folder
 #ifndef ___Renderer_Log_H___
 #define ___Renderer_Log_H___
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <type_traits>
+
+/**
+*\~english
+*\brief
+*	The minimal severity compiled in, messages with a lower severity are removed at compile time.
+*\~french
+*\brief
+*	La sévérité minimale compilée, les messages de sévérité inférieure sont supprimés à la compilation.
+*/
+#if !defined( RENDERLIB_LOG_LEVEL )
+#	define RENDERLIB_LOG_LEVEL 0
+#endif
 
 namespace renderer
 {
+	/**
+	*\~english
+	*\brief
+	*	The log messages severities.
+	*\~french
+	*\brief
+	*	Les sévérités des messages de log.
+	*/
+	enum class LogLevel
+		: uint8_t
+	{
+		eDebug,
+		eInfo,
+		eWarning,
+		eError,
+	};
+	/**
+	*\~english
+	*\brief
+	*	A log message format, registered once per call site.
+	*\remarks
+	*	Only the format identifier and the raw arguments are stored when logging,
+	*	the text is built by the flusher thread, or by the binary dump decoder.
+	*	Each "{}" in the text is replaced by the next argument, the remaining arguments are appended.
+	*\~french
+	*\brief
+	*	Un format de message de log, enregistré une fois par site d'appel.
+	*\remarks
+	*	Seuls l'identifiant du format et les arguments bruts sont stockés lors du log,
+	*	le texte est construit par le thread de vidage, ou par le décodeur de dump binaire.
+	*	Chaque "{}" du texte est remplacé par l'argument suivant, les arguments restants sont ajoutés à la fin.
+	*/
+	class LogFormat
+	{
+	public:
+		//! The message isn't followed by a new line.
+		static uint32_t constexpr NoNewLine = 0x01u;
+		//! The text is a function name, the arguments are written between parentheses.
+		static uint32_t constexpr Call = 0x02u;
+		//! The message continues in the next record of the same thread, the flusher thread joins them.
+		static uint32_t constexpr Partial = 0x04u;
+
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor, registers the format.
+		*\param[in] level
+		*	The messages severity.
+		*\param[in] text
+		*	The format text, must outlive the logger (usually a string literal).
+		*\param[in] flags
+		*	A combination of NoNewLine, Call and Partial.
+		*\~french
+		*\brief
+		*	Constructeur, enregistre le format.
+		*\param[in] level
+		*	La sévérité des messages.
+		*\param[in] text
+		*	Le texte du format, doit survivre au logger (généralement une chaîne littérale).
+		*\param[in] flags
+		*	Une combinaison de NoNewLine, Call et Partial.
+		*/
+		LogFormat( LogLevel level
+			, char const * text
+			, uint32_t flags = 0u );
+
+		LogFormat( LogFormat const & ) = delete;
+		LogFormat & operator=( LogFormat const & ) = delete;
+
+	public:
+		LogLevel const level;
+		char const * const text;
+		uint32_t const flags;
+		uint32_t const id;
+	};
+
+	namespace details
+	{
+		enum class LogArgType
+			: uint8_t
+		{
+			eInt,
+			eUInt,
+			eFloat,
+			ePointer,
+			eString,
+		};
+		/**
+		*\brief
+		*	Un argument de message, avant sa sérialisation.
+		*\remarks
+		*	Les chaînes sont copiées lors de la sérialisation, le pointeur n'est donc utilisé que pendant l'appel.
+		*/
+		struct LogArg
+		{
+			LogArgType type;
+			uint32_t length;
+			union
+			{
+				int64_t i;
+				uint64_t u;
+				double f;
+				void const * p;
+				char const * s;
+			};
+		};
+
+		template< typename T, typename Enable = void >
+		struct LogArgMaker;
+
+		template< typename T >
+		inline LogArg makeLogArg( T const & value );
+		/**
+		*\brief
+		*	Sérialise un message dans le tampon du thread courant.
+		*\return
+		*	\p false si le tampon est plein et que le message n'a pas pu être écrit.
+		*/
+		bool writeLogRecord( LogFormat const & format
+			, LogArg const * args
+			, size_t count );
+		/**
+		*\return
+		*	La sévérité minimale choisie à l'exécution.
+		*/
+		inline std::atomic< LogLevel > & getRuntimeLogLevel();
+	}
+
 	class Logger
 	{
 	public:
+		/**
+		*\~english
+		*\remarks
+		*	The callbacks are invoked in the messages order, without holding any logger lock,
+		*	so they can log or change the callbacks.
+		*\~french
+		*\remarks
+		*	Les callbacks sont appelés dans l'ordre des messages, sans garder de verrou du logger,
+		*	ils peuvent donc logger ou changer les callbacks.
+		*/
 		using LogCallback = std::function< void( std::string const & msg, bool newLine ) >;
 
 	public:
 		/**
 		*\~english
 		*\brief
+		*	Logs a message, using a deferred format.
+		*\remarks
+		*	Doesn't allocate nor lock: the arguments are copied to the calling thread's ring buffer,
+		*	and the message is formatted and written later, by the flusher thread.
+		*	Debug and info messages are dropped when the buffer is full.
+		*	Error messages are flushed immediately.
+		*\param[in] format
+		*	The message format.
+		*\param[in] params
+		*	The message arguments: integers, enums, floats, pointers, or strings.
+		*\~french
+		*\brief
+		*	Logge un message, en utilisant un format différé.
+		*\remarks
+		*	N'alloue pas et ne verrouille pas : les arguments sont copiés dans le tampon circulaire du thread appelant,
+		*	et le message est formaté et écrit plus tard, par le thread de vidage.
+		*	Les messages de débogage et d'information sont abandonnés lorsque le tampon est plein.
+		*	Les messages d'erreur sont vidés immédiatement.
+		*\param[in] format
+		*	Le format du message.
+		*\param[in] params
+		*	Les arguments du message : entiers, énumérations, flottants, pointeurs, ou chaînes.
+		*/
+		template< typename ... ParamsT >
+		static inline void log( LogFormat const & format
+			, ParamsT const & ... params );
+		/**
+		*\~english
+		*\return
+		*	\p true if the messages of given severity are logged.
+		*\~french
+		*\return
+		*	\p true si les messages de la sévérité donnée sont loggés.
+		*/
+		static inline bool isEnabled( LogLevel level );
+		/**
+		*\~english
+		*\brief
+		*	Sets the minimal severity of logged messages.
+		*\~french
+		*\brief
+		*	Définit la sévérité minimale des messages loggés.
+		*/
+		static void setLevel( LogLevel level );
+		/**
+		*\~english
+		*\brief
+		*	Waits for all the messages logged before this call to be written.
+		*\~french
+		*\brief
+		*	Attend que tous les messages loggés avant cet appel soient écrits.
+		*/
+		static void flush();
+		/**
+		*\~english
+		*\brief
+		*	Writes the logged messages, in binary form, to given file.
+		*\remarks
+		*	The messages are still sent to the callbacks.
+		*	The file is read back by decodeDump.
+		*\param[in] path
+		*	The file path, an empty path stops the dump.
+		*\return
+		*	\p false if the file couldn't be opened.
+		*\~french
+		*\brief
+		*	Ecrit les messages loggés, sous forme binaire, dans le fichier donné.
+		*\remarks
+		*	Les messages sont toujours envoyés aux callbacks.
+		*	Le fichier est relu par decodeDump.
+		*\param[in] path
+		*	Le chemin du fichier, un chemin vide arrête le dump.
+		*\return
+		*	\p false si le fichier n'a pas pu être ouvert.
+		*/
+		static bool setDumpFile( std::string const & path );
+		/**
+		*\~english
+		*\brief
+		*	Decodes a binary dump, writing one line per message.
+		*\return
+		*	\p false if the dump is invalid or truncated.
+		*\~french
+		*\brief
+		*	Décode un dump binaire, en écrivant une ligne par message.
+		*\return
+		*	\p false si le dump est invalide ou tronqué.
+		*/
+		static bool decodeDump( std::istream & input
+			, std::ostream & output );
+		/**
+		*\~english
+		*\brief
 		*	Logs a debug message.
 		*\~french
 		*\brief
@@ -125,16 +374,28 @@ namespace renderer
 		static void setErrorCallback( LogCallback callback );
 
 	private:
+		class Worker;
+		friend bool details::writeLogRecord( LogFormat const & format
+			, details::LogArg const * args
+			, size_t count );
+
 		Logger();
+		~Logger();
 
 		static Logger & doGetInstance();
+		static void doLogString( LogLevel level
+			, std::string const & message
+			, bool newLine );
 
 	private:
 		LogCallback m_debug;
 		LogCallback m_info;
 		LogCallback m_warning;
 		LogCallback m_error;
+		std::unique_ptr< Worker > m_worker;
 	};
 }
 
+#include "Log.inl"
+
 #endif
@@ -0,0 +1,151 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+namespace renderer
+{
+	namespace details
+	{
+		template< typename T >
+		struct LogArgMaker< T, typename std::enable_if< std::is_enum< T >::value >::type >
+		{
+			static inline LogArg make( T value )
+			{
+				return makeLogArg( typename std::underlying_type< T >::type( value ) );
+			}
+		};
+
+		template< typename T >
+		struct LogArgMaker< T, typename std::enable_if< std::is_integral< T >::value && std::is_signed< T >::value >::type >
+		{
+			static inline LogArg make( T value )
+			{
+				LogArg result{ LogArgType::eInt, 0u, {} };
+				result.i = int64_t( value );
+				return result;
+			}
+		};
+
+		template< typename T >
+		struct LogArgMaker< T, typename std::enable_if< std::is_integral< T >::value && !std::is_signed< T >::value >::type >
+		{
+			static inline LogArg make( T value )
+			{
+				LogArg result{ LogArgType::eUInt, 0u, {} };
+				result.u = uint64_t( value );
+				return result;
+			}
+		};
+
+		template< typename T >
+		struct LogArgMaker< T, typename std::enable_if< std::is_floating_point< T >::value >::type >
+		{
+			static inline LogArg make( T value )
+			{
+				LogArg result{ LogArgType::eFloat, 0u, {} };
+				result.f = double( value );
+				return result;
+			}
+		};
+
+		template< typename T >
+		struct LogArgMaker< T *, typename std::enable_if< !std::is_same< typename std::remove_cv< T >::type, char >::value && !std::is_function< T >::value >::type >
+		{
+			static inline LogArg make( T * value )
+			{
+				LogArg result{ LogArgType::ePointer, 0u, {} };
+				result.p = value;
+				return result;
+			}
+		};
+
+		template< typename T >
+		struct LogArgMaker< T *, typename std::enable_if< std::is_function< T >::value >::type >
+		{
+			static inline LogArg make( T * value )
+			{
+				LogArg result{ LogArgType::ePointer, 0u, {} };
+				result.p = reinterpret_cast< void const * >( value );
+				return result;
+			}
+		};
+
+		template<>
+		struct LogArgMaker< std::nullptr_t >
+		{
+			static inline LogArg make( std::nullptr_t )
+			{
+				LogArg result{ LogArgType::ePointer, 0u, {} };
+				result.p = nullptr;
+				return result;
+			}
+		};
+
+		template<>
+		struct LogArgMaker< char const * >
+		{
+			static inline LogArg make( char const * value )
+			{
+				LogArg result{ LogArgType::eString, 0u, {} };
+				result.s = value
+					? value
+					: "nullptr";
+				result.length = uint32_t( std::char_traits< char >::length( result.s ) );
+				return result;
+			}
+		};
+
+		template<>
+		struct LogArgMaker< char * >
+			: LogArgMaker< char const * >
+		{
+		};
+
+		template< size_t N >
+		struct LogArgMaker< char[N] >
+			: LogArgMaker< char const * >
+		{
+		};
+
+		template<>
+		struct LogArgMaker< std::string >
+		{
+			static inline LogArg make( std::string const & value )
+			{
+				LogArg result{ LogArgType::eString, uint32_t( value.size() ), {} };
+				result.s = value.data();
+				return result;
+			}
+		};
+
+		template< typename T >
+		inline LogArg makeLogArg( T const & value )
+		{
+			return LogArgMaker< T >::make( value );
+		}
+
+		inline std::atomic< LogLevel > & getRuntimeLogLevel()
+		{
+			static std::atomic< LogLevel > level{ LogLevel::eDebug };
+			return level;
+		}
+	}
+
+	template< typename ... ParamsT >
+	inline void Logger::log( LogFormat const & format
+		, ParamsT const & ... params )
+	{
+		if ( isEnabled( format.level ) )
+		{
+			// One more element, for calls without argument.
+			details::LogArg const args[]{ details::makeLogArg( params )..., details::LogArg{} };
+			details::writeLogRecord( format, args, sizeof...( ParamsT ) );
+		}
+	}
+
+	inline bool Logger::isEnabled( LogLevel level )
+	{
+		return level >= LogLevel( RENDERLIB_LOG_LEVEL )
+			&& level >= details::getRuntimeLogLevel().load( std::memory_order_relaxed );
+	}
+}
@@ -26,6 +26,10 @@ namespace renderer
 		bool hasClearTexImage;
 		bool hasComputeShaders;
 		bool hasStorageBuffers;
+		bool hasBindlessTexture;
+		bool hasMultiBind;
+		bool hasPushConstantsBuffer;
+		bool hasPersistentMapping;
 	};
 }
 
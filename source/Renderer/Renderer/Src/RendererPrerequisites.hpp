@@ -10,7 +10,11 @@ See LICENSE file in root folder.
 #include <cassert>
 #include <cstdint>
 #include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -209,8 +213,10 @@ namespace renderer
 	class Connection;
 	class DescriptorPool;
 	class DescriptorSet;
+	class DescriptorSetAllocator;
 	class DescriptorSetLayout;
 	class DescriptorSetLayoutBinding;
+	class DescriptorSetLayoutCache;
 	class DescriptorSetPool;
 	class Device;
 	class DeviceMemory;
@@ -283,8 +289,10 @@ namespace renderer
 	using ComputePipelinePtr = std::unique_ptr< ComputePipeline >;
 	using ConnectionPtr = std::unique_ptr< Connection >;
 	using DescriptorPoolPtr = std::unique_ptr< DescriptorPool >;
+	using DescriptorSetAllocatorPtr = std::unique_ptr< DescriptorSetAllocator >;
 	using DescriptorSetLayoutPtr = std::unique_ptr< DescriptorSetLayout >;
 	using DescriptorSetLayoutBindingPtr = std::unique_ptr< DescriptorSetLayoutBinding >;
+	using DescriptorSetLayoutCachePtr = std::unique_ptr< DescriptorSetLayoutCache >;
 	using DescriptorSetPoolPtr = std::unique_ptr< DescriptorSetPool >;
 	using DescriptorSetPtr = std::unique_ptr< DescriptorSet >;
 	using FencePtr = std::unique_ptr< Fence >;
@@ -330,6 +338,7 @@ namespace renderer
 	using ImageLayoutArray = std::vector< ImageLayout >;
 	using PipelineStageFlagsArray = std::vector< PipelineStageFlags >;
 	using PushConstantArray = std::vector< PushConstant >;
+	using PushConstantRangeArray = std::vector< PushConstantRange >;
 	using RenderSubpassArray = std::vector< RenderSubpass >;
 	using ShaderStageStateArray = std::vector< ShaderStageState >;
 	using SpecialisationMapEntryArray = std::vector< SpecialisationMapEntry >;
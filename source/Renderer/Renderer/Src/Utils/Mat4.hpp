@@ -226,9 +226,20 @@ namespace renderer
 	*/
 	template< typename T >
 	inline Mat4T< T > inverse( Mat4T< T > const & matrix );
+	/**
+	*\~english
+	*\brief
+	*	Return the transpose of a matrix.
+	*\~french
+	*\brief
+	*	Retourne la transposée d'une matrice.
+	*/
+	template< typename T >
+	inline Mat4T< T > transpose( Mat4T< T > const & matrix );
 	/**\}*/
 }
 
 #include "Mat4.inl"
+#include "Mat4Simd.inl"
 
 #endif
@@ -321,4 +321,13 @@ namespace renderer
 
 		return inverted * oneOverDeterminant;
 	}
+
+	template< typename T >
+	inline Mat4T< T > transpose( Mat4T< T > const & m )
+	{
+		return Mat4T< T >{ Vec4T< T >{ m[0][0], m[1][0], m[2][0], m[3][0] }
+			, Vec4T< T >{ m[0][1], m[1][1], m[2][1], m[3][1] }
+			, Vec4T< T >{ m[0][2], m[1][2], m[2][2], m[3][2] }
+			, Vec4T< T >{ m[0][3], m[1][3], m[2][3], m[3][3] } };
+	}
 }
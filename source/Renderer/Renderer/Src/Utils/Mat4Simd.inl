@@ -0,0 +1,259 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+/*
+*\~english
+*\brief
+*	SSE2 and AVX implementations of the Mat4T< float > hot operations.
+*\remarks
+*	The instruction set is selected at compile time, from the compiler's target macros:
+*	AVX when __AVX__ is defined (-mavx, /arch:AVX), SSE2 on x86-64 and on x86 with SSE2 enabled.
+*	The generic scalar implementations in Mat4.inl are used on other architectures,
+*	or when RENDERLIB_NO_SIMD is defined.
+*	The operations are performed in the same order as the scalar ones, without fused multiply-add,
+*	so their results are identical, as long as the compiler doesn't contract the scalar code.
+*\~french
+*\brief
+*	Implémentations SSE2 et AVX des opérations critiques de Mat4T< float >.
+*\remarks
+*	Le jeu d'instructions est sélectionné à la compilation, depuis les macros de cible du compilateur :
+*	AVX quand __AVX__ est défini (-mavx, /arch:AVX), SSE2 en x86-64 et en x86 avec SSE2 activé.
+*	Les implémentations scalaires génériques de Mat4.inl sont utilisées sur les autres architectures,
+*	ou quand RENDERLIB_NO_SIMD est défini.
+*	Les opérations sont effectuées dans le même ordre que les opérations scalaires, sans multiply-add fusionné,
+*	leurs résultats sont donc identiques, tant que le compilateur ne contracte pas le code scalaire.
+*/
+#if !defined( RENDERLIB_NO_SIMD )
+#	if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#		define RENDERLIB_SIMD_SSE2 1
+#		include <emmintrin.h>
+#	endif
+#	if defined( RENDERLIB_SIMD_SSE2 ) && defined( __AVX__ )
+#		define RENDERLIB_SIMD_AVX 1
+#		include <cstddef>
+#		include <immintrin.h>
+#	endif
+#endif
+
+#if defined( RENDERLIB_SIMD_SSE2 )
+
+namespace renderer
+{
+	namespace simd
+	{
+		inline __m128 load( Vec4T< float > const & value )noexcept
+		{
+			return _mm_loadu_ps( &value[0] );
+		}
+
+		inline void store( Vec4T< float > & result
+			, __m128 value )noexcept
+		{
+			_mm_storeu_ps( &result[0], value );
+		}
+
+		template< int Index >
+		inline __m128 splat( __m128 value )noexcept
+		{
+			return _mm_shuffle_ps( value, value, _MM_SHUFFLE( Index, Index, Index, Index ) );
+		}
+
+		inline __m128 transform( __m128 const ( & lhs )[4]
+			, __m128 rhs )noexcept
+		{
+			__m128 result = _mm_add_ps( _mm_mul_ps( lhs[0], splat< 0 >( rhs ) )
+				, _mm_mul_ps( lhs[1], splat< 1 >( rhs ) ) );
+			result = _mm_add_ps( result, _mm_mul_ps( lhs[2], splat< 2 >( rhs ) ) );
+			return _mm_add_ps( result, _mm_mul_ps( lhs[3], splat< 3 >( rhs ) ) );
+		}
+
+		inline __m128 transformPairwise( __m128 const ( & lhs )[4]
+			, __m128 rhs )noexcept
+		{
+			__m128 const add0 = _mm_add_ps( _mm_mul_ps( lhs[0], splat< 0 >( rhs ) )
+				, _mm_mul_ps( lhs[1], splat< 1 >( rhs ) ) );
+			__m128 const add1 = _mm_add_ps( _mm_mul_ps( lhs[2], splat< 2 >( rhs ) )
+				, _mm_mul_ps( lhs[3], splat< 3 >( rhs ) ) );
+			return _mm_add_ps( add0, add1 );
+		}
+		/**
+		*\brief
+		*	( m[2][Row], m[2][Row], m[1][Row], m[1][Row] ).
+		*/
+		template< int Row >
+		inline __m128 getCofactorsLhs( __m128 const ( & m )[4] )noexcept
+		{
+			return _mm_shuffle_ps( m[2], m[1], _MM_SHUFFLE( Row, Row, Row, Row ) );
+		}
+		/**
+		*\brief
+		*	( m[3][Row], m[3][Row], m[3][Row], m[2][Row] ).
+		*/
+		template< int Row >
+		inline __m128 getCofactorsRhs( __m128 const ( & m )[4] )noexcept
+		{
+			__m128 const tmp = _mm_shuffle_ps( m[3], m[2], _MM_SHUFFLE( Row, Row, Row, Row ) );
+			return _mm_shuffle_ps( tmp, tmp, _MM_SHUFFLE( 2, 0, 0, 0 ) );
+		}
+		/**
+		*\brief
+		*	Computes one of the fac vectors of the scalar inverse().
+		*/
+		template< int RowA, int RowB >
+		inline __m128 getFactors( __m128 const ( & m )[4] )noexcept
+		{
+			return _mm_sub_ps( _mm_mul_ps( getCofactorsLhs< RowA >( m ), getCofactorsRhs< RowB >( m ) )
+				, _mm_mul_ps( getCofactorsRhs< RowA >( m ), getCofactorsLhs< RowB >( m ) ) );
+		}
+		/**
+		*\brief
+		*	( m[1][Row], m[0][Row], m[0][Row], m[0][Row] ).
+		*/
+		template< int Row >
+		inline __m128 getVector( __m128 const ( & m )[4] )noexcept
+		{
+			__m128 const tmp = _mm_shuffle_ps( m[1], m[0], _MM_SHUFFLE( Row, Row, Row, Row ) );
+			return _mm_shuffle_ps( tmp, tmp, _MM_SHUFFLE( 2, 2, 2, 0 ) );
+		}
+
+		inline __m128 getInverseColumn( __m128 vecA
+			, __m128 facA
+			, __m128 vecB
+			, __m128 facB
+			, __m128 vecC
+			, __m128 facC )noexcept
+		{
+			return _mm_add_ps( _mm_sub_ps( _mm_mul_ps( vecA, facA ), _mm_mul_ps( vecB, facB ) )
+				, _mm_mul_ps( vecC, facC ) );
+		}
+	}
+
+	template<>
+	template<>
+	inline Mat4T< float > & Mat4T< float >::operator*=< float >( Mat4T< float > const & rhs )noexcept
+	{
+#if defined( RENDERLIB_SIMD_AVX )
+		// Each 256 bits register holds two columns, so two result columns are computed at once,
+		// the columns pairs must therefore be contiguous, without padding.
+		static_assert( sizeof( Vec4T< float > ) == 4u * sizeof( float )
+				&& offsetof( Mat4T< float >, col1 ) == offsetof( Mat4T< float >, col0 ) + sizeof( Vec4T< float > )
+				&& offsetof( Mat4T< float >, col3 ) == offsetof( Mat4T< float >, col2 ) + sizeof( Vec4T< float > )
+			, "The AVX multiplication reads and writes two columns at once" );
+		__m256 const srcA[4]
+		{
+			_mm256_broadcast_ps( reinterpret_cast< __m128 const * >( &col0[0] ) ),
+			_mm256_broadcast_ps( reinterpret_cast< __m128 const * >( &col1[0] ) ),
+			_mm256_broadcast_ps( reinterpret_cast< __m128 const * >( &col2[0] ) ),
+			_mm256_broadcast_ps( reinterpret_cast< __m128 const * >( &col3[0] ) ),
+		};
+		__m256 const srcB01 = _mm256_loadu_ps( &rhs[0][0] );
+		__m256 const srcB23 = _mm256_loadu_ps( &rhs[2][0] );
+		auto mul = [&srcA]( __m256 srcB )
+		{
+			__m256 result = _mm256_add_ps( _mm256_mul_ps( srcA[0], _mm256_shuffle_ps( srcB, srcB, _MM_SHUFFLE( 0, 0, 0, 0 ) ) )
+				, _mm256_mul_ps( srcA[1], _mm256_shuffle_ps( srcB, srcB, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+			result = _mm256_add_ps( result, _mm256_mul_ps( srcA[2], _mm256_shuffle_ps( srcB, srcB, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+			return _mm256_add_ps( result, _mm256_mul_ps( srcA[3], _mm256_shuffle_ps( srcB, srcB, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+		};
+		__m256 const dst01 = mul( srcB01 );
+		__m256 const dst23 = mul( srcB23 );
+		_mm256_storeu_ps( &col0[0], dst01 );
+		_mm256_storeu_ps( &col2[0], dst23 );
+#else
+		__m128 const srcA[4]
+		{
+			simd::load( col0 ),
+			simd::load( col1 ),
+			simd::load( col2 ),
+			simd::load( col3 ),
+		};
+		__m128 const dst0 = simd::transform( srcA, simd::load( rhs[0] ) );
+		__m128 const dst1 = simd::transform( srcA, simd::load( rhs[1] ) );
+		__m128 const dst2 = simd::transform( srcA, simd::load( rhs[2] ) );
+		__m128 const dst3 = simd::transform( srcA, simd::load( rhs[3] ) );
+		simd::store( col0, dst0 );
+		simd::store( col1, dst1 );
+		simd::store( col2, dst2 );
+		simd::store( col3, dst3 );
+#endif
+		return *this;
+	}
+
+	inline Vec4T< float > operator*( Mat4T< float > const & lhs
+		, Vec4T< float > const & rhs )noexcept
+	{
+		__m128 const m[4]
+		{
+			simd::load( lhs[0] ),
+			simd::load( lhs[1] ),
+			simd::load( lhs[2] ),
+			simd::load( lhs[3] ),
+		};
+		Vec4T< float > result{ noInit };
+		simd::store( result, simd::transformPairwise( m, simd::load( rhs ) ) );
+		return result;
+	}
+
+	inline Mat4T< float > inverse( Mat4T< float > const & matrix )
+	{
+		__m128 const m[4]
+		{
+			simd::load( matrix[0] ),
+			simd::load( matrix[1] ),
+			simd::load( matrix[2] ),
+			simd::load( matrix[3] ),
+		};
+
+		__m128 const fac0 = simd::getFactors< 2, 3 >( m );
+		__m128 const fac1 = simd::getFactors< 1, 3 >( m );
+		__m128 const fac2 = simd::getFactors< 1, 2 >( m );
+		__m128 const fac3 = simd::getFactors< 0, 3 >( m );
+		__m128 const fac4 = simd::getFactors< 0, 2 >( m );
+		__m128 const fac5 = simd::getFactors< 0, 1 >( m );
+
+		__m128 const vec0 = simd::getVector< 0 >( m );
+		__m128 const vec1 = simd::getVector< 1 >( m );
+		__m128 const vec2 = simd::getVector< 2 >( m );
+		__m128 const vec3 = simd::getVector< 3 >( m );
+
+		__m128 const signA = _mm_set_ps( -1.0f, 1.0f, -1.0f, 1.0f );
+		__m128 const signB = _mm_set_ps( 1.0f, -1.0f, 1.0f, -1.0f );
+		__m128 const inv0 = _mm_mul_ps( simd::getInverseColumn( vec1, fac0, vec2, fac1, vec3, fac2 ), signA );
+		__m128 const inv1 = _mm_mul_ps( simd::getInverseColumn( vec0, fac0, vec2, fac3, vec3, fac4 ), signB );
+		__m128 const inv2 = _mm_mul_ps( simd::getInverseColumn( vec0, fac1, vec1, fac3, vec3, fac5 ), signA );
+		__m128 const inv3 = _mm_mul_ps( simd::getInverseColumn( vec0, fac2, vec1, fac4, vec2, fac5 ), signB );
+
+		__m128 const row0 = _mm_shuffle_ps( _mm_shuffle_ps( inv0, inv1, _MM_SHUFFLE( 0, 0, 0, 0 ) )
+			, _mm_shuffle_ps( inv2, inv3, _MM_SHUFFLE( 0, 0, 0, 0 ) )
+			, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+		Vec4T< float > dot0{ noInit };
+		simd::store( dot0, _mm_mul_ps( m[0], row0 ) );
+		float const dot1 = ( dot0.x + dot0.y ) + ( dot0.z + dot0.w );
+		__m128 const oneOverDeterminant = _mm_set1_ps( 1.0f / dot1 );
+
+		Mat4T< float > result{ noInit };
+		simd::store( result[0], _mm_mul_ps( inv0, oneOverDeterminant ) );
+		simd::store( result[1], _mm_mul_ps( inv1, oneOverDeterminant ) );
+		simd::store( result[2], _mm_mul_ps( inv2, oneOverDeterminant ) );
+		simd::store( result[3], _mm_mul_ps( inv3, oneOverDeterminant ) );
+		return result;
+	}
+
+	inline Mat4T< float > transpose( Mat4T< float > const & matrix )
+	{
+		__m128 col0 = simd::load( matrix[0] );
+		__m128 col1 = simd::load( matrix[1] );
+		__m128 col2 = simd::load( matrix[2] );
+		__m128 col3 = simd::load( matrix[3] );
+		_MM_TRANSPOSE4_PS( col0, col1, col2, col3 );
+		Mat4T< float > result{ noInit };
+		simd::store( result[0], col0 );
+		simd::store( result[1], col1 );
+		simd::store( result[2], col2 );
+		simd::store( result[3], col3 );
+		return result;
+	}
+}
+
+#endif
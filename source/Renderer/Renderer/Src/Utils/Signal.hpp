@@ -8,13 +8,218 @@ See LICENSE file in root folder
 
 #include "RendererPrerequisites.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
-#include <set>
-#include <map>
-#include <mutex>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 namespace renderer
 {
+	/**
+	*\brief
+	*	Fonction stockée dans un signal.
+	*\remarks
+	*	Les foncteurs d'au plus SizeT octets, déplaçables sans exception, sont stockés en place,
+	*	sans allocation. Les autres sont alloués sur le tas.
+	*	Une fonction réinitialisée, ou dont le contenu a été déplacé, est vide et ne doit plus être appelée.
+	*/
+	template< typename SignatureT, size_t SizeT = 4u * sizeof( void * ) >
+	class SignalSlot;
+
+	template< typename R, typename ... Params, size_t SizeT >
+	class SignalSlot< R( Params... ), SizeT >
+	{
+	private:
+		using Storage = typename std::aligned_storage< SizeT, alignof( std::max_align_t ) >::type;
+
+		struct Operations
+		{
+			R ( *invoke )( Storage &, Params... );
+			void ( *move )( Storage & dst, Storage & src );
+			void ( *destroy )( Storage & );
+		};
+
+		template< typename FuncT >
+		static constexpr bool isInline()
+		{
+			return sizeof( FuncT ) <= SizeT
+				&& alignof( FuncT ) <= alignof( Storage )
+				&& std::is_nothrow_move_constructible< FuncT >::value;
+		}
+
+		template< typename FuncT, bool Inline = isInline< FuncT >() >
+		struct Holder;
+
+		template< typename FuncT >
+		struct Holder< FuncT, true >
+		{
+			static FuncT & get( Storage & storage )
+			{
+				return *reinterpret_cast< FuncT * >( &storage );
+			}
+
+			template< typename SrcT >
+			static void create( Storage & storage, SrcT && function )
+			{
+				new( &storage ) FuncT( std::forward< SrcT >( function ) );
+			}
+
+			static R invoke( Storage & storage, Params ... params )
+			{
+				return get( storage )( params... );
+			}
+
+			static void move( Storage & dst, Storage & src )
+			{
+				new( &dst ) FuncT( std::move( get( src ) ) );
+				get( src ).~FuncT();
+			}
+
+			static void destroy( Storage & storage )
+			{
+				get( storage ).~FuncT();
+			}
+		};
+
+		template< typename FuncT >
+		struct Holder< FuncT, false >
+		{
+			static FuncT *& get( Storage & storage )
+			{
+				return *reinterpret_cast< FuncT ** >( &storage );
+			}
+
+			template< typename SrcT >
+			static void create( Storage & storage, SrcT && function )
+			{
+				new( &storage ) FuncT *( new FuncT( std::forward< SrcT >( function ) ) );
+			}
+
+			static R invoke( Storage & storage, Params ... params )
+			{
+				return ( *get( storage ) )( params... );
+			}
+
+			static void move( Storage & dst, Storage & src )
+			{
+				new( &dst ) FuncT *( get( src ) );
+				get( src ) = nullptr;
+			}
+
+			static void destroy( Storage & storage )
+			{
+				delete get( storage );
+			}
+		};
+
+		template< typename FuncT >
+		static Operations const & getOperations()
+		{
+			static Operations const result
+			{
+				&Holder< FuncT >::invoke,
+				&Holder< FuncT >::move,
+				&Holder< FuncT >::destroy,
+			};
+			return result;
+		}
+
+	public:
+		/**
+		*\brief
+		*	Constructeur.
+		*\param[in] function
+		*	Le foncteur.
+		*/
+		template< typename FuncT >
+		SignalSlot( FuncT && function )
+			: m_operations{ &getOperations< typename std::decay< FuncT >::type >() }
+		{
+			Holder< typename std::decay< FuncT >::type >::create( m_storage, std::forward< FuncT >( function ) );
+		}
+		/**
+		*\brief
+		*	Constructeur par déplacement.
+		*/
+		SignalSlot( SignalSlot && rhs )noexcept
+			: m_operations{ rhs.m_operations }
+		{
+			if ( m_operations )
+			{
+				m_operations->move( m_storage, rhs.m_storage );
+				rhs.m_operations = nullptr;
+			}
+		}
+		/**
+		*\brief
+		*	Opérateur d'affectation par déplacement.
+		*/
+		SignalSlot & operator=( SignalSlot && rhs )noexcept
+		{
+			if ( &rhs != this )
+			{
+				reset();
+				m_operations = rhs.m_operations;
+
+				if ( m_operations )
+				{
+					m_operations->move( m_storage, rhs.m_storage );
+					rhs.m_operations = nullptr;
+				}
+			}
+
+			return *this;
+		}
+		SignalSlot( SignalSlot const & ) = delete;
+		SignalSlot & operator=( SignalSlot const & ) = delete;
+		/**
+		*\brief
+		*	Destructeur.
+		*/
+		~SignalSlot()
+		{
+			reset();
+		}
+		/**
+		*\brief
+		*	Détruit le foncteur, la fonction est alors vide.
+		*/
+		void reset()
+		{
+			if ( m_operations )
+			{
+				m_operations->destroy( m_storage );
+				m_operations = nullptr;
+			}
+		}
+		/**
+		*\brief
+		*	Appelle le foncteur.
+		*/
+		R operator()( Params ... params )const
+		{
+			return m_operations->invoke( m_storage, params... );
+		}
+
+	private:
+		mutable Storage m_storage;
+		Operations const * m_operations;
+	};
+
+	namespace details
+	{
+		template< typename FunctionT >
+		struct SignalSignature;
+
+		template< typename R, typename ... Params >
+		struct SignalSignature< std::function< R( Params... ) > >
+		{
+			using Type = R( Params... );
+		};
+	}
 	/**
 	*\brief
 	*	Représente une connexion à un signal.
@@ -23,6 +228,7 @@ namespace renderer
 	class SignalConnection
 	{
 	private:
+		friend SignalT;
 		using my_signal = SignalT;
 		using my_signal_ptr = my_signal *;
 		SignalConnection( SignalConnection< my_signal > const & ) = delete;
@@ -50,8 +256,11 @@ namespace renderer
 		{
 			rhs.m_signal = nullptr;
 			rhs.m_connection = 0u;
-			m_signal->remConnection( rhs );
-			m_signal->addConnection( *this );
+
+			if ( m_signal )
+			{
+				m_signal->setConnection( m_connection, this );
+			}
 		}
 		/**
 		*\brief
@@ -61,10 +270,20 @@ namespace renderer
 		*/
 		SignalConnection & operator=( SignalConnection< my_signal > && rhs )
 		{
-			SignalConnection tmp{ std::move( rhs ) };
-			swap( *this, tmp );
-			m_signal->remConnection( tmp );
-			m_signal->addConnection( *this );
+			if ( &rhs != this )
+			{
+				disconnect();
+				m_connection = rhs.m_connection;
+				m_signal = rhs.m_signal;
+				rhs.m_signal = nullptr;
+				rhs.m_connection = 0u;
+
+				if ( m_signal )
+				{
+					m_signal->setConnection( m_connection, this );
+				}
+			}
+
 			return *this;
 		}
 		/**
@@ -79,7 +298,7 @@ namespace renderer
 			: m_connection{ connection }
 			, m_signal{ &signal }
 		{
-			signal.addConnection( *this );
+			signal.setConnection( m_connection, this );
 		}
 		/**
 		*\brief
@@ -100,7 +319,6 @@ namespace renderer
 			if ( m_signal && m_connection )
 			{
 				m_signal->disconnect( m_connection );
-				m_signal->remConnection( *this );
 				m_signal = nullptr;
 				m_connection = 0u;
 			}
@@ -109,15 +327,12 @@ namespace renderer
 	private:
 		/**
 		*\brief
-		*	Echange deux connections.
+		*	Détache la connexion d'un signal en cours de destruction.
 		*/
-		void swap( SignalConnection & lhs, SignalConnection & rhs )
+		void detach()
 		{
-			if ( &rhs != &lhs )
-			{
-				std::swap( lhs.m_signal, rhs.m_signal );
-				std::swap( lhs.m_connection, rhs.m_connection );
-			}
+			m_signal = nullptr;
+			m_connection = 0u;
 		}
 
 	private:
@@ -129,6 +344,17 @@ namespace renderer
 	/**
 	*\brief
 	*	Classe basique de signal.
+	*\remarks
+	*	Les fonctions connectées sont stockées de manière contiguë, sans allocation pour les petits foncteurs,
+	*	et sont appelées par référence, sans copie ni verrou.
+	*	Les fonctions déconnectées sont seulement marquées, et retirées lorsqu'elles sont plus nombreuses
+	*	que les fonctions connectées, ou à la fin d'une émission : la déconnexion ne décale donc pas
+	*	les fonctions suivantes à chaque fois.
+	*	Une fonction peut connecter ou déconnecter des fonctions pendant l'émission : les connexions
+	*	sont mises en attente, puis ajoutées à la fin de l'émission.
+	*	Le signal n'a aucun verrou : il doit être connecté, déconnecté, émis et détruit depuis un seul thread
+	*	à la fois, c'est à l'utilisateur de synchroniser les accès lorsqu'il est partagé entre threads.
+	*	Cela vaut aussi pour les SignalConnection, dont la destruction modifie le signal.
 	*/
 	template< typename Function >
 	class Signal
@@ -136,27 +362,40 @@ namespace renderer
 		friend class SignalConnection< Signal< Function > >;
 		using my_connection = SignalConnection< Signal< Function > >;
 		using my_connection_ptr = my_connection *;
+		using my_slot = SignalSlot< typename details::SignalSignature< Function >::Type >;
+
+		struct Slot
+		{
+			//! L'identifiant de la connexion, jamais modifié, pour garder m_slots trié.
+			uint32_t id;
+			my_connection_ptr connection;
+			my_slot function;
+			//! Dit si la fonction a été déconnectée.
+			bool dead{ false };
+		};
+		using SlotArray = std::vector< Slot >;
 
 	public:
+		Signal() = default;
+		Signal( Signal const & ) = delete;
+		Signal & operator=( Signal const & ) = delete;
 		/**
 		*\brief
 		*	Destructeur.
 		*\remarks
-		*	Déconnecte toutes les connexions restantes.
+		*	Détache toutes les connexions restantes.
 		*/
 		~Signal()
 		{
-			// SignalConnection::disconnect appelle Signal::remConnection, qui
-			// supprime la connection de m_connections, invalidant ainsi
-			// l'itérateur, donc on ne peut pas utiliser un for_each, ni
-			// un range for loop.
-			std::unique_lock< std::recursive_mutex > lock( m_mutex );
-			auto it = m_connections.begin();
-
-			while ( it != m_connections.end() )
+			for ( auto slots : { &m_slots, &m_pending } )
 			{
-				( *it )->disconnect();
-				it = m_connections.begin();
+				for ( auto & slot : *slots )
+				{
+					if ( slot.connection )
+					{
+						slot.connection->detach();
+					}
+				}
 			}
 		}
 		/**
@@ -166,24 +405,17 @@ namespace renderer
 		*\param[in] function
 		*	La fonction.
 		*\return
-		*	L'indice de la fonction, afin de pouvoir la déconnecter.
-		*/
-		my_connection connect( Function function )
-		{
-			uint32_t index = uint32_t( m_slots.size() ) + 1u;
-			m_slots.emplace( index, function );
-			return my_connection{ index, *this };
-		}
-		/**
-		*\brief
-		*	Emet le signal, appelant toutes les fonctions connectées.
+		*	La connexion, qui déconnecte la fonction lors de sa destruction.
 		*/
-		void operator()()const
+		template< typename FuncT >
+		my_connection connect( FuncT && function )
 		{
-			for ( auto it : m_slots )
-			{
-				it.second();
-			}
+			uint32_t id = ++m_lastId;
+			auto & slots = m_emitting
+				? m_pending
+				: m_slots;
+			slots.push_back( Slot{ id, nullptr, my_slot{ std::forward< FuncT >( function ) }, false } );
+			return my_connection{ id, *this };
 		}
 		/**
 		*\brief
@@ -194,58 +426,143 @@ namespace renderer
 		template< typename ... Params >
 		void operator()( Params && ... params )const
 		{
-			for ( auto it : m_slots )
+			++m_emitting;
+			// Les connexions faites pendant l'émission vont dans m_pending,
+			// m_slots ne peut donc pas être réalloué pendant le parcours.
+			size_t const count = m_slots.size();
+
+			for ( size_t index = 0u; index < count; ++index )
 			{
-				it.second( std::forward< Params >( params )... );
+				auto & slot = m_slots[index];
+
+				if ( !slot.dead )
+				{
+					slot.function( params... );
+				}
+			}
+
+			if ( !--m_emitting )
+			{
+				doFlush();
 			}
 		}
 
 	private:
-		/**
-		*\brief
-		*	Déconnecte une fonction.
-		*\param[in] index
-		*	L'indice de la fonction.
-		*/
-		void disconnect( uint32_t index )
+		Slot * doFind( SlotArray & slots, uint32_t id )
+		{
+			// La fonction recherchée est souvent la dernière connectée.
+			if ( !slots.empty() && slots.back().id == id )
+			{
+				return slots.back().dead
+					? nullptr
+					: &slots.back();
+			}
+
+			// Les identifiants sont croissants, et l'ordre est conservé.
+			auto it = std::lower_bound( slots.begin()
+				, slots.end()
+				, id
+				, []( Slot const & slot, uint32_t lookup )
+				{
+					return slot.id < lookup;
+				} );
+			return ( it != slots.end() && it->id == id && !it->dead )
+				? &( *it )
+				: nullptr;
+		}
+
+		Slot * doFind( uint32_t id )
+		{
+			auto result = doFind( m_slots, id );
+			return result
+				? result
+				: doFind( m_pending, id );
+		}
+
+		void doCompact()const
 		{
-			auto it = m_slots.find( index );
+			m_slots.erase( std::remove_if( m_slots.begin()
+					, m_slots.end()
+					, []( Slot const & slot )
+					{
+						return slot.dead;
+					} )
+				, m_slots.end() );
+			m_deadCount = 0u;
+		}
 
-			if ( it != m_slots.end() )
+		void doFlush()const
+		{
+			if ( m_deadCount )
 			{
-				m_slots.erase( it );
+				doCompact();
+			}
+
+			if ( !m_pending.empty() )
+			{
+				std::move( m_pending.begin(), m_pending.end(), std::back_inserter( m_slots ) );
+				m_pending.clear();
 			}
 		}
 		/**
 		*\brief
-		*	Ajoute une connexion à la liste.
-		*\param[in] connection
-		*	La connexion à ajouter.
+		*	Déconnecte une fonction.
+		*\param[in] id
+		*	L'identifiant de la fonction.
 		*/
-		void addConnection( my_connection & connection )
+		void disconnect( uint32_t id )
 		{
-			std::unique_lock< std::recursive_mutex > lock( m_mutex );
-			m_connections.insert( &connection );
+			// Les fonctions déconnectées de m_slots sont seulement marquées, leur identifiant
+			// est conservé pour que les recherches suivantes restent valides.
+			if ( auto slot = doFind( m_slots, id ) )
+			{
+				slot->dead = true;
+				slot->connection = nullptr;
+				++m_deadCount;
+
+				// Pendant l'émission, la fonction peut être celle en cours d'appel,
+				// elle est détruite lors du retrait.
+				if ( !m_emitting )
+				{
+					slot->function.reset();
+
+					if ( m_deadCount * 2u > m_slots.size() )
+					{
+						doCompact();
+					}
+				}
+			}
+			else if ( auto slot = doFind( m_pending, id ) )
+			{
+				m_pending.erase( m_pending.begin() + std::distance( m_pending.data(), slot ) );
+			}
 		}
 		/**
 		*\brief
-		*	Enlève une connexion de la liste.
+		*	Définit la connexion associée à une fonction.
+		*\param[in] id
+		*	L'identifiant de la fonction.
 		*\param[in] connection
-		*	La connexion à enlever.
+		*	La connexion.
 		*/
-		void remConnection( my_connection & connection )
+		void setConnection( uint32_t id, my_connection_ptr connection )
 		{
-			std::unique_lock< std::recursive_mutex > lock( m_mutex );
-			assert( m_connections.find( &connection ) != m_connections.end() );
-			m_connections.erase( &connection );
+			auto slot = doFind( id );
+			assert( slot );
+			slot->connection = connection;
 		}
 
 	private:
-		//! La liste des fonctions connectées.
-		std::map< uint32_t, Function > m_slots;
-		//! Lq liste des connections à ce signal.
-		std::set< my_connection_ptr > m_connections;
-		std::recursive_mutex m_mutex;
+		//! La liste des fonctions connectées, triée par identifiant.
+		mutable SlotArray m_slots;
+		//! Les fonctions connectées pendant une émission.
+		mutable SlotArray m_pending;
+		//! Le dernier identifiant attribué.
+		uint32_t m_lastId{ 0u };
+		//! Le niveau d'imbrication des émissions en cours.
+		mutable uint32_t m_emitting{ 0u };
+		//! Le nombre de fonctions déconnectées restant dans m_slots.
+		mutable size_t m_deadCount{ 0u };
 	};
 }
 
@@ -100,7 +100,7 @@ namespace vk_renderer
 			throw std::runtime_error{ "LogicalDevice creation failed: " + getLastError() };
 		}
 
-#define VK_LIB_DEVICE_FUNCTION( fun ) fun = reinterpret_cast< PFN_##fun >( renderer.vkGetDeviceProcAddr( m_device, #fun ) );
+#define VK_LIB_DEVICE_FUNCTION( fun ) fun.initialise( m_callCounters, #fun, reinterpret_cast< PFN_##fun >( renderer.vkGetDeviceProcAddr( m_device, #fun ) ) );
 #include "Miscellaneous/VulkanFunctionsList.inl"
 
 		m_presentQueue = std::make_unique< Queue >( *this, m_connection->getPresentQueueFamilyIndex() );
@@ -292,6 +292,11 @@ namespace vk_renderer
 		vkDeviceWaitIdle( m_device );
 	}
 
+	renderer::CallStatistics Device::getCallStatistics( bool reset )const
+	{
+		return m_callCounters.getStatistics( reset );
+	}
+
 	renderer::MemoryRequirements Device::getBufferMemoryRequirements( VkBuffer buffer )const
 	{
 		VkMemoryRequirements requirements;
@@ -123,6 +123,22 @@ namespace vk_renderer
 		*/
 		void waitIdle()const override;
 		/**
+		*\copydoc	renderer::Device::getCallStatistics
+		*/
+		renderer::CallStatistics getCallStatistics( bool reset )const override;
+		/**
+		*\~french
+		*\brief
+		*	Compte des octets envoyés au périphérique.
+		*\~english
+		*\brief
+		*	Counts bytes uploaded to the device.
+		*/
+		inline void addUploadedBytes( uint64_t size )const
+		{
+			m_callCounters.addUploadedBytes( size );
+		}
+		/**
 		*\~french
 		*\brief
 		*	Récupère les propriétés mémoire requises pour le tampon donné.
@@ -213,7 +229,7 @@ namespace vk_renderer
 			return m_device;
 		}
 
-#define VK_LIB_DEVICE_FUNCTION( fun ) PFN_##fun fun;
+#define VK_LIB_DEVICE_FUNCTION( fun ) renderer::CountedFunction< PFN_##fun > fun;
 #	include "Miscellaneous/VulkanFunctionsList.inl"
 
 	private:
@@ -235,5 +251,6 @@ namespace vk_renderer
 		PhysicalDevice const & m_gpu;
 		ConnectionPtr m_connection;
 		VkDevice m_device{ VK_NULL_HANDLE };
+		mutable renderer::CallCounters m_callCounters;
 	};
 }
@@ -137,6 +137,10 @@ namespace vk_renderer
 		m_features.hasClearTexImage = true;
 		m_features.hasComputeShaders = true;
 		m_features.hasStorageBuffers = true;
+		m_features.hasBindlessTexture = false;
+		m_features.hasMultiBind = true;
+		m_features.hasPushConstantsBuffer = false;
+		m_features.hasPersistentMapping = true;
 		m_library.getFunction( "vkGetInstanceProcAddr", GetInstanceProcAddr );
 
 		if ( !GetInstanceProcAddr )
@@ -50,6 +50,7 @@ namespace vk_renderer
 		, renderer::MemoryMapFlags flags )const
 	{
 		uint8_t * pointer{ nullptr };
+		doSetMapped( size, flags );
 		auto res = m_device.vkMapMemory( m_device
 			, m_memory
 			, offset
@@ -78,6 +79,7 @@ namespace vk_renderer
 		};
 		DEBUG_DUMP( mappedRange );
 		auto res = m_device.vkFlushMappedMemoryRanges( m_device, 1, &mappedRange );
+		m_device.addUploadedBytes( doGetFlushedBytes( size ) );
 
 		if ( !checkError( res ) )
 		{
@@ -108,5 +110,6 @@ namespace vk_renderer
 	void DeviceMemory::unlock()const
 	{
 		m_device.vkUnmapMemory( m_device, m_memory );
+		m_device.addUploadedBytes( doGetUnmappedBytes() );
 	}
 }
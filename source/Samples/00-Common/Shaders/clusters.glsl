@@ -0,0 +1,113 @@
+// shadertype=glsl
+
+// The lights clusters, filled by common::LightClusters.
+// The including shader must define the PointLight and SpotLight structures,
+// and CLUSTERS_SET and CLUSTERS_BINDING, the descriptor set and first binding of the clusters.
+// Without CLUSTERED_LIGHTS defined (no storage buffers support), the lights are read from the pointLights and spotLights arrays
+// of the including shader's lights UBO, which must then be declared before, and a single cluster holds all of them.
+
+layout( set=CLUSTERS_SET, binding=CLUSTERS_BINDING ) uniform Clusters
+{
+	mat4 clustersView;
+	mat4 clustersProjection;
+	mat4 clustersInvProjection;
+	uvec4 clustersGridSize;
+	vec4 clustersDepthRange;
+	uvec4 clustersLightsCount;
+};
+
+#define SPOT_LIGHT_FLAG 0x80000000u
+
+#ifdef CLUSTERED_LIGHTS
+
+layout( set=CLUSTERS_SET, binding=CLUSTERS_BINDING + 1, std430 ) readonly buffer PointLights
+{
+	PointLight clusterPointLights[];
+};
+
+layout( set=CLUSTERS_SET, binding=CLUSTERS_BINDING + 2, std430 ) readonly buffer SpotLights
+{
+	SpotLight clusterSpotLights[];
+};
+
+layout( set=CLUSTERS_SET, binding=CLUSTERS_BINDING + 3, std430 ) readonly buffer ClusterLights
+{
+	uint clusterLights[];
+};
+
+// Retrieves the index of the cluster containing the given world space position, in the clusters buffer.
+uint getClusterBase( vec3 worldPosition )
+{
+	vec3 viewPosition = ( clustersView * vec4( worldPosition, 1.0 ) ).xyz;
+	vec4 clipPosition = clustersProjection * vec4( viewPosition, 1.0 );
+	vec2 tile = ( clipPosition.xy / clipPosition.w * 0.5 + 0.5 ) * vec2( clustersGridSize.xy );
+	tile = clamp( tile, vec2( 0.0 ), vec2( clustersGridSize.xy ) - 1.0 );
+	float slice = log( max( -viewPosition.z, clustersDepthRange.x ) / clustersDepthRange.x )
+		/ clustersDepthRange.z
+		* float( clustersGridSize.z );
+	slice = clamp( slice, 0.0, float( clustersGridSize.z ) - 1.0 );
+	uint cluster = ( uint( slice ) * clustersGridSize.y + uint( tile.y ) ) * clustersGridSize.x + uint( tile.x );
+	return cluster * ( clustersGridSize.w + 1u );
+}
+
+uint getClusterLightsCount( uint clusterBase )
+{
+	return clusterLights[clusterBase];
+}
+
+// The light index, flagged with SPOT_LIGHT_FLAG for spot lights.
+uint getClusterLight( uint clusterBase, uint index )
+{
+	return clusterLights[clusterBase + 1u + index];
+}
+
+#else
+
+#define clusterPointLights pointLights
+#define clusterSpotLights spotLights
+
+uint getClusterBase( vec3 worldPosition )
+{
+	return 0u;
+}
+
+uint getClusterLightsCount( uint clusterBase )
+{
+	return clustersLightsCount.x + clustersLightsCount.y;
+}
+
+uint getClusterLight( uint clusterBase, uint index )
+{
+	return index < clustersLightsCount.x
+		? index
+		: ( index - clustersLightsCount.x ) | SPOT_LIGHT_FLAG;
+}
+
+#endif
+
+// Computes the light direction, and returns the attenuation factor.
+float getPointLightAttenuation( PointLight light
+	, vec3 worldPosition
+	, out vec3 direction )
+{
+	direction = worldPosition - light.position.xyz;
+	float lightDistance = length( direction );
+	direction /= lightDistance;
+	return 1.0 / ( light.attenation.x
+		+ light.attenation.y * lightDistance
+		+ light.attenation.z * lightDistance * lightDistance );
+}
+
+// The spot light cone factor, the cutoff being the cosine of the cone half angle.
+float getSpotLightFactor( SpotLight light
+	, vec3 direction )
+{
+	float spotFactor = dot( direction, normalize( light.direction.xyz ) );
+
+	if ( spotFactor <= light.coeffs.x )
+	{
+		return 0.0;
+	}
+
+	return pow( 1.0 - ( 1.0 - spotFactor ) / ( 1.0 - light.coeffs.x ), light.coeffs.y );
+}
@@ -0,0 +1,15 @@
+// shadertype=glsl
+
+// The scene textures, packed into 2D texture arrays by common::RenderTarget,
+// and bound by sets of at most MAX_TEXTURE_ARRAYS by common::NodesRenderer.
+// Must match common::MAX_TEXTURE_ARRAYS.
+
+#define MAX_TEXTURE_ARRAYS 16
+
+layout( set=1, binding=0 ) uniform sampler2DArray textures[MAX_TEXTURE_ARRAYS];
+
+// The index holds the slot of the texture array in the set in its 16 high bits, and the layer in its 16 low bits (TextureOperators::texture).
+vec4 sampleTexture( uint index, vec2 texcoord )
+{
+	return texture( textures[index >> 16], vec3( texcoord, float( index & 0xFFFF ) ) );
+}
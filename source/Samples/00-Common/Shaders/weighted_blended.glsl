@@ -0,0 +1,35 @@
+// shadertype=glsl
+
+// The transparent nodes output, see common::TransparentRendering.
+// By default, the colour is written to the colour target.
+// When WEIGHTED_BLENDED_OIT is defined, it is written to the accumulation and revealage targets.
+// OPACITY_THRESHOLD is the opacity under which the fragments are discarded.
+
+#ifdef WEIGHTED_BLENDED_OIT
+
+layout( location = 0 ) out vec4 pxl_accumulation;
+layout( location = 1 ) out float pxl_revealage;
+
+// The translucent fragments are blended, instead of being alpha tested.
+#define OPACITY_THRESHOLD 0.01
+
+void writeColour( vec4 colour )
+{
+	// The depth based weight from McGuire and Bavoil, favouring the nearest fragments.
+	float weight = colour.a * max( 0.01, 3000.0 * pow( 1.0 - gl_FragCoord.z, 3.0 ) );
+	pxl_accumulation = vec4( colour.rgb * colour.a, colour.a ) * weight;
+	pxl_revealage = colour.a;
+}
+
+#else
+
+layout( location = 0 ) out vec4 pxl_colour;
+
+#define OPACITY_THRESHOLD 0.5
+
+void writeColour( vec4 colour )
+{
+	pxl_colour = colour;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#version 450
+#extension GL_KHR_vulkan_glsl : enable
+
+// Resolves the weighted blended transparency targets, blended over the colour target
+// with ( SRC_ALPHA, ONE_MINUS_SRC_ALPHA ).
+
+layout( set=0, binding=0 ) uniform sampler2D accumulationMap;
+layout( set=0, binding=1 ) uniform sampler2D revealageMap;
+
+layout( location = 0 ) out vec4 pxl_colour;
+
+void main()
+{
+	// The targets have the colour target's dimensions.
+	ivec2 texel = ivec2( gl_FragCoord.xy );
+	float revealage = texelFetch( revealageMap, texel, 0 ).r;
+
+	if ( revealage >= 1.0 )
+	{
+		discard;
+	}
+
+	vec4 accumulation = texelFetch( accumulationMap, texel, 0 );
+	pxl_colour = vec4( accumulation.rgb / max( accumulation.a, 0.00001 ), 1.0 - revealage );
+}
@@ -1,11 +1,15 @@
 #include "AssimpLoader.hpp"
 
+#include "LodGenerator.hpp"
+#include "MeshCache.hpp"
+
 #include <stdlib.h>
 #include <fstream>
 #include <sstream>
 
 #include <StringUtils.hpp>
 
+#include <assimp/DefaultIOSystem.h> // Default file system
 #include <assimp/Importer.hpp> // C++ importer interface
 #include <assimp/scene.h> // Output data structure
 #include <assimp/postprocess.h> // Post processing flags
@@ -15,69 +19,153 @@ namespace common
 {
 	namespace
 	{
-		bool doLoadTexture( std::string const & folder
-			, aiString const & name
-			, ImagePtr & data
-			, std::map< std::string, ImagePtr > & images )
+		/**
+		*\brief
+		*	Records the files opened by Assimp, besides the source file.
+		*/
+		class RecordingIOSystem
+			: public Assimp::DefaultIOSystem
 		{
-			bool result = false;
-			auto it = images.find( name.C_Str() );
+		public:
+			RecordingIOSystem( std::string const & source
+				, StringArray & paths )
+				: m_source{ source }
+				, m_paths{ paths }
+			{
+			}
 
-			if ( it != images.end() )
+			Assimp::IOStream * Open( char const * file
+				, char const * mode )override
 			{
-				data = it->second;
-				return true;
+				auto result = Assimp::DefaultIOSystem::Open( file, mode );
+
+				if ( result
+					&& file != m_source
+					&& std::find( m_paths.begin(), m_paths.end(), file ) == m_paths.end() )
+				{
+					m_paths.emplace_back( file );
+				}
+
+				return result;
 			}
 
-			if ( name.length > 0 )
+		private:
+			std::string const & m_source;
+			StringArray & m_paths;
+		};
+
+		std::string doGetTexturePath( std::string const & folder
+			, aiString const & name )
+		{
+			std::string path = name.C_Str();
+			utils::replace( path, R"(\)", "/" );
+
+			if ( path.find( '/' ) != std::string::npos )
 			{
-				folder;
-				std::string path = name.C_Str();
-				auto index = 0u;
-				utils::replace( path, R"(\)", "/" );
+				path = path.substr( path.find_last_of( '/' ) + 1 );
+			}
+
+			std::clog << "  Loading texture " << path << std::endl;
+			// Textures baked by the TextureBaker tool are preferred to their sources.
+			auto baked = folder / ( path.substr( 0u, path.find_last_of( '.' ) ) + ".ktx" );
+			path = folder / path;
 
-				if ( path.find( '/' ) != std::string::npos )
+			if ( wxFileExists( wxString( baked ) ) )
+			{
+				return baked;
+			}
+
+			if ( !wxFileExists( wxString( path ) ) )
+			{
+				utils::replace( path, ".tga", ".jpg" );
+
+				if ( !wxFileExists( wxString( path ) ) )
 				{
-					index = path.find_last_of( '/' ) + 1;
-					path = path.substr( index );
+					utils::replace( path, ".jpg", ".png" );
 				}
+			}
+
+			return path;
+		}
 
-				std::clog << "  Loading texture " << path << std::endl;
-				path = folder / path;
+		void doCollectTextures( std::string const & folder
+			, aiMaterial const & aiMaterial
+			, std::map< std::string, std::string > & paths )
+		{
+			for ( auto type : { aiTextureType_DIFFUSE
+				, aiTextureType_SPECULAR
+				, aiTextureType_EMISSIVE
+				, aiTextureType_SHININESS
+				, aiTextureType_OPACITY
+				, aiTextureType_NORMALS } )
+			{
+				aiString name;
+				aiMaterial.Get( AI_MATKEY_TEXTURE( type, 0 ), name );
 
-				try
+				if ( name.length > 0
+					&& paths.find( name.C_Str() ) == paths.end() )
 				{
-					data = std::make_shared< Image >( common::loadImage( path ) );
-					result = true;
+					paths.emplace( std::string{ name.C_Str() }, doGetTexturePath( folder, name ) );
 				}
-				catch ( std::runtime_error & )
+			}
+		}
+
+		std::map< std::string, ImagePtr > doLoadTextures( std::string const & folder
+			, aiScene const & aiScene
+			, std::map< std::string, std::string > & paths )
+		{
+			for ( size_t meshIndex = 0; meshIndex < aiScene.mNumMeshes; ++meshIndex )
+			{
+				auto & aiMesh = *aiScene.mMeshes[meshIndex];
+
+				if ( aiMesh.HasFaces()
+					&& aiMesh.HasPositions()
+					&& aiMesh.mMaterialIndex < aiScene.mNumMaterials )
 				{
-					utils::replace( path, ".tga", ".jpg" );
-					try
-					{
-						data = std::make_shared< Image >( common::loadImage( path ) );
-						result = true;
-					}
-					catch ( std::runtime_error & )
-					{
-						utils::replace( path, ".tga", ".png" );
-						try
-						{
-							data = std::make_shared< Image >( common::loadImage( path ) );
-							result = true;
-						}
-						catch ( std::runtime_error & )
-						{
-						}
-					}
+					doCollectTextures( folder, *aiScene.mMaterials[aiMesh.mMaterialIndex], paths );
+				}
+			}
+
+			StringArray files;
+			files.reserve( paths.size() );
+
+			for ( auto & path : paths )
+			{
+				files.push_back( path.second );
+			}
+
+			auto loaded = loadImages( files );
+			std::map< std::string, ImagePtr > result;
+			auto it = loaded.begin();
+
+			for ( auto & path : paths )
+			{
+				if ( *it )
+				{
+					result.emplace( path.first, std::move( *it ) );
 				}
 
-				images.insert( { std::string{ name.C_Str() }, data } );
+				++it;
 			}
 
 			return result;
 		}
 
+		bool doLoadTexture( aiString const & name
+			, ImagePtr & data
+			, std::map< std::string, ImagePtr > const & images )
+		{
+			auto it = images.find( name.C_Str() );
+
+			if ( it == images.end() )
+			{
+				return false;
+			}
+
+			data = it->second;
+			return true;
+		}
+
 		template< typename aiMeshType >
 		std::vector< Vertex > doCreateVertexBuffer( aiMeshType const & aiMesh
 			, utils::Vec3 & min
@@ -194,10 +282,9 @@ namespace common
 			}
 		}
 
-		void doProcessPassTextures( std::string const & folder
-			, Material & material
+		void doProcessPassTextures( Material & material
 			, aiMaterial const & aiMaterial
-			, std::map< std::string, ImagePtr > & images )
+			, std::map< std::string, ImagePtr > const & images )
 		{
 			aiString ambTexName;
 			aiMaterial.Get( AI_MATKEY_TEXTURE( aiTextureType_AMBIENT, 0 ), ambTexName );
@@ -217,9 +304,8 @@ namespace common
 			aiMaterial.Get( AI_MATKEY_TEXTURE( aiTextureType_SHININESS, 0 ), shnTexName );
 			ImagePtr image;
 			auto index = 0u;
-			auto it = images.find( difTexName.C_Str() );
 
-			if ( doLoadTexture( folder, difTexName, image, images ) )
+			if ( doLoadTexture( difTexName, image, images ) )
 			{
 				material.textures.push_back( image );
 				material.data.textureOperators[index].diffuse = 1;
@@ -232,7 +318,7 @@ namespace common
 				++index;
 			}
 
-			if ( doLoadTexture( folder, spcTexName, image, images ) )
+			if ( doLoadTexture( spcTexName, image, images ) )
 			{
 				material.textures.push_back( image );
 				material.data.textureOperators[index].specular = 1;
@@ -245,21 +331,21 @@ namespace common
 				++index;
 			}
 
-			if ( doLoadTexture( folder, emiTexName, image, images ) )
+			if ( doLoadTexture( emiTexName, image, images ) )
 			{
 				material.textures.push_back( image );
 				material.data.textureOperators[index].emissive = 1;
 				++index;
 			}
 
-			if ( doLoadTexture( folder, shnTexName, image, images ) )
+			if ( doLoadTexture( shnTexName, image, images ) )
 			{
 				material.textures.push_back( image );
 				material.data.textureOperators[index].shininess = 1;
 				++index;
 			}
 
-			if ( doLoadTexture( folder, opaTexName, image, images ) )
+			if ( doLoadTexture( opaTexName, image, images ) )
 			{
 				material.textures.push_back( image );
 				material.hasOpacity = true;
@@ -276,7 +362,7 @@ namespace common
 				++index;
 			}
 
-			if ( doLoadTexture( folder, nmlTexName, image, images ) )
+			if ( doLoadTexture( nmlTexName, image, images ) )
 			{
 				material.textures.push_back( image );
 				material.data.textureOperators[index].normal = 1;
@@ -291,126 +377,168 @@ namespace common
 
 			material.data.texturesCount = index;
 		}
-	}
 
-	Object loadObject( std::string const & folder
-		, std::string const & fileName
-		, common::ImagePtrArray & images
-		, float rescale )
-	{
-		Assimp::Importer importer;
-		uint32_t flags = aiProcess_Triangulate
-			| aiProcess_JoinIdenticalVertices
-			| aiProcess_OptimizeMeshes
-			| aiProcess_OptimizeGraph
-			| aiProcess_FixInfacingNormals
-			| aiProcess_GenSmoothNormals
-			| aiProcess_CalcTangentSpace
-			| aiProcess_FlipWindingOrder
-			| aiProcess_FlipUVs;
-		aiScene const * aiScene = importer.ReadFile( folder / fileName, flags );
-		Object result;
-
-		if ( aiScene && aiScene->HasMeshes() )
+		Object doImportObject( std::string const & folder
+			, std::string const & fileName
+			, float rescale
+			, common::ImagePtrArray & images
+			, StringArray & imagePaths
+			, StringArray & dependencies )
 		{
-			utils::Vec3 min{ std::numeric_limits< float >::max() };
-			utils::Vec3 max{ std::numeric_limits< float >::lowest() };
-			static Material const defaultMaterial
+			auto source = folder / fileName;
+			Assimp::Importer importer;
+			// The importer takes the ownership of the file system.
+			importer.SetIOHandler( new RecordingIOSystem{ source, dependencies } );
+			uint32_t flags = aiProcess_Triangulate
+				| aiProcess_JoinIdenticalVertices
+				| aiProcess_OptimizeMeshes
+				| aiProcess_OptimizeGraph
+				| aiProcess_FixInfacingNormals
+				| aiProcess_GenSmoothNormals
+				| aiProcess_CalcTangentSpace
+				| aiProcess_FlipWindingOrder
+				| aiProcess_FlipUVs;
+			aiScene const * aiScene = importer.ReadFile( source, flags );
+			Object result;
+
+			if ( aiScene && aiScene->HasMeshes() )
 			{
+				utils::Vec3 min{ std::numeric_limits< float >::max() };
+				utils::Vec3 max{ std::numeric_limits< float >::lowest() };
+				static Material const defaultMaterial
 				{
-					utils::Vec4{ 1, 1, 1, 1 },
-					utils::Vec4{ 1, 1, 1, 1 },
-					utils::Vec4{ 0, 0, 0, 0 },
-				}
-			};
-
-			std::map< std::string, ImagePtr > uniqueImages;
-
-			for ( size_t meshIndex = 0; meshIndex < aiScene->mNumMeshes; ++meshIndex )
-			{
-				auto & aiMesh = *aiScene->mMeshes[meshIndex];
-				Submesh submesh;
-
-				if ( aiMesh.HasFaces() && aiMesh.HasPositions() )
-				{
-					if ( aiMesh.mMaterialIndex < aiScene->mNumMaterials )
 					{
-						auto & aiMaterial = *aiScene->mMaterials[aiMesh.mMaterialIndex];
-						aiString mtlname;
-						aiMaterial.Get( AI_MATKEY_NAME, mtlname );
-						Material material;
-						doProcessPassBaseComponents( material, aiMaterial );
-						doProcessPassTextures( folder, material, aiMaterial, uniqueImages );
-						submesh.materials.push_back( material );
-					}
-					else
-					{
-						submesh.materials.push_back( defaultMaterial );
+						utils::Vec4{ 1, 1, 1, 1 },
+						utils::Vec4{ 1, 1, 1, 1 },
+						utils::Vec4{ 0, 0, 0, 0 },
 					}
+				};
 
-					submesh.vbo.data = doCreateVertexBuffer( aiMesh, min, max );
+				// All the textures are loaded at once, to decode them concurrently.
+				std::map< std::string, std::string > paths;
+				auto uniqueImages = doLoadTextures( folder, *aiScene, paths );
+
+				for ( size_t meshIndex = 0; meshIndex < aiScene->mNumMeshes; ++meshIndex )
+				{
+					auto & aiMesh = *aiScene->mMeshes[meshIndex];
+					Submesh submesh;
 
-					for ( size_t faceIndex = 0u; faceIndex < aiMesh.mNumFaces; ++faceIndex )
+					if ( aiMesh.HasFaces() && aiMesh.HasPositions() )
 					{
-						auto & face = aiMesh.mFaces[faceIndex];
+						if ( aiMesh.mMaterialIndex < aiScene->mNumMaterials )
+						{
+							auto & aiMaterial = *aiScene->mMaterials[aiMesh.mMaterialIndex];
+							aiString mtlname;
+							aiMaterial.Get( AI_MATKEY_NAME, mtlname );
+							Material material;
+							doProcessPassBaseComponents( material, aiMaterial );
+							doProcessPassTextures( material, aiMaterial, uniqueImages );
+							submesh.materials.push_back( material );
+						}
+						else
+						{
+							submesh.materials.push_back( defaultMaterial );
+						}
+
+						submesh.vbo.data = doCreateVertexBuffer( aiMesh, min, max );
 
-						if ( face.mNumIndices == 3 )
+						for ( size_t faceIndex = 0u; faceIndex < aiMesh.mNumFaces; ++faceIndex )
 						{
-							submesh.ibo.data.push_back( Face
+							auto & face = aiMesh.mFaces[faceIndex];
+
+							if ( face.mNumIndices == 3 )
 							{
-								face.mIndices[0],
-								face.mIndices[1],
-								face.mIndices[2]
-							} );
+								submesh.ibo.data.push_back( Face
+								{
+									face.mIndices[0],
+									face.mIndices[1],
+									face.mIndices[2]
+								} );
+							}
 						}
-					}
 
-					if ( submesh.materials[0].hasOpacity )
-					{
-						Material material = submesh.materials[0];
-						auto it = std::find_if( material.data.textureOperators.begin()
-							, material.data.textureOperators.end()
-							, []( TextureOperators const & operators )
+						if ( submesh.materials[0].hasOpacity )
+						{
+							Material material = submesh.materials[0];
+							auto it = std::find_if( material.data.textureOperators.begin()
+								, material.data.textureOperators.end()
+								, []( TextureOperators const & operators )
+								{
+									return operators.normal != 0;
+								} );
+							material.data.backFace = 1;
+
+							if ( it != material.data.textureOperators.end() )
 							{
-								return operators.normal != 0;
-							} );
-						material.data.backFace = 1;
+								it->normal = 2;
+							}
 
-						if ( it != material.data.textureOperators.end() )
-						{
-							it->normal = 2;
+							submesh.materials.push_back( material );
 						}
 
-						submesh.materials.push_back( material );
+						result.emplace_back( std::move( submesh ) );
 					}
-
-					result.emplace_back( std::move( submesh ) );
 				}
-			}
 
-			// Rescale the model.
-			auto diff = max - min;
-			float scale = rescale / std::max( diff[0], std::max( diff[1], diff[2] ) );
-			min *= scale;
-			max *= scale;
-			utils::Vec3 offset{ ( max - min ) / -2.0f };
-			offset[0] = 0.0;
-			offset[2] = 0.0;
+				// Rescale the model.
+				auto diff = max - min;
+				float scale = rescale / std::max( diff[0], std::max( diff[1], diff[2] ) );
+				min *= scale;
+				max *= scale;
+				utils::Vec3 offset{ ( max - min ) / -2.0f };
+				offset[0] = 0.0;
+				offset[2] = 0.0;
 
-			for ( auto & submesh : result )
-			{
-				for ( auto & vertex : submesh.vbo.data )
+				for ( auto & submesh : result )
 				{
-					vertex.position = offset + ( vertex.position * scale );
+					for ( auto & vertex : submesh.vbo.data )
+					{
+						vertex.position = offset + ( vertex.position * scale );
+					}
+
+					// Once rescaled, for the LOD errors to be in the object units.
+					generateLods( submesh );
 				}
-			}
 
-			for ( auto & image : uniqueImages )
-			{
-				images.emplace_back( std::move( image.second ) );
+				for ( auto & image : uniqueImages )
+				{
+					imagePaths.push_back( paths[image.first] );
+					images.emplace_back( std::move( image.second ) );
+				}
 			}
+
+			return result;
+		}
+	}
+
+	Object loadObject( std::string const & folder
+		, std::string const & fileName
+		, common::ImagePtrArray & images
+		, float rescale )
+	{
+		// The post-processed object is cached next to its source, to skip Assimp on the next launches.
+		auto cacheName = fileName + ".meshcache";
+		auto hash = hashFile( folder / fileName );
+		Object result;
+
+		if ( hash
+			&& loadObjectCache( folder, cacheName, hash, rescale, result, images ) )
+		{
+			std::clog << "Loaded " << fileName << " from its cache" << std::endl;
+			return result;
+		}
+
+		ImagePtrArray objectImages;
+		StringArray imagePaths;
+		StringArray dependencies;
+		result = doImportObject( folder, fileName, rescale, objectImages, imagePaths, dependencies );
+
+		if ( hash && !result.empty() )
+		{
+			saveObjectCache( folder, cacheName, hash, rescale, result, objectImages, imagePaths, dependencies );
 		}
 
+		images.insert( images.end(), objectImages.begin(), objectImages.end() );
 		return result;
 	}
 }
@@ -1,6 +1,17 @@
 #include "FileUtils.hpp"
 
+#include <Parallel.hpp>
+
+#include <atomic>
 #include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if defined( RENDERLIB_SIMD_SSE2 ) && ( defined( __SSSE3__ ) || defined( __AVX__ ) )
+#	define RENDERLIB_SIMD_SSSE3 1
+#	include <tmmintrin.h>
+#endif
 
 #if RENDERLIB_WIN32
 
@@ -16,8 +27,11 @@
 
 #elif defined( __linux__ )
 
+#include <sys/mman.h>
 #include <sys/stat.h>
 
+#include <fcntl.h>
+
 #include <unistd.h>
 #include <dirent.h>
 #include <pwd.h>
@@ -171,52 +185,379 @@ namespace common
 
 #endif
 
-	Image loadImage( std::string const & path )
+	namespace
 	{
-		if ( !wxFileExists( wxString( path ) ) )
+		using Clock = std::chrono::high_resolution_clock;
+
+		struct ImageLoadTimings
+		{
+			std::chrono::nanoseconds decode{ 0 };
+			std::chrono::nanoseconds convert{ 0 };
+		};
+
+		void doExpandRGB( uint8_t const * rgb
+			, uint8_t * rgba
+			, size_t begin
+			, size_t end )
+		{
+			rgb += begin * 3u;
+			rgba += begin * 4u;
+			size_t i = begin;
+
+#if defined( RENDERLIB_SIMD_SSSE3 )
+
+			// 16 pixels per iteration: 48 bytes in, 64 bytes out.
+			__m128i const shuffle = _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+			__m128i const opaque = _mm_set1_epi32( int32_t( 0xFF000000u ) );
+
+			for ( ; i + 16u <= end; i += 16u, rgb += 48u, rgba += 64u )
+			{
+				__m128i const a = _mm_loadu_si128( reinterpret_cast< __m128i const * >( rgb ) );
+				__m128i const b = _mm_loadu_si128( reinterpret_cast< __m128i const * >( rgb + 16u ) );
+				__m128i const c = _mm_loadu_si128( reinterpret_cast< __m128i const * >( rgb + 32u ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba )
+					, _mm_or_si128( _mm_shuffle_epi8( a, shuffle ), opaque ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba + 16u )
+					, _mm_or_si128( _mm_shuffle_epi8( _mm_alignr_epi8( b, a, 12 ), shuffle ), opaque ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba + 32u )
+					, _mm_or_si128( _mm_shuffle_epi8( _mm_alignr_epi8( c, b, 8 ), shuffle ), opaque ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba + 48u )
+					, _mm_or_si128( _mm_shuffle_epi8( _mm_srli_si128( c, 4 ), shuffle ), opaque ) );
+			}
+
+#endif
+
+			for ( ; i < end; ++i )
+			{
+				*rgba++ = *rgb++;
+				*rgba++ = *rgb++;
+				*rgba++ = *rgb++;
+				*rgba++ = 0xFF;
+			}
+		}
+
+		void doInterleaveAlpha( uint8_t const * rgb
+			, uint8_t const * alpha
+			, uint8_t * rgba
+			, size_t begin
+			, size_t end )
 		{
-			throw std::runtime_error{ "Couldn't find image file." };
+			rgb += begin * 3u;
+			alpha += begin;
+			rgba += begin * 4u;
+			size_t i = begin;
+
+#if defined( RENDERLIB_SIMD_SSSE3 )
+
+			__m128i const shuffle = _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+			__m128i const alpha0 = _mm_setr_epi8( -1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3 );
+			__m128i const alpha1 = _mm_setr_epi8( -1, -1, -1, 4, -1, -1, -1, 5, -1, -1, -1, 6, -1, -1, -1, 7 );
+			__m128i const alpha2 = _mm_setr_epi8( -1, -1, -1, 8, -1, -1, -1, 9, -1, -1, -1, 10, -1, -1, -1, 11 );
+			__m128i const alpha3 = _mm_setr_epi8( -1, -1, -1, 12, -1, -1, -1, 13, -1, -1, -1, 14, -1, -1, -1, 15 );
+
+			for ( ; i + 16u <= end; i += 16u, rgb += 48u, alpha += 16u, rgba += 64u )
+			{
+				__m128i const a = _mm_loadu_si128( reinterpret_cast< __m128i const * >( rgb ) );
+				__m128i const b = _mm_loadu_si128( reinterpret_cast< __m128i const * >( rgb + 16u ) );
+				__m128i const c = _mm_loadu_si128( reinterpret_cast< __m128i const * >( rgb + 32u ) );
+				__m128i const d = _mm_loadu_si128( reinterpret_cast< __m128i const * >( alpha ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba )
+					, _mm_or_si128( _mm_shuffle_epi8( a, shuffle )
+						, _mm_shuffle_epi8( d, alpha0 ) ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba + 16u )
+					, _mm_or_si128( _mm_shuffle_epi8( _mm_alignr_epi8( b, a, 12 ), shuffle )
+						, _mm_shuffle_epi8( d, alpha1 ) ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba + 32u )
+					, _mm_or_si128( _mm_shuffle_epi8( _mm_alignr_epi8( c, b, 8 ), shuffle )
+						, _mm_shuffle_epi8( d, alpha2 ) ) );
+				_mm_storeu_si128( reinterpret_cast< __m128i * >( rgba + 48u )
+					, _mm_or_si128( _mm_shuffle_epi8( _mm_srli_si128( c, 4 ), shuffle )
+						, _mm_shuffle_epi8( d, alpha3 ) ) );
+			}
+
+#endif
+
+			for ( ; i < end; ++i )
+			{
+				*rgba++ = *rgb++;
+				*rgba++ = *rgb++;
+				*rgba++ = *rgb++;
+				*rgba++ = *alpha++;
+			}
 		}
 
-		wxImage image{ path };
+		// KTX 1.1 container, as written by the TextureBaker tool.
+		uint8_t const KtxIdentifier[12]
+		{
+			0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+		};
+		uint32_t constexpr KtxEndianness = 0x04030201u;
+		uint32_t constexpr GlRGBA8 = 0x8058u;
+		uint32_t constexpr GlCompressedRgbS3tcDxt1 = 0x83F0u;
+		uint32_t constexpr GlCompressedRgbaS3tcDxt1 = 0x83F1u;
+		uint32_t constexpr GlCompressedRgbaS3tcDxt5 = 0x83F3u;
+		char const * const KtxOpacityKey = "RendererLib.opacity";
+
+		struct KtxHeader
+		{
+			uint8_t identifier[12];
+			uint32_t endianness;
+			uint32_t glType;
+			uint32_t glTypeSize;
+			uint32_t glFormat;
+			uint32_t glInternalFormat;
+			uint32_t glBaseInternalFormat;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t pixelDepth;
+			uint32_t numberOfArrayElements;
+			uint32_t numberOfFaces;
+			uint32_t numberOfMipmapLevels;
+			uint32_t bytesOfKeyValueData;
+		};
+
+		bool doIsBakedImage( std::string const & path )
+		{
+			return path.size() > 4u
+				&& path.compare( path.size() - 4u, 4u, ".ktx" ) == 0;
+		}
 
-		if ( !image.IsOk() )
+		uint32_t doReadUInt32( uint8_t const * data )
 		{
-			throw std::runtime_error{ "Couldn't load image file." };
+			uint32_t result;
+			std::memcpy( &result, data, sizeof( result ) );
+			return result;
 		}
 
-		uint8_t * data = image.GetData();
-		Image result;
-		result.format = renderer::Format::eR8G8B8A8_UNORM;
-		result.size = { uint32_t( image.GetSize().x ), uint32_t( image.GetSize().y ) };
-		uint32_t size = image.GetSize().x * image.GetSize().y;
-		result.data.resize( size * 4 );
-		result.opacity = image.HasAlpha();
-		auto it = result.data.begin();
-
-		if ( result.opacity )
+		void doLoadBakedImage( std::string const & path
+			, Image & result )
 		{
-			uint8_t * alpha = image.GetAlpha();
+			auto file = std::make_shared< MappedFile >( path );
+			uint8_t const * data = file->getData();
+			uint8_t const * end = data + file->getSize();
+			KtxHeader header;
+
+			if ( file->getSize() < sizeof( header ) )
+			{
+				throw std::runtime_error{ "Truncated KTX file." };
+			}
+
+			std::memcpy( &header, data, sizeof( header ) );
+			data += sizeof( header );
 
-			for ( uint32_t i{ 0u }; i < size; ++i )
+			if ( std::memcmp( header.identifier, KtxIdentifier, sizeof( KtxIdentifier ) ) != 0
+				|| header.endianness != KtxEndianness )
 			{
-				*it++ = *data++;
-				*it++ = *data++;
-				*it++ = *data++;
-				*it++ = *alpha++;
+				throw std::runtime_error{ "Not a little endian KTX file." };
 			}
+
+			if ( header.pixelDepth > 1u
+				|| header.numberOfArrayElements > 1u
+				|| header.numberOfFaces != 1u )
+			{
+				throw std::runtime_error{ "Only 2D KTX textures are supported." };
+			}
+
+			switch ( header.glInternalFormat )
+			{
+			case GlRGBA8:
+				result.format = renderer::Format::eR8G8B8A8_UNORM;
+				result.opacity = true;
+				break;
+			case GlCompressedRgbS3tcDxt1:
+				result.format = renderer::Format::eBC1_RGB_UNORM_BLOCK;
+				result.opacity = false;
+				break;
+			case GlCompressedRgbaS3tcDxt1:
+				result.format = renderer::Format::eBC1_RGBA_UNORM_BLOCK;
+				result.opacity = true;
+				break;
+			case GlCompressedRgbaS3tcDxt5:
+				result.format = renderer::Format::eBC3_UNORM_BLOCK;
+				result.opacity = true;
+				break;
+			default:
+				throw std::runtime_error{ "Unsupported KTX internal format." };
+			}
+
+			if ( header.bytesOfKeyValueData > size_t( end - data ) )
+			{
+				throw std::runtime_error{ "Truncated KTX file." };
+			}
+
+			auto keyValue = data;
+			data += header.bytesOfKeyValueData;
+
+			while ( keyValue + sizeof( uint32_t ) <= data )
+			{
+				auto size = doReadUInt32( keyValue );
+				keyValue += sizeof( uint32_t );
+
+				if ( size > size_t( data - keyValue ) )
+				{
+					break;
+				}
+
+				// The key is null terminated, and followed by the value.
+				std::string pair( reinterpret_cast< char const * >( keyValue ), size );
+				auto keyEnd = pair.find( '\0' );
+
+				if ( keyEnd != std::string::npos
+					&& keyEnd + 1u < pair.size()
+					&& pair.compare( 0u, keyEnd, KtxOpacityKey ) == 0 )
+				{
+					result.opacity = pair[keyEnd + 1u] == '1';
+				}
+
+				keyValue += ( size + 3u ) & ~3u;
+			}
+
+			renderer::Extent2D size{ header.pixelWidth, std::max( 1u, header.pixelHeight ) };
+			uint32_t levels = std::max( 1u, header.numberOfMipmapLevels );
+
+			for ( uint32_t level = 0u; level < levels; ++level )
+			{
+				if ( sizeof( uint32_t ) > size_t( end - data ) )
+				{
+					throw std::runtime_error{ "Truncated KTX file." };
+				}
+
+				auto byteSize = doReadUInt32( data );
+				data += sizeof( uint32_t );
+
+				if ( byteSize > size_t( end - data ) )
+				{
+					throw std::runtime_error{ "Truncated KTX file." };
+				}
+
+				result.levels.push_back( { size, data, byteSize } );
+				data += ( byteSize + 3u ) & ~3u;
+				size.width = std::max( 1u, size.width / 2u );
+				size.height = std::max( 1u, size.height / 2u );
+			}
+
+			result.size = result.levels[0].size;
+			result.file = std::move( file );
 		}
-		else
+
+		void doLoadImage( std::string const & path
+			, Image & result
+			, ImageLoadTimings & timings
+			, bool parallelConvert )
 		{
-			for ( uint32_t i{ 0u }; i < size; ++i )
+			auto start = Clock::now();
+
+			if ( doIsBakedImage( path ) )
+			{
+				doLoadBakedImage( path, result );
+				timings.decode += Clock::now() - start;
+				return;
+			}
+
+			if ( !wxFileExists( wxString( path ) ) )
 			{
-				*it++ = *data++;
-				*it++ = *data++;
-				*it++ = *data++;
-				*it++ = 0xFF;
+				throw std::runtime_error{ "Couldn't find image file." };
 			}
+
+			wxImage image{ path };
+
+			if ( !image.IsOk() )
+			{
+				throw std::runtime_error{ "Couldn't load image file." };
+			}
+
+			auto decoded = Clock::now();
+			timings.decode += decoded - start;
+			uint8_t const * data = image.GetData();
+			uint8_t const * alpha = image.GetAlpha();
+			size_t size = size_t( image.GetSize().x ) * size_t( image.GetSize().y );
+			result.format = renderer::Format::eR8G8B8A8_UNORM;
+			result.size = { uint32_t( image.GetSize().x ), uint32_t( image.GetSize().y ) };
+			result.opacity = image.HasAlpha();
+			result.data.resize( size * 4u );
+			uint8_t * rgba = result.data.data();
+			auto convert = [data, alpha, rgba]( size_t begin, size_t end )
+			{
+				if ( alpha )
+				{
+					doInterleaveAlpha( data, alpha, rgba, begin, end );
+				}
+				else
+				{
+					doExpandRGB( data, rgba, begin, end );
+				}
+			};
+
+			if ( parallelConvert )
+			{
+				// Chunks of 64K pixels, multiple of the SIMD batch size.
+				utils::parallelFor( size, 65536u, convert );
+			}
+			else
+			{
+				convert( 0u, size );
+			}
+
+			timings.convert += Clock::now() - decoded;
+		}
+
+		double doGetMilliseconds( std::chrono::nanoseconds value )
+		{
+			return std::chrono::duration_cast< std::chrono::microseconds >( value ).count() / 1000.0;
 		}
+	}
 
+	Image loadImage( std::string const & path )
+	{
+		Image result;
+		ImageLoadTimings timings;
+		doLoadImage( path, result, timings, true );
+		return result;
+	}
+
+	ImagePtrArray loadImages( StringArray const & paths )
+	{
+		auto start = Clock::now();
+		ImagePtrArray result( paths.size() );
+		size_t const threads = std::min< size_t >( std::max( std::thread::hardware_concurrency(), 1u )
+			, paths.size() );
+		std::vector< ImageLoadTimings > timings( threads );
+		std::atomic< size_t > next{ 0u };
+
+		// One chunk per worker, the workers then pick the files one at a time,
+		// so that a big image doesn't delay the smaller ones queued behind it.
+		utils::parallelFor( threads
+			, 1u
+			, [&paths, &result, &timings, &next]( size_t begin, size_t end )
+			{
+				for ( auto index = next++; index < paths.size(); index = next++ )
+				{
+					try
+					{
+						auto image = std::make_shared< Image >();
+						doLoadImage( paths[index], *image, timings[begin], false );
+						result[index] = std::move( image );
+					}
+					catch ( std::exception & exc )
+					{
+						std::cerr << "Couldn't load image " << paths[index] << ": " << exc.what() << std::endl;
+					}
+				}
+			} );
+
+		ImageLoadTimings total;
+
+		for ( auto & timing : timings )
+		{
+			total.decode += timing.decode;
+			total.convert += timing.convert;
+		}
+
+		std::clog << "Loaded " << paths.size() << " images on " << threads << " threads"
+			<< " in " << doGetMilliseconds( Clock::now() - start ) << " ms"
+			<< " (decode: " << doGetMilliseconds( total.decode ) << " ms"
+			<< ", conversion: " << doGetMilliseconds( total.convert ) << " ms"
+			<< ", summed over the threads)" << std::endl;
 		return result;
 	}
 
@@ -240,6 +581,48 @@ namespace common
 		return result;
 	}
 
+	std::string dumpShaderFile( std::string const & path )
+	{
+		std::ifstream file( path );
+
+		if ( file.fail() )
+		{
+			throw std::runtime_error{ "Could not open file " + path };
+		}
+
+		static std::string const Include = "#include";
+		std::string result;
+		std::string line;
+
+		while ( std::getline( file, line ) )
+		{
+			auto start = line.find_first_not_of( " \t" );
+
+			if ( start != std::string::npos
+				&& line.compare( start, Include.size(), Include ) == 0 )
+			{
+				auto begin = line.find( '"', start + Include.size() );
+				auto end = begin == std::string::npos
+					? std::string::npos
+					: line.find( '"', begin + 1u );
+
+				if ( end == std::string::npos )
+				{
+					throw std::runtime_error{ "Invalid include directive in " + path + ": " + line };
+				}
+
+				result += dumpShaderFile( getPath( path ) / line.substr( begin + 1u, end - begin - 1u ) );
+			}
+			else
+			{
+				result += line;
+				result += '\n';
+			}
+		}
+
+		return result;
+	}
+
 	renderer::ByteArray dumpBinaryFile( std::string const & path )
 	{
 		std::ifstream file( path, std::ios::binary );
@@ -287,6 +670,50 @@ namespace common
 
 #if RENDERLIB_WIN32
 
+	MappedFile::MappedFile( std::string const & path )
+	{
+		m_file = ::CreateFileA( path.c_str()
+			, GENERIC_READ
+			, FILE_SHARE_READ
+			, nullptr
+			, OPEN_EXISTING
+			, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN
+			, nullptr );
+		LARGE_INTEGER size;
+
+		if ( m_file == INVALID_HANDLE_VALUE
+			|| !::GetFileSizeEx( m_file, &size ) )
+		{
+			throw std::runtime_error{ "Couldn't open file " + path };
+		}
+
+		m_size = size_t( size.QuadPart );
+		m_mapping = ::CreateFileMappingA( m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+		if ( m_mapping )
+		{
+			m_data = static_cast< uint8_t const * >( ::MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+		}
+
+		if ( !m_data )
+		{
+			if ( m_mapping )
+			{
+				::CloseHandle( m_mapping );
+			}
+
+			::CloseHandle( m_file );
+			throw std::runtime_error{ "Couldn't map file " + path };
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		::UnmapViewOfFile( m_data );
+		::CloseHandle( m_mapping );
+		::CloseHandle( m_file );
+	}
+
 	std::string getExecutableDirectory()
 	{
 		std::string pathReturn;
@@ -363,6 +790,44 @@ namespace common
 
 #elif defined( __linux__ )
 
+	MappedFile::MappedFile( std::string const & path )
+	{
+		int fd = open( path.c_str(), O_RDONLY );
+		struct stat status;
+
+		if ( fd == -1
+			|| fstat( fd, &status ) == -1 )
+		{
+			if ( fd != -1 )
+			{
+				close( fd );
+			}
+
+			throw std::runtime_error{ "Couldn't open file " + path };
+		}
+
+		m_size = size_t( status.st_size );
+		void * data = m_size
+			? mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 )
+			: MAP_FAILED;
+		// The mapping keeps its own reference to the file.
+		close( fd );
+
+		if ( data == MAP_FAILED )
+		{
+			throw std::runtime_error{ "Couldn't map file " + path };
+		}
+
+		// The mapped files are read entirely, soon after being mapped.
+		madvise( data, m_size, MADV_WILLNEED );
+		m_data = static_cast< uint8_t const * >( data );
+	}
+
+	MappedFile::~MappedFile()
+	{
+		munmap( const_cast< uint8_t * >( m_data ), m_size );
+	}
+
 	std::string getExecutableDirectory()
 	{
 		std::string pathReturn;
@@ -14,7 +14,52 @@ namespace common
 	/**
 	*\~english
 	*\brief
+	*	A read-only memory mapping of a whole file.
+	*\~french
+	*\brief
+	*	Un mappage mémoire en lecture seule d'un fichier entier.
+	*/
+	class MappedFile
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Maps the file, throws std::runtime_error on failure.
+		*\~french
+		*\brief
+		*	Mappe le fichier, lance une std::runtime_error en cas d'échec.
+		*/
+		explicit MappedFile( std::string const & path );
+		~MappedFile();
+		MappedFile( MappedFile const & ) = delete;
+		MappedFile & operator=( MappedFile const & ) = delete;
+
+		inline uint8_t const * getData()const
+		{
+			return m_data;
+		}
+
+		inline size_t getSize()const
+		{
+			return m_size;
+		}
+
+	private:
+		uint8_t const * m_data{ nullptr };
+		size_t m_size{ 0u };
+#if RENDERLIB_WIN32
+		void * m_file{ nullptr };
+		void * m_mapping{ nullptr };
+#endif
+	};
+	/**
+	*\~english
+	*\brief
 	*	Loads an image.
+	*\remarks
+	*	The .ktx images, written by the TextureBaker tool, are memory mapped,
+	*	and their precomputed levels are given in Image::levels, without any decode.
 	*\param[in] path
 	*	The image gile path.
 	*\return
@@ -22,6 +67,9 @@ namespace common
 	*\~french
 	*\brief
 	*	Charge une image.
+	*\remarks
+	*	Les images .ktx, écrites par l'outil TextureBaker, sont mappées en mémoire,
+	*	et leurs niveaux précalculés sont donnés dans Image::levels, sans aucun décodage.
 	*\param[in] path
 	*	Le chemin d'accès à l'image.
 	*\return
@@ -31,6 +79,29 @@ namespace common
 	/**
 	*\~english
 	*\brief
+	*	Loads images concurrently, on a pool of threads.
+	*\remarks
+	*	Logs the total time, and the decode and conversion times.
+	*\param[in] paths
+	*	The images files paths.
+	*\return
+	*	The images data, in the same order as \p paths.
+	*	The images that couldn't be loaded are null.
+	*\~french
+	*\brief
+	*	Charge des images en parallèle, sur un groupe de threads.
+	*\remarks
+	*	Journalise le temps total, et les temps de décodage et de conversion.
+	*\param[in] paths
+	*	Les chemins d'accès aux images.
+	*\return
+	*	Les données des images, dans le même ordre que \p paths.
+	*	Les images n'ayant pas pu être chargées sont nulles.
+	*/
+	ImagePtrArray loadImages( StringArray const & paths );
+	/**
+	*\~english
+	*\brief
 	*	List all files in a directory, recursively or not.
 	*\param[in] folderPath
 	*	The directory path.
@@ -75,6 +146,23 @@ namespace common
 	/**
 	*\~french
 	*\brief
+	*	Charge le contenu d'un fichier de shader, en remplaçant ses lignes #include "fichier" par le contenu du fichier inclus.
+	*\param[in] file
+	*	Le chemin d'accès au fichier, les fichiers inclus sont relatifs à son dossier.
+	*\return
+	*	Le source du shader.
+	*\~english
+	*\brief
+	*	Loads the content of a shader file, replacing its #include "file" lines with the included file content.
+	*\param[in] file
+	*	The file path, the included files are relative to its folder.
+	*\return
+	*	The shader source.
+	*/
+	std::string dumpShaderFile( std::string const & file );
+	/**
+	*\~french
+	*\brief
 	*	Charge le contenu d'un fichier binaire dans un tableau d'octets.
 	*\param[in] file
 	*	Le chemin d'accès au fichier.
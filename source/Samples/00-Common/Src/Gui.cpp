@@ -36,6 +36,20 @@ namespace common
 {
 	namespace
 	{
+		uint32_t doGetCapacity( uint32_t capacity
+			, uint32_t count )
+		{
+			static uint32_t constexpr MinCapacity = 4096u;
+			capacity = std::max( capacity, MinCapacity );
+
+			while ( capacity < count )
+			{
+				capacity *= 2u;
+			}
+
+			return capacity;
+		}
+
 		renderer::PushConstantArray doCreateConstants()
 		{
 			return
@@ -49,6 +63,7 @@ namespace common
 	Gui::Gui( renderer::Device const & device
 		, renderer::Extent2D const & size )
 		: m_device{ device }
+		, m_persistentMapping{ device.getRenderer().getFeatures().hasPersistentMapping }
 		, m_size{ size }
 		, m_pushConstants{ renderer::ShaderStageFlag::eVertex, doCreateConstants() }
 	{
@@ -71,6 +86,19 @@ namespace common
 		doPrepareResources();
 	}
 
+	Gui::~Gui()
+	{
+		for ( auto & frame : m_frames )
+		{
+			doWaitFrame( frame );
+
+			if ( m_persistentMapping )
+			{
+				doUnmapGeometryBuffers( frame );
+			}
+		}
+	}
+
 	void Gui::updateView( renderer::TextureView const & colourView )
 	{
 		if ( m_colourView != &colourView )
@@ -81,7 +109,7 @@ namespace common
 
 			if ( !first )
 			{
-				doUpdateCommandBuffers();
+				update();
 			}
 		}
 	}
@@ -95,67 +123,47 @@ namespace common
 			return;
 		}
 
-		bool updateCmdBuffers = false;
-		auto vertexBufferSize = uint32_t( imDrawData->TotalVtxCount );
+		auto & frame = m_frames[m_frameIndex];
+		doWaitFrame( frame );
+		doUpdateGeometryBuffers( frame
+			, uint32_t( imDrawData->TotalVtxCount )
+			, uint32_t( imDrawData->TotalIdxCount ) );
 
-		if ( !m_vertexBuffer || m_vertexCount != vertexBufferSize )
+		if ( !m_persistentMapping )
 		{
-			m_vertexBuffer.reset();
-			m_vertexCount = vertexBufferSize;
-			m_vertexBuffer = renderer::makeVertexBuffer< ImDrawVert >( m_device
-				, m_vertexCount
-				, renderer::BufferTargets{ 0u }
-				, renderer::MemoryPropertyFlag::eHostVisible );
-			updateCmdBuffers = true;
+			doMapGeometryBuffers( frame, renderer::MemoryMapFlag::eWrite | renderer::MemoryMapFlag::eInvalidateBuffer );
 		}
 
-		auto indexBufferSize = uint32_t( imDrawData->TotalIdxCount );
+		auto vtx = frame.vertexData;
+		auto idx = frame.indexData;
 
-		if ( !m_indexBuffer || m_indexCount < indexBufferSize )
+		for ( int n = 0; n < imDrawData->CmdListsCount; n++ )
 		{
-			m_indexBuffer.reset();
-			m_indexCount = indexBufferSize;
-			m_indexBuffer = renderer::makeBuffer< ImDrawIdx >( m_device
-				, m_indexCount
-				, renderer::BufferTarget::eIndexBuffer
-				, renderer::MemoryPropertyFlag::eHostVisible );
-			updateCmdBuffers = true;
+			const ImDrawList * cmdList = imDrawData->CmdLists[n];
+			memcpy( vtx, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof( ImDrawVert ) );
+			memcpy( idx, cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof( ImDrawIdx ) );
+			vtx += cmdList->VtxBuffer.Size;
+			idx += cmdList->IdxBuffer.Size;
 		}
 
-		if ( auto vtx = m_vertexBuffer->lock( 0u
-			, m_vertexCount
-			, renderer::MemoryMapFlag::eInvalidateRange | renderer::MemoryMapFlag::eWrite ) )
+		if ( !m_persistentMapping )
 		{
-			for ( int n = 0; n < imDrawData->CmdListsCount; n++ )
+			// The written ranges must be visible to the device before the submit.
+			if ( imDrawData->TotalVtxCount )
 			{
-				const ImDrawList * cmdList = imDrawData->CmdLists[n];
-				memcpy( vtx, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof( ImDrawVert ) );
-				vtx += cmdList->VtxBuffer.Size;
+				frame.vertexBuffer->flush( 0u, uint32_t( imDrawData->TotalVtxCount ) );
 			}
 
-			m_vertexBuffer->flush( 0u, m_vertexCount );
-			m_vertexBuffer->unlock();
-		}
-
-		if ( auto idx = m_indexBuffer->lock( 0u
-			, m_indexCount
-			, renderer::MemoryMapFlag::eInvalidateRange | renderer::MemoryMapFlag::eWrite ) )
-		{
-			for ( int n = 0; n < imDrawData->CmdListsCount; n++ )
+			if ( imDrawData->TotalIdxCount )
 			{
-				const ImDrawList * cmdList = imDrawData->CmdLists[n];
-				memcpy( idx, cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof( ImDrawIdx ) );
-				idx += cmdList->IdxBuffer.Size;
+				frame.indexBuffer->flush( 0u, uint32_t( imDrawData->TotalIdxCount ) );
 			}
 
-			m_indexBuffer->flush( 0u, m_indexCount );
-			m_indexBuffer->unlock();
+			doUnmapGeometryBuffers( frame );
 		}
 
-		if ( updateCmdBuffers )
-		{
-			doUpdateCommandBuffers();
-		}
+		// The draw commands follow the overlay content, hence they are recorded each frame.
+		doUpdateCommandBuffer( frame );
 	}
 
 	void Gui::resize( renderer::Extent2D const & size )
@@ -163,28 +171,34 @@ namespace common
 		ImGuiIO & io = ImGui::GetIO();
 		io.DisplaySize = ImVec2( float( size.width ), float( size.height ) );
 		m_size = size;
-		doUpdateCommandBuffers();
+		update();
 	}
 
 	void Gui::submit( renderer::Queue const & queue )
 	{
-		queue.submit( *m_commandBuffer
-			, m_fence.get() );
-		m_fence->wait( renderer::FenceTimeout );
-		m_fence->reset();
+		auto & frame = m_frames[m_frameIndex];
+
+		if ( frame.recorded )
+		{
+			// The fence is only waited when the frame's resources are reused, FramesInFlight frames later.
+			queue.submit( *frame.commandBuffer
+				, frame.fence.get() );
+			frame.pending = true;
+			m_frameIndex = ( m_frameIndex + 1u ) % FramesInFlight;
+		}
 	}
 
-	bool Gui::header( const char *caption )
+	bool Gui::header( const char *caption )const
 	{
 		return ImGui::CollapsingHeader( caption, ImGuiTreeNodeFlags_DefaultOpen );
 	}
 
-	bool Gui::checkBox( const char *caption, bool *value )
+	bool Gui::checkBox( const char *caption, bool *value )const
 	{
 		return ImGui::Checkbox( caption, value );
 	}
 
-	bool Gui::checkBox( const char *caption, int32_t *value )
+	bool Gui::checkBox( const char *caption, int32_t *value )const
 	{
 		bool val = ( *value == 1 );
 		bool res = ImGui::Checkbox( caption, &val );
@@ -192,22 +206,22 @@ namespace common
 		return res;
 	}
 
-	bool Gui::inputFloat( const char *caption, float *value, float step, uint32_t precision )
+	bool Gui::inputFloat( const char *caption, float *value, float step, uint32_t precision )const
 	{
 		return ImGui::InputFloat( caption, value, step, step * 10.0f, precision );
 	}
 
-	bool Gui::sliderFloat( char const * caption, float* value, float min, float max )
+	bool Gui::sliderFloat( char const * caption, float* value, float min, float max )const
 	{
 		return ImGui::SliderFloat( caption, value, min, max );
 	}
 
-	bool Gui::sliderInt( char const * caption, int32_t* value, int32_t min, int32_t max )
+	bool Gui::sliderInt( char const * caption, int32_t* value, int32_t min, int32_t max )const
 	{
 		return ImGui::SliderInt( caption, value, min, max );
 	}
 
-	bool Gui::comboBox( const char *caption, int32_t *itemindex, std::vector<std::string> items )
+	bool Gui::comboBox( const char *caption, int32_t *itemindex, std::vector<std::string> items )const
 	{
 		if ( items.empty() )
 		{
@@ -225,12 +239,12 @@ namespace common
 		return ImGui::Combo( caption, itemindex, &charitems[0], itemCount, itemCount );
 	}
 
-	bool Gui::button( const char *caption )
+	bool Gui::button( const char *caption )const
 	{
 		return ImGui::Button( caption );
 	}
 
-	void Gui::text( const char *formatstr, ... )
+	void Gui::text( const char *formatstr, ... )const
 	{
 		va_list args;
 		va_start( args, formatstr );
@@ -282,7 +296,12 @@ namespace common
 
 		m_commandPool = m_device.createCommandPool( m_device.getGraphicsQueue().getFamilyIndex()
 			, renderer::CommandPoolCreateFlag::eResetCommandBuffer );
-		m_commandBuffer = m_commandPool->createCommandBuffer();
+
+		for ( auto & frame : m_frames )
+		{
+			frame.commandBuffer = m_commandPool->createCommandBuffer();
+			frame.fence = m_device.createFence();
+		}
 
 		renderer::DescriptorSetLayoutBindingArray bindings
 		{
@@ -300,8 +319,6 @@ namespace common
 		m_pipelineLayout = m_device.createPipelineLayout( *m_descriptorSetLayout
 			, range );
 
-		m_fence = m_device.createFence();
-
 		m_vertexLayout = renderer::makeLayout< ImDrawVert >( 0u );
 		m_vertexLayout->createAttribute( 0u, renderer::Format::eR32G32_SFLOAT, offsetof( ImDrawVert, pos ) );
 		m_vertexLayout->createAttribute( 1u, renderer::Format::eR32G32_SFLOAT, offsetof( ImDrawVert, uv ) );
@@ -408,43 +425,131 @@ namespace common
 		} );
 	}
 
-	void Gui::doUpdateCommandBuffers()
+	void Gui::doWaitFrame( Frame & frame )
+	{
+		if ( frame.pending )
+		{
+			frame.fence->wait( renderer::FenceTimeout );
+			frame.fence->reset();
+			frame.pending = false;
+		}
+	}
+
+	void Gui::doUpdateGeometryBuffers( Frame & frame
+		, uint32_t vertexCount
+		, uint32_t indexCount )
+	{
+		// Host coherent memory is written directly by update, without staging.
+		auto flags = renderer::MemoryPropertyFlag::eHostVisible | renderer::MemoryPropertyFlag::eHostCoherent;
+		auto vertexGrows = frame.vertexCapacity < vertexCount || !frame.vertexBuffer;
+		auto indexGrows = frame.indexCapacity < indexCount || !frame.indexBuffer;
+
+		if ( !vertexGrows && !indexGrows )
+		{
+			return;
+		}
+
+		if ( m_persistentMapping )
+		{
+			doUnmapGeometryBuffers( frame );
+		}
+
+		if ( vertexGrows )
+		{
+			frame.vertexCapacity = doGetCapacity( frame.vertexCapacity, vertexCount );
+			frame.vertexBuffer = renderer::makeVertexBuffer< ImDrawVert >( m_device
+				, frame.vertexCapacity
+				, renderer::BufferTargets{ 0u }
+				, flags );
+		}
+
+		if ( indexGrows )
+		{
+			frame.indexCapacity = doGetCapacity( frame.indexCapacity, indexCount );
+			frame.indexBuffer = renderer::makeBuffer< ImDrawIdx >( m_device
+				, frame.indexCapacity
+				, renderer::BufferTarget::eIndexBuffer
+				, flags );
+		}
+
+		if ( m_persistentMapping )
+		{
+			doMapGeometryBuffers( frame, renderer::MemoryMapFlag::eWrite | renderer::MemoryMapFlag::ePersistent );
+		}
+	}
+
+	void Gui::doMapGeometryBuffers( Frame & frame
+		, renderer::MemoryMapFlags flags )
+	{
+		frame.vertexData = frame.vertexBuffer->lock( 0u
+			, frame.vertexCapacity
+			, flags );
+
+		if ( !frame.vertexData )
+		{
+			throw std::runtime_error{ "Couldn't map the overlay vertex buffer" };
+		}
+
+		frame.indexData = frame.indexBuffer->lock( 0u
+			, frame.indexCapacity
+			, flags );
+
+		if ( !frame.indexData )
+		{
+			frame.vertexBuffer->unlock();
+			frame.vertexData = nullptr;
+			throw std::runtime_error{ "Couldn't map the overlay index buffer" };
+		}
+	}
+
+	void Gui::doUnmapGeometryBuffers( Frame & frame )
+	{
+		if ( frame.vertexData )
+		{
+			frame.vertexBuffer->unlock();
+			frame.vertexData = nullptr;
+		}
+
+		if ( frame.indexData )
+		{
+			frame.indexBuffer->unlock();
+			frame.indexData = nullptr;
+		}
+	}
+
+	void Gui::doUpdateCommandBuffer( Frame & frame )
 	{
 		size_t index = 0u;
 		ImGuiIO & io = ImGui::GetIO();
 		m_pushConstants.getData()->scale = utils::Vec2{ 2.0f / io.DisplaySize.x, 2.0f / io.DisplaySize.y };
 		m_pushConstants.getData()->translate = utils::Vec2{ -1.0f };
 
-		if ( m_commandBuffer->begin() )
+		auto & commandBuffer = *frame.commandBuffer;
+
+		if ( commandBuffer.begin() )
 		{
-			m_commandBuffer->memoryBarrier( renderer::PipelineStageFlag::eTransfer
+			commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eTransfer
 				, renderer::PipelineStageFlag::eFragmentShader
 				, m_fontView->makeShaderInputResource( renderer::ImageLayout::eUndefined
 					, 0u ) );
-			m_commandBuffer->memoryBarrier( renderer::PipelineStageFlag::eTransfer
-				, renderer::PipelineStageFlag::eVertexInput
-				, m_vertexBuffer->getBuffer().makeVertexShaderInputResource() );
-			m_commandBuffer->memoryBarrier( renderer::PipelineStageFlag::eTransfer
-				, renderer::PipelineStageFlag::eVertexInput
-				, m_indexBuffer->getBuffer().makeVertexShaderInputResource() );
-			m_commandBuffer->beginRenderPass( *m_renderPass
+			commandBuffer.beginRenderPass( *m_renderPass
 				, *m_frameBuffer
 				, { renderer::ClearColorValue{ 1.0, 1.0, 1.0, 0.0 } }
 				, renderer::SubpassContents::eInline );
-			m_commandBuffer->bindPipeline( *m_pipeline );
-			m_commandBuffer->bindDescriptorSet( *m_descriptorSet
+			commandBuffer.bindPipeline( *m_pipeline );
+			commandBuffer.bindDescriptorSet( *m_descriptorSet
 				, *m_pipelineLayout );
-			m_commandBuffer->bindVertexBuffer( 0u, m_vertexBuffer->getBuffer(), 0u );
-			m_commandBuffer->bindIndexBuffer( m_indexBuffer->getBuffer(), 0u, renderer::IndexType::eUInt16 );
-			m_commandBuffer->setViewport( { uint32_t( ImGui::GetIO().DisplaySize.x )
+			commandBuffer.bindVertexBuffer( 0u, frame.vertexBuffer->getBuffer(), 0u );
+			commandBuffer.bindIndexBuffer( frame.indexBuffer->getBuffer(), 0u, renderer::IndexType::eUInt16 );
+			commandBuffer.setViewport( { uint32_t( ImGui::GetIO().DisplaySize.x )
 				, uint32_t( ImGui::GetIO().DisplaySize.y )
 				, 0
 				, 0 } );
-			m_commandBuffer->setScissor( { 0
+			commandBuffer.setScissor( { 0
 				, 0 
 				, uint32_t( ImGui::GetIO().DisplaySize.x )
 				, uint32_t( ImGui::GetIO().DisplaySize.y ) } );
-			m_commandBuffer->pushConstants( *m_pipelineLayout, m_pushConstants );
+			commandBuffer.pushConstants( *m_pipelineLayout, m_pushConstants );
 			ImDrawData * imDrawData = ImGui::GetDrawData();
 			int32_t vertexOffset = 0;
 			int32_t indexOffset = 0;
@@ -456,27 +561,22 @@ namespace common
 				for ( int32_t k = 0; k < cmdList->CmdBuffer.Size; k++ )
 				{
 					ImDrawCmd const * cmd = &cmdList->CmdBuffer[k];
-					m_commandBuffer->setScissor( {
+					commandBuffer.setScissor( {
 						std::max( int32_t( cmd->ClipRect.x ), 0 ),
 						std::max( int32_t( cmd->ClipRect.y ), 0 ),
 						uint32_t( cmd->ClipRect.z - cmd->ClipRect.x ),
 						uint32_t( cmd->ClipRect.w - cmd->ClipRect.y ),
 					} );
-					m_commandBuffer->drawIndexed( cmd->ElemCount, 1u, indexOffset, vertexOffset );
+					commandBuffer.drawIndexed( cmd->ElemCount, 1u, indexOffset, vertexOffset );
 					indexOffset += cmd->ElemCount;
 				}
 
 				vertexOffset += cmdList->VtxBuffer.Size;
 			}
 
-			m_commandBuffer->endRenderPass();
-			m_commandBuffer->memoryBarrier( renderer::PipelineStageFlag::eVertexInput
-				, renderer::PipelineStageFlag::eTransfer
-				, m_vertexBuffer->getBuffer().makeTransferDestination() );
-			m_commandBuffer->memoryBarrier( renderer::PipelineStageFlag::eVertexInput
-				, renderer::PipelineStageFlag::eTransfer
-				, m_indexBuffer->getBuffer().makeTransferDestination() );
-			m_commandBuffer->end();
+			commandBuffer.endRenderPass();
+			commandBuffer.end();
+			frame.recorded = true;
 		}
 	}
 }
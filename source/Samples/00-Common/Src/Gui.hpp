@@ -5,6 +5,8 @@
 
 #include <Buffer/PushConstantsBuffer.hpp>
 
+#include <array>
+
 namespace common
 {
 	class Gui
@@ -12,20 +14,21 @@ namespace common
 	public:
 		Gui( renderer::Device const & device
 			, renderer::Extent2D const & size );
+		~Gui();
 		void updateView( renderer::TextureView const & colourView );
 		void update();
 		void resize( renderer::Extent2D const & size );
 		void submit( renderer::Queue const & queue );
 
-		bool header( char const * caption );
-		bool checkBox( char const * caption, bool * value );
-		bool checkBox( char const * caption, int32_t * value );
-		bool inputFloat( char const * caption, float * value, float step, uint32_t precision );
-		bool sliderFloat( char const * caption, float * value, float min, float max );
-		bool sliderInt( char const * caption, int32_t * value, int32_t min, int32_t max );
-		bool comboBox( char const * caption, int32_t * itemindex, std::vector< std::string > items );
-		bool button( char const * caption );
-		void text( char const * formatstr, ... );
+		bool header( char const * caption )const;
+		bool checkBox( char const * caption, bool * value )const;
+		bool checkBox( char const * caption, int32_t * value )const;
+		bool inputFloat( char const * caption, float * value, float step, uint32_t precision )const;
+		bool sliderFloat( char const * caption, float * value, float min, float max )const;
+		bool sliderInt( char const * caption, int32_t * value, int32_t min, int32_t max )const;
+		bool comboBox( char const * caption, int32_t * itemindex, std::vector< std::string > items )const;
+		bool button( char const * caption )const;
+		void text( char const * formatstr, ... )const;
 
 		inline renderer::TextureView const & getTargetView()const
 		{
@@ -33,9 +36,47 @@ namespace common
 		}
 
 	private:
+		/**
+		*\~english
+		*\brief
+		*	The resources of a frame in flight.
+		*\remarks
+		*	The geometry buffers only grow, geometrically, so that an animated overlay neither reallocates
+		*	nor waits for the previous frame. They are persistently mapped when the renderer supports it
+		*	(RendererFeatures::hasPersistentMapping), or else mapped during the update only.
+		*\~french
+		*\brief
+		*	Les ressources d'une image en cours de rendu.
+		*\remarks
+		*	Les tampons de géométrie ne font que grandir, géométriquement, afin qu'un overlay animé ne réalloue
+		*	ni n'attende l'image précédente. Ils sont mappés de manière persistante quand le renderer le supporte
+		*	(RendererFeatures::hasPersistentMapping), ou sinon pendant la mise à jour seulement.
+		*/
+		struct Frame
+		{
+			renderer::VertexBufferPtr< ImDrawVert > vertexBuffer;
+			renderer::BufferPtr< ImDrawIdx > indexBuffer;
+			ImDrawVert * vertexData{ nullptr };
+			ImDrawIdx * indexData{ nullptr };
+			uint32_t vertexCapacity{ 0u };
+			uint32_t indexCapacity{ 0u };
+			renderer::CommandBufferPtr commandBuffer;
+			renderer::FencePtr fence;
+			bool pending{ false };
+			bool recorded{ false };
+		};
+		static uint32_t constexpr FramesInFlight = 2u;
+
 		void doPrepareResources();
 		void doPreparePipeline();
-		void doUpdateCommandBuffers();
+		void doWaitFrame( Frame & frame );
+		void doUpdateGeometryBuffers( Frame & frame
+			, uint32_t vertexCount
+			, uint32_t indexCount );
+		void doMapGeometryBuffers( Frame & frame
+			, renderer::MemoryMapFlags flags );
+		void doUnmapGeometryBuffers( Frame & frame );
+		void doUpdateCommandBuffer( Frame & frame );
 
 	private:
 		struct PushConstBlock
@@ -45,15 +86,12 @@ namespace common
 		};
 
 		renderer::Device const & m_device;
+		bool m_persistentMapping;
 		renderer::TextureView const * m_colourView{ nullptr };
 		renderer::Extent2D m_size;
 		renderer::PushConstantsBuffer< PushConstBlock > m_pushConstants;
-		renderer::VertexBufferPtr< ImDrawVert > m_vertexBuffer;
-		renderer::BufferPtr< ImDrawIdx > m_indexBuffer;
 		renderer::TexturePtr m_target;
 		renderer::TextureViewPtr m_targetView;
-		uint32_t m_vertexCount = 0;
-		uint32_t m_indexCount = 0;
 
 		renderer::DescriptorSetLayoutPtr m_descriptorSetLayout;
 		renderer::DescriptorSetPoolPtr m_descriptorPool;
@@ -64,8 +102,8 @@ namespace common
 		renderer::VertexLayoutPtr m_vertexLayout;
 		renderer::PipelinePtr m_pipeline;
 		renderer::CommandPoolPtr m_commandPool;
-		renderer::CommandBufferPtr m_commandBuffer;
-		renderer::FencePtr m_fence;
+		std::array< Frame, FramesInFlight > m_frames;
+		uint32_t m_frameIndex{ 0u };
 
 		renderer::TexturePtr m_fontImage;
 		renderer::TextureViewPtr m_fontView;
@@ -0,0 +1,314 @@
+#include "HiZBuffer.hpp"
+
+#include "FileUtils.hpp"
+
+#include <Command/CommandPool.hpp>
+#include <Command/Queue.hpp>
+#include <Core/Device.hpp>
+#include <Descriptor/DescriptorSetLayoutBinding.hpp>
+#include <Image/Texture.hpp>
+#include <Image/TextureView.hpp>
+#include <Pipeline/ShaderStageState.hpp>
+#include <Shader/ShaderModule.hpp>
+#include <Sync/BufferMemoryBarrier.hpp>
+#include <Sync/ImageMemoryBarrier.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace common
+{
+	namespace
+	{
+		static uint32_t constexpr GroupSize = 8u;
+
+		renderer::DescriptorSetLayoutBindingArray doGetBindings()
+		{
+			renderer::DescriptorSetLayoutBindingArray result;
+			result.emplace_back( 0u, renderer::DescriptorType::eCombinedImageSampler, renderer::ShaderStageFlag::eCompute );
+			result.emplace_back( 1u, renderer::DescriptorType::eStorageBuffer, renderer::ShaderStageFlag::eCompute );
+			return result;
+		}
+	}
+
+	HiZBuffer::HiZBuffer( renderer::Device const & device
+		, renderer::DescriptorSetLayoutCache & descriptorCache
+		, renderer::TextureView const & depthView )
+		: m_device{ device }
+		// The OpenGL renderers, with a bottom up clip direction, have a [-1, 1] clip space depth range.
+		, m_glDepthRange{ device.getClipDirection() == renderer::ClipDirection::eBottomUp }
+		, m_sampler{ m_device.createSampler( renderer::WrapMode::eClampToEdge
+			, renderer::WrapMode::eClampToEdge
+			, renderer::WrapMode::eClampToEdge
+			, renderer::Filter::eNearest
+			, renderer::Filter::eNearest ) }
+		, m_descriptorLayout{ descriptorCache.getLayout( doGetBindings() ) }
+		, m_descriptorAllocator{ descriptorCache.getAllocator( m_descriptorLayout ) }
+		, m_fence{ m_device.createFence() }
+	{
+		std::string shadersFolder = getPath( getExecutableDirectory() ) / "share" / "Sample-00-Common" / "Shaders";
+
+		if ( !wxFileExists( shadersFolder / "hiz.comp" ) )
+		{
+			throw std::runtime_error{ "Shader files are missing" };
+		}
+
+		m_pipelineLayout = m_device.createPipelineLayout( m_descriptorLayout );
+		renderer::ShaderStageState stage
+		{
+			m_device.createShaderModule( renderer::ShaderStageFlag::eCompute )
+		};
+		stage.module->loadShader( dumpTextFile( shadersFolder / "hiz.comp" ) );
+		m_pipeline = m_pipelineLayout->createPipeline( std::move( stage ) );
+
+		for ( auto & reduction : m_reductions )
+		{
+			reduction.commandBuffer = m_device.getGraphicsCommandPool().createCommandBuffer();
+		}
+
+		update( depthView );
+	}
+
+	HiZBuffer::~HiZBuffer()
+	{
+		doWaitReduction();
+	}
+
+	void HiZBuffer::update( renderer::TextureView const & depthView )
+	{
+		auto & dimensions = depthView.getTexture().getDimensions();
+		m_size = renderer::Extent2D{ dimensions.width, dimensions.height };
+		m_tilesCount = renderer::Extent2D
+		{
+			( m_size.width + TileSize - 1u ) / TileSize,
+			( m_size.height + TileSize - 1u ) / TileSize,
+		};
+		m_levels.clear();
+		// The commands and buffers of the pending reduction are replaced.
+		doWaitReduction();
+		m_current = 0u;
+
+		// Only the depth aspect can be sampled.
+		auto & depth = depthView.getTexture();
+		m_depthView = depth.createView(
+			{
+				renderer::TextureViewType::e2D,
+				depth.getFormat(),
+				renderer::ComponentMapping{},
+				{
+					renderer::ImageAspectFlag::eDepth,
+					0u,
+					1u,
+					0u,
+					1u,
+				}
+			} );
+
+		for ( auto & reduction : m_reductions )
+		{
+			// The previous set is recycled, the pool would otherwise run out of sets on resize.
+			m_descriptorAllocator.release( std::move( reduction.descriptorSet ) );
+			reduction.tilesBuffer = m_device.createBuffer( uint32_t( m_tilesCount.width * m_tilesCount.height * sizeof( float ) )
+				, renderer::BufferTarget::eStorageBuffer
+				, renderer::MemoryPropertyFlag::eHostVisible | renderer::MemoryPropertyFlag::eHostCoherent );
+			reduction.descriptorSet = m_descriptorAllocator.allocate();
+			reduction.descriptorSet->createBinding( m_descriptorLayout.getBinding( 0u )
+				, *m_depthView
+				, *m_sampler
+				, renderer::ImageLayout::eDepthStencilReadOnlyOptimal );
+			reduction.descriptorSet->createBinding( m_descriptorLayout.getBinding( 1u )
+				, *reduction.tilesBuffer
+				, 0u
+				, reduction.tilesBuffer->getSize() );
+			reduction.descriptorSet->update();
+
+			reduction.commandBuffer->reset();
+			auto & commandBuffer = *reduction.commandBuffer;
+
+			if ( commandBuffer.begin( renderer::CommandBufferUsageFlag::eSimultaneousUse ) )
+			{
+				commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eLateFragmentTests
+					, renderer::PipelineStageFlag::eComputeShader
+					, depthView.makeDepthStencilReadOnly( renderer::ImageLayout::eDepthStencilAttachmentOptimal
+						, renderer::AccessFlag::eDepthStencilAttachmentWrite ) );
+				commandBuffer.bindPipeline( *m_pipeline );
+				commandBuffer.bindDescriptorSet( *reduction.descriptorSet
+					, *m_pipelineLayout
+					, renderer::PipelineBindPoint::eCompute );
+				commandBuffer.dispatch( ( m_tilesCount.width + GroupSize - 1u ) / GroupSize
+					, ( m_tilesCount.height + GroupSize - 1u ) / GroupSize
+					, 1u );
+				commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eComputeShader
+					, renderer::PipelineStageFlag::eHost
+					, reduction.tilesBuffer->makeMemoryTransitionBarrier( renderer::AccessFlag::eHostRead ) );
+				// The next frame renders with the depth buffer.
+				commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eComputeShader
+					, renderer::PipelineStageFlag::eEarlyFragmentTests
+					, depthView.makeDepthStencilAttachment( renderer::ImageLayout::eDepthStencilReadOnlyOptimal
+						, renderer::AccessFlag::eShaderRead ) );
+				commandBuffer.end();
+			}
+		}
+	}
+
+	bool HiZBuffer::generate()
+	{
+		// The fence of the previous reduction is usually signaled already, the frame it follows being presented.
+		auto hasPrevious = m_reducing;
+		doWaitReduction();
+		auto & reduction = m_reductions[m_current];
+		auto & previous = m_reductions[1u - m_current];
+
+		if ( !m_device.getGraphicsQueue().submit( *reduction.commandBuffer, m_fence.get() ) )
+		{
+			return false;
+		}
+
+		m_reducing = true;
+		m_current = 1u - m_current;
+
+		if ( !hasPrevious )
+		{
+			return true;
+		}
+
+		auto count = m_tilesCount.width * m_tilesCount.height;
+
+		if ( auto * mapped = previous.tilesBuffer->lock( 0u
+			, uint32_t( count * sizeof( float ) )
+			, renderer::MemoryMapFlag::eRead ) )
+		{
+			m_levels.resize( 1u );
+			m_levels[0].width = m_tilesCount.width;
+			m_levels[0].height = m_tilesCount.height;
+			m_levels[0].depths.resize( count );
+			std::memcpy( m_levels[0].depths.data(), mapped, count * sizeof( float ) );
+			previous.tilesBuffer->unlock();
+			doBuildLevels();
+			return true;
+		}
+
+		m_levels.clear();
+		return false;
+	}
+
+	bool HiZBuffer::isOccluded( renderer::Mat4 const & matrix
+		, utils::Vec3 const & min
+		, utils::Vec3 const & max )const
+	{
+		if ( m_levels.empty() )
+		{
+			return false;
+		}
+
+		float minX{ std::numeric_limits< float >::max() };
+		float minY{ std::numeric_limits< float >::max() };
+		float maxX{ std::numeric_limits< float >::lowest() };
+		float maxY{ std::numeric_limits< float >::lowest() };
+		float nearest{ std::numeric_limits< float >::max() };
+
+		for ( uint32_t corner = 0u; corner < 8u; ++corner )
+		{
+			auto position = matrix * renderer::Vec4
+			{
+				( corner & 1u ) ? max[0] : min[0],
+				( corner & 2u ) ? max[1] : min[1],
+				( corner & 4u ) ? max[2] : min[2],
+				1.0f
+			};
+
+			if ( position[3] <= std::numeric_limits< float >::epsilon() )
+			{
+				return false;
+			}
+
+			minX = std::min( minX, position[0] / position[3] );
+			minY = std::min( minY, position[1] / position[3] );
+			maxX = std::max( maxX, position[0] / position[3] );
+			maxY = std::max( maxY, position[1] / position[3] );
+			nearest = std::min( nearest, position[2] / position[3] );
+		}
+
+		if ( m_glDepthRange )
+		{
+			nearest = nearest * 0.5f + 0.5f;
+		}
+
+		// The framebuffer rows follow the clip space Y axis, for both clip directions.
+		auto toTile = []( float ndc, uint32_t size )
+		{
+			auto pixel = ( std::max( -1.0f, std::min( 1.0f, ndc ) ) * 0.5f + 0.5f ) * float( size );
+			return std::min( uint32_t( pixel ) / TileSize, ( size - 1u ) / TileSize );
+		};
+		uint32_t firstX = toTile( minX, m_size.width );
+		uint32_t firstY = toTile( minY, m_size.height );
+		uint32_t lastX = toTile( maxX, m_size.width );
+		uint32_t lastY = toTile( maxY, m_size.height );
+
+		// Picks the level where the box covers at most 2x2 texels.
+		size_t level = 0u;
+
+		while ( level + 1u < m_levels.size()
+			&& ( ( lastX >> level ) - ( firstX >> level ) > 1u
+				|| ( lastY >> level ) - ( firstY >> level ) > 1u ) )
+		{
+			++level;
+		}
+
+		auto & lookup = m_levels[level];
+		float farthest{ 0.0f };
+
+		for ( uint32_t y = firstY >> level; y <= ( lastY >> level ); ++y )
+		{
+			for ( uint32_t x = firstX >> level; x <= ( lastX >> level ); ++x )
+			{
+				farthest = std::max( farthest, lookup.depths[y * lookup.width + x] );
+			}
+		}
+
+		return nearest > farthest;
+	}
+
+	void HiZBuffer::doWaitReduction()
+	{
+		if ( m_reducing )
+		{
+			m_fence->wait( renderer::FenceTimeout );
+			m_fence->reset();
+			m_reducing = false;
+		}
+	}
+
+	void HiZBuffer::doBuildLevels()
+	{
+		while ( m_levels.back().width > 1u
+			|| m_levels.back().height > 1u )
+		{
+			auto & previous = m_levels.back();
+			Level level
+			{
+				( previous.width + 1u ) / 2u,
+				( previous.height + 1u ) / 2u,
+			};
+			level.depths.resize( level.width * level.height );
+
+			for ( uint32_t y = 0u; y < level.height; ++y )
+			{
+				for ( uint32_t x = 0u; x < level.width; ++x )
+				{
+					// The odd sizes last column and row have a single source texel.
+					auto srcX = std::min( x * 2u + 1u, previous.width - 1u );
+					auto srcY = std::min( y * 2u + 1u, previous.height - 1u );
+					level.depths[y * level.width + x] = std::max(
+						std::max( previous.depths[y * 2u * previous.width + x * 2u]
+							, previous.depths[y * 2u * previous.width + srcX] )
+						, std::max( previous.depths[srcY * previous.width + x * 2u]
+							, previous.depths[srcY * previous.width + srcX] ) );
+				}
+			}
+
+			m_levels.push_back( std::move( level ) );
+		}
+	}
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Prerequisites.hpp"
+
+#include <Buffer/Buffer.hpp>
+#include <Command/CommandBuffer.hpp>
+#include <Descriptor/DescriptorSet.hpp>
+#include <Descriptor/DescriptorSetLayout.hpp>
+#include <Descriptor/DescriptorSetLayoutCache.hpp>
+#include <Image/Sampler.hpp>
+#include <Image/TextureView.hpp>
+#include <Pipeline/ComputePipeline.hpp>
+#include <Pipeline/PipelineLayout.hpp>
+#include <Sync/Fence.hpp>
+
+#include <array>
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	A hierarchical depth buffer, read back from the GPU, for the CPU occlusion culling.
+	*\remarks
+	*	A compute shader reduces the depth buffer to its farthest depth per tile of TileSize² pixels,
+	*	the coarser levels are then built on the CPU, each texel holding the farthest depth of the 2x2
+	*	texels of the previous level. The tiles are read back with one frame of latency, so the levels tested
+	*	against a frame's nodes come from the depth buffer of two frames before, and the nodes may therefore
+	*	appear two frames late when they get disoccluded.
+	*	Requires compute shaders (RendererFeatures::hasComputeShaders).
+	*\~french
+	*\brief
+	*	Un tampon de profondeur hiérarchique, relu depuis le GPU, pour le culling d'occlusion côté CPU.
+	*\remarks
+	*	Un compute shader réduit le tampon de profondeur à sa profondeur la plus lointaine par tuile de TileSize²
+	*	pixels, les niveaux plus grossiers sont ensuite construits sur le CPU, chaque texel contenant la profondeur
+	*	la plus lointaine des 2x2 texels du niveau précédent. Les tuiles sont relues avec une image de latence, les
+	*	niveaux testés contre les noeuds d'une image viennent donc du tampon de profondeur d'il y a deux images, et
+	*	les noeuds peuvent apparaître avec deux images de retard lorsqu'ils sont désoccultés.
+	*	Nécessite les compute shaders (RendererFeatures::hasComputeShaders).
+	*/
+	class HiZBuffer
+	{
+	public:
+		static uint32_t constexpr TileSize = 16u;
+
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] device
+		*	The logical device.
+		*\param[in] descriptorCache
+		*	The descriptor set layouts cache.
+		*\param[in] depthView
+		*	The depth buffer.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] device
+		*	Le périphérique logique.
+		*\param[in] descriptorCache
+		*	Le cache de layouts de sets de descripteurs.
+		*\param[in] depthView
+		*	Le tampon de profondeur.
+		*/
+		HiZBuffer( renderer::Device const & device
+			, renderer::DescriptorSetLayoutCache & descriptorCache
+			, renderer::TextureView const & depthView );
+		/**
+		*\~english
+		*\brief
+		*	Destructor, waits for the pending reduction.
+		*\~french
+		*\brief
+		*	Destructeur, attend la réduction en cours.
+		*/
+		~HiZBuffer();
+		/**
+		*\~english
+		*\brief
+		*	Recreates the tiles buffers and the reduction commands, the levels are invalidated until the second next generate.
+		*\~french
+		*\brief
+		*	Recrée les tampons de tuiles et les commandes de réduction, les niveaux sont invalidés jusqu'au deuxième prochain generate.
+		*/
+		void update( renderer::TextureView const & depthView );
+		/**
+		*\~english
+		*\brief
+		*	Submits the depth buffer reduction, and builds the levels from the tiles of the previous one.
+		*\remarks
+		*	Must be called once the frame is rendered, the depth buffer being in depth attachment layout.
+		*	The tiles buffers alternate, the previous reduction's tiles are read while the GPU runs this one.
+		*\~french
+		*\brief
+		*	Soumet la réduction du tampon de profondeur, et construit les niveaux à partir des tuiles de la précédente.
+		*\remarks
+		*	Doit être appelée une fois l'image dessinée, le tampon de profondeur étant en layout d'attache de profondeur.
+		*	Les tampons de tuiles alternent, les tuiles de la réduction précédente sont lues pendant que le GPU exécute celle-ci.
+		*/
+		bool generate();
+		/**
+		*\~english
+		*\brief
+		*	Tells if an axis aligned bounding box is hidden behind the last generated depth buffer.
+		*\param[in] matrix
+		*	The box clip space transform, must be the one used by the vertex shader.
+		*\return
+		*	\p false if the levels are not generated, or if the box crosses the camera plane.
+		*\~french
+		*\brief
+		*	Dit si une boîte englobante alignée sur les axes est cachée par le dernier tampon de profondeur généré.
+		*\param[in] matrix
+		*	La transformation de la boîte en espace de clipping, doit être celle utilisée par le vertex shader.
+		*\return
+		*	\p false si les niveaux ne sont pas générés, ou si la boîte traverse le plan de la caméra.
+		*/
+		bool isOccluded( renderer::Mat4 const & matrix
+			, utils::Vec3 const & min
+			, utils::Vec3 const & max )const;
+
+	private:
+		void doWaitReduction();
+		void doBuildLevels();
+
+	private:
+		struct Level
+		{
+			uint32_t width;
+			uint32_t height;
+			std::vector< float > depths;
+		};
+
+		struct Reduction
+		{
+			renderer::BufferBasePtr tilesBuffer;
+			renderer::DescriptorSetPtr descriptorSet;
+			renderer::CommandBufferPtr commandBuffer;
+		};
+
+		renderer::Device const & m_device;
+		bool m_glDepthRange;
+		renderer::Extent2D m_size;
+		renderer::Extent2D m_tilesCount;
+		std::vector< Level > m_levels;
+		renderer::SamplerPtr m_sampler;
+		renderer::TextureViewPtr m_depthView;
+		renderer::DescriptorSetLayout const & m_descriptorLayout;
+		renderer::DescriptorSetAllocator & m_descriptorAllocator;
+		renderer::PipelineLayoutPtr m_pipelineLayout;
+		renderer::ComputePipelinePtr m_pipeline;
+		std::array< Reduction, 2u > m_reductions;
+		uint32_t m_current{ 0u };
+		renderer::FencePtr m_fence;
+		bool m_reducing{ false };
+	};
+}
@@ -0,0 +1,231 @@
+#include "LightBinning.hpp"
+
+#include <Angle.hpp>
+#include <Parallel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace common
+{
+	namespace
+	{
+		static_assert( sizeof( ClustersConfig ) == 240u, "ClustersConfig must match the std140 layout of the clusters shaders" );
+		static_assert( sizeof( PointLight ) == 64u, "PointLight must match the std430 layout of the clusters shaders" );
+		static_assert( sizeof( SpotLight ) == 96u, "SpotLight must match the std430 layout of the clusters shaders" );
+
+		struct Aabb
+		{
+			utils::Vec3 min;
+			utils::Vec3 max;
+		};
+
+		float doGetSliceDepth( ClustersConfig const & config
+			, uint32_t slice )
+		{
+			return config.depthRange[0] * std::exp( config.depthRange[2] * float( slice ) / float( config.gridSize[2] ) );
+		}
+
+		utils::Vec3 doGetViewRay( ClustersConfig const & config
+			, float x
+			, float y )
+		{
+			auto position = config.mtxInvProjection * renderer::Vec4{ x, y, 0.5f, 1.0f };
+			auto depth = -position[2] / position[3];
+			return utils::Vec3
+			{
+				position[0] / position[3] / depth,
+				position[1] / position[3] / depth,
+				-1.0f,
+			};
+		}
+
+		Aabb doGetClusterAabb( ClustersConfig const & config
+			, uint32_t index )
+		{
+			uint32_t x = index % config.gridSize[0];
+			uint32_t y = ( index / config.gridSize[0] ) % config.gridSize[1];
+			uint32_t z = index / ( config.gridSize[0] * config.gridSize[1] );
+			float ndcX[2]
+			{
+				float( x ) / float( config.gridSize[0] ) * 2.0f - 1.0f,
+				float( x + 1u ) / float( config.gridSize[0] ) * 2.0f - 1.0f,
+			};
+			float ndcY[2]
+			{
+				float( y ) / float( config.gridSize[1] ) * 2.0f - 1.0f,
+				float( y + 1u ) / float( config.gridSize[1] ) * 2.0f - 1.0f,
+			};
+			float depths[2]
+			{
+				doGetSliceDepth( config, z ),
+				doGetSliceDepth( config, z + 1u ),
+			};
+			Aabb result
+			{
+				utils::Vec3{ std::numeric_limits< float >::max(), std::numeric_limits< float >::max(), std::numeric_limits< float >::max() },
+				utils::Vec3{ std::numeric_limits< float >::lowest(), std::numeric_limits< float >::lowest(), std::numeric_limits< float >::lowest() },
+			};
+
+			for ( uint32_t i = 0u; i < 4u; ++i )
+			{
+				auto ray = doGetViewRay( config, ndcX[i & 1u], ndcY[( i & 2u ) >> 1u] );
+
+				for ( auto depth : depths )
+				{
+					for ( size_t c = 0u; c < 3u; ++c )
+					{
+						result.min[c] = std::min( result.min[c], ray[c] * depth );
+						result.max[c] = std::max( result.max[c], ray[c] * depth );
+					}
+				}
+			}
+
+			return result;
+		}
+
+		renderer::Vec4 doGetViewSphere( ClustersConfig const & config
+			, PointLight const & light )
+		{
+			auto position = config.mtxView * renderer::Vec4{ light.position[0], light.position[1], light.position[2], 1.0f };
+			return renderer::Vec4{ position[0], position[1], position[2], light.position[3] };
+		}
+
+		bool doIntersects( Aabb const & aabb
+			, renderer::Vec4 const & sphere )
+		{
+			float distance = 0.0f;
+
+			for ( size_t c = 0u; c < 3u; ++c )
+			{
+				auto offset = std::min( std::max( sphere[c], aabb.min[c] ), aabb.max[c] ) - sphere[c];
+				distance += offset * offset;
+			}
+
+			return distance <= sphere[3] * sphere[3];
+		}
+	}
+
+	float LightBinning::getRange( PointLight const & light )
+	{
+		// Solves constant + linear * d + quadratic * d² = 256 * intensity.
+		auto intensity = light.base.intensities[0]
+			* std::max( light.base.colour[0], std::max( light.base.colour[1], light.base.colour[2] ) );
+		auto constant = light.attenation[0] - 256.0f * intensity;
+		auto linear = light.attenation[1];
+		auto quadratic = light.attenation[2];
+
+		if ( constant >= 0.0f )
+		{
+			return 0.0f;
+		}
+
+		if ( quadratic > 0.0f )
+		{
+			return ( -linear + std::sqrt( linear * linear - 4.0f * quadratic * constant ) ) / ( 2.0f * quadratic );
+		}
+
+		if ( linear > 0.0f )
+		{
+			return -constant / linear;
+		}
+
+		return std::numeric_limits< float >::max();
+	}
+
+	renderer::UInt32Array LightBinning::binLights( ClustersConfig const & config
+		, PointLightArray const & pointLights
+		, SpotLightArray const & spotLights )
+	{
+		auto count = config.gridSize[0] * config.gridSize[1] * config.gridSize[2];
+		auto clusterSize = config.gridSize[3] + 1u;
+		renderer::UInt32Array result( count * clusterSize, 0u );
+		std::vector< renderer::Vec4 > spheres;
+		spheres.reserve( pointLights.size() + spotLights.size() );
+
+		for ( auto & light : pointLights )
+		{
+			spheres.push_back( doGetViewSphere( config, light ) );
+		}
+
+		for ( auto & light : spotLights )
+		{
+			spheres.push_back( doGetViewSphere( config, light.base ) );
+		}
+
+		utils::parallelFor( count
+			, 64u
+			, [&config, &spheres, &result, &pointLights, clusterSize]( size_t begin, size_t end )
+			{
+				for ( auto index = begin; index < end; ++index )
+				{
+					auto aabb = doGetClusterAabb( config, uint32_t( index ) );
+					auto cluster = result.data() + index * clusterSize;
+					uint32_t lights = 0u;
+
+					for ( uint32_t i = 0u; i < spheres.size() && lights < config.gridSize[3]; ++i )
+					{
+						if ( doIntersects( aabb, spheres[i] ) )
+						{
+							cluster[1u + lights] = i < pointLights.size()
+								? i
+								: ( i - uint32_t( pointLights.size() ) ) | SpotLightFlag;
+							++lights;
+						}
+					}
+
+					cluster[0] = lights;
+				}
+			} );
+		return result;
+	}
+
+	void generateLights( utils::Vec3 const & center
+		, float radius
+		, uint32_t count
+		, PointLightArray & pointLights
+		, SpotLightArray & spotLights )
+	{
+		static float const GoldenAngle = float( utils::Pi ) * ( 3.0f - std::sqrt( 5.0f ) );
+
+		for ( uint32_t i = 0u; i < count; ++i )
+		{
+			// Fibonacci sphere.
+			auto y = 1.0f - 2.0f * ( float( i ) + 0.5f ) / float( count );
+			auto ring = std::sqrt( 1.0f - y * y );
+			auto angle = GoldenAngle * float( i );
+			utils::Vec3 direction{ ring * std::cos( angle ), y, ring * std::sin( angle ) };
+			auto hue = float( i ) / float( count ) * 6.0f;
+			PointLight light
+			{
+				{
+					utils::Vec4
+					{
+						std::min( 1.0f, std::max( 0.0f, std::abs( hue - 3.0f ) - 1.0f ) ),
+						std::min( 1.0f, std::max( 0.0f, 2.0f - std::abs( hue - 2.0f ) ) ),
+						std::min( 1.0f, std::max( 0.0f, 2.0f - std::abs( hue - 4.0f ) ) ),
+						1.0f
+					},
+					utils::Vec4{ 2.0f, 1.0f, 0.0f, 0.0f }
+				},
+				utils::Vec4{ center[0] + direction[0] * radius, center[1] + direction[1] * radius, center[2] + direction[2] * radius, 0.0f },
+				utils::Vec4{ 1.0f, 0.0f, 400.0f, 0.0f }
+			};
+
+			if ( i % 8u == 7u )
+			{
+				spotLights.push_back( SpotLight
+				{
+					light,
+					utils::Vec4{ -direction[0], -direction[1], -direction[2], 0.0f },
+					utils::Vec4{ 0.9f, 2.0f, 0.0f, 0.0f }
+				} );
+			}
+			else
+			{
+				pointLights.push_back( light );
+			}
+		}
+	}
+}
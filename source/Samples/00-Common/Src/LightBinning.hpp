@@ -0,0 +1,144 @@
+#pragma once
+
+#include <Utils/Mat4.hpp>
+
+#include <Vec3.hpp>
+
+namespace common
+{
+	static uint32_t constexpr MAX_LIGHTS = 10u;
+
+	/**
+	*\~english
+	*\name Lighting.
+	*\~french
+	*\name Eclairage.
+	*/
+	/**\{*/
+	struct Light
+	{
+		utils::Vec4 colour;
+		utils::Vec4 intensities;
+	};
+
+	struct DirectionalLight
+	{
+		Light base;
+		utils::Vec4 direction;
+	};
+
+	struct PointLight
+	{
+		Light base;
+		utils::Vec4 position;
+		utils::Vec4 attenation;
+	};
+
+	struct SpotLight
+	{
+		PointLight base;
+		utils::Vec4 direction;
+		utils::Vec4 coeffs;// .x = cutoff (cosine of the cone half angle), .y = exponent
+	};
+
+	struct LightsData
+	{
+		utils::IVec4 lightsCount;
+		DirectionalLight directionalLights[MAX_LIGHTS];
+		PointLight pointLights[MAX_LIGHTS];
+		SpotLight spotLights[MAX_LIGHTS];
+	};
+	/**\}*/
+
+	using PointLightArray = std::vector< PointLight >;
+	using SpotLightArray = std::vector< SpotLight >;
+	/**
+	*\~english
+	*\brief
+	*	The light clusters grid parameters.
+	*\remarks
+	*	Matches the std140 layout of the Clusters uniform buffer, in the binning and lighting shaders.
+	*\~french
+	*\brief
+	*	Les paramètres de la grille de clusters de sources lumineuses.
+	*\remarks
+	*	Correspond à la disposition std140 du tampon uniforme Clusters, dans les shaders de tri et d'éclairage.
+	*/
+	struct ClustersConfig
+	{
+		renderer::Mat4 mtxView;
+		renderer::Mat4 mtxProjection;
+		renderer::Mat4 mtxInvProjection;
+		//!\~english	The clusters count on X, Y, Z, and the maximum lights count per cluster in W.
+		//!\~french		Le nombre de clusters en X, Y, Z, et le nombre maximal de sources par cluster en W.
+		utils::UIVec4 gridSize;
+		//!\~english	The near plane in X, the far plane in Y, log( far / near ) in Z.
+		//!\~french		Le plan proche en X, le plan lointain en Y, log( lointain / proche ) en Z.
+		utils::Vec4 depthRange;
+		//!\~english	The point lights count in X, the spot lights count in Y.
+		//!\~french		Le nombre de sources ponctuelles en X, le nombre de projecteurs en Y.
+		utils::UIVec4 lightsCount;
+	};
+	/**
+	*\~english
+	*\brief
+	*	The light clusters grid, and the CPU reference binning of the lights into it.
+	*\remarks
+	*	Independent from the rendering, see LightClusters for the GPU side.
+	*\~french
+	*\brief
+	*	La grille de clusters de sources lumineuses, et le tri CPU de référence des sources dans celle-ci.
+	*\remarks
+	*	Indépendant du rendu, voir LightClusters pour le côté GPU.
+	*/
+	class LightBinning
+	{
+	public:
+		static uint32_t constexpr GridWidth = 16u;
+		static uint32_t constexpr GridHeight = 9u;
+		static uint32_t constexpr GridDepth = 24u;
+		static uint32_t constexpr MaxLightsPerCluster = 127u;
+		static uint32_t constexpr SpotLightFlag = 0x80000000u;
+
+	public:
+		/**
+		*\~english
+		*\return
+		*	The range of a point light, beyond which its contribution is below 1/256.
+		*	Unbounded for a light without attenuation.
+		*\~french
+		*\return
+		*	La portée d'une source ponctuelle, au-delà de laquelle sa contribution est inférieure à 1/256.
+		*	Non bornée pour une source sans atténuation.
+		*/
+		static float getRange( PointLight const & light );
+		/**
+		*\~english
+		*\brief
+		*	The CPU reference binning, the lights ranges must already be computed.
+		*\return
+		*	The clusters buffer content.
+		*\~french
+		*\brief
+		*	Le tri CPU de référence, les portées des sources doivent déjà être calculées.
+		*\return
+		*	Le contenu du tampon des clusters.
+		*/
+		static renderer::UInt32Array binLights( ClustersConfig const & config
+			, PointLightArray const & pointLights
+			, SpotLightArray const & spotLights );
+	};
+	/**
+	*\~english
+	*\brief
+	*	Generates lights evenly spread on a sphere, with varying colours, one out of eight being a spot light aimed at the sphere center.
+	*\~french
+	*\brief
+	*	Génère des sources lumineuses réparties sur une sphère, de couleurs variées, une sur huit étant un projecteur dirigé vers le centre de la sphère.
+	*/
+	void generateLights( utils::Vec3 const & center
+		, float radius
+		, uint32_t count
+		, PointLightArray & pointLights
+		, SpotLightArray & spotLights );
+}
@@ -0,0 +1,327 @@
+#include "LightClusters.hpp"
+
+#include "FileUtils.hpp"
+
+#include <Command/CommandPool.hpp>
+#include <Command/Queue.hpp>
+#include <Core/Device.hpp>
+#include <Core/Renderer.hpp>
+#include <Descriptor/DescriptorSetLayoutBinding.hpp>
+#include <Pipeline/ShaderStageState.hpp>
+#include <Shader/ShaderModule.hpp>
+#include <Sync/BufferMemoryBarrier.hpp>
+#include <Sync/Fence.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace common
+{
+	namespace
+	{
+		static uint32_t constexpr GroupSize = 64u;
+		static uint32_t constexpr ClustersCount = LightBinning::GridWidth
+			* LightBinning::GridHeight
+			* LightBinning::GridDepth;
+		static uint32_t constexpr ClusterSize = LightBinning::MaxLightsPerCluster + 1u;
+
+		template< typename T >
+		void doUpload( renderer::BufferBase const & buffer
+			, uint32_t offset
+			, T const * data
+			, uint32_t size )
+		{
+			if ( !size )
+			{
+				return;
+			}
+
+			if ( auto * mapped = buffer.lock( offset
+				, size
+				, renderer::MemoryMapFlag::eWrite ) )
+			{
+				std::memcpy( mapped, data, size );
+				buffer.flush( offset, size );
+				buffer.unlock();
+			}
+		}
+	}
+
+	LightClusters::LightClusters( renderer::Device const & device
+		, uint32_t maxLights )
+		: m_device{ device }
+		, m_maxLights{ std::max( 1u, maxLights ) }
+		, m_clustered{ device.getRenderer().getFeatures().hasStorageBuffers }
+		, m_gpuDriven{ m_clustered && device.getRenderer().getFeatures().hasComputeShaders }
+		, m_config{}
+	{
+		auto hostFlags = renderer::MemoryPropertyFlag::eHostVisible | renderer::MemoryPropertyFlag::eHostCoherent;
+		// The staging buffer holds the config, followed by the CPU binned clusters.
+		auto stagingSize = uint32_t( sizeof( ClustersConfig ) );
+
+		if ( m_clustered && !m_gpuDriven )
+		{
+			stagingSize += uint32_t( ClustersCount * ClusterSize * sizeof( uint32_t ) );
+		}
+
+		m_stagingBuffer = m_device.createBuffer( stagingSize
+			, renderer::BufferTarget::eTransferSrc
+			, hostFlags );
+		m_configBuffer = m_device.createBuffer( uint32_t( sizeof( ClustersConfig ) )
+			, renderer::BufferTarget::eUniformBuffer | renderer::BufferTarget::eTransferDst
+			, renderer::MemoryPropertyFlag::eDeviceLocal );
+
+		if ( m_clustered )
+		{
+			m_pointLightsBuffer = m_device.createBuffer( uint32_t( m_maxLights * sizeof( PointLight ) )
+				, renderer::BufferTarget::eStorageBuffer
+				, hostFlags );
+			m_spotLightsBuffer = m_device.createBuffer( uint32_t( m_maxLights * sizeof( SpotLight ) )
+				, renderer::BufferTarget::eStorageBuffer
+				, hostFlags );
+			m_clustersBuffer = m_device.createBuffer( uint32_t( ClustersCount * ClusterSize * sizeof( uint32_t ) )
+				, renderer::BufferTarget::eStorageBuffer | renderer::BufferTarget::eTransferDst
+				, renderer::MemoryPropertyFlag::eDeviceLocal );
+		}
+
+		m_config.gridSize = utils::UIVec4{ LightBinning::GridWidth, LightBinning::GridHeight, LightBinning::GridDepth, LightBinning::MaxLightsPerCluster };
+
+		if ( m_gpuDriven )
+		{
+			doCreateComputePipeline();
+		}
+
+		// Submitted with the frames, on the graphics queue, to be ordered with the passes reading the clusters.
+		m_commandBuffer = m_device.getGraphicsCommandPool().createCommandBuffer();
+		m_fence = m_device.createFence();
+	}
+
+	LightClusters::~LightClusters()
+	{
+		if ( m_binning )
+		{
+			m_fence->wait( renderer::FenceTimeout );
+		}
+	}
+
+	void LightClusters::setLights( PointLightArray const & pointLights
+		, SpotLightArray const & spotLights )
+	{
+		assert( pointLights.size() <= m_maxLights );
+		assert( spotLights.size() <= m_maxLights );
+		m_pointLights = pointLights;
+		m_spotLights = spotLights;
+
+		if ( !m_clustered )
+		{
+			m_pointLights.resize( std::min< size_t >( m_pointLights.size(), MAX_LIGHTS ) );
+			m_spotLights.resize( std::min< size_t >( m_spotLights.size(), MAX_LIGHTS ) );
+		}
+
+		for ( auto & light : m_pointLights )
+		{
+			light.position[3] = LightBinning::getRange( light );
+		}
+
+		for ( auto & light : m_spotLights )
+		{
+			light.base.position[3] = LightBinning::getRange( light.base );
+		}
+
+		m_config.lightsCount = utils::UIVec4{ uint32_t( m_pointLights.size() ), uint32_t( m_spotLights.size() ), 0u, 0u };
+
+		if ( m_clustered )
+		{
+			// The previous frames may still read the lights buffers.
+			m_device.getGraphicsQueue().waitIdle();
+			doUpload( *m_pointLightsBuffer
+				, 0u
+				, m_pointLights.data()
+				, uint32_t( m_pointLights.size() * sizeof( PointLight ) ) );
+			doUpload( *m_spotLightsBuffer
+				, 0u
+				, m_spotLights.data()
+				, uint32_t( m_spotLights.size() * sizeof( SpotLight ) ) );
+		}
+
+		// The grid isn't known before the first update.
+		if ( m_config.depthRange[0] > 0.0f )
+		{
+			doBin();
+		}
+	}
+
+	void LightClusters::update( renderer::Mat4 const & view
+		, renderer::Mat4 const & projection
+		, float nearPlane
+		, float farPlane )
+	{
+		m_config.mtxView = view;
+		m_config.mtxProjection = projection;
+		m_config.mtxInvProjection = renderer::inverse( projection );
+		m_config.depthRange = utils::Vec4{ nearPlane, farPlane, std::log( farPlane / nearPlane ), 0.0f };
+		doBin();
+	}
+
+	void LightClusters::fillDescriptorLayoutBindings( renderer::DescriptorSetLayoutBindingArray & bindings
+		, uint32_t firstBinding
+		, renderer::ShaderStageFlags stages )const
+	{
+		bindings.emplace_back( firstBinding + 0u, renderer::DescriptorType::eUniformBuffer, stages );
+
+		if ( m_clustered )
+		{
+			bindings.emplace_back( firstBinding + 1u, renderer::DescriptorType::eStorageBuffer, stages );
+			bindings.emplace_back( firstBinding + 2u, renderer::DescriptorType::eStorageBuffer, stages );
+			bindings.emplace_back( firstBinding + 3u, renderer::DescriptorType::eStorageBuffer, stages );
+		}
+	}
+
+	void LightClusters::fillDescriptorSet( renderer::DescriptorSetLayout const & descriptorLayout
+		, renderer::DescriptorSet & descriptorSet
+		, uint32_t firstBinding )const
+	{
+		descriptorSet.createBinding( descriptorLayout.getBinding( firstBinding + 0u )
+			, *m_configBuffer
+			, 0u
+			, m_configBuffer->getSize() );
+
+		if ( !m_clustered )
+		{
+			return;
+		}
+
+		descriptorSet.createBinding( descriptorLayout.getBinding( firstBinding + 1u )
+			, *m_pointLightsBuffer
+			, 0u
+			, m_pointLightsBuffer->getSize() );
+		descriptorSet.createBinding( descriptorLayout.getBinding( firstBinding + 2u )
+			, *m_spotLightsBuffer
+			, 0u
+			, m_spotLightsBuffer->getSize() );
+		descriptorSet.createBinding( descriptorLayout.getBinding( firstBinding + 3u )
+			, *m_clustersBuffer
+			, 0u
+			, m_clustersBuffer->getSize() );
+	}
+
+	void LightClusters::fillLights( LightsData & lights )const
+	{
+		if ( !m_clustered )
+		{
+			std::copy( m_pointLights.begin(), m_pointLights.end(), lights.pointLights );
+			std::copy( m_spotLights.begin(), m_spotLights.end(), lights.spotLights );
+		}
+	}
+
+	void LightClusters::doCreateComputePipeline()
+	{
+		std::string shadersFolder = getPath( getExecutableDirectory() ) / "share" / "Sample-00-Common" / "Shaders";
+
+		if ( !wxFileExists( shadersFolder / "light_clusters.comp" ) )
+		{
+			throw std::runtime_error{ "Shader files are missing" };
+		}
+
+		renderer::DescriptorSetLayoutBindingArray bindings;
+		fillDescriptorLayoutBindings( bindings, 0u, renderer::ShaderStageFlag::eCompute );
+		m_descriptorLayout = m_device.createDescriptorSetLayout( std::move( bindings ) );
+		m_descriptorPool = m_descriptorLayout->createPool( 1u );
+		m_descriptorSet = m_descriptorPool->createDescriptorSet();
+		fillDescriptorSet( *m_descriptorLayout, *m_descriptorSet, 0u );
+		m_descriptorSet->update();
+		m_pipelineLayout = m_device.createPipelineLayout( *m_descriptorLayout );
+		renderer::ShaderStageState stage
+		{
+			m_device.createShaderModule( renderer::ShaderStageFlag::eCompute )
+		};
+		stage.module->loadShader( dumpTextFile( shadersFolder / "light_clusters.comp" ) );
+		m_pipeline = m_pipelineLayout->createPipeline( std::move( stage ) );
+	}
+
+	void LightClusters::doBin()
+	{
+		// The staging buffer is reused, so the previous binning must have read it.
+		if ( m_binning )
+		{
+			m_fence->wait( renderer::FenceTimeout );
+			m_fence->reset();
+			m_binning = false;
+		}
+
+		auto configSize = uint32_t( sizeof( ClustersConfig ) );
+		auto clustersSize = uint32_t( ClustersCount * ClusterSize * sizeof( uint32_t ) );
+		doUpload( *m_stagingBuffer
+			, 0u
+			, &m_config
+			, configSize );
+
+		if ( m_clustered && !m_gpuDriven )
+		{
+			auto clusters = LightBinning::binLights( m_config, m_pointLights, m_spotLights );
+			doUpload( *m_stagingBuffer
+				, configSize
+				, clusters.data()
+				, clustersSize );
+		}
+
+		auto & commandBuffer = *m_commandBuffer;
+
+		if ( !commandBuffer.begin( renderer::CommandBufferUsageFlag::eOneTimeSubmit ) )
+		{
+			throw std::runtime_error{ "Lights binning failed." };
+		}
+
+		// The previous frame may still read the config and the clusters.
+		auto readers = renderer::PipelineStageFlag::eVertexShader
+			| renderer::PipelineStageFlag::eFragmentShader
+			| renderer::PipelineStageFlag::eComputeShader;
+		commandBuffer.memoryBarrier( readers
+			, renderer::PipelineStageFlag::eTransfer
+			, m_configBuffer->makeTransferDestination() );
+		commandBuffer.copyBuffer( *m_stagingBuffer
+			, *m_configBuffer
+			, configSize );
+		commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eTransfer
+			, readers
+			, m_configBuffer->makeUniformBufferInput() );
+
+		if ( m_gpuDriven )
+		{
+			commandBuffer.memoryBarrier( readers
+				, renderer::PipelineStageFlag::eComputeShader
+				, m_clustersBuffer->makeMemoryTransitionBarrier( renderer::AccessFlag::eShaderWrite ) );
+			commandBuffer.bindPipeline( *m_pipeline );
+			commandBuffer.bindDescriptorSet( *m_descriptorSet
+				, *m_pipelineLayout
+				, renderer::PipelineBindPoint::eCompute );
+			commandBuffer.dispatch( ( ClustersCount + GroupSize - 1u ) / GroupSize, 1u, 1u );
+			commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eComputeShader
+				, renderer::PipelineStageFlag::eFragmentShader
+				, m_clustersBuffer->makeMemoryTransitionBarrier( renderer::AccessFlag::eShaderRead ) );
+		}
+		else if ( m_clustered )
+		{
+			commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eFragmentShader
+				, renderer::PipelineStageFlag::eTransfer
+				, m_clustersBuffer->makeTransferDestination() );
+			commandBuffer.copyBuffer( *m_stagingBuffer
+				, *m_clustersBuffer
+				, clustersSize
+				, configSize );
+			commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eTransfer
+				, renderer::PipelineStageFlag::eFragmentShader
+				, m_clustersBuffer->makeMemoryTransitionBarrier( renderer::AccessFlag::eShaderRead ) );
+		}
+
+		if ( !commandBuffer.end()
+			|| !m_device.getGraphicsQueue().submit( commandBuffer, m_fence.get() ) )
+		{
+			throw std::runtime_error{ "Lights binning failed." };
+		}
+
+		m_binning = true;
+	}
+}
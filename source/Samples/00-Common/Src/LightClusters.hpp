@@ -0,0 +1,198 @@
+#pragma once
+
+#include "LightBinning.hpp"
+#include "Prerequisites.hpp"
+
+#include <Buffer/Buffer.hpp>
+#include <Command/CommandBuffer.hpp>
+#include <Descriptor/DescriptorSet.hpp>
+#include <Descriptor/DescriptorSetLayout.hpp>
+#include <Descriptor/DescriptorSetPool.hpp>
+#include <Pipeline/ComputePipeline.hpp>
+#include <Pipeline/PipelineLayout.hpp>
+#include <Sync/Fence.hpp>
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	Clustered light culling.
+	*\remarks
+	*	Bins the point and spot lights into a froxel grid (screen tiles, subdivided along the view depth),
+	*	so that the lighting shaders only iterate the lights affecting their cluster.
+	*	Each cluster holds its lights count, followed by LightBinning::MaxLightsPerCluster light indices,
+	*	the spot lights indices being flagged with LightBinning::SpotLightFlag.
+	*	The binning is done in a compute shader, or by the CPU reference implementation (LightBinning::binLights)
+	*	when compute shaders are not supported (RendererFeatures::hasComputeShaders).
+	*	It is submitted to the graphics queue, before the frame using it, and the Clusters uniform buffer
+	*	is copied from a staging buffer in the same command buffer, so neither waits for the previous frame.
+	*	Without storage buffers support (RendererFeatures::hasStorageBuffers), the lights are not clustered:
+	*	only the MAX_LIGHTS first point and spot lights are kept, in the lights UBO (see fillLights),
+	*	and each fragment processes all of them.
+	*\~french
+	*\brief
+	*	Culling des sources lumineuses par clusters.
+	*\remarks
+	*	Trie les sources ponctuelles et les projecteurs dans une grille de froxels (tuiles de l'écran, subdivisées
+	*	selon la profondeur), afin que les shaders d'éclairage ne parcourent que les sources affectant leur cluster.
+	*	Chaque cluster contient son nombre de sources, suivi de LightBinning::MaxLightsPerCluster indices de sources,
+	*	les indices des projecteurs étant marqués par LightBinning::SpotLightFlag.
+	*	Le tri est effectué dans un compute shader, ou par l'implémentation CPU de référence (LightBinning::binLights)
+	*	quand les compute shaders ne sont pas supportés (RendererFeatures::hasComputeShaders).
+	*	Il est soumis à la file graphique, avant l'image l'utilisant, et le tampon uniforme Clusters
+	*	est copié depuis un tampon de transfert dans le même tampon de commandes, aucun n'attend donc l'image précédente.
+	*	Sans support des storage buffers (RendererFeatures::hasStorageBuffers), les sources ne sont pas triées :
+	*	seules les MAX_LIGHTS premières sources ponctuelles et projecteurs sont gardées, dans l'UBO des sources (voir fillLights),
+	*	et chaque fragment les traite toutes.
+	*/
+	class LightClusters
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] device
+		*	The logical device.
+		*\param[in] maxLights
+		*	The maximum count of each light type.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] device
+		*	Le périphérique logique.
+		*\param[in] maxLights
+		*	Le nombre maximal de sources de chaque type.
+		*/
+		LightClusters( renderer::Device const & device
+			, uint32_t maxLights );
+		/**
+		*\~english
+		*\brief
+		*	Destructor, waits for the last binning.
+		*\~french
+		*\brief
+		*	Destructeur, attend le dernier tri.
+		*/
+		~LightClusters();
+		/**
+		*\~english
+		*\brief
+		*	Sets the lights, their range is computed and stored in their position's W component.
+		*\remarks
+		*	Waits for the graphics queue to be idle, since the previous lights may still be read.
+		*	Without clustering, only the MAX_LIGHTS first lights of each type are kept.
+		*\~french
+		*\brief
+		*	Définit les sources lumineuses, leur portée est calculée et stockée dans la composante W de leur position.
+		*\remarks
+		*	Attend que la file graphique soit inactive, les sources précédentes pouvant encore être lues.
+		*	Sans tri, seules les MAX_LIGHTS premières sources de chaque type sont gardées.
+		*/
+		void setLights( PointLightArray const & pointLights
+			, SpotLightArray const & spotLights );
+		/**
+		*\~english
+		*\brief
+		*	Updates the grid for the given camera, and bins the lights.
+		*\remarks
+		*	The lights are binned again by setLights, once the grid is known.
+		*	Only waits for the previous binning, whose staging buffer is reused.
+		*\~french
+		*\brief
+		*	Met à jour la grille pour la caméra donnée, et trie les sources lumineuses.
+		*\remarks
+		*	Les sources sont de nouveau triées par setLights, une fois la grille connue.
+		*	N'attend que le tri précédent, dont le tampon de transfert est réutilisé.
+		*/
+		void update( renderer::Mat4 const & view
+			, renderer::Mat4 const & projection
+			, float nearPlane
+			, float farPlane );
+		/**
+		*\~english
+		*\brief
+		*	Adds the clusters bindings (the Clusters uniform buffer, then the point lights,
+		*	spot lights, and clusters storage buffers) to a descriptor set layout.
+		*	Without clustering, only the Clusters uniform buffer is added.
+		*\~french
+		*\brief
+		*	Ajoute les attaches des clusters (le tampon uniforme Clusters, puis les storage buffers
+		*	des sources ponctuelles, des projecteurs, et des clusters) à un layout de descripteurs.
+		*	Sans tri, seul le tampon uniforme Clusters est ajouté.
+		*/
+		void fillDescriptorLayoutBindings( renderer::DescriptorSetLayoutBindingArray & bindings
+			, uint32_t firstBinding
+			, renderer::ShaderStageFlags stages )const;
+		/**
+		*\~english
+		*\brief
+		*	Writes the clusters bindings added by fillDescriptorLayoutBindings.
+		*\~french
+		*\brief
+		*	Ecrit les attaches des clusters ajoutées par fillDescriptorLayoutBindings.
+		*/
+		void fillDescriptorSet( renderer::DescriptorSetLayout const & descriptorLayout
+			, renderer::DescriptorSet & descriptorSet
+			, uint32_t firstBinding )const;
+		/**
+		*\~english
+		*\brief
+		*	Without clustering, copies the lights to the lights UBO data, which is then read by the clusters shader functions.
+		*\remarks
+		*	The shaders must then be compiled without CLUSTERED_LIGHTS defined.
+		*\~french
+		*\brief
+		*	Sans tri, copie les sources dans les données de l'UBO des sources, lues alors par les fonctions de shader des clusters.
+		*\remarks
+		*	Les shaders doivent alors être compilés sans CLUSTERED_LIGHTS défini.
+		*/
+		void fillLights( LightsData & lights )const;
+		inline bool isClustered()const
+		{
+			return m_clustered;
+		}
+
+		inline bool isGpuDriven()const
+		{
+			return m_gpuDriven;
+		}
+
+		inline uint32_t getPointLightsCount()const
+		{
+			return uint32_t( m_pointLights.size() );
+		}
+
+		inline uint32_t getSpotLightsCount()const
+		{
+			return uint32_t( m_spotLights.size() );
+		}
+
+	private:
+		void doCreateComputePipeline();
+		void doBin();
+
+	private:
+		renderer::Device const & m_device;
+		uint32_t m_maxLights;
+		bool m_clustered;
+		bool m_gpuDriven;
+		ClustersConfig m_config;
+		PointLightArray m_pointLights;
+		SpotLightArray m_spotLights;
+		renderer::BufferBasePtr m_stagingBuffer;
+		renderer::BufferBasePtr m_configBuffer;
+		renderer::BufferBasePtr m_pointLightsBuffer;
+		renderer::BufferBasePtr m_spotLightsBuffer;
+		renderer::BufferBasePtr m_clustersBuffer;
+		renderer::DescriptorSetLayoutPtr m_descriptorLayout;
+		renderer::DescriptorSetPoolPtr m_descriptorPool;
+		renderer::DescriptorSetPtr m_descriptorSet;
+		renderer::PipelineLayoutPtr m_pipelineLayout;
+		renderer::ComputePipelinePtr m_pipeline;
+		renderer::CommandBufferPtr m_commandBuffer;
+		renderer::FencePtr m_fence;
+		bool m_binning{ false };
+	};
+}
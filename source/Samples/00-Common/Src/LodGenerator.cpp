@@ -0,0 +1,354 @@
+#include "LodGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace common
+{
+	namespace
+	{
+		// The faces count ratio between two levels.
+		static float constexpr LodReduction = 0.5f;
+		// Under this faces count, no coarser level is generated.
+		static uint32_t constexpr MinLodFaces = 64u;
+
+		// The symmetric 4x4 matrix summing the squared distances to a set of planes.
+		struct Quadric
+		{
+			std::array< double, 10u > m{};
+
+			void addPlane( utils::Vec3 const & normal, float d )
+			{
+				double p[4]{ normal[0], normal[1], normal[2], d };
+				uint32_t index = 0u;
+
+				for ( uint32_t i = 0u; i < 4u; ++i )
+				{
+					for ( uint32_t j = i; j < 4u; ++j )
+					{
+						m[index++] += p[i] * p[j];
+					}
+				}
+			}
+
+			double evaluate( utils::Vec3 const & position )const
+			{
+				double p[4]{ position[0], position[1], position[2], 1.0 };
+				double result = 0.0;
+				uint32_t index = 0u;
+
+				for ( uint32_t i = 0u; i < 4u; ++i )
+				{
+					for ( uint32_t j = i; j < 4u; ++j )
+					{
+						result += ( i == j ? 1.0 : 2.0 ) * m[index++] * p[i] * p[j];
+					}
+				}
+
+				return std::max( result, 0.0 );
+			}
+
+			Quadric & operator+=( Quadric const & rhs )
+			{
+				for ( size_t i = 0u; i < m.size(); ++i )
+				{
+					m[i] += rhs.m[i];
+				}
+
+				return *this;
+			}
+		};
+
+		struct Collapse
+		{
+			uint32_t from;
+			uint32_t to;
+			double cost;
+		};
+
+		uint32_t doGetIndex( Face const & face, uint32_t corner )
+		{
+			return corner == 0u
+				? face.a
+				: ( corner == 1u ? face.b : face.c );
+		}
+
+		utils::Vec3 doGetNormal( utils::Vec3 const & a
+			, utils::Vec3 const & b
+			, utils::Vec3 const & c )
+		{
+			return utils::cross( b - a, c - a );
+		}
+
+		std::vector< Quadric > doComputeQuadrics( Vertex const * vertices
+			, uint32_t verticesCount
+			, std::vector< Face > const & faces )
+		{
+			std::vector< Quadric > result( verticesCount );
+
+			for ( auto & face : faces )
+			{
+				auto normal = doGetNormal( vertices[face.a].position
+					, vertices[face.b].position
+					, vertices[face.c].position );
+				auto length = utils::length( normal );
+
+				if ( length > 0.0f )
+				{
+					normal = normal / length;
+					Quadric quadric;
+					quadric.addPlane( normal, -utils::dot( normal, vertices[face.a].position ) );
+					result[face.a] += quadric;
+					result[face.b] += quadric;
+					result[face.c] += quadric;
+				}
+			}
+
+			return result;
+		}
+
+		std::vector< uint8_t > doFindLockedVertices( uint32_t verticesCount
+			, std::vector< Face > const & faces )
+		{
+			// The edges not shared by exactly two faces are on an open border, or on a seam split
+			// by the vertices attributes.
+			std::unordered_map< uint64_t, uint32_t > edges;
+
+			for ( auto & face : faces )
+			{
+				for ( uint32_t corner = 0u; corner < 3u; ++corner )
+				{
+					auto a = doGetIndex( face, corner );
+					auto b = doGetIndex( face, ( corner + 1u ) % 3u );
+					++edges[( uint64_t( std::min( a, b ) ) << 32u ) | std::max( a, b )];
+				}
+			}
+
+			std::vector< uint8_t > result( verticesCount, 0u );
+
+			for ( auto & edge : edges )
+			{
+				if ( edge.second != 2u )
+				{
+					result[uint32_t( edge.first >> 32u )] = 1u;
+					result[uint32_t( edge.first & 0xFFFFFFFFu )] = 1u;
+				}
+			}
+
+			return result;
+		}
+
+		bool doFlips( Vertex const * vertices
+			, std::vector< Face > const & faces
+			, uint32_t const * first
+			, uint32_t const * last
+			, Collapse const & collapse )
+		{
+			for ( auto it = first; it != last; ++it )
+			{
+				auto & face = faces[*it];
+
+				if ( face.a == collapse.to
+					|| face.b == collapse.to
+					|| face.c == collapse.to )
+				{
+					// This face disappears with the collapse.
+					continue;
+				}
+
+				auto move = [&collapse, vertices]( uint32_t index )
+				{
+					return vertices[index == collapse.from ? collapse.to : index].position;
+				};
+				auto before = doGetNormal( vertices[face.a].position
+					, vertices[face.b].position
+					, vertices[face.c].position );
+				auto after = doGetNormal( move( face.a ), move( face.b ), move( face.c ) );
+
+				if ( utils::dot( before, after ) <= 0.0f )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void doSimplify( Vertex const * vertices
+			, uint32_t verticesCount
+			, std::vector< uint8_t > const & locked
+			, uint32_t targetCount
+			, std::vector< Quadric > & quadrics
+			, std::vector< Face > & faces
+			, double & maxError )
+		{
+			while ( faces.size() > targetCount )
+			{
+				// The vertices faces, to check the collapses.
+				std::vector< uint32_t > offsets( verticesCount + 1u, 0u );
+
+				for ( auto & face : faces )
+				{
+					++offsets[face.a + 1u];
+					++offsets[face.b + 1u];
+					++offsets[face.c + 1u];
+				}
+
+				for ( uint32_t index = 0u; index < verticesCount; ++index )
+				{
+					offsets[index + 1u] += offsets[index];
+				}
+
+				std::vector< uint32_t > adjacency( offsets.back() );
+				auto fill = offsets;
+
+				for ( uint32_t index = 0u; index < faces.size(); ++index )
+				{
+					adjacency[fill[faces[index].a]++] = index;
+					adjacency[fill[faces[index].b]++] = index;
+					adjacency[fill[faces[index].c]++] = index;
+				}
+
+				std::vector< Collapse > collapses;
+				collapses.reserve( faces.size() * 3u );
+
+				for ( auto & face : faces )
+				{
+					for ( uint32_t corner = 0u; corner < 3u; ++corner )
+					{
+						auto from = doGetIndex( face, corner );
+						auto to = doGetIndex( face, ( corner + 1u ) % 3u );
+
+						for ( auto i = 0u; i < 2u; ++i )
+						{
+							if ( !locked[from] )
+							{
+								auto quadric = quadrics[from];
+								quadric += quadrics[to];
+								collapses.push_back( { from, to, quadric.evaluate( vertices[to].position ) } );
+							}
+
+							std::swap( from, to );
+						}
+					}
+				}
+
+				std::sort( collapses.begin()
+					, collapses.end()
+					, []( Collapse const & lhs, Collapse const & rhs )
+					{
+						return lhs.cost < rhs.cost;
+					} );
+
+				// The collapses of a pass don't share any face, so that each one is checked against the actual surface.
+				std::vector< uint32_t > remap( verticesCount );
+				std::vector< uint8_t > touched( verticesCount, 0u );
+				uint32_t removed = 0u;
+
+				for ( uint32_t index = 0u; index < verticesCount; ++index )
+				{
+					remap[index] = index;
+				}
+
+				for ( auto & collapse : collapses )
+				{
+					if ( faces.size() - removed <= targetCount )
+					{
+						break;
+					}
+
+					auto first = adjacency.data() + offsets[collapse.from];
+					auto last = adjacency.data() + offsets[collapse.from + 1u];
+
+					if ( touched[collapse.from]
+						|| touched[collapse.to]
+						|| doFlips( vertices, faces, first, last, collapse ) )
+					{
+						continue;
+					}
+
+					for ( auto it = first; it != last; ++it )
+					{
+						auto & face = faces[*it];
+						touched[face.a] = 1u;
+						touched[face.b] = 1u;
+						touched[face.c] = 1u;
+						removed += ( face.a == collapse.to || face.b == collapse.to || face.c == collapse.to ) ? 1u : 0u;
+					}
+
+					remap[collapse.from] = collapse.to;
+					quadrics[collapse.to] += quadrics[collapse.from];
+					maxError = std::max( maxError, collapse.cost );
+				}
+
+				if ( !removed )
+				{
+					break;
+				}
+
+				std::vector< Face > result;
+				result.reserve( faces.size() - removed );
+
+				for ( auto & face : faces )
+				{
+					Face remapped{ remap[face.a], remap[face.b], remap[face.c] };
+
+					if ( remapped.a != remapped.b
+						&& remapped.b != remapped.c
+						&& remapped.c != remapped.a )
+					{
+						result.push_back( remapped );
+					}
+				}
+
+				faces = std::move( result );
+			}
+		}
+	}
+
+	void generateLods( Submesh & submesh )
+	{
+		assert( !submesh.vbo.cached && !submesh.ibo.cached );
+		auto vertices = submesh.vbo.getData();
+		auto verticesCount = submesh.vbo.getCount();
+		auto faces = submesh.ibo.data;
+		submesh.lods.clear();
+		submesh.lods.push_back( { 0u, uint32_t( faces.size() ), 0.0f } );
+
+		auto quadrics = doComputeQuadrics( vertices, verticesCount, faces );
+		auto locked = doFindLockedVertices( verticesCount, faces );
+		// The quadrics accumulate the collapsed vertices ones, so the errors are measured against the full resolution surface.
+		double maxError = 0.0;
+
+		while ( submesh.lods.size() < MAX_LODS )
+		{
+			auto previousCount = uint32_t( faces.size() );
+			auto targetCount = uint32_t( float( previousCount ) * LodReduction );
+
+			if ( targetCount < MinLodFaces )
+			{
+				break;
+			}
+
+			doSimplify( vertices
+				, verticesCount
+				, locked
+				, targetCount
+				, quadrics
+				, faces
+				, maxError );
+
+			if ( faces.size() > ( previousCount + targetCount ) / 2u )
+			{
+				// Not worth a level, the remaining vertices are mostly locked.
+				break;
+			}
+
+			submesh.lods.push_back( { uint32_t( submesh.ibo.data.size() )
+				, uint32_t( faces.size() )
+				, float( std::sqrt( maxError ) ) } );
+			submesh.ibo.data.insert( submesh.ibo.data.end(), faces.begin(), faces.end() );
+		}
+	}
+}
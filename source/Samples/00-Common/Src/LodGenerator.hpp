@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Prerequisites.hpp"
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	Generates the levels of detail of a submesh, by edge collapses.
+	*\remarks
+	*	Each level halves the faces count of the previous one, up to MAX_LODS levels, the generation stops earlier
+	*	when the collapses don't reduce the faces count enough. The vertices are collapsed onto one of their neighbours,
+	*	chosen with the quadric error metric, so the levels share the vertex buffer, and their faces are appended
+	*	to the index buffer. The vertices on the open borders and on the attributes seams are never collapsed.
+	*	The submesh buffers must not be cached (VertexBuffer::cached, IndexBuffer::cached).
+	*\~french
+	*\brief
+	*	Génère les niveaux de détail d'un sous-maillage, par fusions d'arêtes.
+	*\remarks
+	*	Chaque niveau divise par deux le nombre de faces du précédent, jusqu'à MAX_LODS niveaux, la génération s'arrête
+	*	plus tôt lorsque les fusions ne réduisent pas assez le nombre de faces. Les sommets sont fusionnés sur l'un de leurs
+	*	voisins, choisi avec la métrique d'erreur quadrique, les niveaux partagent donc le tampon de sommets, et leurs faces
+	*	sont ajoutées au tampon d'indices. Les sommets sur les bords ouverts et sur les coutures d'attributs ne sont jamais fusionnés.
+	*	Les tampons du sous-maillage ne doivent pas être en cache (VertexBuffer::cached, IndexBuffer::cached).
+	*/
+	void generateLods( Submesh & submesh );
+}
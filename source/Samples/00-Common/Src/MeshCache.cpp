@@ -0,0 +1,498 @@
+#include "MeshCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace common
+{
+	namespace
+	{
+		char const CacheMagic[4]{ 'R', 'L', 'M', 'C' };
+		uint32_t constexpr CacheVersion = 3u;
+		// The blobs offsets are aligned so that they can be read in place.
+		uint64_t constexpr BlobAlignment = 16u;
+
+		struct CacheHeader
+		{
+			char magic[4];
+			uint32_t version;
+			uint64_t sourceHash;
+			float rescale;
+			// The structures sizes, so that a layout change invalidates the caches.
+			uint32_t vertexSize;
+			uint32_t materialSize;
+			uint32_t imageCount;
+			uint32_t dependencyCount;
+			uint32_t submeshCount;
+			uint32_t tableSize;
+		};
+
+		struct CacheSubmesh
+		{
+			uint64_t vertexOffset;
+			uint64_t faceOffset;
+			uint32_t vertexCount;
+			uint32_t faceCount;
+			uint32_t hasNormals;
+			uint32_t materialCount;
+			uint32_t lodCount;
+		};
+
+		struct CacheMaterial
+		{
+			MaterialData data;
+			uint32_t hasOpacity;
+			uint32_t textureCount;
+		};
+
+		uint64_t doAlign( uint64_t value )
+		{
+			return ( value + BlobAlignment - 1u ) & ~( BlobAlignment - 1u );
+		}
+
+		std::string doGetRelativePath( std::string const & folder
+			, std::string const & path )
+		{
+			return path.compare( 0u, folder.size(), folder ) == 0
+				? path.substr( std::min( folder.size() + 1u, path.size() ) )
+				: path;
+		}
+		// The structures are written as they are, they are zeroed, padding included,
+		// so that the same object always gives the same cache file.
+		CacheSubmesh doMakeCacheSubmesh( Submesh const & submesh )
+		{
+			CacheSubmesh result;
+			std::memset( &result, 0, sizeof( result ) );
+			result.vertexCount = submesh.vbo.getCount();
+			result.faceCount = submesh.ibo.getCount();
+			result.hasNormals = submesh.vbo.hasNormals ? 1u : 0u;
+			result.materialCount = uint32_t( submesh.materials.size() );
+			result.lodCount = uint32_t( submesh.lods.size() );
+			return result;
+		}
+
+		CacheHeader doMakeCacheHeader( uint64_t sourceHash
+			, float rescale )
+		{
+			CacheHeader result;
+			std::memset( &result, 0, sizeof( result ) );
+			std::memcpy( result.magic, CacheMagic, sizeof( CacheMagic ) );
+			result.version = CacheVersion;
+			result.sourceHash = sourceHash;
+			result.rescale = rescale;
+			result.vertexSize = uint32_t( sizeof( Vertex ) );
+			result.materialSize = uint32_t( sizeof( MaterialData ) );
+			return result;
+		}
+
+		class TableReader
+		{
+		public:
+			TableReader( uint8_t const * data
+				, uint8_t const * end )
+				: m_data{ data }
+				, m_end{ end }
+			{
+			}
+
+			template< typename T >
+			bool read( T & value )
+			{
+				if ( sizeof( T ) > size_t( m_end - m_data ) )
+				{
+					return false;
+				}
+
+				std::memcpy( &value, m_data, sizeof( T ) );
+				m_data += sizeof( T );
+				return true;
+			}
+
+			bool read( std::string & value )
+			{
+				uint32_t size;
+
+				if ( !read( size )
+					|| size > size_t( m_end - m_data ) )
+				{
+					return false;
+				}
+
+				value.assign( reinterpret_cast< char const * >( m_data ), size );
+				m_data += size;
+				return true;
+			}
+
+		private:
+			uint8_t const * m_data;
+			uint8_t const * m_end;
+		};
+
+		template< typename T >
+		void doWrite( renderer::ByteArray & table
+			, T const & value )
+		{
+			auto data = reinterpret_cast< uint8_t const * >( &value );
+			table.insert( table.end(), data, data + sizeof( T ) );
+		}
+
+		void doWrite( renderer::ByteArray & table
+			, std::string const & value )
+		{
+			doWrite( table, uint32_t( value.size() ) );
+			table.insert( table.end(), value.begin(), value.end() );
+		}
+
+		bool doWriteTable( Object const & object
+			, ImagePtrArray const & images
+			, StringArray const & imagePaths
+			, std::vector< std::pair< std::string, uint64_t > > const & dependencies
+			, std::vector< CacheSubmesh > const & submeshes
+			, renderer::ByteArray & table )
+		{
+			table.clear();
+
+			for ( auto & path : imagePaths )
+			{
+				doWrite( table, path );
+			}
+
+			for ( auto & dependency : dependencies )
+			{
+				doWrite( table, dependency.first );
+				doWrite( table, dependency.second );
+			}
+
+			for ( size_t index = 0u; index < object.size(); ++index )
+			{
+				doWrite( table, submeshes[index] );
+
+				for ( auto & lod : object[index].lods )
+				{
+					doWrite( table, lod );
+				}
+
+				for ( auto & material : object[index].materials )
+				{
+					doWrite( table, CacheMaterial
+						{
+							material.data,
+							material.hasOpacity ? 1u : 0u,
+							uint32_t( material.textures.size() ),
+						} );
+
+					for ( auto & texture : material.textures )
+					{
+						auto it = std::find( images.begin(), images.end(), texture );
+
+						if ( it == images.end() )
+						{
+							return false;
+						}
+
+						doWrite( table, uint32_t( std::distance( images.begin(), it ) ) );
+					}
+				}
+			}
+
+			return true;
+		}
+	}
+
+	uint64_t hashFile( std::string const & path )
+	{
+		try
+		{
+			MappedFile file{ path };
+			// 64 bits FNV-1a.
+			uint64_t result = 0xcbf29ce484222325ull;
+
+			for ( auto data = file.getData(), end = data + file.getSize(); data != end; ++data )
+			{
+				result = ( result ^ *data ) * 0x100000001b3ull;
+			}
+
+			return result;
+		}
+		catch ( std::exception & )
+		{
+			return 0u;
+		}
+	}
+
+	bool loadObjectCache( std::string const & folder
+		, std::string const & cacheName
+		, uint64_t sourceHash
+		, float rescale
+		, Object & object
+		, ImagePtrArray & images )
+	{
+		MappedFilePtr file;
+
+		try
+		{
+			file = std::make_shared< MappedFile >( folder / cacheName );
+		}
+		catch ( std::exception & )
+		{
+			return false;
+		}
+
+		auto begin = file->getData();
+		auto end = begin + file->getSize();
+		CacheHeader header;
+
+		if ( file->getSize() < sizeof( header ) )
+		{
+			return false;
+		}
+
+		std::memcpy( &header, begin, sizeof( header ) );
+
+		if ( std::memcmp( header.magic, CacheMagic, sizeof( CacheMagic ) ) != 0
+			|| header.version != CacheVersion
+			|| header.sourceHash != sourceHash
+			|| header.rescale != rescale
+			|| header.vertexSize != sizeof( Vertex )
+			|| header.materialSize != sizeof( MaterialData )
+			|| header.tableSize > file->getSize() - sizeof( header ) )
+		{
+			return false;
+		}
+
+		TableReader reader{ begin + sizeof( header )
+			, begin + sizeof( header ) + header.tableSize };
+		StringArray paths( header.imageCount );
+
+		for ( auto & path : paths )
+		{
+			if ( !reader.read( path ) )
+			{
+				return false;
+			}
+
+			path = folder / path;
+		}
+
+		// The cache is outdated as soon as one of the files read along with the source changed.
+		for ( uint32_t index = 0u; index < header.dependencyCount; ++index )
+		{
+			std::string path;
+			uint64_t hash;
+
+			if ( !reader.read( path )
+				|| !reader.read( hash )
+				|| hashFile( folder / path ) != hash )
+			{
+				return false;
+			}
+		}
+
+		Object result;
+		std::vector< std::vector< uint32_t > > textures;
+
+		for ( uint32_t index = 0u; index < header.submeshCount; ++index )
+		{
+			CacheSubmesh cached;
+
+			if ( !reader.read( cached )
+				|| cached.vertexOffset % BlobAlignment
+				|| cached.faceOffset % BlobAlignment
+				|| cached.vertexOffset > file->getSize()
+				|| cached.faceOffset > file->getSize()
+				|| cached.vertexCount > ( file->getSize() - cached.vertexOffset ) / sizeof( Vertex )
+				|| cached.faceCount > ( file->getSize() - cached.faceOffset ) / sizeof( Face ) )
+			{
+				return false;
+			}
+
+			Submesh submesh;
+			submesh.vbo.hasNormals = cached.hasNormals != 0u;
+			submesh.vbo.cached = reinterpret_cast< Vertex const * >( begin + cached.vertexOffset );
+			submesh.vbo.cachedCount = cached.vertexCount;
+			submesh.ibo.cached = reinterpret_cast< Face const * >( begin + cached.faceOffset );
+			submesh.ibo.cachedCount = cached.faceCount;
+			submesh.file = file;
+
+			if ( cached.lodCount > MAX_LODS )
+			{
+				return false;
+			}
+
+			submesh.lods.resize( cached.lodCount );
+
+			for ( auto & lod : submesh.lods )
+			{
+				if ( !reader.read( lod )
+					|| lod.firstFace > cached.faceCount
+					|| lod.facesCount > cached.faceCount - lod.firstFace )
+				{
+					return false;
+				}
+			}
+
+			for ( uint32_t materialIndex = 0u; materialIndex < cached.materialCount; ++materialIndex )
+			{
+				CacheMaterial material;
+
+				if ( !reader.read( material ) )
+				{
+					return false;
+				}
+
+				submesh.materials.push_back( Material{ material.data, material.hasOpacity != 0u } );
+				textures.emplace_back( material.textureCount );
+
+				for ( auto & texture : textures.back() )
+				{
+					if ( !reader.read( texture )
+						|| texture >= header.imageCount )
+					{
+						return false;
+					}
+				}
+			}
+
+			result.emplace_back( std::move( submesh ) );
+		}
+
+		// The images are only loaded once the whole table is known to be valid.
+		auto loaded = loadImages( paths );
+
+		if ( std::find( loaded.begin(), loaded.end(), nullptr ) != loaded.end() )
+		{
+			return false;
+		}
+
+		auto it = textures.begin();
+
+		for ( auto & submesh : result )
+		{
+			for ( auto & material : submesh.materials )
+			{
+				for ( auto index : *it )
+				{
+					material.textures.push_back( loaded[index] );
+				}
+
+				++it;
+			}
+		}
+
+		images.insert( images.end(), loaded.begin(), loaded.end() );
+		object = std::move( result );
+		return true;
+	}
+
+	void saveObjectCache( std::string const & folder
+		, std::string const & cacheName
+		, uint64_t sourceHash
+		, float rescale
+		, Object const & object
+		, ImagePtrArray const & images
+		, StringArray const & imagePaths
+		, StringArray const & dependencies )
+	{
+		// The images and dependencies paths are stored relative to the folder.
+		StringArray paths;
+		std::vector< std::pair< std::string, uint64_t > > hashes;
+
+		for ( auto & path : imagePaths )
+		{
+			paths.push_back( doGetRelativePath( folder, path ) );
+		}
+
+		for ( auto files : { &imagePaths, &dependencies } )
+		{
+			for ( auto & path : *files )
+			{
+				auto hash = hashFile( path );
+
+				if ( !hash )
+				{
+					std::cerr << "Couldn't write the cache " << cacheName << ": couldn't read " << path << "." << std::endl;
+					return;
+				}
+
+				hashes.emplace_back( doGetRelativePath( folder, path ), hash );
+			}
+		}
+
+		// The table size doesn't depend on the blobs offsets, so it is computed once with null offsets.
+		std::vector< CacheSubmesh > submeshes;
+
+		for ( auto & submesh : object )
+		{
+			submeshes.push_back( doMakeCacheSubmesh( submesh ) );
+		}
+
+		renderer::ByteArray table;
+
+		if ( !doWriteTable( object, images, paths, hashes, submeshes, table ) )
+		{
+			std::cerr << "Couldn't write the cache " << cacheName << ": unknown material image." << std::endl;
+			return;
+		}
+
+		uint64_t offset = doAlign( sizeof( CacheHeader ) + table.size() );
+
+		for ( size_t index = 0u; index < object.size(); ++index )
+		{
+			submeshes[index].vertexOffset = offset;
+			offset = doAlign( offset + object[index].vbo.getCount() * sizeof( Vertex ) );
+			submeshes[index].faceOffset = offset;
+			offset = doAlign( offset + object[index].ibo.getCount() * sizeof( Face ) );
+		}
+
+		doWriteTable( object, images, paths, hashes, submeshes, table );
+		auto header = doMakeCacheHeader( sourceHash, rescale );
+		header.imageCount = uint32_t( paths.size() );
+		header.dependencyCount = uint32_t( hashes.size() );
+		header.submeshCount = uint32_t( object.size() );
+		header.tableSize = uint32_t( table.size() );
+		// The cache is written in a temporary file, then renamed, so that an interrupted write
+		// doesn't leave a truncated cache, which would be mapped on the next launch.
+		auto path = folder / cacheName;
+		auto temporary = path + ".tmp";
+		std::ofstream file{ temporary, std::ios::binary };
+		file.write( reinterpret_cast< char const * >( &header ), sizeof( header ) );
+		file.write( reinterpret_cast< char const * >( table.data() ), std::streamsize( table.size() ) );
+		auto pad = [&file]()
+		{
+			static char const zeroes[BlobAlignment]{};
+			auto position = uint64_t( file.tellp() );
+			file.write( zeroes, std::streamsize( doAlign( position ) - position ) );
+		};
+
+		for ( auto & submesh : object )
+		{
+			pad();
+			file.write( reinterpret_cast< char const * >( submesh.vbo.getData() )
+				, std::streamsize( submesh.vbo.getCount() * sizeof( Vertex ) ) );
+			pad();
+			file.write( reinterpret_cast< char const * >( submesh.ibo.getData() )
+				, std::streamsize( submesh.ibo.getCount() * sizeof( Face ) ) );
+		}
+
+		file.close();
+
+		if ( !file )
+		{
+			std::cerr << "Couldn't write the cache " << cacheName << std::endl;
+			std::remove( temporary.c_str() );
+			return;
+		}
+
+		// The renaming replaces the previous cache at once on POSIX systems, but fails on Windows if it exists.
+		if ( std::rename( temporary.c_str(), path.c_str() ) != 0
+			&& ( std::remove( path.c_str() ) != 0
+				|| std::rename( temporary.c_str(), path.c_str() ) != 0 ) )
+		{
+			std::cerr << "Couldn't replace the cache " << cacheName << std::endl;
+			std::remove( temporary.c_str() );
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "FileUtils.hpp"
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	Computes the hash of a file's content, used to validate the caches built from it.
+	*\return
+	*	0 if the file couldn't be read.
+	*\~french
+	*\brief
+	*	Calcule le hash du contenu d'un fichier, utilisé pour valider les caches construits depuis celui-ci.
+	*\return
+	*	0 si le fichier n'a pas pu être lu.
+	*/
+	uint64_t hashFile( std::string const & path );
+	/**
+	*\~english
+	*\brief
+	*	Loads an object from its cache file.
+	*\remarks
+	*	The cache file is memory mapped, and the submeshes vertex and index buffers point into the mapping,
+	*	their data is thus uploaded straight from the file.
+	*	The object's images are loaded and appended to \p images.
+	*\param[in] folder
+	*	The folder containing the cache file, and the images.
+	*\param[in] cacheName
+	*	The cache file name.
+	*\param[in] sourceHash, rescale
+	*	The cache is only used if it was built from a source file with this hash, and with this rescale factor.
+	*	The files read along with the source, such as the materials library and the images, must not have changed either.
+	*\return
+	*	\p false if the cache doesn't exist, is invalid or outdated.
+	*\~french
+	*\brief
+	*	Charge un objet depuis son fichier de cache.
+	*\remarks
+	*	Le fichier de cache est mappé en mémoire, et les tampons de sommets et d'indices des sous-maillages pointent dans le mappage,
+	*	leurs données sont donc envoyées directement depuis le fichier.
+	*	Les images de l'objet sont chargées et ajoutées à \p images.
+	*\param[in] folder
+	*	Le dossier contenant le fichier de cache, et les images.
+	*\param[in] cacheName
+	*	Le nom du fichier de cache.
+	*\param[in] sourceHash, rescale
+	*	Le cache n'est utilisé que s'il a été construit depuis un fichier source ayant ce hash, et avec ce facteur de redimensionnement.
+	*	Les fichiers lus avec la source, tels que la bibliothèque de matériaux et les images, ne doivent pas non plus avoir changé.
+	*\return
+	*	\p false si le cache n'existe pas, est invalide ou périmé.
+	*/
+	bool loadObjectCache( std::string const & folder
+		, std::string const & cacheName
+		, uint64_t sourceHash
+		, float rescale
+		, Object & object
+		, ImagePtrArray & images );
+	/**
+	*\~english
+	*\brief
+	*	Writes an object's cache file.
+	*\remarks
+	*	The vertex and index buffers are written as they are uploaded, with the levels of detail faces.
+	*	The cache file is written next to the final one, then renamed.
+	*\param[in] images, imagePaths
+	*	The images used by the object's materials, and their files paths.
+	*\param[in] dependencies
+	*	The other files read along with the source, their hashes are stored with those of the images.
+	*\~french
+	*\brief
+	*	Ecrit le fichier de cache d'un objet.
+	*\remarks
+	*	Les tampons de sommets et d'indices sont écrits tels qu'ils sont envoyés, avec les faces des niveaux de détail.
+	*	Le fichier de cache est écrit à côté du fichier final, puis renommé.
+	*\param[in] images, imagePaths
+	*	Les images utilisées par les matériaux de l'objet, et les chemins de leurs fichiers.
+	*\param[in] dependencies
+	*	Les autres fichiers lus avec la source, leurs hashs sont stockés avec ceux des images.
+	*/
+	void saveObjectCache( std::string const & folder
+		, std::string const & cacheName
+		, uint64_t sourceHash
+		, float rescale
+		, Object const & object
+		, ImagePtrArray const & images
+		, StringArray const & imagePaths
+		, StringArray const & dependencies );
+}
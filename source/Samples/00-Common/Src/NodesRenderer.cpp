@@ -1,6 +1,7 @@
 #include "NodesRenderer.hpp"
 
 #include "FileUtils.hpp"
+#include "HiZBuffer.hpp"
 #include "RenderTarget.hpp"
 #include "Scene.hpp"
 
@@ -13,7 +14,7 @@
 #include <Descriptor/DescriptorSet.hpp>
 #include <Descriptor/DescriptorSetLayout.hpp>
 #include <Descriptor/DescriptorSetLayoutBinding.hpp>
-#include <Descriptor/DescriptorSetPool.hpp>
+#include <Descriptor/DescriptorSetLayoutCache.hpp>
 #include <Image/Texture.hpp>
 #include <Image/TextureView.hpp>
 #include <Miscellaneous/QueryPool.hpp>
@@ -33,14 +34,34 @@
 #include <Shader/ShaderProgram.hpp>
 #include <Sync/ImageMemoryBarrier.hpp>
 
+#include <Transform.hpp>
+
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace common
 {
 	namespace
 	{
+		std::string doGetFragmentShader( std::string const & fragmentShaderFile
+			, std::vector< std::string > const & defines )
+		{
+			auto result = common::dumpShaderFile( fragmentShaderFile );
+			// The defines must follow the #version directive.
+			auto end = result.find( '\n', result.find( "#version" ) );
+
+			for ( auto & define : defines )
+			{
+				result.insert( end + 1u, "#define " + define + "\n" );
+			}
+
+			return result;
+		}
+
 		std::vector< renderer::ShaderStageState > doCreateObjectProgram( renderer::Device const & device
-			, std::string const & fragmentShaderFile )
+			, std::string const & fragmentShaderFile
+			, std::vector< std::string > const & defines )
 		{
 			std::string shadersFolder = common::getPath( common::getExecutableDirectory() ) / "share" / "Sample-00-Common" / "Shaders";
 
@@ -54,12 +75,13 @@ namespace common
 			result.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eVertex ) } );
 			result.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eFragment ) } );
 			result[0].module->loadShader( common::dumpTextFile( shadersFolder / "object.vert" ) );
-			result[1].module->loadShader( common::dumpTextFile( fragmentShaderFile ) );
+			result[1].module->loadShader( doGetFragmentShader( fragmentShaderFile, defines ) );
 			return result;
 		}
 
 		std::vector< renderer::ShaderStageState > doCreateBillboardProgram( renderer::Device const & device
-			, std::string const & fragmentShaderFile )
+			, std::string const & fragmentShaderFile
+			, std::vector< std::string > const & defines )
 		{
 			std::string shadersFolder = common::getPath( common::getExecutableDirectory() ) / "share" / "Sample-00-Common" / "Shaders";
 
@@ -73,7 +95,7 @@ namespace common
 			result.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eVertex ) } );
 			result.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eFragment ) } );
 			result[0].module->loadShader( common::dumpTextFile( shadersFolder / "billboard.vert" ) );
-			result[1].module->loadShader( common::dumpTextFile( fragmentShaderFile ) );
+			result[1].module->loadShader( doGetFragmentShader( fragmentShaderFile, defines ) );
 			return result;
 		}
 
@@ -141,6 +163,64 @@ namespace common
 			return device.createRenderPass( renderPass );
 		}
 
+		renderer::RenderPassPtr doCreateWeightedBlendedRenderPass( renderer::Device const & device
+			, std::vector< renderer::Format > const & formats )
+		{
+			assert( formats.size() == 3u
+				&& renderer::isDepthOrStencilFormat( formats[0] ) );
+			renderer::RenderPassCreateInfo renderPass;
+			renderPass.subpasses.resize( 1u );
+			// The depth buffer is kept from the opaque nodes.
+			renderPass.attachments.push_back(
+			{
+				formats[0],
+				renderer::SampleCountFlag::e1,
+				renderer::AttachmentLoadOp::eLoad,
+				renderer::AttachmentStoreOp::eStore,
+				renderer::AttachmentLoadOp::eLoad,
+				renderer::AttachmentStoreOp::eStore,
+				renderer::ImageLayout::eDepthStencilAttachmentOptimal,
+				renderer::ImageLayout::eDepthStencilAttachmentOptimal
+			} );
+			renderPass.subpasses[0].depthStencilAttachment = { 0u, renderer::ImageLayout::eDepthStencilAttachmentOptimal };
+
+			// The accumulation and revealage targets are cleared, then sampled by the composite pass.
+			for ( uint32_t index = 1u; index < 3u; ++index )
+			{
+				renderPass.attachments.push_back(
+				{
+					formats[index],
+					renderer::SampleCountFlag::e1,
+					renderer::AttachmentLoadOp::eClear,
+					renderer::AttachmentStoreOp::eStore,
+					renderer::AttachmentLoadOp::eDontCare,
+					renderer::AttachmentStoreOp::eDontCare,
+					renderer::ImageLayout::eUndefined,
+					renderer::ImageLayout::eShaderReadOnlyOptimal
+				} );
+				renderPass.subpasses[0].colorAttachments.emplace_back( renderer::AttachmentReference{ index, renderer::ImageLayout::eColourAttachmentOptimal } );
+			}
+
+			renderPass.dependencies.resize( 2u );
+			renderPass.dependencies[0].srcSubpass = renderer::ExternalSubpass;
+			renderPass.dependencies[0].dstSubpass = 0u;
+			renderPass.dependencies[0].srcStageMask = renderer::PipelineStageFlag::eFragmentShader;
+			renderPass.dependencies[0].dstStageMask = renderer::PipelineStageFlag::eColourAttachmentOutput;
+			renderPass.dependencies[0].srcAccessMask = renderer::AccessFlag::eShaderRead;
+			renderPass.dependencies[0].dstAccessMask = renderer::AccessFlag::eColourAttachmentWrite;
+			renderPass.dependencies[0].dependencyFlags = renderer::DependencyFlag::eByRegion;
+
+			renderPass.dependencies[1].srcSubpass = 0u;
+			renderPass.dependencies[1].dstSubpass = renderer::ExternalSubpass;
+			renderPass.dependencies[1].srcStageMask = renderer::PipelineStageFlag::eColourAttachmentOutput;
+			renderPass.dependencies[1].dstStageMask = renderer::PipelineStageFlag::eFragmentShader;
+			renderPass.dependencies[1].srcAccessMask = renderer::AccessFlag::eColourAttachmentWrite;
+			renderPass.dependencies[1].dstAccessMask = renderer::AccessFlag::eShaderRead;
+			renderPass.dependencies[1].dependencyFlags = renderer::DependencyFlag::eByRegion;
+
+			return device.createRenderPass( renderPass );
+		}
+
 		renderer::FrameBufferPtr doCreateFrameBuffer( renderer::RenderPass const & renderPass
 			, renderer::TextureViewCRefArray const & views )
 		{
@@ -197,6 +277,111 @@ namespace common
 
 			return result;
 		}
+
+		void doAddBounds( utils::BoundingBoxArrays & bounds
+			, utils::Vec3 const & min
+			, utils::Vec3 const & max )
+		{
+			auto index = bounds.size();
+			bounds.resize( index + 1u );
+			bounds.min.x[index] = min[0];
+			bounds.min.y[index] = min[1];
+			bounds.min.z[index] = min[2];
+			bounds.max.x[index] = max[0];
+			bounds.max.y[index] = max[1];
+			bounds.max.z[index] = max[2];
+		}
+
+		void doCullNodes( renderer::Mat4 const & matrix
+			, utils::BoundingBoxArrays const & bounds
+			, HiZBuffer const * hiZ
+			, utils::ByteArray & visible
+			, CullingCounts & counts )
+		{
+			auto count = bounds.size();
+			auto inside = utils::cullBoundingBoxes( matrix, bounds, visible );
+			counts.frustumCulled += uint32_t( count - inside );
+
+			if ( hiZ )
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					if ( visible[index]
+						&& hiZ->isOccluded( matrix
+							, { bounds.min.x[index], bounds.min.y[index], bounds.min.z[index] }
+							, { bounds.max.x[index], bounds.max.y[index], bounds.max.z[index] } ) )
+					{
+						visible[index] = 0u;
+						--inside;
+						++counts.occlusionCulled;
+					}
+				}
+			}
+
+			counts.visible += uint32_t( inside );
+		}
+
+		float doGetDepth( renderer::Mat4 const & matrix
+			, utils::BoundingBoxArrays const & bounds
+			, size_t index )
+		{
+			// The clip space W of the box centre, its distance along the view axis.
+			return matrix[0][3] * ( bounds.min.x[index] + bounds.max.x[index] ) * 0.5f
+				+ matrix[1][3] * ( bounds.min.y[index] + bounds.max.y[index] ) * 0.5f
+				+ matrix[2][3] * ( bounds.min.z[index] + bounds.max.z[index] ) * 0.5f
+				+ matrix[3][3];
+		}
+
+		uint32_t doSelectLod( std::vector< Lod > const & lods
+			, renderer::Mat4 const & matrix
+			, utils::BoundingBoxArrays const & bounds
+			, size_t index
+			, float pixelsPerUnit
+			, float threshold )
+		{
+			auto depth = doGetDepth( matrix, bounds, index );
+
+			if ( depth <= std::numeric_limits< float >::epsilon() )
+			{
+				return 0u;
+			}
+
+			auto lod = uint32_t( lods.size() - 1u );
+
+			while ( lod > 0u
+				&& lods[lod].error * pixelsPerUnit > threshold * depth )
+			{
+				--lod;
+			}
+
+			return lod;
+		}
+
+		template< typename NodeType >
+		void doEnqueue( std::vector< MaterialNode< NodeType > > const & nodes
+			, renderer::Mat4 const & matrix
+			, utils::BoundingBoxArrays const & bounds
+			, utils::ByteArray const & visible
+			, uint32_t pass
+			, bool backToFront
+			, uint32_t offset
+			, RenderQueue & queue )
+		{
+			for ( size_t index = 0u; index < nodes.size(); ++index )
+			{
+				if ( visible[index] )
+				{
+					auto & node = nodes[index];
+					queue.push( RenderQueue::makeKey( pass
+							, node.pipeline
+							, node.material
+							, node.mesh
+							, doGetDepth( matrix, bounds, index )
+							, backToFront )
+						, offset + uint32_t( index ) );
+				}
+			}
+		}
 	}
 
 	NodesRenderer::NodesRenderer( renderer::Device const & device
@@ -219,11 +404,49 @@ namespace common
 	{
 	}
 
+	NodesRenderer::~NodesRenderer()
+	{
+		if ( m_descriptorCache )
+		{
+			// The sets go back to the shared allocators, for the next renderers.
+			for ( auto & node : m_submeshRenderNodes )
+			{
+				m_descriptorCache->getAllocator( *m_objectDescriptorLayout ).release( std::move( node.descriptorSetUbos ) );
+			}
+
+			for ( auto & node : m_billboardRenderNodes )
+			{
+				m_descriptorCache->getAllocator( *m_billboardDescriptorLayout ).release( std::move( node.descriptorSetUbos ) );
+			}
+
+			for ( auto & texturesSet : m_texturesSets )
+			{
+				m_descriptorCache->getAllocator( *m_texturesDescriptorLayout ).release( std::move( texturesSet.descriptorSet ) );
+			}
+		}
+	}
+
 	void NodesRenderer::update( RenderTarget const & target )
 	{
 		doUpdate( { target.getDepthView(), target.getColourView() } );
 	}
 
+	void NodesRenderer::enableWeightedBlending( std::vector< renderer::Format > const & formats )
+	{
+		assert( m_submeshRenderNodes.empty() && m_billboardRenderNodes.empty()
+			&& "The weighted blending must be enabled before the initialisation" );
+		m_weightedBlending = true;
+		m_fragmentDefines.push_back( "WEIGHTED_BLENDED_OIT" );
+		m_renderPass = doCreateWeightedBlendedRenderPass( m_device, formats );
+	}
+
+	void NodesRenderer::addFragmentDefine( std::string const & define )
+	{
+		assert( m_submeshRenderNodes.empty() && m_billboardRenderNodes.empty()
+			&& "The fragment shader defines must be added before the initialisation" );
+		m_fragmentDefines.push_back( define );
+	}
+
 	bool NodesRenderer::draw( std::chrono::nanoseconds & gpu )const
 	{
 		bool result = m_device.getGraphicsQueue().submit( *m_commandBuffer, nullptr );
@@ -244,15 +467,22 @@ namespace common
 
 	void NodesRenderer::initialise( Scene const & scene
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::TextureNodePtrArray const & textureNodes )
 	{
+		m_descriptorCache = &descriptorCache;
 		m_materialsUbo = doCreateMaterialsUbo( m_device
 			, scene
 			, m_opaqueNodes
 			, m_objectsCount
 			, m_billboardsCount );
 
+		// The scene texture arrays are bound by sets of MAX_TEXTURE_ARRAYS, the materials index them in their set.
+		renderer::DescriptorSetLayoutBindingArray bindings;
+		bindings.emplace_back( 0u, renderer::DescriptorType::eCombinedImageSampler, renderer::ShaderStageFlag::eFragment, MAX_TEXTURE_ARRAYS );
+		m_texturesDescriptorLayout = &descriptorCache.getLayout( std::move( bindings ) );
+
 		uint32_t matIndex = 0u;
 		doInitialiseObject( scene.object
 			, stagingBuffer
@@ -262,6 +492,7 @@ namespace common
 			, stagingBuffer
 			, textureNodes
 			, matIndex );
+		doCreateTexturesSets( textureNodes );
 
 		if ( m_objectsCount || m_billboardsCount )
 		{
@@ -271,8 +502,17 @@ namespace common
 				, renderer::PipelineStageFlag::eFragmentShader );
 		}
 
+		// All the nodes are drawn, at full resolution, until the first culling.
+		m_submeshLods.assign( m_submeshRenderNodes.size(), 0u );
+		m_queue.clear();
+		doEnqueueNodes( renderer::Mat4{}
+			, renderer::Mat4{}
+			, utils::ByteArray( m_submeshRenderNodes.size(), 1u )
+			, utils::ByteArray( m_billboardRenderNodes.size(), 1u )
+			, m_queue );
 		doUpdate( views );
 	}
+
 	void NodesRenderer::doUpdate( renderer::TextureViewCRefArray const & views )
 	{
 		assert( !views.empty() );
@@ -283,9 +523,11 @@ namespace common
 		{
 			m_size = size;
 			m_views.clear();
+			m_clearValues.clear();
 			static renderer::ClearColorValue const colour{ 1.0f, 0.8f, 0.4f, 0.0f };
+			static renderer::ClearColorValue const accumulation{ 0.0f, 0.0f, 0.0f, 0.0f };
+			static renderer::ClearColorValue const revealage{ 1.0f, 1.0f, 1.0f, 1.0f };
 			static renderer::DepthStencilClearValue const depth{ 1.0, 0 };
-			renderer::ClearValueArray clearValues;
 
 			for ( auto & view : views )
 			{
@@ -293,76 +535,313 @@ namespace common
 
 				if ( !renderer::isDepthOrStencilFormat( view.get().getFormat() ) )
 				{
-					clearValues.emplace_back( colour );
+					if ( m_weightedBlending )
+					{
+						m_clearValues.emplace_back( m_clearValues.size() == 1u
+							? accumulation
+							: revealage );
+					}
+					else
+					{
+						m_clearValues.emplace_back( colour );
+					}
 				}
 				else
 				{
-					clearValues.emplace_back( depth );
+					m_clearValues.emplace_back( depth );
 				}
 			}
 
 			m_frameBuffer = doCreateFrameBuffer( *m_renderPass, views );
-			m_commandBuffer->reset();
-			auto & commandBuffer = *m_commandBuffer;
+			doRecordCommandBuffer();
+		}
+	}
+
+	CullingCounts NodesRenderer::cull( renderer::Mat4 const & viewProjection
+		, renderer::Mat4 const & model
+		, HiZBuffer const * hiZ
+		, float lodThreshold )
+	{
+		auto objectMatrix = viewProjection * model;
 
-			if ( commandBuffer.begin( renderer::CommandBufferUsageFlag::eSimultaneousUse ) )
+		if ( m_device.getClipDirection() == renderer::ClipDirection::eBottomUp )
+		{
+			// The OpenGL renderers rendererScalePosition, applied to the object space positions by object.vert.
+			objectMatrix = utils::scale( objectMatrix, utils::Vec3{ 1.0f, -1.0f, 1.0f } );
+		}
+
+		CullingCounts result;
+		utils::ByteArray submeshVisible;
+		utils::ByteArray billboardVisible;
+		doCullNodes( objectMatrix
+			, m_submeshBounds
+			, hiZ
+			, submeshVisible
+			, result );
+		doCullNodes( viewProjection
+			, m_billboardBounds
+			, hiZ
+			, billboardVisible
+			, result );
+
+		// The clip space Y of an object space unit at a depth of 1, the projection scale times the model one,
+		// converted to pixels.
+		auto pixelsPerUnit = 0.5f * float( m_size.height ) * std::sqrt( objectMatrix[0][1] * objectMatrix[0][1]
+			+ objectMatrix[1][1] * objectMatrix[1][1]
+			+ objectMatrix[2][1] * objectMatrix[2][1] );
+		std::vector< uint32_t > lods( m_submeshRenderNodes.size(), 0u );
+
+		for ( size_t index = 0u; index < m_submeshRenderNodes.size(); ++index )
+		{
+			if ( submeshVisible[index] )
 			{
-				commandBuffer.resetQueryPool( *m_queryPool, 0u, 2u );
-				commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eTopOfPipe
-					, *m_queryPool
-					, 0u );
-				commandBuffer.beginRenderPass( *m_renderPass
-					, *m_frameBuffer
-					, clearValues
-					, renderer::SubpassContents::eInline );
+				auto & nodeLods = m_submeshRenderNodes[index].instance->lods;
 
-				for ( auto & node : m_submeshRenderNodes )
+				if ( lodThreshold > 0.0f )
 				{
-					commandBuffer.bindPipeline( *node.pipeline );
-					commandBuffer.setViewport( { size.width
-						, size.height
-						, 0
-						, 0 } );
-					commandBuffer.setScissor( { 0
-						, 0
-						, size.width
-						, size.height } );
-					m_commandBuffer->bindVertexBuffer( 0u, node.instance->vbo->getBuffer(), 0u );
-					m_commandBuffer->bindIndexBuffer( node.instance->ibo->getBuffer(), 0u, renderer::IndexType::eUInt32 );
-					commandBuffer.bindDescriptorSet( *node.descriptorSetUbos
-						, *node.pipelineLayout );
-					commandBuffer.bindDescriptorSet( *node.descriptorSetTextures
-						, *node.pipelineLayout );
-					commandBuffer.drawIndexed( node.instance->ibo->getCount() * 3u );
+					lods[index] = doSelectLod( nodeLods
+						, objectMatrix
+						, m_submeshBounds
+						, index
+						, pixelsPerUnit
+						, lodThreshold );
 				}
 
-				for ( BillboardMaterialNode & node : m_billboardRenderNodes )
+				result.faces += nodeLods[lods[index]].facesCount;
+			}
+		}
+
+		RenderQueue queue;
+		doEnqueueNodes( objectMatrix
+			, viewProjection
+			, submeshVisible
+			, billboardVisible
+			, queue );
+
+		if ( !queue.hasSameOrder( m_queue )
+			|| lods != m_submeshLods )
+		{
+			m_queue = std::move( queue );
+			m_submeshLods = std::move( lods );
+
+			if ( m_frameBuffer )
+			{
+				doRecordCommandBuffer();
+			}
+		}
+
+		return result;
+	}
+
+	uint32_t NodesRenderer::doGetObjectPipeline( bool backFace )
+	{
+		auto it = m_objectPipelines.find( backFace );
+
+		if ( it == m_objectPipelines.end() )
+		{
+			renderer::RasterisationState rasterisationState;
+
+			if ( backFace )
+			{
+				rasterisationState.cullMode = renderer::CullModeFlag::eFront;
+			}
+
+			std::vector< renderer::DynamicState > dynamicStateEnables
+			{
+				renderer::DynamicState::eViewport,
+				renderer::DynamicState::eScissor
+			};
+
+			m_pipelines.push_back( m_objectPipelineLayout->createPipeline(
+			{
+				doCreateObjectProgram( m_device, m_fragmentShaderFile, m_fragmentDefines ),
+				*m_renderPass,
+				renderer::VertexInputState::create( *m_objectVertexLayout ),
+				{ renderer::PrimitiveTopology::eTriangleList },
+				rasterisationState,
+				renderer::MultisampleState{},
+				doCreateBlendState(),
+				dynamicStateEnables,
+				doCreateDepthStencilState()
+			} ) );
+			it = m_objectPipelines.emplace( backFace, uint32_t( m_pipelines.size() - 1u ) ).first;
+		}
+
+		return it->second;
+	}
+
+	uint32_t NodesRenderer::doCreateBillboardPipeline()
+	{
+		renderer::RasterisationState rasterisationState;
+		rasterisationState.cullMode = renderer::CullModeFlag::eNone;
+		std::vector< renderer::DynamicState > dynamicStateEnables
+		{
+			renderer::DynamicState::eViewport,
+			renderer::DynamicState::eScissor
+		};
+
+		m_pipelines.push_back( m_billboardPipelineLayout->createPipeline(
+		{
+			doCreateBillboardProgram( m_device, m_fragmentShaderFile, m_fragmentDefines ),
+			*m_renderPass,
+			renderer::VertexInputState::create( { *m_billboardVertexLayout, *m_billboardInstanceLayout } ),
+			{ renderer::PrimitiveTopology::eTriangleStrip },
+			rasterisationState,
+			renderer::MultisampleState{},
+			doCreateBlendState(),
+			dynamicStateEnables,
+			doCreateDepthStencilState()
+		} ) );
+		return uint32_t( m_pipelines.size() - 1u );
+	}
+
+	void NodesRenderer::doEnqueueNodes( renderer::Mat4 const & objectMatrix
+		, renderer::Mat4 const & billboardMatrix
+		, utils::ByteArray const & submeshVisible
+		, utils::ByteArray const & billboardVisible
+		, RenderQueue & queue )const
+	{
+		auto pass = m_opaqueNodes ? 0u : 1u;
+		// The forward blended nodes are drawn back to front, the other ones grouped by state.
+		auto backToFront = !m_opaqueNodes && !m_weightedBlending;
+		doEnqueue( m_submeshRenderNodes
+			, objectMatrix
+			, m_submeshBounds
+			, submeshVisible
+			, pass
+			, backToFront
+			, 0u
+			, queue );
+		doEnqueue( m_billboardRenderNodes
+			, billboardMatrix
+			, m_billboardBounds
+			, billboardVisible
+			, pass
+			, backToFront
+			, uint32_t( m_submeshRenderNodes.size() )
+			, queue );
+		queue.sort();
+	}
+
+	void NodesRenderer::doRecordCommandBuffer()
+	{
+		m_commandBuffer->reset();
+		auto & commandBuffer = *m_commandBuffer;
+
+		if ( commandBuffer.begin( renderer::CommandBufferUsageFlag::eSimultaneousUse ) )
+		{
+			commandBuffer.resetQueryPool( *m_queryPool, 0u, 2u );
+			commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eTopOfPipe
+				, *m_queryPool
+				, 0u );
+			commandBuffer.beginRenderPass( *m_renderPass
+				, *m_frameBuffer
+				, m_clearValues
+				, renderer::SubpassContents::eInline );
+
+			// The states are only bound when they change between two consecutive draws.
+			uint32_t pipeline{ ~0u };
+			renderer::PipelineLayout const * pipelineLayout{ nullptr };
+			renderer::DescriptorSet const * descriptorSetUbos{ nullptr };
+			renderer::DescriptorSet const * texturesSet{ nullptr };
+			void const * mesh{ nullptr };
+			auto submeshCount = uint32_t( m_submeshRenderNodes.size() );
+
+			auto bindStates = [&]( uint32_t nodePipeline
+				, renderer::PipelineLayout const & nodePipelineLayout
+				, renderer::DescriptorSet const & nodeDescriptorSetUbos
+				, renderer::DescriptorSet const & nodeTexturesSet )
+			{
+				if ( nodePipeline != pipeline )
 				{
-					commandBuffer.bindPipeline( *node.pipeline );
-					commandBuffer.setViewport( { size.width
-						, size.height
-						, 0
-						, 0 } );
-					commandBuffer.setScissor( { 0
-						, 0
-						, size.width
-						, size.height } );
-					m_commandBuffer->bindVertexBuffers( 0u
-						, { node.instance->vbo->getBuffer(), node.instance->instance->getBuffer() }
-						, { 0u, 0u } );
-					commandBuffer.bindDescriptorSet( *node.descriptorSetUbos
-						, *node.pipelineLayout );
-					commandBuffer.bindDescriptorSet( *node.descriptorSetTextures
-						, *node.pipelineLayout );
-					commandBuffer.draw( 4u, node.instance->instance->getCount() );
+					commandBuffer.bindPipeline( *m_pipelines[nodePipeline] );
+
+					if ( pipeline == ~0u )
+					{
+						commandBuffer.setViewport( { m_size.width
+							, m_size.height
+							, 0
+							, 0 } );
+						commandBuffer.setScissor( { 0
+							, 0
+							, m_size.width
+							, m_size.height } );
+					}
+
+					if ( &nodePipelineLayout != pipelineLayout )
+					{
+						// The descriptor sets layouts differ between the objects and the billboards.
+						descriptorSetUbos = nullptr;
+						texturesSet = nullptr;
+						mesh = nullptr;
+						pipelineLayout = &nodePipelineLayout;
+					}
+
+					pipeline = nodePipeline;
 				}
 
-				commandBuffer.endRenderPass();
-				commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eBottomOfPipe
-					, *m_queryPool
-					, 1u );
-				commandBuffer.end();
+				if ( &nodeDescriptorSetUbos != descriptorSetUbos )
+				{
+					commandBuffer.bindDescriptorSet( nodeDescriptorSetUbos
+						, nodePipelineLayout );
+					descriptorSetUbos = &nodeDescriptorSetUbos;
+				}
+
+				if ( &nodeTexturesSet != texturesSet )
+				{
+					commandBuffer.bindDescriptorSet( nodeTexturesSet
+						, nodePipelineLayout );
+					texturesSet = &nodeTexturesSet;
+				}
+			};
+
+			for ( auto & item : m_queue.getItems() )
+			{
+				if ( item.node < submeshCount )
+				{
+					auto & node = m_submeshRenderNodes[item.node];
+					bindStates( node.pipeline
+						, *m_objectPipelineLayout
+						, *node.descriptorSetUbos
+						, *m_texturesSets[node.texturesSet].descriptorSet );
+
+					if ( node.instance.get() != mesh )
+					{
+						commandBuffer.bindVertexBuffer( 0u, node.instance->vbo->getBuffer(), 0u );
+						commandBuffer.bindIndexBuffer( node.instance->ibo->getBuffer(), 0u, renderer::IndexType::eUInt32 );
+						mesh = node.instance.get();
+					}
+
+					auto & lod = node.instance->lods[m_submeshLods[item.node]];
+					commandBuffer.drawIndexed( lod.facesCount * 3u
+						, 1u
+						, lod.firstFace * 3u );
+				}
+				else
+				{
+					auto & node = m_billboardRenderNodes[item.node - submeshCount];
+					bindStates( node.pipeline
+						, *m_billboardPipelineLayout
+						, *node.descriptorSetUbos
+						, *m_texturesSets[node.texturesSet].descriptorSet );
+
+					if ( node.instance.get() != mesh )
+					{
+						commandBuffer.bindVertexBuffers( 0u
+							, { node.instance->vbo->getBuffer(), node.instance->instance->getBuffer() }
+							, { 0u, 0u } );
+						mesh = node.instance.get();
+					}
+
+					commandBuffer.draw( 4u, node.instance->instance->getCount() );
+				}
 			}
+
+			commandBuffer.endRenderPass();
+			commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eBottomOfPipe
+				, *m_queryPool
+				, 1u );
+			commandBuffer.end();
 		}
 	}
 
@@ -378,8 +857,8 @@ namespace common
 				renderer::DescriptorSetLayoutBinding{ 0u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eFragment },
 			};
 			doFillBillboardDescriptorLayoutBindings( bindings );
-			m_billboardDescriptorLayout = m_device.createDescriptorSetLayout( std::move( bindings ) );
-			m_billboardDescriptorPool = m_billboardDescriptorLayout->createPool( m_billboardsCount );
+			m_billboardDescriptorLayout = &m_descriptorCache->getLayout( std::move( bindings ) );
+			auto & descriptorAllocator = m_descriptorCache->getAllocator( *m_billboardDescriptorLayout );
 
 			// Initialise vertex layout.
 			m_billboardVertexLayout = renderer::makeLayout< Vertex >( 0u, renderer::VertexInputRate::eVertex );
@@ -439,9 +918,11 @@ namespace common
 				}
 
 				m_materialsUbo->getData( matIndex ) = material.data;
+				materialNode.texturesSet = doAddTextures( materialNode.textures
+					, m_materialsUbo->getData( matIndex ) );
 
 				// Initialise descriptor set for UBOs
-				materialNode.descriptorSetUbos = m_billboardDescriptorPool->createDescriptorSet( 0u );
+				materialNode.descriptorSetUbos = descriptorAllocator.allocate( 0u );
 				materialNode.descriptorSetUbos->createBinding( m_billboardDescriptorLayout->getBinding( 0u )
 					, *m_materialsUbo
 					, matIndex
@@ -449,65 +930,30 @@ namespace common
 				doFillBillboardDescriptorSet( *m_billboardDescriptorLayout, *materialNode.descriptorSetUbos );
 				materialNode.descriptorSetUbos->update();
 
-				// Initialise descriptor set for textures.
-				renderer::DescriptorSetLayoutBindingArray bindings;
-				bindings.emplace_back( 0u, renderer::DescriptorType::eCombinedImageSampler, renderer::ShaderStageFlag::eFragment, 6u );
-				materialNode.layout = m_device.createDescriptorSetLayout( std::move( bindings ) );
-				materialNode.pool = materialNode.layout->createPool( 1u );
-				materialNode.descriptorSetTextures = materialNode.pool->createDescriptorSet( 1u );
-
-				for ( uint32_t index = 0u; index < material.data.texturesCount; ++index )
-				{
-					materialNode.descriptorSetTextures->createBinding( materialNode.layout->getBinding( 0u, index )
-						, *materialNode.textures[index]->view
-						, *m_sampler
-						, renderer::ImageLayout::eShaderReadOnlyOptimal
-						, index );
-				}
-
-				materialNode.descriptorSetTextures->update();
-				renderer::RasterisationState rasterisationState;
-				rasterisationState.cullMode = renderer::CullModeFlag::eNone;
-
 				// Initialise the pipeline
-				if ( materialNode.layout )
-				{
-					materialNode.pipelineLayout = m_device.createPipelineLayout( { *m_billboardDescriptorLayout, *materialNode.layout } );
-				}
-				else
-				{
-					materialNode.pipelineLayout = m_device.createPipelineLayout( *m_billboardDescriptorLayout );
-				}
+				m_billboardPipelineLayout = m_device.createPipelineLayout( { *m_billboardDescriptorLayout, *m_texturesDescriptorLayout } );
+				materialNode.pipeline = doCreateBillboardPipeline();
+				materialNode.material = matIndex;
+				materialNode.mesh = uint32_t( m_billboardNodes.size() - 1u );
+				m_billboardRenderNodes.emplace_back( std::move( materialNode ) );
 
-				renderer::ColourBlendState blendState;
+				// The quads face the camera, they are bounded by their enclosing sphere.
+				utils::Vec3 min{ std::numeric_limits< float >::max() };
+				utils::Vec3 max{ std::numeric_limits< float >::lowest() };
 
-				for ( auto & attach : m_renderPass->getAttachments() )
+				for ( auto & instance : billboard.list )
 				{
-					if ( !renderer::isDepthOrStencilFormat( attach.format ) )
+					auto radius = 0.5f * std::sqrt( instance.dimensions[0] * instance.dimensions[0]
+						+ instance.dimensions[1] * instance.dimensions[1] );
+
+					for ( auto i = 0u; i < 3u; ++i )
 					{
-						blendState.attachs.push_back( renderer::ColourBlendStateAttachment{} );
+						min[i] = std::min( min[i], instance.offset[i] - radius );
+						max[i] = std::max( max[i], instance.offset[i] + radius );
 					}
 				}
 
-				std::vector< renderer::DynamicState > dynamicStateEnables
-				{
-					renderer::DynamicState::eViewport,
-					renderer::DynamicState::eScissor
-				};
-
-				materialNode.pipeline = materialNode.pipelineLayout->createPipeline( 
-				{
-					doCreateBillboardProgram( m_device, m_fragmentShaderFile ),
-					*m_renderPass,
-					renderer::VertexInputState::create( { *m_billboardVertexLayout, *m_billboardInstanceLayout } ),
-					{ renderer::PrimitiveTopology::eTriangleStrip },
-					rasterisationState,
-					renderer::MultisampleState{},
-					blendState,
-					dynamicStateEnables,
-					renderer::DepthStencilState{}
-				} );
-				m_billboardRenderNodes.emplace_back( std::move( materialNode ) );
+				doAddBounds( m_billboardBounds, min, max );
 				++matIndex;
 			}
 		}
@@ -523,8 +969,8 @@ namespace common
 			renderer::DescriptorSetLayoutBinding{ 0u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eFragment },
 		};
 		doFillObjectDescriptorLayoutBindings( bindings );
-		m_objectDescriptorLayout = m_device.createDescriptorSetLayout( std::move( bindings ) );
-		m_objectDescriptorPool = m_objectDescriptorLayout->createPool( m_objectsCount );
+		m_objectDescriptorLayout = &m_descriptorCache->getLayout( std::move( bindings ) );
+		auto & descriptorAllocator = m_descriptorCache->getAllocator( *m_objectDescriptorLayout );
 
 		// Initialise vertex layout.
 		m_objectVertexLayout = renderer::makeLayout< Vertex >( 0u );
@@ -533,6 +979,7 @@ namespace common
 		m_objectVertexLayout->createAttribute( 2u, renderer::Format::eR32G32B32_SFLOAT, offsetof( common::Vertex, tangent ) );
 		m_objectVertexLayout->createAttribute( 3u, renderer::Format::eR32G32B32_SFLOAT, offsetof( common::Vertex, bitangent ) );
 		m_objectVertexLayout->createAttribute( 4u, renderer::Format::eR32G32_SFLOAT, offsetof( common::Vertex, texture ) );
+		m_objectPipelineLayout = m_device.createPipelineLayout( { *m_objectDescriptorLayout, *m_texturesDescriptorLayout } );
 
 		for ( auto & submesh : object )
 		{
@@ -553,19 +1000,41 @@ namespace common
 
 				// Initialise geometry buffers.
 				submeshNode->vbo = renderer::makeVertexBuffer< common::Vertex >( m_device
-					, uint32_t( submesh.vbo.data.size() )
+					, submesh.vbo.getCount()
 					, renderer::BufferTarget::eTransferDst
 					, renderer::MemoryPropertyFlag::eDeviceLocal );
 				stagingBuffer.uploadVertexData( *m_updateCommandBuffer
-					, submesh.vbo.data
+					, reinterpret_cast< uint8_t const * >( submesh.vbo.getData() )
+					, uint32_t( submesh.vbo.getCount() * sizeof( common::Vertex ) )
 					, *submeshNode->vbo );
 				submeshNode->ibo = renderer::makeBuffer< common::Face >( m_device
-					, uint32_t( submesh.ibo.data.size() )
+					, submesh.ibo.getCount()
 					, renderer::BufferTarget::eIndexBuffer | renderer::BufferTarget::eTransferDst
 					, renderer::MemoryPropertyFlag::eDeviceLocal );
 				stagingBuffer.uploadBufferData( *m_updateCommandBuffer
-					, submesh.ibo.data
+					, reinterpret_cast< uint8_t const * >( submesh.ibo.getData() )
+					, uint32_t( submesh.ibo.getCount() * sizeof( common::Face ) )
 					, *submeshNode->ibo );
+				submeshNode->lods = submesh.lods;
+
+				if ( submeshNode->lods.empty() )
+				{
+					submeshNode->lods.push_back( { 0u, submesh.ibo.getCount(), 0.0f } );
+				}
+
+				// The submesh bounds, shared by its material nodes.
+				utils::Vec3 min{ std::numeric_limits< float >::max() };
+				utils::Vec3 max{ std::numeric_limits< float >::lowest() };
+				auto vertices = submesh.vbo.getData();
+
+				for ( auto it = vertices; it != vertices + submesh.vbo.getCount(); ++it )
+				{
+					for ( auto i = 0u; i < 3u; ++i )
+					{
+						min[i] = std::min( min[i], it->position[i] );
+						max[i] = std::max( max[i], it->position[i] );
+					}
+				}
 
 				for ( auto & material : compatibleMaterials )
 				{
@@ -586,9 +1055,11 @@ namespace common
 					}
 
 					m_materialsUbo->getData( matIndex ) = material.data;
+					materialNode.texturesSet = doAddTextures( materialNode.textures
+						, m_materialsUbo->getData( matIndex ) );
 
 					// Initialise descriptor set for UBOs
-					materialNode.descriptorSetUbos = m_objectDescriptorPool->createDescriptorSet( 0u );
+					materialNode.descriptorSetUbos = descriptorAllocator.allocate( 0u );
 					materialNode.descriptorSetUbos->createBinding( m_objectDescriptorLayout->getBinding( 0u )
 						, *m_materialsUbo
 						, matIndex
@@ -596,72 +1067,138 @@ namespace common
 					doFillObjectDescriptorSet( *m_objectDescriptorLayout, *materialNode.descriptorSetUbos );
 					materialNode.descriptorSetUbos->update();
 
-					// Initialise descriptor set for textures.
-					renderer::DescriptorSetLayoutBindingArray bindings;
-					bindings.emplace_back( 0u, renderer::DescriptorType::eCombinedImageSampler, renderer::ShaderStageFlag::eFragment, 6u );
-					materialNode.layout = m_device.createDescriptorSetLayout( std::move( bindings ) );
-					materialNode.pool = materialNode.layout->createPool( 1u );
-					materialNode.descriptorSetTextures = materialNode.pool->createDescriptorSet( 1u );
+					materialNode.pipeline = doGetObjectPipeline( material.data.backFace != 0 );
+					materialNode.material = matIndex;
+					materialNode.mesh = uint32_t( m_submeshNodes.size() - 1u );
+					m_submeshRenderNodes.emplace_back( std::move( materialNode ) );
+					doAddBounds( m_submeshBounds, min, max );
+					++matIndex;
+				}
+			}
+		}
+	}
 
-					for ( uint32_t index = 0u; index < material.data.texturesCount; ++index )
-					{
-						materialNode.descriptorSetTextures->createBinding( materialNode.layout->getBinding( 0u, index )
-							, *materialNode.textures[index]->view
-							, *m_sampler
-							, renderer::ImageLayout::eShaderReadOnlyOptimal
-							, index );
-					}
+	uint32_t NodesRenderer::doAddTextures( TextureNodePtrArray const & textures
+		, MaterialData & materialData )
+	{
+		auto getMissing = [&textures]( TexturesSet const & texturesSet )
+		{
+			std::vector< uint32_t > result;
 
-					materialNode.descriptorSetTextures->update();
-					renderer::RasterisationState rasterisationState;
+			for ( auto & textureNode : textures )
+			{
+				if ( std::find( texturesSet.arrays.begin(), texturesSet.arrays.end(), textureNode->arrayIndex ) == texturesSet.arrays.end()
+					&& std::find( result.begin(), result.end(), textureNode->arrayIndex ) == result.end() )
+				{
+					result.push_back( textureNode->arrayIndex );
+				}
+			}
 
-					if ( material.data.backFace )
-					{
-						rasterisationState.cullMode = renderer::CullModeFlag::eFront;
-					}
+			return result;
+		};
+		auto it = std::find_if( m_texturesSets.begin()
+			, m_texturesSets.end()
+			, [&getMissing]( TexturesSet const & lookup )
+			{
+				return lookup.arrays.size() + getMissing( lookup ).size() <= MAX_TEXTURE_ARRAYS;
+			} );
 
-					// Initialise the pipeline
-					if ( materialNode.layout )
-					{
-						materialNode.pipelineLayout = m_device.createPipelineLayout( { *m_objectDescriptorLayout, *materialNode.layout } );
-					}
-					else
-					{
-						materialNode.pipelineLayout = m_device.createPipelineLayout( *m_objectDescriptorLayout );
-					}
+		if ( it == m_texturesSets.end() )
+		{
+			// A material has at most MAX_TEXTURES arrays, they always fit in a new set.
+			m_texturesSets.emplace_back();
+			it = m_texturesSets.end() - 1;
+		}
 
-					renderer::ColourBlendState blendState;
+		for ( auto arrayIndex : getMissing( *it ) )
+		{
+			it->arrays.push_back( arrayIndex );
+		}
 
-					for ( auto & attach : m_renderPass->getAttachments() )
-					{
-						if ( !renderer::isDepthOrStencilFormat( attach.format ) )
-						{
-							blendState.attachs.push_back( renderer::ColourBlendStateAttachment{} );
-						}
-					}
+		for ( uint32_t index = 0u; index < textures.size(); ++index )
+		{
+			auto & textureNode = *textures[index];
+			auto slot = uint32_t( std::distance( it->arrays.begin()
+				, std::find( it->arrays.begin(), it->arrays.end(), textureNode.arrayIndex ) ) );
+			materialData.textureOperators[index].texture = ( slot << 16u ) | textureNode.layer;
+		}
 
-					std::vector< renderer::DynamicState > dynamicStateEnables
-					{
-						renderer::DynamicState::eViewport,
-						renderer::DynamicState::eScissor
-					};
+		return uint32_t( std::distance( m_texturesSets.begin(), it ) );
+	}
+
+	void NodesRenderer::doCreateTexturesSets( TextureNodePtrArray const & textureNodes )
+	{
+		auto & descriptorAllocator = m_descriptorCache->getAllocator( *m_texturesDescriptorLayout );
 
-					materialNode.pipeline = materialNode.pipelineLayout->createPipeline(
+		for ( auto & texturesSet : m_texturesSets )
+		{
+			texturesSet.descriptorSet = descriptorAllocator.allocate( 1u );
+
+			for ( uint32_t slot = 0u; slot < texturesSet.arrays.size(); ++slot )
+			{
+				auto it = std::find_if( textureNodes.begin()
+					, textureNodes.end()
+					, [&texturesSet, slot]( TextureNodePtr const & lookup )
 					{
-						doCreateObjectProgram( m_device, m_fragmentShaderFile ),
-						*m_renderPass,
-						renderer::VertexInputState::create( *m_objectVertexLayout ),
-						{ renderer::PrimitiveTopology::eTriangleList },
-						rasterisationState,
-						renderer::MultisampleState{},
-						blendState,
-						dynamicStateEnables,
-						renderer::DepthStencilState{}
+						return lookup->arrayIndex == texturesSet.arrays[slot];
 					} );
-					m_submeshRenderNodes.emplace_back( std::move( materialNode ) );
-					++matIndex;
+				assert( it != textureNodes.end() );
+				texturesSet.descriptorSet->createBinding( m_texturesDescriptorLayout->getBinding( 0u, slot )
+					, *( *it )->array->view
+					, *m_sampler
+					, renderer::ImageLayout::eShaderReadOnlyOptimal
+					, slot );
+			}
+
+			texturesSet.descriptorSet->update();
+		}
+	}
+
+	renderer::ColourBlendState NodesRenderer::doCreateBlendState()const
+	{
+		renderer::ColourBlendState result;
+
+		if ( m_weightedBlending )
+		{
+			// Accumulation: the weighted premultiplied colours and the weights are summed.
+			result.attachs.push_back( renderer::ColourBlendStateAttachment{ true
+				, renderer::BlendFactor::eOne
+				, renderer::BlendFactor::eOne
+				, renderer::BlendOp::eAdd
+				, renderer::BlendFactor::eOne
+				, renderer::BlendFactor::eOne
+				, renderer::BlendOp::eAdd } );
+			// Revealage: the product of the fragments transparencies.
+			result.attachs.push_back( renderer::ColourBlendStateAttachment{ true
+				, renderer::BlendFactor::eZero
+				, renderer::BlendFactor::eInvSrcColour
+				, renderer::BlendOp::eAdd
+				, renderer::BlendFactor::eZero
+				, renderer::BlendFactor::eInvSrcAlpha
+				, renderer::BlendOp::eAdd } );
+		}
+		else
+		{
+			for ( auto & attach : m_renderPass->getAttachments() )
+			{
+				if ( !renderer::isDepthOrStencilFormat( attach.format ) )
+				{
+					result.attachs.push_back( renderer::ColourBlendStateAttachment{} );
 				}
 			}
 		}
+
+		return result;
+	}
+
+	renderer::DepthStencilState NodesRenderer::doCreateDepthStencilState()const
+	{
+		if ( m_weightedBlending )
+		{
+			// The transparent fragments are occluded by the opaque ones, but not by each other.
+			return renderer::DepthStencilState{ 0u, true, false };
+		}
+
+		return renderer::DepthStencilState{};
 	}
 }
@@ -1,12 +1,13 @@
 #pragma once
 
 #include "Prerequisites.hpp"
+#include "RenderQueue.hpp"
 
 #include <Buffer/UniformBuffer.hpp>
 #include <Command/CommandBuffer.hpp>
 #include <Descriptor/DescriptorSet.hpp>
 #include <Descriptor/DescriptorSetLayout.hpp>
-#include <Descriptor/DescriptorSetPool.hpp>
+#include <Descriptor/DescriptorSetLayoutCache.hpp>
 #include <Image/Sampler.hpp>
 #include <Miscellaneous/QueryPool.hpp>
 #include <Pipeline/Pipeline.hpp>
@@ -16,6 +17,10 @@
 #include <RenderPass/RenderPass.hpp>
 #include <Shader/ShaderProgram.hpp>
 
+#include <TransformBatch.hpp>
+
+#include <map>
+
 namespace common
 {
 	class NodesRenderer
@@ -26,13 +31,95 @@ namespace common
 			, std::vector< renderer::Format > const & formats
 			, bool clearViews
 			, bool opaqueNodes );
-		virtual ~NodesRenderer() = default;
+		virtual ~NodesRenderer();
 		virtual void update( RenderTarget const & target );
 		bool draw( std::chrono::nanoseconds & gpu )const;
 		void initialise( Scene const & scene
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, TextureNodePtrArray const & textureNodes );
+		/**
+		*\~english
+		*\brief
+		*	Renders the nodes to weighted blended transparency targets, instead of the colour target.
+		*\remarks
+		*	Must be called before initialise. The fragment shader is then compiled with WEIGHTED_BLENDED_OIT defined,
+		*	the depth buffer is tested but not written, the first colour target is additively blended (accumulation),
+		*	and the second one is multiplied by the fragments transparency (revealage).
+		*\param[in] formats
+		*	The depth buffer, accumulation and revealage formats.
+		*\~french
+		*\brief
+		*	Dessine les noeuds dans des cibles de transparence "weighted blended", au lieu de la cible couleur.
+		*\remarks
+		*	Doit être appelée avant initialise. Le fragment shader est alors compilé avec WEIGHTED_BLENDED_OIT défini,
+		*	le tampon de profondeur est testé mais pas écrit, la première cible couleur est mélangée additivement (accumulation),
+		*	et la seconde est multipliée par la transparence des fragments (révélation).
+		*\param[in] formats
+		*	Les formats du tampon de profondeur, d'accumulation et de révélation.
+		*/
+		void enableWeightedBlending( std::vector< renderer::Format > const & formats );
+		/**
+		*\~english
+		*\brief
+		*	Adds a define to the fragment shader.
+		*\remarks
+		*	Must be called before initialise.
+		*\~french
+		*\brief
+		*	Ajoute une définition au fragment shader.
+		*\remarks
+		*	Doit être appelée avant initialise.
+		*/
+		void addFragmentDefine( std::string const & define );
+		/**
+		*\~english
+		*\brief
+		*	Updates the frame buffer and the command buffer, when the views dimensions change.
+		*\~french
+		*\brief
+		*	Met à jour le tampon d'images et le tampon de commandes, quand les dimensions des vues changent.
+		*/
+		inline void updateViews( renderer::TextureViewCRefArray const & views )
+		{
+			doUpdate( views );
+		}
+
+		/**
+		*\~english
+		*\brief
+		*	Culls the nodes against the view frustum and, optionally, against the previous frame's depth buffer.
+		*\remarks
+		*	The visible nodes are then sorted by state and depth, and each visible submesh gets the coarsest level of detail
+		*	whose projected error is under \p lodThreshold. The command buffer is recorded again when the order or a level changes.
+		*\param[in] viewProjection
+		*	The projection * view matrix, used by the billboards.
+		*\param[in] model
+		*	The objects model matrix.
+		*\param[in] hiZ
+		*	The previous frame's depth buffer, \p nullptr to disable the occlusion culling.
+		*\param[in] lodThreshold
+		*	The maximum screen space error of the levels of detail, in pixels, 0 to always draw the full resolution.
+		*\~french
+		*\brief
+		*	Elimine les noeuds hors du frustum de vue et, optionnellement, ceux cachés par le tampon de profondeur de l'image précédente.
+		*\remarks
+		*	Les noeuds visibles sont ensuite triés par état et profondeur, et chaque sous-maillage visible reçoit le niveau de détail
+		*	le plus grossier dont l'erreur projetée est sous \p lodThreshold. Le tampon de commandes est réenregistré quand l'ordre ou un niveau change.
+		*\param[in] viewProjection
+		*	La matrice projection * vue, utilisée par les billboards.
+		*\param[in] model
+		*	La matrice modèle des objets.
+		*\param[in] hiZ
+		*	Le tampon de profondeur de l'image précédente, \p nullptr pour désactiver le culling d'occlusion.
+		*\param[in] lodThreshold
+		*	L'erreur maximale en espace écran des niveaux de détail, en pixels, 0 pour toujours dessiner la pleine résolution.
+		*/
+		CullingCounts cull( renderer::Mat4 const & viewProjection
+			, renderer::Mat4 const & model
+			, HiZBuffer const * hiZ
+			, float lodThreshold );
 
 		inline renderer::Device const & getDevice()const
 		{
@@ -51,6 +138,19 @@ namespace common
 			, renderer::StagingBuffer & stagingBuffer
 			, TextureNodePtrArray const & textureNodes
 			, uint32_t & matIndex );
+		uint32_t doAddTextures( TextureNodePtrArray const & textures
+			, MaterialData & materialData );
+		void doCreateTexturesSets( TextureNodePtrArray const & textureNodes );
+		uint32_t doGetObjectPipeline( bool backFace );
+		uint32_t doCreateBillboardPipeline();
+		void doEnqueueNodes( renderer::Mat4 const & objectMatrix
+			, renderer::Mat4 const & billboardMatrix
+			, utils::ByteArray const & submeshVisible
+			, utils::ByteArray const & billboardVisible
+			, RenderQueue & queue )const;
+		void doRecordCommandBuffer();
+		renderer::ColourBlendState doCreateBlendState()const;
+		renderer::DepthStencilState doCreateDepthStencilState()const;
 
 		virtual void doFillObjectDescriptorLayoutBindings( renderer::DescriptorSetLayoutBindingArray & bindings )
 		{
@@ -73,22 +173,55 @@ namespace common
 	protected:
 		renderer::Device const & m_device;
 		bool m_opaqueNodes;
+		bool m_weightedBlending{ false };
 		renderer::Extent2D m_size;
 		std::string m_fragmentShaderFile;
+		std::vector< std::string > m_fragmentDefines;
 		std::vector< renderer::TextureView const * > m_views;
 		renderer::SamplerPtr m_sampler;
 		renderer::CommandBufferPtr m_updateCommandBuffer;
 		renderer::CommandBufferPtr m_commandBuffer;
 		renderer::UniformBufferPtr< MaterialData > m_materialsUbo;
+		//!\~english	The descriptor set layouts come from this cache, shared with the other renderers, and the sets from its allocators.
+		//!\~french		Les layouts de descriptor sets viennent de ce cache, partagé avec les autres renderers, et les sets de ses allocateurs.
+		renderer::DescriptorSetLayoutCache * m_descriptorCache{ nullptr };
 
-		renderer::DescriptorSetLayoutPtr m_objectDescriptorLayout;
-		renderer::DescriptorSetPoolPtr m_objectDescriptorPool;
+		renderer::DescriptorSetLayout * m_objectDescriptorLayout{ nullptr };
 		renderer::VertexLayoutPtr m_objectVertexLayout;
 
-		renderer::DescriptorSetLayoutPtr m_billboardDescriptorLayout;
-		renderer::DescriptorSetPoolPtr m_billboardDescriptorPool;
+		renderer::PipelineLayoutPtr m_objectPipelineLayout;
+		std::map< bool, uint32_t > m_objectPipelines;
+
+		renderer::DescriptorSetLayout * m_billboardDescriptorLayout{ nullptr };
 		renderer::VertexLayoutPtr m_billboardVertexLayout;
 		renderer::VertexLayoutPtr m_billboardInstanceLayout;
+		renderer::PipelineLayoutPtr m_billboardPipelineLayout;
+
+		/**
+		*\~english
+		*\brief
+		*	Up to MAX_TEXTURE_ARRAYS scene texture arrays, bound in one descriptor set.
+		*\remarks
+		*	Each material uses the first set able to hold all its arrays, a set is added when none can.
+		*\~french
+		*\brief
+		*	Jusqu'à MAX_TEXTURE_ARRAYS tableaux de textures de la scène, liés dans un descriptor set.
+		*\remarks
+		*	Chaque matériau utilise le premier set pouvant contenir tous ses tableaux, un set est ajouté quand aucun ne le peut.
+		*/
+		struct TexturesSet
+		{
+			//!\~english	The scene indices of the arrays, by slot.
+			//!\~french		Les indices dans la scène des tableaux, par emplacement.
+			std::vector< uint32_t > arrays;
+			renderer::DescriptorSetPtr descriptorSet;
+		};
+
+		renderer::DescriptorSetLayout * m_texturesDescriptorLayout{ nullptr };
+		std::vector< TexturesSet > m_texturesSets;
+		//!\~english	The pipelines, shared by the nodes with the same states.
+		//!\~french		Les pipelines, partagés par les noeuds ayant les mêmes états.
+		std::vector< renderer::PipelinePtr > m_pipelines;
 
 		renderer::RenderPassPtr m_renderPass;
 		renderer::FrameBufferPtr m_frameBuffer;
@@ -99,5 +232,16 @@ namespace common
 		BillboardListNodes m_billboardRenderNodes;
 		uint32_t m_objectsCount;
 		uint32_t m_billboardsCount;
+		renderer::ClearValueArray m_clearValues;
+		//!\~english	The object space bounding boxes, one per draw.
+		//!\~french		Les boîtes englobantes en espace objet, une par dessin.
+		utils::BoundingBoxArrays m_submeshBounds;
+		utils::BoundingBoxArrays m_billboardBounds;
+		//!\~english	The visible nodes, in recording order: the submeshes, then the billboards.
+		//!\~french		Les noeuds visibles, dans l'ordre d'enregistrement : les sous-maillages, puis les billboards.
+		RenderQueue m_queue;
+		//!\~english	The selected level of detail of each submesh node.
+		//!\~french		Le niveau de détail sélectionné pour chaque noeud de sous-maillage.
+		std::vector< uint32_t > m_submeshLods;
 	};
 }
@@ -10,12 +10,14 @@ namespace common
 	OpaqueRendering::OpaqueRendering( NodesRendererPtr && renderer
 		, Scene const & scene
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::TextureNodePtrArray const & textureNodes )
 		: m_renderer{ std::move( renderer ) }
 	{
 		m_renderer->initialise( scene
 			, stagingBuffer
+			, descriptorCache
 			, views
 			, textureNodes );
 	}
@@ -29,4 +31,12 @@ namespace common
 	{
 		return m_renderer->draw( gpu );
 	}
+
+	CullingCounts OpaqueRendering::cull( renderer::Mat4 const & viewProjection
+		, renderer::Mat4 const & model
+		, HiZBuffer const * hiZ
+		, float lodThreshold )
+	{
+		return m_renderer->cull( viewProjection, model, hiZ, lodThreshold );
+	}
 }
@@ -10,11 +10,16 @@ namespace common
 		OpaqueRendering( NodesRendererPtr && renderer
 			, Scene const & scene
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::TextureNodePtrArray const & textureNodes );
 		virtual ~OpaqueRendering() = default;
 		virtual void update( RenderTarget const & target );
 		virtual bool draw( std::chrono::nanoseconds & gpu )const;
+		virtual CullingCounts cull( renderer::Mat4 const & viewProjection
+			, renderer::Mat4 const & model
+			, HiZBuffer const * hiZ
+			, float lodThreshold );
 
 	protected:
 		NodesRendererPtr m_renderer;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "LightBinning.hpp"
+
 #include <Core/Connection.hpp>
 #include <Core/Renderer.hpp>
 #include <Image/Texture.hpp>
@@ -29,7 +31,12 @@ namespace common
 		, std::function< renderer::RendererPtr( renderer::Renderer::Configuration const & ) > >;
 
 	static uint32_t constexpr MAX_TEXTURES = 6u;
-	static uint32_t constexpr MAX_LIGHTS = 10u;
+	//!\~english	The maximum number of texture arrays bound at once, see texture_arrays.glsl.
+	//!\~french		Le nombre maximal de tableaux de textures liés en même temps, cf. texture_arrays.glsl.
+	static uint32_t constexpr MAX_TEXTURE_ARRAYS = 16u;
+	//!\~english	The maximum number of levels of detail of a submesh, the full resolution one included.
+	//!\~french		Le nombre maximal de niveaux de détail d'un sous-maillage, celui en pleine résolution inclus.
+	static uint32_t constexpr MAX_LODS = 4u;
 
 	struct NonTexturedVertex2DData
 	{
@@ -67,12 +74,26 @@ namespace common
 	*\name Données chargées.
 	*/
 	/**\{*/
+	class MappedFile;
+	using MappedFilePtr = std::shared_ptr< MappedFile >;
+
+	struct ImageLevel
+	{
+		renderer::Extent2D size;
+		uint8_t const * data;
+		uint32_t byteSize;
+	};
+
 	struct Image
 	{
 		renderer::Extent2D size;
 		renderer::ByteArray data;
 		renderer::Format format;
 		bool opacity{ false };
+		// The precomputed mip levels of a baked image, pointing into file.
+		// Empty for decoded images, whose pixels are in data.
+		std::vector< ImageLevel > levels;
+		MappedFilePtr file;
 	};
 
 	using ImagePtr = std::shared_ptr< Image >;
@@ -87,7 +108,9 @@ namespace common
 		uint32_t shininess{ 0 }; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
 		uint32_t opacity{ 0 }; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
 		uint32_t height{ 0 }; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
-		float fill{ 0.0f }; // align to 16 bytes.
+		//!\~english	Set by NodesRenderer in the former std140 padding: the array's slot in the node's textures set << 16 | the layer.
+		//!\~french		Défini par NodesRenderer dans l'ancien padding std140 : l'emplacement du tableau dans le set de textures du noeud << 16 | la couche.
+		uint32_t texture{ 0 };
 	};
 
 	struct MaterialData
@@ -102,6 +125,9 @@ namespace common
 		std::array< TextureOperators, MAX_TEXTURES > textureOperators;
 	};
 
+	static_assert( sizeof( TextureOperators ) == 32u, "TextureOperators must match the std140 layout of the materials UBO" );
+	static_assert( sizeof( MaterialData ) == 256u, "MaterialData must match the std140 layout of the materials UBO" );
+
 	struct Material
 	{
 		MaterialData data;
@@ -122,6 +148,19 @@ namespace common
 	{
 		std::vector< Vertex > data;
 		bool hasNormals{ false }; // true implies that it will also have tangents and bitangents
+		// The vertices of a cached object, pointing into Submesh::file, data is then empty.
+		Vertex const * cached{ nullptr };
+		uint32_t cachedCount{ 0u };
+
+		inline Vertex const * getData()const
+		{
+			return cached ? cached : data.data();
+		}
+
+		inline uint32_t getCount()const
+		{
+			return cached ? cachedCount : uint32_t( data.size() );
+		}
 	};
 
 	struct Face
@@ -134,13 +173,46 @@ namespace common
 	struct IndexBuffer
 	{
 		std::vector< Face > data;
+		// The faces of a cached object, pointing into Submesh::file, data is then empty.
+		Face const * cached{ nullptr };
+		uint32_t cachedCount{ 0u };
+
+		inline Face const * getData()const
+		{
+			return cached ? cached : data.data();
+		}
+
+		inline uint32_t getCount()const
+		{
+			return cached ? cachedCount : uint32_t( data.size() );
+		}
+	};
+
+	/**
+	*\~english
+	*\brief
+	*	A submesh level of detail, a range of its index buffer.
+	*\~french
+	*\brief
+	*	Un niveau de détail de sous-maillage, un intervalle de son tampon d'indices.
+	*/
+	struct Lod
+	{
+		uint32_t firstFace;
+		uint32_t facesCount;
+		//!\~english	The geometric error, in object space units, 0 for the full resolution level.
+		//!\~french		L'erreur géométrique, en unités de l'espace objet, 0 pour le niveau en pleine résolution.
+		float error;
 	};
 
 	struct Submesh
 	{
 		VertexBuffer vbo;
 		IndexBuffer ibo;
+		// The levels of detail, from the finest, their faces follow each other in ibo and share vbo.
+		std::vector< Lod > lods;
 		std::vector< Material > materials;
+		MappedFilePtr file;
 	};
 
 	using Object = std::vector< Submesh >;
@@ -153,59 +225,37 @@ namespace common
 	/**\}*/
 	/**
 	*\~english
-	*\name Lighting.
+	*\name Rendered data.
 	*\~french
-	*\name Eclairage.
+	*\name Données rendues.
 	*/
 	/**\{*/
-	struct Light
-	{
-		utils::Vec4 colour;
-		utils::Vec4 intensities;
-	};
-
-	struct DirectionalLight
-	{
-		Light base;
-		utils::Vec4 direction;
-	};
-
-	struct PointLight
-	{
-		Light base;
-		utils::Vec4 position;
-		utils::Vec4 attenation;
-	};
-
-	struct SpotLight
-	{
-		PointLight base;
-		utils::Vec4 direction;
-		utils::Vec4 coeffs;// .x = cutoff, .y = exponent
-	};
-
-	struct LightsData
-	{
-		utils::IVec4 lightsCount;
-		DirectionalLight directionalLights[MAX_LIGHTS];
-		PointLight pointLights[MAX_LIGHTS];
-		SpotLight spotLights[MAX_LIGHTS];
-	};
-	/**\}*/
 	/**
 	*\~english
-	*\name Rendered data.
+	*\brief
+	*	A 2D texture array, holding images with the same format, dimensions and mip levels.
 	*\~french
-	*\name Données rendues.
+	*\brief
+	*	Un tableau de textures 2D, contenant des images de mêmes format, dimensions et niveaux de mipmaps.
 	*/
-	/**\{*/
-	struct TextureNode
+	struct TextureArray
 	{
-		ImagePtr image;
 		renderer::TexturePtr texture;
 		renderer::TextureViewPtr view;
 	};
 
+	using TextureArrayPtr = std::shared_ptr< TextureArray >;
+
+	struct TextureNode
+	{
+		ImagePtr image;
+		TextureArrayPtr array;
+		//!\~english	The index of the array in the scene, and the layer of the image in the array.
+		//!\~french		L'indice du tableau dans la scène, et la couche de l'image dans le tableau.
+		uint32_t arrayIndex;
+		uint32_t layer;
+	};
+
 	using TextureNodePtr = std::shared_ptr< TextureNode >;
 	using TextureNodePtrArray = std::vector< TextureNodePtr >;
 
@@ -214,18 +264,22 @@ namespace common
 	{
 		std::shared_ptr< NodeType > instance;
 		TextureNodePtrArray textures;
-		renderer::DescriptorSetLayoutPtr layout;
-		renderer::DescriptorSetPoolPtr pool;
-		renderer::DescriptorSetPtr descriptorSetTextures;
 		renderer::DescriptorSetPtr descriptorSetUbos;
-		renderer::PipelineLayoutPtr pipelineLayout;
-		renderer::PipelinePtr pipeline;
+		//!\~english	The indices of the renderer's pipeline, of the material and of the mesh, used in the sort keys.
+		//!\~french		Les indices du pipeline du renderer, du matériau et du maillage, utilisés dans les clés de tri.
+		uint32_t pipeline;
+		uint32_t material;
+		uint32_t mesh;
+		//!\~english	The index of the renderer's textures set holding the texture arrays of the material.
+		//!\~french		L'indice du set de textures du renderer contenant les tableaux de textures du matériau.
+		uint32_t texturesSet;
 	};
 
 	struct SubmeshNode
 	{
 		renderer::VertexBufferPtr< Vertex > vbo;
 		renderer::BufferPtr< Face > ibo;
+		std::vector< Lod > lods;
 	};
 
 	struct BillboardNode
@@ -250,18 +304,54 @@ namespace common
 		, renderer::Renderer const & renderer );
 
 	std::vector< renderer::Format > getFormats( renderer::TextureViewCRefArray const & views );
+	/**
+	*\~english
+	*\brief
+	*	The transparent nodes rendering modes.
+	*\~french
+	*\brief
+	*	Les modes de rendu des noeuds transparents.
+	*/
+	enum class TransparencyMode
+	{
+		//! The nodes are drawn directly into the colour target, in their storage order.
+		eForward,
+		//! Weighted blended order independent transparency: the nodes are accumulated, then composited into the colour target.
+		eWeightedBlended,
+	};
+	/**
+	*\~english
+	*\brief
+	*	The nodes culling results, the counts are in draws.
+	*\~french
+	*\brief
+	*	Les résultats du culling des noeuds, les nombres sont en dessins.
+	*/
+	struct CullingCounts
+	{
+		uint32_t visible{ 0u };
+		uint32_t frustumCulled{ 0u };
+		uint32_t occlusionCulled{ 0u };
+		//!\~english	The faces drawn for the visible submeshes, at their selected level of detail.
+		//!\~french		Les faces dessinées pour les sous-maillages visibles, à leur niveau de détail sélectionné.
+		uint32_t faces{ 0u };
+	};
 
 	struct Scene;
 
 	class Application;
+	class HiZBuffer;
 	class MainFrame;
 	class NodesRenderer;
 	class OpaqueRendering;
 	class RenderPanel;
 	class RenderTarget;
 	class TransparentRendering;
+	class WeightedBlendedComposite;
 
+	using HiZBufferPtr = std::unique_ptr< HiZBuffer >;
 	using NodesRendererPtr = std::unique_ptr< NodesRenderer >;
 	using OpaqueRenderingPtr = std::unique_ptr< OpaqueRendering >;
 	using TransparentRenderingPtr = std::unique_ptr< TransparentRendering >;
+	using WeightedBlendedCompositePtr = std::unique_ptr< WeightedBlendedComposite >;
 }
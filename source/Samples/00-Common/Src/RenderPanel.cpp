@@ -451,11 +451,47 @@ namespace common
 			ImGui::Text( "Min: %.2f ms, Max %.2f ms", ( minGpuTime.count() / 1000.0f ), ( maxGpuTime.count() / 1000.0f ) );
 		}
 
+		auto & counts = m_renderTarget->getCullingCounts();
+		ImGui::Text( "Nodes: %u visible, %u frustum culled, %u occluded", counts.visible, counts.frustumCulled, counts.occlusionCulled );
+		ImGui::Text( "Faces: %u", counts.faces );
+
 #if RENDERLIB_ANDROID
 		ImGui::PushStyleVar( ImGuiStyleVar_ItemSpacing, ImVec2( 0.0f, 5.0f * UIOverlay->scale ) );
 #endif
 
 		ImGui::PushItemWidth( 110.0f );
+
+		if ( m_gui->header( "Transparency" ) )
+		{
+			auto mode = int32_t( m_renderTarget->getTransparencyMode() );
+
+			if ( m_gui->comboBox( "Mode", &mode, { "Forward", "Weighted blended" } ) )
+			{
+				m_renderTarget->setTransparencyMode( TransparencyMode( mode ) );
+			}
+		}
+
+		if ( m_renderTarget->hasOcclusionCulling()
+			&& m_gui->header( "Culling" ) )
+		{
+			auto occlusion = m_renderTarget->isOcclusionCulling();
+
+			if ( m_gui->checkBox( "Occlusion", &occlusion ) )
+			{
+				m_renderTarget->setOcclusionCulling( occlusion );
+			}
+		}
+
+		if ( m_gui->header( "Level of detail" ) )
+		{
+			auto threshold = m_renderTarget->getLodThreshold();
+
+			if ( m_gui->sliderFloat( "Max error (px)", &threshold, 0.0f, 16.0f ) )
+			{
+				m_renderTarget->setLodThreshold( threshold );
+			}
+		}
+
 		doUpdateOverlays( *m_gui );
 		ImGui::PopItemWidth();
 
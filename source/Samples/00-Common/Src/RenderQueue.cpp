@@ -0,0 +1,113 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace common
+{
+	namespace
+	{
+		static uint32_t constexpr DigitBits = 8u;
+		static uint32_t constexpr DigitsCount = 64u / DigitBits;
+		static uint32_t constexpr BucketsCount = 1u << DigitBits;
+
+		uint64_t doGetDepthBits( float depth )
+		{
+			// Positive floats order like their bit patterns.
+			depth = std::max( depth, 0.0f );
+			uint32_t bits;
+			std::memcpy( &bits, &depth, sizeof( bits ) );
+			return bits >> 16u;
+		}
+	}
+
+	uint64_t RenderQueue::makeKey( uint32_t pass
+		, uint32_t pipeline
+		, uint32_t material
+		, uint32_t mesh
+		, float depth
+		, bool backToFront )
+	{
+		assert( pass < ( 1u << 4u ) );
+		assert( pipeline < ( 1u << 12u ) );
+		assert( material < ( 1u << 16u ) );
+		assert( mesh < ( 1u << 16u ) );
+		auto state = ( uint64_t( pipeline ) << 32u )
+			| ( uint64_t( material ) << 16u )
+			| uint64_t( mesh );
+
+		if ( backToFront )
+		{
+			auto farFirst = ~doGetDepthBits( depth ) & 0xFFFFu;
+			return ( uint64_t( pass ) << 60u )
+				| ( farFirst << 44u )
+				| state;
+		}
+
+		return ( uint64_t( pass ) << 60u )
+			| ( state << 16u )
+			| doGetDepthBits( depth );
+	}
+
+	void RenderQueue::clear()
+	{
+		m_items.clear();
+	}
+
+	void RenderQueue::push( uint64_t key, uint32_t node )
+	{
+		m_items.push_back( { key, node } );
+	}
+
+	void RenderQueue::sort()
+	{
+		m_buffer.resize( m_items.size() );
+		std::array< uint32_t, BucketsCount > offsets;
+
+		for ( uint32_t digit = 0u; digit < DigitsCount; ++digit )
+		{
+			auto shift = digit * DigitBits;
+			offsets.fill( 0u );
+
+			for ( auto & item : m_items )
+			{
+				++offsets[( item.key >> shift ) & ( BucketsCount - 1u )];
+			}
+
+			if ( std::find( offsets.begin(), offsets.end(), uint32_t( m_items.size() ) ) != offsets.end() )
+			{
+				// All the keys share this digit.
+				continue;
+			}
+
+			uint32_t offset = 0u;
+
+			for ( auto & count : offsets )
+			{
+				auto bucketCount = count;
+				count = offset;
+				offset += bucketCount;
+			}
+
+			for ( auto & item : m_items )
+			{
+				m_buffer[offsets[( item.key >> shift ) & ( BucketsCount - 1u )]++] = item;
+			}
+
+			std::swap( m_items, m_buffer );
+		}
+	}
+
+	bool RenderQueue::hasSameOrder( RenderQueue const & rhs )const
+	{
+		return std::equal( m_items.begin()
+			, m_items.end()
+			, rhs.m_items.begin()
+			, rhs.m_items.end()
+			, []( Item const & lhs, Item const & rhs )
+			{
+				return lhs.node == rhs.node;
+			} );
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Prerequisites.hpp"
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	A queue of draws, sorted by a 64 bits key so that the draws sharing a state are recorded together.
+	*\remarks
+	*	The key holds, from the most significant bits: the pass (4 bits), the pipeline (12 bits), the material (16 bits),
+	*	the mesh (16 bits) and the depth (16 bits). The back to front queues move the depth right after the pass.
+	*\~french
+	*\brief
+	*	Une file de dessins, triés selon une clé de 64 bits afin que les dessins partageant un état soient enregistrés ensemble.
+	*\remarks
+	*	La clé contient, depuis les bits de poids fort : la passe (4 bits), le pipeline (12 bits), le matériau (16 bits),
+	*	le maillage (16 bits) et la profondeur (16 bits). Les files d'arrière en avant placent la profondeur juste après la passe.
+	*/
+	class RenderQueue
+	{
+	public:
+		struct Item
+		{
+			uint64_t key;
+			uint32_t node;
+		};
+
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Builds a sort key.
+		*\param[in] depth
+		*	The camera distance, clamped to 0, only the 16 most significant bits of its IEEE 754 representation are kept.
+		*\param[in] backToFront
+		*	\p true to sort by decreasing depth first, for the blended nodes.
+		*\~french
+		*\brief
+		*	Construit une clé de tri.
+		*\param[in] depth
+		*	La distance à la caméra, bornée à 0, seuls les 16 bits de poids fort de sa représentation IEEE 754 sont gardés.
+		*\param[in] backToFront
+		*	\p true pour trier par profondeur décroissante d'abord, pour les noeuds mélangés.
+		*/
+		static uint64_t makeKey( uint32_t pass
+			, uint32_t pipeline
+			, uint32_t material
+			, uint32_t mesh
+			, float depth
+			, bool backToFront );
+
+		void clear();
+		void push( uint64_t key, uint32_t node );
+		/**
+		*\~english
+		*\brief
+		*	Sorts the draws by increasing key, with a LSD radix sort on 8 bits digits.
+		*\remarks
+		*	The digits shared by all the keys are skipped, the sort is stable.
+		*\~french
+		*\brief
+		*	Trie les dessins par clé croissante, avec un tri par base LSD sur des chiffres de 8 bits.
+		*\remarks
+		*	Les chiffres communs à toutes les clés sont sautés, le tri est stable.
+		*/
+		void sort();
+		/**
+		*\return
+		*	\~english	\p true if both queues draw the same nodes in the same order.
+		*	\~french	\p true si les deux files dessinent les mêmes noeuds dans le même ordre.
+		*/
+		bool hasSameOrder( RenderQueue const & rhs )const;
+
+		inline std::vector< Item > const & getItems()const
+		{
+			return m_items;
+		}
+
+	private:
+		std::vector< Item > m_items;
+		std::vector< Item > m_buffer;
+	};
+}
@@ -1,13 +1,16 @@
 #include "RenderTarget.hpp"
 
+#include "HiZBuffer.hpp"
 #include "OpaqueRendering.hpp"
 #include "TransparentRendering.hpp"
 
 #include <Buffer/StagingBuffer.hpp>
 #include <Buffer/UniformBuffer.hpp>
 #include <Command/Queue.hpp>
+#include <Core/Renderer.hpp>
 #include <Descriptor/DescriptorSet.hpp>
 #include <Descriptor/DescriptorSetLayout.hpp>
+#include <Descriptor/DescriptorSetLayoutCache.hpp>
 #include <Descriptor/DescriptorSetPool.hpp>
 #include <Image/Texture.hpp>
 #include <Image/TextureView.hpp>
@@ -19,11 +22,14 @@
 #include <RenderPass/RenderSubpass.hpp>
 #include <RenderPass/RenderSubpassState.hpp>
 #include <Shader/ShaderProgram.hpp>
+#include <Sync/Fence.hpp>
 #include <Sync/ImageMemoryBarrier.hpp>
 
 #include <Transform.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 
 namespace common
 {
@@ -46,6 +52,7 @@ namespace common
 		{
 			doCreateStagingBuffer();
 			std::cout << "Staging buffer created." << std::endl;
+			m_descriptorCache = std::make_unique< renderer::DescriptorSetLayoutCache >( m_device );
 			doCreateTextures();
 			std::cout << "Textures created." << std::endl;
 			doCreateRenderPass();
@@ -70,6 +77,12 @@ namespace common
 		{
 			m_size = size;
 			doUpdateRenderViews();
+
+			if ( m_hiZ )
+			{
+				m_hiZ->update( *m_depthView );
+			}
+
 			doResize( size );
 			m_opaque->update( *this );
 			m_transparent->update( *this );
@@ -87,19 +100,90 @@ namespace common
 		std::chrono::nanoseconds transparent;
 		auto result = m_opaque->draw( opaque );
 		result &= m_transparent->draw( transparent );
+
+		if ( result && m_occlusionCulling )
+		{
+			// Read back one frame later, for the culling of the frame after.
+			result = m_hiZ->generate();
+		}
+
 		gpu = std::chrono::duration_cast< std::chrono::microseconds >( opaque + transparent );
 		return result;
 	}
 
+	void RenderTarget::setTransparencyMode( TransparencyMode mode )
+	{
+		if ( mode != m_transparencyMode )
+		{
+			m_transparencyMode = mode;
+
+			if ( m_transparent )
+			{
+				doRecreateTransparentRendering();
+			}
+		}
+	}
+
+	void RenderTarget::setOcclusionCulling( bool enable )
+	{
+		assert( !enable || m_hiZ );
+		m_occlusionCulling = enable;
+	}
+
 	void RenderTarget::doInitialise()
 	{
+		if ( m_device.getRenderer().getFeatures().hasComputeShaders )
+		{
+			m_hiZ = std::make_unique< HiZBuffer >( m_device, *m_descriptorCache, *m_depthView );
+		}
+
+		m_opaque = doCreateOpaqueRendering( m_device
+			, *m_stagingBuffer
+			, *m_descriptorCache
+			, { *m_depthView, *m_colourView }
+			, m_scene
+			, m_textureNodes );
+		m_transparent = doCreateTransparentRendering( m_device
+			, *m_stagingBuffer
+			, *m_descriptorCache
+			, { *m_depthView, *m_colourView }
+			, m_scene
+			, m_textureNodes );
+	}
+
+	void RenderTarget::doCull( renderer::Mat4 const & viewProjection
+		, renderer::Mat4 const & model )
+	{
+		auto hiZ = m_occlusionCulling
+			? m_hiZ.get()
+			: nullptr;
+		auto opaque = m_opaque->cull( viewProjection, model, hiZ, m_lodThreshold );
+		auto transparent = m_transparent->cull( viewProjection, model, hiZ, m_lodThreshold );
+		m_cullingCounts.visible = opaque.visible + transparent.visible;
+		m_cullingCounts.frustumCulled = opaque.frustumCulled + transparent.frustumCulled;
+		m_cullingCounts.occlusionCulled = opaque.occlusionCulled + transparent.occlusionCulled;
+		m_cullingCounts.faces = opaque.faces + transparent.faces;
+	}
+
+	void RenderTarget::doRecreateOpaqueRendering()
+	{
+		m_device.waitIdle();
+		m_opaque.reset();
 		m_opaque = doCreateOpaqueRendering( m_device
 			, *m_stagingBuffer
+			, *m_descriptorCache
 			, { *m_depthView, *m_colourView }
 			, m_scene
 			, m_textureNodes );
+	}
+
+	void RenderTarget::doRecreateTransparentRendering()
+	{
+		m_device.waitIdle();
+		m_transparent.reset();
 		m_transparent = doCreateTransparentRendering( m_device
 			, *m_stagingBuffer
+			, *m_descriptorCache
 			, { *m_depthView, *m_colourView }
 			, m_scene
 			, m_textureNodes );
@@ -113,6 +197,8 @@ namespace common
 
 		m_transparent.reset();
 		m_opaque.reset();
+		m_hiZ.reset();
+		m_descriptorCache.reset();
 		m_depthView.reset();
 		m_depth.reset();
 		m_colourView.reset();
@@ -132,35 +218,211 @@ namespace common
 
 	void RenderTarget::doCreateTextures()
 	{
+		// The images sharing a format, dimensions and mip levels are packed into the same texture array.
+		struct Group
+		{
+			renderer::Format format;
+			renderer::Extent2D size;
+			uint32_t mipLevels;
+			bool baked;
+			ImagePtrArray images;
+		};
+		std::vector< Group > groups;
+
 		for ( auto & image : m_images )
 		{
-			common::TextureNodePtr textureNode = std::make_shared< common::TextureNode >();
-			textureNode->image = image;
-			textureNode->texture = m_device.createTexture(
+			if ( renderer::isCompressedFormat( image->format )
+				&& !m_device.getFeatures().textureCompressionBC )
+			{
+				throw std::runtime_error{ "BC compressed textures are not supported, bake the textures without compression." };
+			}
+
+			// Baked images come with all their levels, the decoded ones get 4 generated levels.
+			uint32_t mipLevels = image->levels.empty()
+				? 4u
+				: uint32_t( image->levels.size() );
+			auto it = std::find_if( groups.begin()
+				, groups.end()
+				, [&image, &mipLevels]( Group const & lookup )
+				{
+					return lookup.format == image->format
+						&& lookup.size == image->size
+						&& lookup.mipLevels == mipLevels
+						&& lookup.baked == !image->levels.empty();
+				} );
+
+			if ( it == groups.end() )
+			{
+				groups.push_back( { image->format, image->size, mipLevels, !image->levels.empty() } );
+				it = groups.end() - 1;
+			}
+
+			it->images.push_back( image );
+		}
+
+		// There is no limit on the arrays count, the renderers bind them by sets of MAX_TEXTURE_ARRAYS.
+		for ( uint32_t index = 0u; index < groups.size(); ++index )
+		{
+			auto & group = groups[index];
+			auto array = std::make_shared< common::TextureArray >();
+			auto layers = uint32_t( group.images.size() );
+			array->texture = m_device.createTexture(
 				{
 					0u,
 					renderer::TextureType::e2D,
-					image->format,
-					renderer::Extent3D{ image->size.width, image->size.height, 1u },
-					4u,
-					1u,
+					group.format,
+					renderer::Extent3D{ group.size.width, group.size.height, 1u },
+					group.mipLevels,
+					layers,
 					renderer::SampleCountFlag::e1,
 					renderer::ImageTiling::eOptimal,
 					renderer::ImageUsageFlag::eTransferSrc | renderer::ImageUsageFlag::eTransferDst | renderer::ImageUsageFlag::eSampled
 				}
 				, renderer::MemoryPropertyFlag::eDeviceLocal );
-			textureNode->view = textureNode->texture->createView( renderer::TextureViewType( textureNode->texture->getType() )
-				, textureNode->texture->getFormat()
+			array->view = array->texture->createView( renderer::TextureViewType::e2DArray
+				, group.format
+				, 0u
+				, group.mipLevels
 				, 0u
-				, 4u );
-			auto view = textureNode->texture->createView( renderer::TextureViewType( textureNode->texture->getType() )
-				, textureNode->texture->getFormat() );
-			m_stagingBuffer->uploadTextureData( *m_updateCommandBuffer
-				, image->data
-				, *view );
-			textureNode->texture->generateMipmaps();
-			m_textureNodes.emplace_back( textureNode );
+				, layers );
+
+			for ( uint32_t layer = 0u; layer < layers; ++layer )
+			{
+				auto & image = group.images[layer];
+
+				if ( group.baked )
+				{
+					doUploadLevels( *image, *array->texture, layer );
+				}
+				else
+				{
+					auto view = array->texture->createView( renderer::TextureViewType::e2D
+						, group.format
+						, 0u
+						, 1u
+						, layer
+						, 1u );
+					m_stagingBuffer->uploadTextureData( *m_updateCommandBuffer
+						, image->data
+						, *view );
+				}
+
+				common::TextureNodePtr textureNode = std::make_shared< common::TextureNode >();
+				textureNode->image = image;
+				textureNode->array = array;
+				textureNode->arrayIndex = index;
+				textureNode->layer = layer;
+				m_textureNodes.emplace_back( textureNode );
+			}
+
+			if ( !group.baked )
+			{
+				array->texture->generateMipmaps();
+			}
+		}
+	}
+
+	void RenderTarget::doUploadLevels( Image const & image
+		, renderer::Texture const & texture
+		, uint32_t layer )
+	{
+		// Compressed formats need buffer offsets aligned on their block size.
+		static uint32_t constexpr Alignment = 16u;
+		auto & buffer = m_stagingBuffer->getBuffer();
+		renderer::BufferImageCopyArray copies;
+		uint32_t size{ 0u };
+
+		for ( auto & level : image.levels )
+		{
+			renderer::BufferImageCopy copy{};
+			copy.bufferOffset = size;
+			copy.imageSubresource.aspectMask = renderer::ImageAspectFlag::eColour;
+			copy.imageSubresource.mipLevel = uint32_t( copies.size() );
+			copy.imageSubresource.baseArrayLayer = layer;
+			copy.imageSubresource.layerCount = 1u;
+			copy.imageExtent = { level.size.width, level.size.height, 1u };
+			copy.levelSize = level.byteSize;
+			copies.push_back( copy );
+			size += ( level.byteSize + Alignment - 1u ) & ~( Alignment - 1u );
 		}
+
+		if ( size > buffer.getSize() )
+		{
+			throw std::runtime_error{ "Baked image too large for the staging buffer." };
+		}
+
+		// The levels are copied straight from the file mapping.
+		auto data = buffer.lock( 0u
+			, size
+			, renderer::MemoryMapFlag::eWrite | renderer::MemoryMapFlag::eInvalidateRange );
+
+		if ( !data )
+		{
+			throw std::runtime_error{ "Staging buffer storage memory mapping failed." };
+		}
+
+		for ( size_t index = 0u; index < copies.size(); ++index )
+		{
+			std::memcpy( data + copies[index].bufferOffset
+				, image.levels[index].data
+				, image.levels[index].byteSize );
+		}
+
+		buffer.flush( 0u, size );
+		buffer.unlock();
+
+		// All the levels are uploaded in a single submission.
+		renderer::ImageSubresourceRange range
+		{
+			renderer::ImageAspectFlag::eColour,
+			0u,
+			uint32_t( copies.size() ),
+			layer,
+			1u,
+		};
+
+		if ( !m_updateCommandBuffer->begin( renderer::CommandBufferUsageFlag::eOneTimeSubmit ) )
+		{
+			throw std::runtime_error{ "Texture data copy failed." };
+		}
+
+		m_updateCommandBuffer->memoryBarrier( renderer::PipelineStageFlag::eTopOfPipe
+			, renderer::PipelineStageFlag::eTransfer
+			, renderer::ImageMemoryBarrier{ 0u
+				, renderer::AccessFlag::eTransferWrite
+				, renderer::ImageLayout::eUndefined
+				, renderer::ImageLayout::eTransferDstOptimal
+				, ~( 0u )
+				, ~( 0u )
+				, texture
+				, range } );
+		m_updateCommandBuffer->copyToImage( copies
+			, buffer
+			, texture );
+		m_updateCommandBuffer->memoryBarrier( renderer::PipelineStageFlag::eTransfer
+			, renderer::PipelineStageFlag::eFragmentShader
+			, renderer::ImageMemoryBarrier{ renderer::AccessFlag::eTransferWrite
+				, renderer::AccessFlag::eShaderRead
+				, renderer::ImageLayout::eTransferDstOptimal
+				, renderer::ImageLayout::eShaderReadOnlyOptimal
+				, ~( 0u )
+				, ~( 0u )
+				, texture
+				, range } );
+
+		if ( !m_updateCommandBuffer->end() )
+		{
+			throw std::runtime_error{ "Texture data copy failed." };
+		}
+
+		auto fence = m_device.createFence();
+
+		if ( !m_device.getGraphicsQueue().submit( *m_updateCommandBuffer, fence.get() ) )
+		{
+			throw std::runtime_error{ "Texture data copy failed." };
+		}
+
+		fence->wait( renderer::FenceTimeout );
 	}
 
 	void RenderTarget::doCreateRenderPass()
@@ -198,7 +460,7 @@ namespace common
 				1u,
 				renderer::SampleCountFlag::e1,
 				renderer::ImageTiling::eOptimal,
-				renderer::ImageUsageFlag::eDepthStencilAttachment
+				renderer::ImageUsageFlag::eDepthStencilAttachment | renderer::ImageUsageFlag::eSampled
 			}
 			, renderer::MemoryPropertyFlag::eDeviceLocal );
 		m_depthView = m_depth->createView( renderer::TextureViewType::e2D
@@ -18,6 +18,70 @@ namespace common
 		void resize( renderer::Extent2D const & size );
 		void update( std::chrono::microseconds const & duration );
 		bool draw( std::chrono::microseconds & gpu );
+		/**
+		*\~english
+		*\brief
+		*	Sets the transparent nodes rendering mode, recreating the transparent rendering if it changes.
+		*\~french
+		*\brief
+		*	Définit le mode de rendu des noeuds transparents, recréant le rendu transparent s'il change.
+		*/
+		void setTransparencyMode( TransparencyMode mode );
+
+		inline TransparencyMode getTransparencyMode()const
+		{
+			return m_transparencyMode;
+		}
+
+		/**
+		*\~english
+		*\brief
+		*	Enables or disables the nodes occlusion culling against the previous frame's hierarchical depth buffer.
+		*\~french
+		*\brief
+		*	Active ou désactive le culling d'occlusion des noeuds contre le tampon de profondeur hiérarchique de l'image précédente.
+		*/
+		void setOcclusionCulling( bool enable );
+
+		inline bool isOcclusionCulling()const
+		{
+			return m_occlusionCulling;
+		}
+		/**
+		*\~english
+		*\return
+		*	\p true if the device supports the occlusion culling (it needs compute shaders).
+		*\~french
+		*\return
+		*	\p true si le périphérique supporte le culling d'occlusion (il nécessite les compute shaders).
+		*/
+		inline bool hasOcclusionCulling()const
+		{
+			return m_hiZ != nullptr;
+		}
+
+		/**
+		*\~english
+		*\brief
+		*	Sets the maximum screen space error of the submeshes levels of detail, in pixels, 0 to disable them.
+		*\~french
+		*\brief
+		*	Définit l'erreur maximale en espace écran des niveaux de détail des sous-maillages, en pixels, 0 pour les désactiver.
+		*/
+		inline void setLodThreshold( float threshold )
+		{
+			m_lodThreshold = threshold;
+		}
+
+		inline float getLodThreshold()const
+		{
+			return m_lodThreshold;
+		}
+
+		inline CullingCounts const & getCullingCounts()const
+		{
+			return m_cullingCounts;
+		}
 
 		inline renderer::TextureView const & getColourView()const
 		{
@@ -31,6 +95,26 @@ namespace common
 
 	protected:
 		void doInitialise();
+		/**
+		*\~english
+		*\brief
+		*	Culls the opaque and transparent nodes, to call from doUpdate once the matrices are computed.
+		*\param[in] viewProjection
+		*	The projection * view matrix.
+		*\param[in] model
+		*	The objects model matrix.
+		*\~french
+		*\brief
+		*	Elimine les noeuds opaques et transparents, à appeler depuis doUpdate une fois les matrices calculées.
+		*\param[in] viewProjection
+		*	La matrice projection * vue.
+		*\param[in] model
+		*	La matrice modèle des objets.
+		*/
+		void doCull( renderer::Mat4 const & viewProjection
+			, renderer::Mat4 const & model );
+		void doRecreateOpaqueRendering();
+		void doRecreateTransparentRendering();
 
 		inline OpaqueRendering const & getOpaqueRendering()const
 		{
@@ -48,6 +132,9 @@ namespace common
 		void doCleanup();
 		void doCreateStagingBuffer();
 		void doCreateTextures();
+		void doUploadLevels( Image const & image
+			, renderer::Texture const & texture
+			, uint32_t layer );
 		void doCreateRenderPass();
 		void doUpdateRenderViews();
 
@@ -56,11 +143,13 @@ namespace common
 
 		virtual OpaqueRenderingPtr doCreateOpaqueRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, Scene const & scene
 			, TextureNodePtrArray const & textureNodes ) = 0;
 		virtual TransparentRenderingPtr doCreateTransparentRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, Scene const & scene
 			, TextureNodePtrArray const & textureNodes ) = 0;
@@ -68,6 +157,7 @@ namespace common
 	protected:
 		renderer::Device const & m_device;
 		renderer::StagingBufferPtr m_stagingBuffer;
+		renderer::DescriptorSetLayoutCachePtr m_descriptorCache;
 		renderer::CommandBufferPtr m_updateCommandBuffer;
 		renderer::Extent2D m_size;
 
@@ -83,5 +173,10 @@ namespace common
 		renderer::CommandBufferPtr m_commandBuffer;
 		std::shared_ptr< OpaqueRendering > m_opaque;
 		std::shared_ptr< TransparentRendering > m_transparent;
+		TransparencyMode m_transparencyMode{ TransparencyMode::eForward };
+		HiZBufferPtr m_hiZ;
+		bool m_occlusionCulling{ false };
+		float m_lodThreshold{ 1.0f };
+		CullingCounts m_cullingCounts;
 	};
 }
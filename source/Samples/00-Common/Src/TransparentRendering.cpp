@@ -1,6 +1,8 @@
 #include "TransparentRendering.hpp"
 
+#include "RenderTarget.hpp"
 #include "Scene.hpp"
+#include "WeightedBlendedComposite.hpp"
 
 #include <Pipeline/VertexLayout.hpp>
 #include <RenderPass/RenderSubpass.hpp>
@@ -10,23 +12,73 @@ namespace common
 	TransparentRendering::TransparentRendering( NodesRendererPtr && renderer
 		, Scene const & scene
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
-		, common::TextureNodePtrArray const & textureNodes )
+		, common::TextureNodePtrArray const & textureNodes
+		, TransparencyMode mode )
 		: m_renderer{ std::move( renderer ) }
 	{
-		m_renderer->initialise( scene
-			, stagingBuffer
-			, views
-			, textureNodes );
+		if ( mode == TransparencyMode::eWeightedBlended )
+		{
+			// The nodes are rendered to the composite targets, instead of the colour view.
+			m_composite = std::make_unique< WeightedBlendedComposite >( m_renderer->getDevice()
+				, stagingBuffer
+				, views[1].get() );
+			m_renderer->enableWeightedBlending( { views[0].get().getFormat()
+				, WeightedBlendedComposite::AccumulationFormat
+				, WeightedBlendedComposite::RevealageFormat } );
+			m_renderer->initialise( scene
+				, stagingBuffer
+				, descriptorCache
+				, { views[0], m_composite->getAccumulationView(), m_composite->getRevealageView() }
+				, textureNodes );
+		}
+		else
+		{
+			m_renderer->initialise( scene
+				, stagingBuffer
+				, descriptorCache
+				, views
+				, textureNodes );
+		}
+	}
+
+	TransparentRendering::~TransparentRendering()
+	{
 	}
 
 	void TransparentRendering::update( RenderTarget const & target )
 	{
-		m_renderer->update( target );
+		if ( m_composite )
+		{
+			m_composite->update( target.getColourView() );
+			m_renderer->updateViews( { target.getDepthView()
+				, m_composite->getAccumulationView()
+				, m_composite->getRevealageView() } );
+		}
+		else
+		{
+			m_renderer->update( target );
+		}
 	}
 
 	bool TransparentRendering::draw( std::chrono::nanoseconds & gpu )const
 	{
-		return m_renderer->draw( gpu );
+		auto result = m_renderer->draw( gpu );
+
+		if ( result && m_composite )
+		{
+			result = m_composite->draw( gpu );
+		}
+
+		return result;
+	}
+
+	CullingCounts TransparentRendering::cull( renderer::Mat4 const & viewProjection
+		, renderer::Mat4 const & model
+		, HiZBuffer const * hiZ
+		, float lodThreshold )
+	{
+		return m_renderer->cull( viewProjection, model, hiZ, lodThreshold );
 	}
 }
@@ -10,11 +10,17 @@ namespace common
 		TransparentRendering( NodesRendererPtr && renderer
 			, Scene const & scene
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
-			, common::TextureNodePtrArray const & textureNodes );
-		virtual ~TransparentRendering() = default;
+			, common::TextureNodePtrArray const & textureNodes
+			, TransparencyMode mode = TransparencyMode::eForward );
+		virtual ~TransparentRendering();
 		virtual void update( RenderTarget const & target );
 		virtual bool draw( std::chrono::nanoseconds & gpu )const;
+		virtual CullingCounts cull( renderer::Mat4 const & viewProjection
+			, renderer::Mat4 const & model
+			, HiZBuffer const * hiZ
+			, float lodThreshold );
 
 	protected:
 		void doInitialise( Object const & submeshes
@@ -24,5 +30,6 @@ namespace common
 
 	private:
 		NodesRendererPtr m_renderer;
+		WeightedBlendedCompositePtr m_composite;
 	};
 }
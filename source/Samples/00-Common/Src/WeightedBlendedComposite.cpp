@@ -0,0 +1,278 @@
+#include "WeightedBlendedComposite.hpp"
+
+#include "FileUtils.hpp"
+
+#include <Buffer/StagingBuffer.hpp>
+#include <Command/CommandPool.hpp>
+#include <Core/Device.hpp>
+#include <Descriptor/DescriptorSetLayoutBinding.hpp>
+#include <Pipeline/DepthStencilState.hpp>
+#include <Pipeline/InputAssemblyState.hpp>
+#include <Pipeline/MultisampleState.hpp>
+#include <Pipeline/Scissor.hpp>
+#include <Pipeline/Viewport.hpp>
+#include <RenderPass/FrameBufferAttachment.hpp>
+#include <RenderPass/RenderPassCreateInfo.hpp>
+#include <RenderPass/RenderSubpass.hpp>
+#include <RenderPass/RenderSubpassState.hpp>
+#include <Shader/ShaderProgram.hpp>
+
+namespace common
+{
+	namespace
+	{
+		std::vector< renderer::ShaderStageState > doCreateProgram( renderer::Device const & device )
+		{
+			std::string shadersFolder = common::getPath( common::getExecutableDirectory() ) / "share" / "Sample-00-Common" / "Shaders";
+
+			if ( !wxFileExists( shadersFolder / "weighted_blended_composite.vert" )
+				|| !wxFileExists( shadersFolder / "weighted_blended_composite.frag" ) )
+			{
+				throw std::runtime_error{ "Shader files are missing" };
+			}
+
+			std::vector< renderer::ShaderStageState > result;
+			result.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eVertex ) } );
+			result.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eFragment ) } );
+			result[0].module->loadShader( common::dumpTextFile( shadersFolder / "weighted_blended_composite.vert" ) );
+			result[1].module->loadShader( common::dumpTextFile( shadersFolder / "weighted_blended_composite.frag" ) );
+			return result;
+		}
+
+		renderer::RenderPassPtr doCreateRenderPass( renderer::Device const & device
+			, renderer::Format format )
+		{
+			renderer::RenderPassCreateInfo renderPass;
+			renderPass.subpasses.resize( 1u );
+			// The transparent nodes are composited over the opaque ones.
+			renderPass.attachments.push_back(
+			{
+				format,
+				renderer::SampleCountFlag::e1,
+				renderer::AttachmentLoadOp::eLoad,
+				renderer::AttachmentStoreOp::eStore,
+				renderer::AttachmentLoadOp::eDontCare,
+				renderer::AttachmentStoreOp::eDontCare,
+				renderer::ImageLayout::eColourAttachmentOptimal,
+				renderer::ImageLayout::eShaderReadOnlyOptimal
+			} );
+			renderPass.subpasses[0].colorAttachments.emplace_back( renderer::AttachmentReference{ 0u, renderer::ImageLayout::eColourAttachmentOptimal } );
+
+			renderPass.dependencies.resize( 2u );
+			renderPass.dependencies[0].srcSubpass = renderer::ExternalSubpass;
+			renderPass.dependencies[0].dstSubpass = 0u;
+			renderPass.dependencies[0].srcStageMask = renderer::PipelineStageFlag::eColourAttachmentOutput;
+			renderPass.dependencies[0].dstStageMask = renderer::PipelineStageFlag::eFragmentShader;
+			renderPass.dependencies[0].srcAccessMask = renderer::AccessFlag::eColourAttachmentWrite;
+			renderPass.dependencies[0].dstAccessMask = renderer::AccessFlag::eShaderRead;
+			renderPass.dependencies[0].dependencyFlags = renderer::DependencyFlag::eByRegion;
+
+			renderPass.dependencies[1].srcSubpass = 0u;
+			renderPass.dependencies[1].dstSubpass = renderer::ExternalSubpass;
+			renderPass.dependencies[1].srcStageMask = renderer::PipelineStageFlag::eColourAttachmentOutput;
+			renderPass.dependencies[1].dstStageMask = renderer::PipelineStageFlag::eFragmentShader;
+			renderPass.dependencies[1].srcAccessMask = renderer::AccessFlag::eColourAttachmentWrite;
+			renderPass.dependencies[1].dstAccessMask = renderer::AccessFlag::eShaderRead;
+			renderPass.dependencies[1].dependencyFlags = renderer::DependencyFlag::eByRegion;
+
+			return device.createRenderPass( renderPass );
+		}
+
+		renderer::TexturePtr doCreateTexture( renderer::Device const & device
+			, renderer::Format format
+			, renderer::Extent3D const & dimensions )
+		{
+			return device.createTexture(
+				{
+					0,
+					renderer::TextureType::e2D,
+					format,
+					dimensions,
+					1u,
+					1u,
+					renderer::SampleCountFlag::e1,
+					renderer::ImageTiling::eOptimal,
+					renderer::ImageUsageFlag::eColourAttachment | renderer::ImageUsageFlag::eSampled
+				}
+				, renderer::MemoryPropertyFlag::eDeviceLocal );
+		}
+
+		renderer::VertexBufferPtr< utils::Vec4 > doCreateVertexBuffer( renderer::Device const & device
+			, renderer::StagingBuffer & stagingBuffer
+			, renderer::CommandBuffer const & commandBuffer )
+		{
+			std::vector< utils::Vec4 > vertexData
+			{
+				{ -1.0, -1.0, 0.0, 1.0 },
+				{ -1.0, +1.0, 0.0, 1.0 },
+				{ +1.0, -1.0, 0.0, 1.0 },
+				{ +1.0, +1.0, 0.0, 1.0 },
+			};
+			auto result = renderer::makeVertexBuffer< utils::Vec4 >( device
+				, uint32_t( vertexData.size() )
+				, renderer::BufferTarget::eTransferDst
+				, renderer::MemoryPropertyFlag::eDeviceLocal );
+			stagingBuffer.uploadVertexData( commandBuffer
+				, vertexData
+				, *result );
+			return result;
+		}
+
+		renderer::VertexLayoutPtr doCreateVertexLayout()
+		{
+			auto result = renderer::makeLayout< utils::Vec4 >( 0 );
+			result->createAttribute( 0u
+				, renderer::Format::eR32G32B32A32_SFLOAT
+				, 0u );
+			return result;
+		}
+
+		renderer::DescriptorSetLayoutPtr doCreateDescriptorLayout( renderer::Device const & device )
+		{
+			std::vector< renderer::DescriptorSetLayoutBinding > bindings
+			{
+				renderer::DescriptorSetLayoutBinding{ 0u, renderer::DescriptorType::eCombinedImageSampler, renderer::ShaderStageFlag::eFragment },
+				renderer::DescriptorSetLayoutBinding{ 1u, renderer::DescriptorType::eCombinedImageSampler, renderer::ShaderStageFlag::eFragment },
+			};
+			return device.createDescriptorSetLayout( std::move( bindings ) );
+		}
+
+		renderer::ColourBlendState doCreateBlendState()
+		{
+			// The resolved colour's alpha is the transparent nodes coverage.
+			renderer::ColourBlendState result;
+			result.attachs.push_back( renderer::ColourBlendStateAttachment{ true
+				, renderer::BlendFactor::eSrcAlpha
+				, renderer::BlendFactor::eInvSrcAlpha
+				, renderer::BlendOp::eAdd
+				, renderer::BlendFactor::eSrcAlpha
+				, renderer::BlendFactor::eInvSrcAlpha
+				, renderer::BlendOp::eAdd } );
+			return result;
+		}
+	}
+
+	WeightedBlendedComposite::WeightedBlendedComposite( renderer::Device const & device
+		, renderer::StagingBuffer & stagingBuffer
+		, renderer::TextureView const & colourView )
+		: m_device{ device }
+		, m_updateCommandBuffer{ m_device.getGraphicsCommandPool().createCommandBuffer() }
+		, m_commandBuffer{ m_device.getGraphicsCommandPool().createCommandBuffer() }
+		, m_sampler{ m_device.createSampler( renderer::WrapMode::eClampToEdge
+			, renderer::WrapMode::eClampToEdge
+			, renderer::WrapMode::eClampToEdge
+			, renderer::Filter::eNearest
+			, renderer::Filter::eNearest ) }
+		, m_vertexBuffer{ doCreateVertexBuffer( m_device, stagingBuffer, *m_updateCommandBuffer ) }
+		, m_vertexLayout{ doCreateVertexLayout() }
+		, m_descriptorLayout{ doCreateDescriptorLayout( m_device ) }
+		, m_descriptorPool{ m_descriptorLayout->createPool( 1u, false ) }
+		, m_renderPass{ doCreateRenderPass( m_device, colourView.getFormat() ) }
+		, m_pipelineLayout{ m_device.createPipelineLayout( *m_descriptorLayout ) }
+		, m_pipeline{ m_pipelineLayout->createPipeline(
+			{
+				doCreateProgram( m_device ),
+				*m_renderPass,
+				renderer::VertexInputState::create( *m_vertexLayout ),
+				{ renderer::PrimitiveTopology::eTriangleStrip },
+				renderer::RasterisationState{},
+				renderer::MultisampleState{},
+				doCreateBlendState(),
+				{ renderer::DynamicState::eViewport, renderer::DynamicState::eScissor },
+				renderer::DepthStencilState{ 0u, false, false }
+			} ) }
+		, m_queryPool{ m_device.createQueryPool( renderer::QueryType::eTimestamp, 2u, 0u ) }
+	{
+		update( colourView );
+	}
+
+	void WeightedBlendedComposite::update( renderer::TextureView const & colourView )
+	{
+		auto & dimensions = colourView.getTexture().getDimensions();
+
+		if ( m_colourView == &colourView
+			&& m_accumulation
+			&& m_accumulation->getDimensions() == dimensions )
+		{
+			return;
+		}
+
+		m_colourView = &colourView;
+		m_frameBuffer.reset();
+		m_descriptorSet.reset();
+		m_accumulationView.reset();
+		m_revealageView.reset();
+		m_accumulation = doCreateTexture( m_device, AccumulationFormat, dimensions );
+		m_accumulationView = m_accumulation->createView( renderer::TextureViewType::e2D
+			, m_accumulation->getFormat() );
+		m_revealage = doCreateTexture( m_device, RevealageFormat, dimensions );
+		m_revealageView = m_revealage->createView( renderer::TextureViewType::e2D
+			, m_revealage->getFormat() );
+
+		m_descriptorSet = m_descriptorPool->createDescriptorSet( 0u );
+		m_descriptorSet->createBinding( m_descriptorLayout->getBinding( 0u )
+			, *m_accumulationView
+			, *m_sampler );
+		m_descriptorSet->createBinding( m_descriptorLayout->getBinding( 1u )
+			, *m_revealageView
+			, *m_sampler );
+		m_descriptorSet->update();
+
+		renderer::FrameBufferAttachmentArray attaches;
+		attaches.emplace_back( *m_renderPass->getAttachments().begin(), colourView );
+		auto size = renderer::Extent2D{ dimensions.width, dimensions.height };
+		m_frameBuffer = m_renderPass->createFrameBuffer( size
+			, std::move( attaches ) );
+
+		m_commandBuffer->reset();
+		auto & commandBuffer = *m_commandBuffer;
+
+		if ( commandBuffer.begin( renderer::CommandBufferUsageFlag::eSimultaneousUse ) )
+		{
+			commandBuffer.resetQueryPool( *m_queryPool, 0u, 2u );
+			commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eTopOfPipe
+				, *m_queryPool
+				, 0u );
+			commandBuffer.beginRenderPass( *m_renderPass
+				, *m_frameBuffer
+				, { renderer::ClearColorValue{} }
+				, renderer::SubpassContents::eInline );
+			commandBuffer.bindPipeline( *m_pipeline );
+			commandBuffer.setViewport( { size.width
+				, size.height
+				, 0
+				, 0 } );
+			commandBuffer.setScissor( { 0
+				, 0
+				, size.width
+				, size.height } );
+			commandBuffer.bindVertexBuffer( 0u, m_vertexBuffer->getBuffer(), 0u );
+			commandBuffer.bindDescriptorSet( *m_descriptorSet
+				, *m_pipelineLayout );
+			commandBuffer.draw( 4u );
+			commandBuffer.endRenderPass();
+			commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eBottomOfPipe
+				, *m_queryPool
+				, 1u );
+			commandBuffer.end();
+		}
+	}
+
+	bool WeightedBlendedComposite::draw( std::chrono::nanoseconds & gpu )const
+	{
+		bool result = m_device.getGraphicsQueue().submit( *m_commandBuffer, nullptr );
+
+		if ( result )
+		{
+			renderer::UInt32Array values{ 0u, 0u };
+			m_queryPool->getResults( 0u
+				, 2u
+				, 0u
+				, renderer::QueryResultFlag::eWait
+				, values );
+			gpu += std::chrono::nanoseconds{ uint64_t( ( values[1] - values[0] ) / float( m_device.getTimestampPeriod() ) ) };
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Prerequisites.hpp"
+
+#include <Buffer/VertexBuffer.hpp>
+#include <Command/CommandBuffer.hpp>
+#include <Descriptor/DescriptorSet.hpp>
+#include <Descriptor/DescriptorSetLayout.hpp>
+#include <Descriptor/DescriptorSetPool.hpp>
+#include <Image/Sampler.hpp>
+#include <Image/Texture.hpp>
+#include <Image/TextureView.hpp>
+#include <Miscellaneous/QueryPool.hpp>
+#include <Pipeline/Pipeline.hpp>
+#include <Pipeline/PipelineLayout.hpp>
+#include <Pipeline/VertexLayout.hpp>
+#include <RenderPass/FrameBuffer.hpp>
+#include <RenderPass/RenderPass.hpp>
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	The weighted blended order independent transparency targets, and their composition into the colour target.
+	*\remarks
+	*	The transparent nodes are accumulated, in any order, into the accumulation target (weighted premultiplied colours
+	*	and weights sum) and the revealage target (transparencies product), which are then resolved by a full screen pass.
+	*\~french
+	*\brief
+	*	Les cibles de la transparence indépendante de l'ordre "weighted blended", et leur composition dans la cible couleur.
+	*\remarks
+	*	Les noeuds transparents sont accumulés, dans n'importe quel ordre, dans la cible d'accumulation (somme des couleurs
+	*	prémultipliées pondérées et des poids) et dans la cible de révélation (produit des transparences), qui sont ensuite
+	*	résolues par une passe plein écran.
+	*/
+	class WeightedBlendedComposite
+	{
+	public:
+		static renderer::Format constexpr AccumulationFormat = renderer::Format::eR16G16B16A16_SFLOAT;
+		static renderer::Format constexpr RevealageFormat = renderer::Format::eR16_SFLOAT;
+
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Constructor.
+		*\param[in] device
+		*	The logical device.
+		*\param[in] stagingBuffer
+		*	The staging buffer used to upload the full screen quad.
+		*\param[in] colourView
+		*	The colour target, the targets are created with its dimensions.
+		*\~french
+		*\brief
+		*	Constructeur.
+		*\param[in] device
+		*	Le périphérique logique.
+		*\param[in] stagingBuffer
+		*	Le tampon de transfert utilisé pour charger le quad plein écran.
+		*\param[in] colourView
+		*	La cible couleur, les cibles sont créées avec ses dimensions.
+		*/
+		WeightedBlendedComposite( renderer::Device const & device
+			, renderer::StagingBuffer & stagingBuffer
+			, renderer::TextureView const & colourView );
+		/**
+		*\~english
+		*\brief
+		*	Recreates the targets and the composite commands, when the colour target changes.
+		*\~french
+		*\brief
+		*	Recrée les cibles et les commandes de composition, quand la cible couleur change.
+		*/
+		void update( renderer::TextureView const & colourView );
+		bool draw( std::chrono::nanoseconds & gpu )const;
+
+		inline renderer::TextureView const & getAccumulationView()const
+		{
+			return *m_accumulationView;
+		}
+
+		inline renderer::TextureView const & getRevealageView()const
+		{
+			return *m_revealageView;
+		}
+
+	private:
+		renderer::Device const & m_device;
+		renderer::TextureView const * m_colourView{ nullptr };
+		renderer::TexturePtr m_accumulation;
+		renderer::TextureViewPtr m_accumulationView;
+		renderer::TexturePtr m_revealage;
+		renderer::TextureViewPtr m_revealageView;
+		renderer::CommandBufferPtr m_updateCommandBuffer;
+		renderer::CommandBufferPtr m_commandBuffer;
+		renderer::SamplerPtr m_sampler;
+		renderer::VertexBufferPtr< utils::Vec4 > m_vertexBuffer;
+		renderer::VertexLayoutPtr m_vertexLayout;
+		renderer::DescriptorSetLayoutPtr m_descriptorLayout;
+		renderer::DescriptorSetPoolPtr m_descriptorPool;
+		renderer::DescriptorSetPtr m_descriptorSet;
+		renderer::RenderPassPtr m_renderPass;
+		renderer::PipelineLayoutPtr m_pipelineLayout;
+		renderer::PipelinePtr m_pipeline;
+		renderer::FrameBufferPtr m_frameBuffer;
+		renderer::QueryPoolPtr m_queryPool;
+	};
+}
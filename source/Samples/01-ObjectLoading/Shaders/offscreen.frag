@@ -12,7 +12,7 @@ struct TextureOperator
 	uint shininess; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
 	uint opacity; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
 	uint height; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
-	float fill; // align to 16 bytes.
+	uint texture; // the texture array index << 16 | the layer
 };
 
 struct Material
@@ -32,14 +32,14 @@ layout( set=0, binding=0 ) uniform ObjectMaterial
 	Material material;
 };
 
-layout( set=1, binding=0 ) uniform sampler2D textures[MAX_TEXTURES];
+#include "../../Sample-00-Common/Shaders/texture_arrays.glsl"
 
 layout( location = 0 ) in vec3 vtx_normal;
 layout( location = 1 ) in vec3 vtx_tangent;
 layout( location = 2 ) in vec3 vtx_bitangent;
 layout( location = 3 ) in vec2 vtx_texcoord;
 
-layout( location = 0 ) out vec4 pxl_colour;
+#include "../../Sample-00-Common/Shaders/weighted_blended.glsl"
 
 vec3 getDiffuse( TextureOperator operator, vec4 sampled, vec3 diffuse )
 {
@@ -76,7 +76,6 @@ float getOpacity( TextureOperator operator, vec4 sampled, float opacity )
 
 void main()
 {
-	pxl_colour = vec4( 0.0, 0.0, 0.0, 1.0 );
 	vec3 diffuse = material.diffuse.rgb;
 	vec3 specular = material.specular.rgb;
 	vec3 emissive = material.emissive.rgb;
@@ -85,7 +84,7 @@ void main()
 
 	for ( int i = 0; i < material.texturesCount; ++i )
 	{
-		vec4 sampled = texture( textures[i], vtx_texcoord );
+		vec4 sampled = sampleTexture( material.textureOperators[i].texture, vtx_texcoord );
 		TextureOperator operator = material.textureOperators[i];
 		opacity = getOpacity( operator, sampled, opacity );
 		diffuse = getDiffuse( operator, sampled, diffuse );
@@ -94,10 +93,10 @@ void main()
 		shininess = getShininess( operator, sampled, shininess );
 	}
 	
-	if ( opacity < 0.5 )
+	if ( opacity < OPACITY_THRESHOLD )
 	{
 		discard;
 	}
 
-	pxl_colour = vec4( diffuse, opacity );
+	writeColour( vec4( diffuse, opacity ) );
 }
@@ -47,6 +47,9 @@ namespace vkapp
 			, m_objectUbo->getDatas()
 			, *m_objectUbo
 			, renderer::PipelineStageFlag::eVertexShader );
+		auto & sceneData = m_sceneUbo->getData( 0u );
+		doCull( sceneData.mtxProjection * sceneData.mtxView
+			, m_objectUbo->getData( 0 ).mtxModel );
 	}
 
 	void RenderTarget::doResize( renderer::Extent2D const & size )
@@ -56,6 +59,7 @@ namespace vkapp
 
 	common::OpaqueRenderingPtr RenderTarget::doCreateOpaqueRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -69,12 +73,14 @@ namespace vkapp
 				, *m_objectUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
 			, textureNodes );
 	}
 
 	common::TransparentRenderingPtr RenderTarget::doCreateTransparentRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -88,8 +94,10 @@ namespace vkapp
 				, *m_objectUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
-			, textureNodes );
+			, textureNodes
+			, getTransparencyMode() );
 	}
 
 	void RenderTarget::doUpdateMatrixUbo( renderer::Extent2D const & size )
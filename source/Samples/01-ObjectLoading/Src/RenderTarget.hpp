@@ -20,11 +20,13 @@ namespace vkapp
 		virtual void doResize( renderer::Extent2D const & size )override;
 		common::OpaqueRenderingPtr doCreateOpaqueRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::Scene const & scene
 			, common::TextureNodePtrArray const & textureNodes )override;
 		common::TransparentRenderingPtr doCreateTransparentRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::Scene const & scene
 			, common::TextureNodePtrArray const & textureNodes )override;
@@ -13,7 +13,7 @@ struct TextureOperator
 	uint shininess; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
 	uint opacity; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
 	uint height; // 0 for none, 1 for R, 2 for G, 4 for B, 8 for A
-	float fill; // align to 16 bytes.
+	uint texture; // the texture array index << 16 | the layer
 };
 
 struct Material
@@ -67,7 +67,11 @@ layout( set=0, binding=3 ) uniform Lights
 	SpotLight spotLights[MAX_LIGHTS];
 };
 
-layout( set=1, binding=0 ) uniform sampler2D textures[MAX_TEXTURES];
+#define CLUSTERS_SET 0
+#define CLUSTERS_BINDING 4
+#include "../../Sample-00-Common/Shaders/clusters.glsl"
+
+#include "../../Sample-00-Common/Shaders/texture_arrays.glsl"
 
 layout( location = 0 ) in vec3 vtx_normal;
 layout( location = 1 ) in vec3 vtx_tangent;
@@ -75,7 +79,7 @@ layout( location = 2 ) in vec3 vtx_bitangent;
 layout( location = 3 ) in vec2 vtx_texcoord;
 layout( location = 4 ) in vec3 vtx_worldPosition;
 
-layout( location = 0 ) out vec4 pxl_colour;
+#include "../../Sample-00-Common/Shaders/weighted_blended.glsl"
 
 vec3 getDiffuse( TextureOperator operator, vec4 sampled, vec3 diffuse )
 {
@@ -110,7 +114,7 @@ float getOpacity( TextureOperator operator, vec4 sampled, float opacity )
 	return mix( opacity, /*opacity * */max( length( channel * sampled ), min( 1.0, 1.0 - float( opacity ) ) ), float( operator.opacity ) );
 }
 
-void computeLight( Light light, vec3 direction, vec3 normal, float shininess, out vec3 diffuse, out vec3 specular )
+void computeLight( Light light, vec3 direction, vec3 normal, float shininess, inout vec3 diffuse, inout vec3 specular )
 {
 	float diffuseFactor = max( dot( normal, -direction ), 0.0 );
 	diffuse += light.colour.xyz * light.intensities.x * diffuseFactor;
@@ -121,15 +125,59 @@ void computeLight( Light light, vec3 direction, vec3 normal, float shininess, ou
 	specular += vec3( light.colour * shininess * specularFactor );
 }
 
-void computeDirectionalLight( int index, vec3 normal, float shininess, out vec3 diffuse, out vec3 specular )
+void computeDirectionalLight( int index, vec3 normal, float shininess, inout vec3 diffuse, inout vec3 specular )
 {
 	DirectionalLight light = directionalLights[index];
 	computeLight( light.base, light.direction.xyz, normal, shininess, diffuse, specular );
 }
 
+void computeAttenuatedLight( Light light, vec3 direction, float attenuation, vec3 normal, float shininess, inout vec3 diffuse, inout vec3 specular )
+{
+	vec3 lightDiffuse = vec3( 0.0, 0.0, 0.0 );
+	vec3 lightSpecular = vec3( 0.0, 0.0, 0.0 );
+	computeLight( light, direction, normal, shininess, lightDiffuse, lightSpecular );
+	diffuse += lightDiffuse * attenuation;
+	specular += lightSpecular * attenuation;
+}
+
+void computePointLight( PointLight light, vec3 normal, float shininess, inout vec3 diffuse, inout vec3 specular )
+{
+	vec3 direction;
+	float attenuation = getPointLightAttenuation( light, vtx_worldPosition, direction );
+	computeAttenuatedLight( light.base, direction, attenuation, normal, shininess, diffuse, specular );
+}
+
+void computeSpotLight( SpotLight light, vec3 normal, float shininess, inout vec3 diffuse, inout vec3 specular )
+{
+	vec3 direction;
+	float attenuation = getPointLightAttenuation( light.base, vtx_worldPosition, direction )
+		* getSpotLightFactor( light, direction );
+	computeAttenuatedLight( light.base.base, direction, attenuation, normal, shininess, diffuse, specular );
+}
+
+// Only the point and spot lights of the fragment's cluster are processed.
+void computeClusterLights( vec3 normal, float shininess, inout vec3 diffuse, inout vec3 specular )
+{
+	uint cluster = getClusterBase( vtx_worldPosition );
+	uint count = getClusterLightsCount( cluster );
+
+	for ( uint i = 0u; i < count; ++i )
+	{
+		uint light = getClusterLight( cluster, i );
+
+		if ( ( light & SPOT_LIGHT_FLAG ) != 0u )
+		{
+			computeSpotLight( clusterSpotLights[light & ~SPOT_LIGHT_FLAG], normal, shininess, diffuse, specular );
+		}
+		else
+		{
+			computePointLight( clusterPointLights[light], normal, shininess, diffuse, specular );
+		}
+	}
+}
+
 void main()
 {
-	pxl_colour = vec4( 0.0, 0.0, 0.0, 1.0 );
 	vec3 diffuse = material.diffuse.rgb;
 	vec3 specular = material.specular.rgb;
 	vec3 emissive = material.emissive.rgb;
@@ -139,7 +187,7 @@ void main()
 
 	for ( int i = 0; i < material.texturesCount; ++i )
 	{
-		vec4 sampled = texture( textures[i], vtx_texcoord );
+		vec4 sampled = sampleTexture( material.textureOperators[i].texture, vtx_texcoord );
 		TextureOperator operator = material.textureOperators[i];
 		opacity = getOpacity( operator, sampled, opacity );
 		diffuse = getDiffuse( operator, sampled, diffuse );
@@ -148,7 +196,7 @@ void main()
 		shininess = getShininess( operator, sampled, shininess );
 	}
 	
-	if ( opacity < 0.5 )
+	if ( opacity < OPACITY_THRESHOLD )
 	{
 		discard;
 	}
@@ -163,5 +211,7 @@ void main()
 		computeDirectionalLight( i, normal, shininess, lightDiffuse, lightSpecular );
 	}
 
-	pxl_colour = vec4( diffuse * ( lightDiffuse + lightSpecular ), opacity );
+	computeClusterLights( normal, shininess, lightDiffuse, lightSpecular );
+
+	writeColour( vec4( diffuse * ( lightDiffuse + lightSpecular ), opacity ) );
 }
@@ -9,7 +9,8 @@ namespace vkapp
 		, bool opaqueNodes
 		, renderer::UniformBuffer< common::SceneData > const & sceneUbo
 		, renderer::UniformBuffer< common::ObjectData > const & objectUbo
-		, renderer::UniformBuffer< common::LightsData > const & lightsUbo )
+		, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+		, common::LightClusters const & lightClusters )
 		: common::NodesRenderer{ device
 			, fragmentShaderFile
 			, formats
@@ -18,7 +19,12 @@ namespace vkapp
 		, m_sceneUbo{ sceneUbo }
 		, m_objectUbo{ objectUbo }
 		, m_lightsUbo{ lightsUbo }
+		, m_lightClusters{ lightClusters }
 	{
+		if ( m_lightClusters.isClustered() )
+		{
+			addFragmentDefine( "CLUSTERED_LIGHTS" );
+		}
 	}
 
 	void NodesRenderer::doFillObjectDescriptorLayoutBindings( renderer::DescriptorSetLayoutBindingArray & bindings )
@@ -26,6 +32,7 @@ namespace vkapp
 		bindings.emplace_back( 1u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eVertex );
 		bindings.emplace_back( 2u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eVertex );
 		bindings.emplace_back( 3u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eFragment );
+		m_lightClusters.fillDescriptorLayoutBindings( bindings, 4u, renderer::ShaderStageFlag::eFragment );
 	}
 
 	void NodesRenderer::doFillObjectDescriptorSet( renderer::DescriptorSetLayout & descriptorLayout
@@ -43,5 +50,8 @@ namespace vkapp
 			, m_lightsUbo
 			, 0u
 			, 1u );
+		m_lightClusters.fillDescriptorSet( descriptorLayout
+			, descriptorSet
+			, 4u );
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "Prerequisites.hpp"
 
+#include <LightClusters.hpp>
 #include <NodesRenderer.hpp>
 
 namespace vkapp
@@ -17,7 +18,8 @@ namespace vkapp
 			, bool opaqueNodes
 			, renderer::UniformBuffer< common::SceneData > const & sceneUbo
 			, renderer::UniformBuffer< common::ObjectData > const & objectUbo
-			, renderer::UniformBuffer< common::LightsData > const & lightsUbo );
+			, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+			, common::LightClusters const & lightClusters );
 
 	private:
 		void doFillObjectDescriptorLayoutBindings( renderer::DescriptorSetLayoutBindingArray & bindings )override;
@@ -28,5 +30,6 @@ namespace vkapp
 		renderer::UniformBuffer< common::SceneData > const & m_sceneUbo;
 		renderer::UniformBuffer< common::ObjectData > const & m_objectUbo;
 		renderer::UniformBuffer< common::LightsData > const & m_lightsUbo;
+		common::LightClusters const & m_lightClusters;
 	};
 }
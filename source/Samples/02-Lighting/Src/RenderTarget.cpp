@@ -30,6 +30,7 @@ namespace vkapp
 			, 1u
 			, renderer::BufferTarget::eTransferDst
 			, renderer::MemoryPropertyFlag::eDeviceLocal ) }
+		, m_lightClusters{ device, 1024u }
 	{
 		doInitialise();
 		doUpdateMatrixUbo( size );
@@ -52,6 +53,9 @@ namespace vkapp
 			, m_objectUbo->getDatas()
 			, *m_objectUbo
 			, renderer::PipelineStageFlag::eVertexShader );
+		auto & sceneData = m_sceneUbo->getData( 0u );
+		doCull( sceneData.mtxProjection * sceneData.mtxView
+			, m_objectUbo->getData( 0 ).mtxModel );
 	}
 
 	void RenderTarget::doResize( renderer::Extent2D const & size )
@@ -61,6 +65,7 @@ namespace vkapp
 
 	common::OpaqueRenderingPtr RenderTarget::doCreateOpaqueRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -72,15 +77,18 @@ namespace vkapp
 				, true
 				, *m_sceneUbo
 				, *m_objectUbo
-				, *m_lightsUbo )
+				, *m_lightsUbo
+				, m_lightClusters )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
 			, textureNodes );
 	}
 
 	common::TransparentRenderingPtr RenderTarget::doCreateTransparentRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -92,21 +100,29 @@ namespace vkapp
 				, false
 				, *m_sceneUbo
 				, *m_objectUbo
-				, *m_lightsUbo )
+				, *m_lightsUbo
+				, m_lightClusters )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
-			, textureNodes );
+			, textureNodes
+			, getTransparencyMode() );
 	}
 
 	void RenderTarget::doUpdateMatrixUbo( renderer::Extent2D const & size )
 	{
 		auto width = float( size.width );
 		auto height = float( size.height );
-		m_sceneUbo->getData( 0u ).mtxProjection = m_device.perspective( float( utils::toRadians( 90.0_degrees ) )
+		auto & sceneData = m_sceneUbo->getData( 0u );
+		sceneData.mtxProjection = m_device.perspective( float( utils::toRadians( 90.0_degrees ) )
 			, width / height
 			, 0.01f
 			, 100.0f );
+		m_lightClusters.update( sceneData.mtxView
+			, sceneData.mtxProjection
+			, 0.01f
+			, 100.0f );
 		m_stagingBuffer->uploadUniformData( *m_updateCommandBuffer
 			, m_sceneUbo->getDatas()
 			, *m_sceneUbo
@@ -127,6 +143,17 @@ namespace vkapp
 		};
 		lights.directionalLights[0] = directional;
 
+		// The point and spot lights are only limited by the clusters capacity, or by MAX_LIGHTS without clustering.
+		common::PointLightArray pointLights;
+		common::SpotLightArray spotLights;
+		common::generateLights( { 0.0f, 0.0f, -5.0f }
+			, 2.5f
+			, 512u
+			, pointLights
+			, spotLights );
+		m_lightClusters.setLights( pointLights, spotLights );
+		m_lightClusters.fillLights( lights );
+
 		m_stagingBuffer->uploadUniformData( *m_updateCommandBuffer
 			, m_lightsUbo->getDatas()
 			, *m_lightsUbo
@@ -2,6 +2,7 @@
 
 #include "Prerequisites.hpp"
 
+#include <LightClusters.hpp>
 #include <RenderTarget.hpp>
 
 namespace vkapp
@@ -20,11 +21,13 @@ namespace vkapp
 		virtual void doResize( renderer::Extent2D const & size )override;
 		common::OpaqueRenderingPtr doCreateOpaqueRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::Scene const & scene
 			, common::TextureNodePtrArray const & textureNodes )override;
 		common::TransparentRenderingPtr doCreateTransparentRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::Scene const & scene
 			, common::TextureNodePtrArray const & textureNodes )override;
@@ -35,6 +38,7 @@ namespace vkapp
 		renderer::UniformBufferPtr< common::SceneData > m_sceneUbo;
 		renderer::UniformBufferPtr< common::ObjectData > m_objectUbo;
 		renderer::UniformBufferPtr< common::LightsData > m_lightsUbo;
+		common::LightClusters m_lightClusters;
 		renderer::Mat4 m_rotate;
 	};
 }
@@ -52,6 +52,9 @@ namespace vkapp
 			, m_objectUbo->getDatas()
 			, *m_objectUbo
 			, renderer::PipelineStageFlag::eVertexShader );
+		auto & sceneData = m_sceneUbo->getData( 0u );
+		doCull( sceneData.mtxProjection * sceneData.mtxView
+			, m_objectUbo->getData( 0 ).mtxModel );
 	}
 
 	void RenderTarget::doResize( renderer::Extent2D const & size )
@@ -61,6 +64,7 @@ namespace vkapp
 
 	common::OpaqueRenderingPtr RenderTarget::doCreateOpaqueRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -75,12 +79,14 @@ namespace vkapp
 				, *m_lightsUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
 			, textureNodes );
 	}
 
 	common::TransparentRenderingPtr RenderTarget::doCreateTransparentRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -95,8 +101,10 @@ namespace vkapp
 				, *m_lightsUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
-			, textureNodes );
+			, textureNodes
+			, getTransparencyMode() );
 	}
 
 	void RenderTarget::doUpdateMatrixUbo( renderer::Extent2D const & size )
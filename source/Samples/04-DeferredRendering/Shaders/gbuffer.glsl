@@ -0,0 +1,46 @@
+// shadertype=glsl
+
+// G-buffer packing functions, shared by the geometry and lighting passes.
+
+vec2 signNotZero( vec2 value )
+{
+	return vec2( value.x >= 0.0 ? 1.0 : -1.0
+		, value.y >= 0.0 ? 1.0 : -1.0 );
+}
+
+// Octahedral encoding of a unit vector, to [0, 1] range.
+vec2 encodeNormal( vec3 normal )
+{
+	vec2 result = normal.xy / ( abs( normal.x ) + abs( normal.y ) + abs( normal.z ) );
+
+	if ( normal.z <= 0.0 )
+	{
+		result = ( 1.0 - abs( result.yx ) ) * signNotZero( result );
+	}
+
+	return result * 0.5 + 0.5;
+}
+
+vec3 decodeNormal( vec2 encoded )
+{
+	vec2 value = encoded * 2.0 - 1.0;
+	vec3 result = vec3( value, 1.0 - abs( value.x ) - abs( value.y ) );
+
+	if ( result.z < 0.0 )
+	{
+		result.xy = ( 1.0 - abs( result.yx ) ) * signNotZero( result.xy );
+	}
+
+	return normalize( result );
+}
+
+// Logarithmic encoding of the shininess, to [0, 1] range, for values up to 2047.
+float encodeShininess( float shininess )
+{
+	return clamp( log2( 1.0 + shininess ) / 11.0, 0.0, 1.0 );
+}
+
+float decodeShininess( float encoded )
+{
+	return exp2( encoded * 11.0 ) - 1.0;
+}
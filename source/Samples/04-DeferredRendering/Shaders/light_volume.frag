@@ -0,0 +1,5 @@
+// shadertype=glsl
+
+#version 450
+
+#include "light_volume.glsl"
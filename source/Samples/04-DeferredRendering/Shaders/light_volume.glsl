@@ -0,0 +1,56 @@
+// shadertype=glsl
+
+// The light volumes, adding one point or spot light contribution to the lit pixels.
+
+#include "lighting.glsl"
+
+layout( location = 0 ) flat in uint vtx_light;
+
+layout( location = 0 ) out vec4 pxl_colour;
+
+void main()
+{
+	vec2 texcoord = gl_FragCoord.xy / vec2( textureSize( depthMap, 0 ) );
+	vec3 worldPosition;
+	vec3 normal;
+	vec4 specular;
+	readGBuffer( texcoord, worldPosition, normal, specular );
+	vec3 lightDiffuse = vec3( 0.0, 0.0, 0.0 );
+	vec3 lightSpecular = vec3( 0.0, 0.0, 0.0 );
+
+	if ( ( vtx_light & SPOT_LIGHT_FLAG ) != 0u )
+	{
+		SpotLight light = clusterSpotLights[vtx_light & ~SPOT_LIGHT_FLAG];
+
+		// The volumes are drawn without faces culling, so the surfaces in front of them must be rejected.
+		if ( distance( worldPosition, light.base.position.xyz ) > light.base.position.w )
+		{
+			discard;
+		}
+
+		computeSpotLight( light
+			, normal
+			, specular.w
+			, worldPosition
+			, lightDiffuse
+			, lightSpecular );
+	}
+	else
+	{
+		PointLight light = clusterPointLights[vtx_light];
+
+		if ( distance( worldPosition, light.position.xyz ) > light.position.w )
+		{
+			discard;
+		}
+
+		computePointLight( light
+			, normal
+			, specular.w
+			, worldPosition
+			, lightDiffuse
+			, lightSpecular );
+	}
+
+	pxl_colour = vec4( texture( diffuseMap, texcoord ).xyz * ( lightDiffuse + lightSpecular ), 1.0 );
+}
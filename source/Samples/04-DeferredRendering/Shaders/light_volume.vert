@@ -0,0 +1,47 @@
+#version 450
+
+// The light volumes: one instance per light, a sphere for the point lights, or a cone for the spot lights when SPOT_LIGHT is defined.
+// The proxy meshes enclose the unit sphere, or the unit cone (apex at the origin, base of radius 1 at Z = 1).
+
+#include "lights.glsl"
+
+#ifdef VULKAN
+#	define instanceIndex gl_InstanceIndex
+#else
+#	define instanceIndex gl_InstanceID
+#endif
+
+layout( location = 0 ) in vec3 position;
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+layout( location = 0 ) flat out uint vtx_light;
+
+void main()
+{
+	uint index = uint( instanceIndex );
+#ifdef SPOT_LIGHT
+	SpotLight light = clusterSpotLights[index];
+	vec3 axis = normalize( light.direction.xyz );
+	vec3 up = abs( axis.y ) < 0.99 ? vec3( 0.0, 1.0, 0.0 ) : vec3( 1.0, 0.0, 0.0 );
+	vec3 side = normalize( cross( up, axis ) );
+	up = cross( axis, side );
+	float range = light.base.position.w;
+	float cutoff = max( light.coeffs.x, 0.01 );
+	float radius = range * sqrt( 1.0 - cutoff * cutoff ) / cutoff;
+	vec3 worldPosition = light.base.position.xyz
+		+ side * position.x * radius
+		+ up * position.y * radius
+		+ axis * position.z * range;
+	vtx_light = index | SPOT_LIGHT_FLAG;
+#else
+	PointLight light = clusterPointLights[index];
+	vec3 worldPosition = light.position.xyz + position * light.position.w;
+	vtx_light = index;
+#endif
+	// The volume must cover the pixels whose reconstructed position is lit, hence no rendererScalePosition.
+	gl_Position = clustersProjection * clustersView * vec4( worldPosition, 1.0 );
+}
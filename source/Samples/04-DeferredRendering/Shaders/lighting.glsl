@@ -0,0 +1,136 @@
+// shadertype=glsl
+
+// The G-buffer reading and lights computations, shared by the lighting pass and the light volumes.
+// The G-buffer is read with the full layout, or with the packed one when PACKED_GBUFFER is defined.
+
+#include "lights.glsl"
+#include "gbuffer.glsl"
+
+// With the packed layout, the depth map is the depth buffer.
+layout( set=0, binding=0 ) uniform sampler2D depthMap;
+layout( set=0, binding=1 ) uniform sampler2D diffuseMap;
+layout( set=0, binding=2 ) uniform sampler2D specularMap;
+layout( set=0, binding=3 ) uniform sampler2D emissiveMap;
+layout( set=0, binding=4 ) uniform sampler2D normalMap;
+
+void computeLight( Light light
+	, vec3 direction
+	, vec3 normal
+	, float shininess
+	, vec3 worldPosition
+	, inout vec3 diffuse
+	, inout vec3 specular )
+{
+	float diffuseFactor = max( dot( normal, -direction ), 0.0 );
+	diffuse += light.colour.xyz * light.intensities.x * diffuseFactor;
+	vec3 vertexToEye = normalize( -worldPosition );
+	vec3 lightReflect = normalize( reflect( direction, normal ) );
+	float specularFactor = max( dot( vertexToEye, lightReflect ), 0.0 );
+	specularFactor = pow( specularFactor, light.intensities.y );
+	specular += vec3( light.colour * shininess * specularFactor );
+}
+
+void computeDirectionalLight( int index
+	, vec3 normal
+	, float shininess
+	, vec3 worldPosition
+	, inout vec3 diffuse
+	, inout vec3 specular )
+{
+	DirectionalLight light = directionalLights[index];
+	computeLight( light.base
+		, light.direction.xyz
+		, normal
+		, shininess
+		, worldPosition
+		, diffuse
+		, specular );
+}
+
+void computeAttenuatedLight( Light light
+	, vec3 direction
+	, float attenuation
+	, vec3 normal
+	, float shininess
+	, vec3 worldPosition
+	, inout vec3 diffuse
+	, inout vec3 specular )
+{
+	vec3 lightDiffuse = vec3( 0.0, 0.0, 0.0 );
+	vec3 lightSpecular = vec3( 0.0, 0.0, 0.0 );
+	computeLight( light
+		, direction
+		, normal
+		, shininess
+		, worldPosition
+		, lightDiffuse
+		, lightSpecular );
+	diffuse += lightDiffuse * attenuation;
+	specular += lightSpecular * attenuation;
+}
+
+void computePointLight( PointLight light
+	, vec3 normal
+	, float shininess
+	, vec3 worldPosition
+	, inout vec3 diffuse
+	, inout vec3 specular )
+{
+	vec3 direction;
+	float attenuation = getPointLightAttenuation( light, worldPosition, direction );
+	computeAttenuatedLight( light.base
+		, direction
+		, attenuation
+		, normal
+		, shininess
+		, worldPosition
+		, diffuse
+		, specular );
+}
+
+void computeSpotLight( SpotLight light
+	, vec3 normal
+	, float shininess
+	, vec3 worldPosition
+	, inout vec3 diffuse
+	, inout vec3 specular )
+{
+	vec3 direction;
+	float attenuation = getPointLightAttenuation( light.base, worldPosition, direction )
+		* getSpotLightFactor( light, direction );
+	computeAttenuatedLight( light.base.base
+		, direction
+		, attenuation
+		, normal
+		, shininess
+		, worldPosition
+		, diffuse
+		, specular );
+}
+
+vec3 computeWorldSpacePosition( float depth
+	, vec2 uv
+	, mat4 invViewProj )
+{
+	vec3 csPosition = vec3( uv * 2.0f - 1.0f, depth * 2.0 - 1.0 );
+	vec4 wsPosition = invViewProj * vec4( csPosition, 1.0 );
+	wsPosition.xyz /= wsPosition.w;
+	return wsPosition.xyz;
+}
+
+void readGBuffer( vec2 texcoord
+	, out vec3 worldPosition
+	, out vec3 normal
+	, out vec4 specular )
+{
+	float depth = texture( depthMap, texcoord ).x;
+	worldPosition = computeWorldSpacePosition( depth, texcoord, mtxInvViewProj );
+#ifdef PACKED_GBUFFER
+	normal = decodeNormal( texture( normalMap, texcoord ).xy );
+	specular = texture( specularMap, texcoord );
+	specular.w = decodeShininess( specular.w );
+#else
+	normal = texture( normalMap, texcoord ).xyz;
+	specular = texture( specularMap, texcoord );
+#endif
+}
@@ -0,0 +1,50 @@
+// shadertype=glsl
+
+// The lights descriptors, shared by the lighting pass and the light volumes.
+
+#extension GL_KHR_vulkan_glsl : enable
+
+#define MAX_LIGHTS 10
+
+struct Light
+{
+	vec4 colour;
+	vec4 intensities;
+};
+
+struct DirectionalLight
+{
+	Light base;
+	vec4 direction;
+};
+
+struct PointLight
+{
+	Light base;
+	vec4 position;// .w = range
+	vec4 attenation;
+};
+
+struct SpotLight
+{
+	PointLight base;
+	vec4 direction;
+	vec4 coeffs;// .x = cutoff (cosine of the cone half angle), .y = exponent
+};
+
+layout( set=1, binding=0 ) uniform Lights
+{
+	ivec4 lightsCount;
+	DirectionalLight directionalLights[MAX_LIGHTS];
+	PointLight pointLights[MAX_LIGHTS];
+	SpotLight spotLights[MAX_LIGHTS];
+};
+
+layout( set=1, binding=1 ) uniform Matrix
+{
+	mat4 mtxInvViewProj;
+};
+
+#define CLUSTERS_SET 1
+#define CLUSTERS_BINDING 2
+#include "../../Sample-00-Common/Shaders/clusters.glsl"
@@ -0,0 +1,6 @@
+// shadertype=glsl
+
+#version 450
+
+#define PACKED_GBUFFER
+#include "opaque_gp.glsl"
@@ -0,0 +1,84 @@
+// shadertype=glsl
+
+// The lighting pass, reading the G-buffer with the full layout, or with the packed one when PACKED_GBUFFER is defined.
+// When LIGHT_VOLUMES is defined, only the directional lights are processed, the other ones being drawn as light volumes.
+
+#include "lighting.glsl"
+
+layout( location = 0 ) in vec2 vtx_texcoord;
+
+layout( location = 0 ) out vec4 pxl_colour;
+
+#ifndef LIGHT_VOLUMES
+
+// Only the point and spot lights of the pixel's cluster are processed.
+void computeClusterLights( vec3 normal
+	, float shininess
+	, vec3 worldPosition
+	, inout vec3 diffuse
+	, inout vec3 specular )
+{
+	uint cluster = getClusterBase( worldPosition );
+	uint count = getClusterLightsCount( cluster );
+
+	for ( uint i = 0u; i < count; ++i )
+	{
+		uint light = getClusterLight( cluster, i );
+
+		if ( ( light & SPOT_LIGHT_FLAG ) != 0u )
+		{
+			computeSpotLight( clusterSpotLights[light & ~SPOT_LIGHT_FLAG]
+				, normal
+				, shininess
+				, worldPosition
+				, diffuse
+				, specular );
+		}
+		else
+		{
+			computePointLight( clusterPointLights[light]
+				, normal
+				, shininess
+				, worldPosition
+				, diffuse
+				, specular );
+		}
+	}
+}
+
+#endif
+
+void main()
+{
+#ifdef VULKAN
+	vec2 texcoord = vtx_texcoord;
+#else
+	vec2 texcoord = vec2( vtx_texcoord.x, 1.0 - vtx_texcoord.y );
+#endif
+
+	vec3 worldPosition;
+	vec3 normal;
+	vec4 specular;
+	readGBuffer( texcoord, worldPosition, normal, specular );
+	vec3 lightDiffuse = vec3( 0.0, 0.0, 0.0 );
+	vec3 lightSpecular = vec3( 0.0, 0.0, 0.0 );
+
+	for ( int i = 0; i < lightsCount.x; ++i )
+	{
+		computeDirectionalLight( i
+			, normal
+			, specular.w
+			, worldPosition
+			, lightDiffuse
+			, lightSpecular );
+	}
+
+#ifndef LIGHT_VOLUMES
+	computeClusterLights( normal
+		, specular.w
+		, worldPosition
+		, lightDiffuse
+		, lightSpecular );
+#endif
+	pxl_colour = vec4( texture( diffuseMap, texcoord ).xyz * ( lightDiffuse + lightSpecular ), 1.0 );
+}
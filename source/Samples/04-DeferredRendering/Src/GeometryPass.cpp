@@ -45,7 +45,7 @@ namespace vkapp
 				depthFormat,
 			};
 
-			for ( auto & texture : gbuffer )
+			for ( auto & texture : gbuffer.textures )
 			{
 				result.push_back( texture.view->getFormat() );
 			}
@@ -61,7 +61,7 @@ namespace vkapp
 				depthview
 			};
 
-			for ( auto & texture : gbuffer )
+			for ( auto & texture : gbuffer.textures )
 			{
 				result.emplace_back( *texture.view );
 			}
@@ -28,38 +28,94 @@
 #include <Shader/ShaderProgram.hpp>
 #include <Sync/ImageMemoryBarrier.hpp>
 
+#include <Angle.hpp>
 #include <FileUtils.hpp>
 
 namespace vkapp
 {
 	namespace
 	{
-		std::vector< renderer::ShaderStageState > doCreateProgram( renderer::Device const & device )
+		// The defines must follow the #version directive.
+		std::string doAddDefine( std::string source
+			, std::string const & define )
+		{
+			auto end = source.find( '\n', source.find( "#version" ) );
+			source.insert( end + 1u, "#define " + define + "\n" );
+			return source;
+		}
+
+		std::vector< renderer::ShaderStageState > doCreateProgram( renderer::Device const & device
+			, GBufferLayout layout
+			, LightingStrategy strategy
+			, common::LightClusters const & lightClusters )
 		{
 			std::string shadersFolder = common::getPath( common::getExecutableDirectory() ) / "share" / AppName / "Shaders";
+			std::string fragmentShaderFile = layout == GBufferLayout::ePacked
+				? "opaque_lp_packed.frag"
+				: "opaque_lp.frag";
 
 			if ( !wxFileExists( shadersFolder / "opaque_lp.vert" )
-				|| !wxFileExists( shadersFolder / "opaque_lp.frag" ) )
+				|| !wxFileExists( shadersFolder / fragmentShaderFile ) )
 			{
 				throw std::runtime_error{ "Shader files are missing" };
 			}
 
+			auto fragmentShader = common::dumpShaderFile( shadersFolder / fragmentShaderFile );
+
+			if ( strategy == LightingStrategy::eLightVolumes )
+			{
+				fragmentShader = doAddDefine( fragmentShader, "LIGHT_VOLUMES" );
+			}
+
+			if ( lightClusters.isClustered() )
+			{
+				fragmentShader = doAddDefine( fragmentShader, "CLUSTERED_LIGHTS" );
+			}
+
 			std::vector< renderer::ShaderStageState > shaderStages;
 			shaderStages.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eVertex ) } );
 			shaderStages.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eFragment ) } );
 			shaderStages[0].module->loadShader( common::dumpTextFile( shadersFolder / "opaque_lp.vert" ) );
-			shaderStages[1].module->loadShader( common::dumpTextFile( shadersFolder / "opaque_lp.frag" ) );
+			shaderStages[1].module->loadShader( fragmentShader );
 			return shaderStages;
 		}
 
-		std::vector< renderer::Format > doGetFormats( renderer::TextureView const & depthView
-			, renderer::TextureView const & colourView )
+		std::vector< renderer::ShaderStageState > doCreateVolumeProgram( renderer::Device const & device
+			, GBufferLayout layout
+			, bool spot
+			, common::LightClusters const & lightClusters )
 		{
-			return
+			std::string shadersFolder = common::getPath( common::getExecutableDirectory() ) / "share" / AppName / "Shaders";
+			std::string fragmentShaderFile = layout == GBufferLayout::ePacked
+				? "light_volume_packed.frag"
+				: "light_volume.frag";
+
+			if ( !wxFileExists( shadersFolder / "light_volume.vert" )
+				|| !wxFileExists( shadersFolder / fragmentShaderFile ) )
 			{
-				depthView.getFormat(),
-				colourView.getFormat(),
-			};
+				throw std::runtime_error{ "Shader files are missing" };
+			}
+
+			auto vertexShader = common::dumpShaderFile( shadersFolder / "light_volume.vert" );
+			auto fragmentShader = common::dumpShaderFile( shadersFolder / fragmentShaderFile );
+
+			if ( spot )
+			{
+				vertexShader = doAddDefine( vertexShader, "SPOT_LIGHT" );
+			}
+
+			if ( lightClusters.isClustered() )
+			{
+				vertexShader = doAddDefine( vertexShader, "CLUSTERED_LIGHTS" );
+				fragmentShader = doAddDefine( fragmentShader, "CLUSTERED_LIGHTS" );
+			}
+
+			std::vector< renderer::ShaderStageState > shaderStages;
+			shaderStages.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eVertex ) } );
+			shaderStages.push_back( { device.createShaderModule( renderer::ShaderStageFlag::eFragment ) } );
+			shaderStages[0].module->loadShader( vertexShader );
+			shaderStages[1].module->loadShader( fragmentShader );
+			return shaderStages;
 		}
 
 		renderer::AttachmentDescriptionArray doGetAttaches( renderer::TextureView const & depthView
@@ -74,8 +130,8 @@ namespace vkapp
 					renderer::AttachmentStoreOp::eStore,
 					renderer::AttachmentLoadOp::eLoad,
 					renderer::AttachmentStoreOp::eStore,
-					renderer::ImageLayout::eUndefined,
-					renderer::ImageLayout::eDepthStencilAttachmentOptimal,
+					renderer::ImageLayout::eDepthStencilReadOnlyOptimal,
+					renderer::ImageLayout::eDepthStencilReadOnlyOptimal,
 				},
 				{
 					colourView.getFormat(),
@@ -85,7 +141,7 @@ namespace vkapp
 					renderer::AttachmentLoadOp::eDontCare,
 					renderer::AttachmentStoreOp::eDontCare,
 					renderer::ImageLayout::eUndefined,
-					renderer::ImageLayout::eDepthStencilAttachmentOptimal,
+					renderer::ImageLayout::eColourAttachmentOptimal,
 				}
 			};
 		}
@@ -94,6 +150,8 @@ namespace vkapp
 			, renderer::TextureView const & depthView
 			, renderer::TextureView const & colourView )
 		{
+			// The depth buffer is read only, since the light volumes are depth tested against it,
+			// and since it is sampled with the packed G-buffer layout.
 			renderer::AttachmentReferenceArray subAttaches
 			{
 				renderer::AttachmentReference{ 1u, renderer::ImageLayout::eColourAttachmentOptimal },
@@ -102,7 +160,7 @@ namespace vkapp
 			subpasses.emplace_back( std::make_unique< renderer::RenderSubpass >( renderer::PipelineBindPoint::eGraphics
 				, renderer::RenderSubpassState{ renderer::PipelineStageFlag::eColourAttachmentOutput, renderer::AccessFlag::eColourAttachmentWrite }
 				, subAttaches
-				, renderer::AttachmentReference{ 0u, renderer::ImageLayout::eDepthStencilAttachmentOptimal } ) );
+				, renderer::AttachmentReference{ 0u, renderer::ImageLayout::eDepthStencilReadOnlyOptimal } ) );
 			return device.createRenderPass( doGetAttaches( depthView, colourView )
 				, std::move( subpasses )
 				, renderer::RenderSubpassState{ renderer::PipelineStageFlag::eColourAttachmentOutput
@@ -115,7 +173,6 @@ namespace vkapp
 			, renderer::TextureView const & depthView
 			, renderer::TextureView const & colourView )
 		{
-			auto formats = doGetFormats( depthView, colourView );
 			renderer::FrameBufferAttachmentArray attaches;
 			attaches.emplace_back( *( renderPass.getAttachments().begin() + 0u ), depthView );
 			attaches.emplace_back( *( renderPass.getAttachments().begin() + 1u ), colourView );
@@ -124,6 +181,24 @@ namespace vkapp
 				, std::move( attaches ) );
 		}
 
+		renderer::TextureViewCRefArray doGetGBufferViews( GeometryPassResult const & gbuffer )
+		{
+			renderer::TextureViewCRefArray result;
+
+			// The packed layout reads the depth from the depth buffer.
+			if ( gbuffer.layout == GBufferLayout::ePacked )
+			{
+				result.emplace_back( *gbuffer.depthView );
+			}
+
+			for ( auto & texture : gbuffer.textures )
+			{
+				result.emplace_back( *texture.view );
+			}
+
+			return result;
+		}
+
 		renderer::DescriptorSetLayoutPtr doCreateGBufferDescriptorLayout( renderer::Device const & device )
 		{
 			std::vector< renderer::DescriptorSetLayoutBinding > bindings
@@ -137,18 +212,24 @@ namespace vkapp
 			return device.createDescriptorSetLayout( std::move( bindings ) );
 		}
 
-		renderer::DescriptorSetLayoutPtr doCreateUboDescriptorLayout( renderer::Device const & device )
+		renderer::DescriptorSetLayoutPtr doCreateUboDescriptorLayout( renderer::Device const & device
+			, common::LightClusters const & lightClusters )
 		{
 			std::vector< renderer::DescriptorSetLayoutBinding > bindings
 			{
-				renderer::DescriptorSetLayoutBinding{ 0u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eFragment },
+				renderer::DescriptorSetLayoutBinding{ 0u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eVertex | renderer::ShaderStageFlag::eFragment },
 				renderer::DescriptorSetLayoutBinding{ 1u, renderer::DescriptorType::eUniformBuffer, renderer::ShaderStageFlag::eFragment },
 			};
+			// The light volumes read their light in the vertex shader, from the lights UBO without clustering.
+			lightClusters.fillDescriptorLayoutBindings( bindings
+				, 2u
+				, renderer::ShaderStageFlag::eVertex | renderer::ShaderStageFlag::eFragment );
 			return device.createDescriptorSetLayout( std::move( bindings ) );
 		}
 
 		renderer::DescriptorSetPtr doCreateUboDescriptorSet( renderer::DescriptorSetPool const & pool
 			, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+			, common::LightClusters const & lightClusters
 			, renderer::UniformBuffer< common::SceneData > const & sceneUbo )
 		{
 			auto & layout = pool.getLayout();
@@ -161,6 +242,9 @@ namespace vkapp
 				, sceneUbo
 				, 0u
 				, 1u );
+			lightClusters.fillDescriptorSet( layout
+				, *result
+				, 2u );
 			result->update();
 			return result;
 		}
@@ -197,22 +281,106 @@ namespace vkapp
 				, uint32_t( offsetof( common::TexturedVertexData, uv ) ) );
 			return result;
 		}
+
+		struct ProxyMesh
+		{
+			std::vector< utils::Vec3 > vertices;
+			std::vector< uint16_t > indices;
+		};
+
+		// A UV sphere, its vertices being pushed out so that its faces enclose the unit sphere.
+		ProxyMesh doCreateSphereMesh()
+		{
+			static uint32_t constexpr Rings = 8u;
+			static uint32_t constexpr Segments = 16u;
+			auto radius = 1.0f / std::cos( float( utils::Pi ) / Rings );
+			ProxyMesh result;
+
+			for ( uint32_t ring = 0u; ring <= Rings; ++ring )
+			{
+				auto theta = float( utils::Pi ) * ring / Rings;
+
+				for ( uint32_t segment = 0u; segment < Segments; ++segment )
+				{
+					auto phi = 2.0f * float( utils::Pi ) * segment / Segments;
+					result.vertices.push_back( utils::Vec3{ radius * std::sin( theta ) * std::cos( phi )
+						, radius * std::cos( theta )
+						, radius * std::sin( theta ) * std::sin( phi ) } );
+				}
+			}
+
+			for ( uint32_t ring = 0u; ring < Rings; ++ring )
+			{
+				for ( uint32_t segment = 0u; segment < Segments; ++segment )
+				{
+					auto a = uint16_t( ring * Segments + segment );
+					auto b = uint16_t( ring * Segments + ( segment + 1u ) % Segments );
+					result.indices.insert( result.indices.end()
+						, { a, uint16_t( a + Segments ), b, b, uint16_t( a + Segments ), uint16_t( b + Segments ) } );
+				}
+			}
+
+			return result;
+		}
+
+		// A capped cone, apex at the origin, its base being pushed out so that it encloses the unit cone.
+		ProxyMesh doCreateConeMesh()
+		{
+			static uint32_t constexpr Segments = 16u;
+			auto radius = 1.0f / std::cos( float( utils::Pi ) / Segments );
+			ProxyMesh result;
+			result.vertices.push_back( utils::Vec3{ 0.0f, 0.0f, 0.0f } );
+			result.vertices.push_back( utils::Vec3{ 0.0f, 0.0f, 1.0f } );
+
+			for ( uint32_t segment = 0u; segment < Segments; ++segment )
+			{
+				auto phi = 2.0f * float( utils::Pi ) * segment / Segments;
+				result.vertices.push_back( utils::Vec3{ radius * std::cos( phi )
+					, radius * std::sin( phi )
+					, 1.0f } );
+			}
+
+			for ( uint32_t segment = 0u; segment < Segments; ++segment )
+			{
+				auto a = uint16_t( 2u + segment );
+				auto b = uint16_t( 2u + ( segment + 1u ) % Segments );
+				result.indices.insert( result.indices.end()
+					, { uint16_t( 0u ), a, b, uint16_t( 1u ), b, a } );
+			}
+
+			return result;
+		}
+
+		renderer::VertexLayoutPtr doCreateVolumeVertexLayout( renderer::Device const & device )
+		{
+			auto result = renderer::makeLayout< utils::Vec3 >( 0 );
+			result->createAttribute( 0u
+				, renderer::Format::eR32G32B32_SFLOAT
+				, 0u );
+			return result;
+		}
 	}
 
 	LightingPass::LightingPass( renderer::Device const & device
+		, GBufferLayout layout
+		, LightingStrategy strategy
 		, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+		, common::LightClusters const & lightClusters
 		, renderer::StagingBuffer & stagingBuffer
 		, renderer::TextureViewCRefArray const & views )
 		: m_device{ device }
+		, m_layout{ layout }
+		, m_strategy{ strategy }
 		, m_lightsUbo{ lightsUbo }
+		, m_lightClusters{ lightClusters }
 		, m_updateCommandBuffer{ m_device.getGraphicsCommandPool().createCommandBuffer() }
 		, m_commandBuffer{ m_device.getGraphicsCommandPool().createCommandBuffer() }
 		, m_sceneUbo{ renderer::makeUniformBuffer< common::SceneData >( device, 1u, renderer::BufferTarget::eTransferDst, renderer::MemoryPropertyFlag::eDeviceLocal ) }
 		, m_gbufferDescriptorLayout{ doCreateGBufferDescriptorLayout( m_device ) }
 		, m_gbufferDescriptorPool{ m_gbufferDescriptorLayout->createPool( 1u, false ) }
-		, m_uboDescriptorLayout{ doCreateUboDescriptorLayout( m_device ) }
+		, m_uboDescriptorLayout{ doCreateUboDescriptorLayout( m_device, m_lightClusters ) }
 		, m_uboDescriptorPool{ m_uboDescriptorLayout->createPool( 1u ) }
-		, m_uboDescriptorSet{ doCreateUboDescriptorSet( *m_uboDescriptorPool, m_lightsUbo, *m_sceneUbo ) }
+		, m_uboDescriptorSet{ doCreateUboDescriptorSet( *m_uboDescriptorPool, m_lightsUbo, m_lightClusters, *m_sceneUbo ) }
 		, m_renderPass{ doCreateRenderPass( m_device, views[0].get(), views[1].get() ) }
 		, m_sampler{ m_device.createSampler( renderer::WrapMode::eClampToEdge
 			, renderer::WrapMode::eClampToEdge
@@ -224,7 +392,7 @@ namespace vkapp
 		, m_pipelineLayout{ m_device.createPipelineLayout( { *m_gbufferDescriptorLayout, *m_uboDescriptorLayout } ) }
 		, m_pipeline{ m_pipelineLayout->createPipeline( 
 			{
-				doCreateProgram( m_device ),
+				doCreateProgram( m_device, m_layout, m_strategy, m_lightClusters ),
 				*m_renderPass,
 				renderer::VertexInputState::create( *m_vertexLayout ),
 				{ renderer::PrimitiveTopology::eTriangleStrip },
@@ -235,8 +403,14 @@ namespace vkapp
 				renderer::DepthStencilState{ 0u, false, false, renderer::CompareOp::eLess }
 			} )
 		}
+		, m_volumeVertexLayout{ doCreateVolumeVertexLayout( m_device ) }
 		, m_queryPool{ m_device.createQueryPool( renderer::QueryType::eTimestamp, 2u, 0u ) }
 	{
+		if ( m_strategy == LightingStrategy::eLightVolumes )
+		{
+			doCreateLightVolume( m_pointLightVolume, false, stagingBuffer );
+			doCreateLightVolume( m_spotLightVolume, true, stagingBuffer );
+		}
 	}
 
 	void LightingPass::update( common::SceneData const & sceneData
@@ -259,19 +433,21 @@ namespace vkapp
 		m_frameBuffer = doCreateFrameBuffer( *m_renderPass, *m_depthView, *m_colourView );
 		m_gbufferDescriptorSet.reset();
 		m_gbufferDescriptorSet = m_gbufferDescriptorPool->createDescriptorSet( 0u );
-		auto & gbuffer = *m_geometryBuffers;
+		auto gbuffer = doGetGBufferViews( *m_geometryBuffers );
 
 		for ( size_t i = 0; i < gbuffer.size(); ++i )
 		{
-			m_gbufferDescriptorSet->createBinding( m_gbufferDescriptorLayout->getBinding( i )
-				, *gbuffer[i].view
-				, *m_sampler );
+			m_gbufferDescriptorSet->createBinding( m_gbufferDescriptorLayout->getBinding( uint32_t( i ) )
+				, gbuffer[i].get()
+				, *m_sampler
+				, ( m_layout == GBufferLayout::ePacked && i == 0u )
+					? renderer::ImageLayout::eDepthStencilReadOnlyOptimal
+					: renderer::ImageLayout::eShaderReadOnlyOptimal );
 		}
 
 		m_gbufferDescriptorSet->update();
 		m_commandBuffer->reset();
 		auto & commandBuffer = *m_commandBuffer;
-		static renderer::DepthStencilClearValue const depth{ 1.0, 0 };
 		static renderer::ClearColorValue const colour{ 1.0f, 0.8f, 0.4f, 0.0f };
 
 		if ( commandBuffer.begin( renderer::CommandBufferUsageFlag::eSimultaneousUse ) )
@@ -281,7 +457,7 @@ namespace vkapp
 				, *m_queryPool
 				, 0u );
 
-			for ( auto & texture : gbuffer )
+			for ( auto & texture : m_geometryBuffers->textures )
 			{
 				commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eColourAttachmentOutput
 					, renderer::PipelineStageFlag::eFragmentShader
@@ -289,9 +465,14 @@ namespace vkapp
 						, renderer::AccessFlag::eColourAttachmentWrite ) );
 			}
 
+			commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eLateFragmentTests
+				, renderer::PipelineStageFlag::eEarlyFragmentTests | renderer::PipelineStageFlag::eFragmentShader
+				, m_depthView->makeDepthStencilReadOnly( renderer::ImageLayout::eDepthStencilAttachmentOptimal
+					, renderer::AccessFlag::eDepthStencilAttachmentWrite ) );
+
 			commandBuffer.beginRenderPass( *m_renderPass
 				, *m_frameBuffer
-				, { depth, colour }
+				, { colour }
 				, renderer::SubpassContents::eInline );
 			commandBuffer.bindPipeline( *m_pipeline );
 			commandBuffer.setViewport( { size.width
@@ -308,7 +489,24 @@ namespace vkapp
 			commandBuffer.bindDescriptorSet( *m_uboDescriptorSet
 				, *m_pipelineLayout );
 			commandBuffer.draw( 4u );
+
+			if ( m_strategy == LightingStrategy::eLightVolumes )
+			{
+				doDrawLightVolume( commandBuffer
+					, m_pointLightVolume
+					, m_lightClusters.getPointLightsCount() );
+				doDrawLightVolume( commandBuffer
+					, m_spotLightVolume
+					, m_lightClusters.getSpotLightsCount() );
+			}
+
 			commandBuffer.endRenderPass();
+			// The transparent pass renders with the depth buffer.
+			commandBuffer.memoryBarrier( renderer::PipelineStageFlag::eFragmentShader | renderer::PipelineStageFlag::eLateFragmentTests
+				, renderer::PipelineStageFlag::eEarlyFragmentTests
+				, m_depthView->makeDepthStencilAttachment( renderer::ImageLayout::eDepthStencilReadOnlyOptimal
+					, renderer::AccessFlag::eShaderRead ) );
+
 			commandBuffer.writeTimestamp( renderer::PipelineStageFlag::eTopOfPipe
 				, *m_queryPool
 				, 1u );
@@ -333,4 +531,71 @@ namespace vkapp
 
 		return result;
 	}
+
+	void LightingPass::doCreateLightVolume( LightVolume & volume
+		, bool spot
+		, renderer::StagingBuffer & stagingBuffer )
+	{
+		auto mesh = spot
+			? doCreateConeMesh()
+			: doCreateSphereMesh();
+		volume.indexCount = uint32_t( mesh.indices.size() );
+		volume.vertexBuffer = renderer::makeVertexBuffer< utils::Vec3 >( m_device
+			, uint32_t( mesh.vertices.size() )
+			, renderer::BufferTarget::eTransferDst
+			, renderer::MemoryPropertyFlag::eDeviceLocal );
+		stagingBuffer.uploadVertexData( *m_updateCommandBuffer
+			, mesh.vertices
+			, *volume.vertexBuffer );
+		volume.indexBuffer = renderer::makeBuffer< uint16_t >( m_device
+			, volume.indexCount
+			, renderer::BufferTarget::eIndexBuffer | renderer::BufferTarget::eTransferDst
+			, renderer::MemoryPropertyFlag::eDeviceLocal );
+		stagingBuffer.uploadBufferData( *m_updateCommandBuffer
+			, mesh.indices
+			, *volume.indexBuffer );
+
+		// The volumes are added to the directional lighting, where they lie behind the G-buffer surfaces.
+		// Their faces aren't culled, so the lit pixels are covered even when the camera is inside a volume,
+		// the pixels lying in front of a volume being discarded in the fragment shader.
+		renderer::RasterisationState rasterisationState;
+		rasterisationState.cullMode = renderer::CullModeFlag::eNone;
+		renderer::ColourBlendState blendState;
+		blendState.attachs.push_back( renderer::ColourBlendStateAttachment{ true
+			, renderer::BlendFactor::eOne
+			, renderer::BlendFactor::eOne
+			, renderer::BlendOp::eAdd
+			, renderer::BlendFactor::eOne
+			, renderer::BlendFactor::eOne
+			, renderer::BlendOp::eAdd } );
+		volume.pipeline = m_pipelineLayout->createPipeline(
+			{
+				doCreateVolumeProgram( m_device, m_layout, spot, m_lightClusters ),
+				*m_renderPass,
+				renderer::VertexInputState::create( *m_volumeVertexLayout ),
+				{ renderer::PrimitiveTopology::eTriangleList },
+				rasterisationState,
+				renderer::MultisampleState{},
+				blendState,
+				{ renderer::DynamicState::eViewport, renderer::DynamicState::eScissor },
+				renderer::DepthStencilState{ 0u, true, false, renderer::CompareOp::eGreaterEqual }
+			} );
+	}
+
+	void LightingPass::doDrawLightVolume( renderer::CommandBuffer & commandBuffer
+		, LightVolume const & volume
+		, uint32_t lightsCount )const
+	{
+		if ( lightsCount )
+		{
+			commandBuffer.bindPipeline( *volume.pipeline );
+			commandBuffer.bindVertexBuffer( 0u, volume.vertexBuffer->getBuffer(), 0u );
+			commandBuffer.bindIndexBuffer( volume.indexBuffer->getBuffer(), 0u, renderer::IndexType::eUInt16 );
+			commandBuffer.bindDescriptorSet( *m_gbufferDescriptorSet
+				, *m_pipelineLayout );
+			commandBuffer.bindDescriptorSet( *m_uboDescriptorSet
+				, *m_pipelineLayout );
+			commandBuffer.drawIndexed( volume.indexCount, lightsCount );
+		}
+	}
 }
@@ -2,6 +2,8 @@
 
 #include "Prerequisites.hpp"
 
+#include <LightClusters.hpp>
+
 #include <Pipeline/VertexLayout.hpp>
 
 namespace vkapp
@@ -10,7 +12,10 @@ namespace vkapp
 	{
 	public:
 		LightingPass( renderer::Device const & device
+			, GBufferLayout layout
+			, LightingStrategy strategy
 			, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+			, common::LightClusters const & lightClusters
 			, renderer::StagingBuffer & stagingBuffer
 			, renderer::TextureViewCRefArray const & views );
 		void update( common::SceneData const & sceneData
@@ -19,9 +24,36 @@ namespace vkapp
 			, GeometryPassResult const & geometryBuffers );
 		bool draw( std::chrono::nanoseconds & gpu )const;
 
+	private:
+		/**
+		*\~english
+		*\brief
+		*	The proxy geometry of a light type, drawn once per light.
+		*\~french
+		*\brief
+		*	La géométrie englobante d'un type de source, dessinée une fois par source.
+		*/
+		struct LightVolume
+		{
+			renderer::VertexBufferPtr< utils::Vec3 > vertexBuffer;
+			renderer::BufferPtr< uint16_t > indexBuffer;
+			uint32_t indexCount{ 0u };
+			renderer::PipelinePtr pipeline;
+		};
+
+		void doCreateLightVolume( LightVolume & volume
+			, bool spot
+			, renderer::StagingBuffer & stagingBuffer );
+		void doDrawLightVolume( renderer::CommandBuffer & commandBuffer
+			, LightVolume const & volume
+			, uint32_t lightsCount )const;
+
 	private:
 		renderer::Device const & m_device;
+		GBufferLayout m_layout;
+		LightingStrategy m_strategy;
 		renderer::UniformBuffer< common::LightsData > const & m_lightsUbo;
+		common::LightClusters const & m_lightClusters;
 		renderer::TextureView const * m_colourView{ nullptr };
 		renderer::TextureView const * m_depthView{ nullptr };
 		GeometryPassResult const * m_geometryBuffers{ nullptr };
@@ -41,6 +73,9 @@ namespace vkapp
 		renderer::VertexLayoutPtr m_vertexLayout;
 		renderer::PipelineLayoutPtr m_pipelineLayout;
 		renderer::PipelinePtr m_pipeline;
+		renderer::VertexLayoutPtr m_volumeVertexLayout;
+		LightVolume m_pointLightVolume;
+		LightVolume m_spotLightVolume;
 		renderer::FrameBufferPtr m_frameBuffer;
 		renderer::QueryPoolPtr m_queryPool;
 	};
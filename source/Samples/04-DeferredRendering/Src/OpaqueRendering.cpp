@@ -44,7 +44,7 @@ namespace vkapp
 				views[0].get()
 			};
 
-			for ( auto & texture : gbuffer )
+			for ( auto & texture : gbuffer.textures )
 			{
 				result.emplace_back( *texture.view );
 			}
@@ -56,21 +56,28 @@ namespace vkapp
 	OpaqueRendering::OpaqueRendering( std::unique_ptr< GeometryPass > && renderer
 		, common::Scene const & scene
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, GeometryPassResult const & gbuffer
+		, LightingStrategy strategy
 		, renderer::TextureViewCRefArray const & views
 		, common::TextureNodePtrArray const & textureNodes
 		, renderer::UniformBuffer< common::SceneData > const & sceneUbo
-		, renderer::UniformBuffer< common::LightsData > const & lightsUbo )
+		, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+		, common::LightClusters const & lightClusters )
 		: common::OpaqueRendering{ std::move( renderer )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, doGetViews( gbuffer, views )
 			, textureNodes }
 		, m_sceneUbo{ sceneUbo }
 		, m_lightsUbo{ lightsUbo }
 		, m_stagingBuffer{ stagingBuffer }
 		, m_lightingPass{ m_renderer->getDevice()
+			, gbuffer.layout
+			, strategy
 			, lightsUbo
+			, lightClusters
 			, stagingBuffer
 			, views }
 	{
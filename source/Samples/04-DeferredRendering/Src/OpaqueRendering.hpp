@@ -14,11 +14,14 @@ namespace vkapp
 		OpaqueRendering( std::unique_ptr< GeometryPass > && renderer
 			, common::Scene const & scene
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, GeometryPassResult const & gbuffer
+			, LightingStrategy strategy
 			, renderer::TextureViewCRefArray const & views
 			, common::TextureNodePtrArray const & textureNodes
 			, renderer::UniformBuffer< common::SceneData > const & sceneUbo
-			, renderer::UniformBuffer< common::LightsData > const & lightsUbo );
+			, renderer::UniformBuffer< common::LightsData > const & lightsUbo
+			, common::LightClusters const & lightClusters );
 		void update( common::RenderTarget const & target )override;
 		bool draw( std::chrono::nanoseconds & gpu )const override;
 
@@ -4,13 +4,52 @@
 
 namespace vkapp
 {
+	/**
+	*\~english
+	*\brief
+	*	The G-buffer layouts.
+	*\~french
+	*\brief
+	*	Les agencements du G-buffer.
+	*/
+	enum class GBufferLayout
+	{
+		//! R32F depth, and RGBA32F diffuse, specular, emissive and normal: 68 bytes per pixel.
+		eFull,
+		//! RGBA8 diffuse, specular and emissive, RG16 octahedral normal, the depth being read from the depth buffer: 16 bytes per pixel.
+		ePacked,
+	};
+
+	/**
+	*\~english
+	*\brief
+	*	The point and spot lights processing, in the lighting pass.
+	*\~french
+	*\brief
+	*	Le traitement des sources ponctuelles et des projecteurs, dans la passe d'éclairage.
+	*/
+	enum class LightingStrategy
+	{
+		//! A full screen pass, processing the lights of each pixel's cluster.
+		eClustered,
+		//! A full screen pass for the directional lights, then one instanced sphere or cone per point or spot light, blended additively.
+		eLightVolumes,
+	};
+
 	struct GeometryPassTexture
 	{
 		renderer::TexturePtr texture;
 		renderer::TextureViewPtr view;
 	};
 
-	using GeometryPassResult = std::array < GeometryPassTexture, 5u >;
+	struct GeometryPassResult
+	{
+		GBufferLayout layout{ GBufferLayout::eFull };
+		//! The geometry pass colour attachments.
+		std::vector< GeometryPassTexture > textures;
+		//! The depth aspect view of the depth buffer, sampled by the lighting pass with the packed layout.
+		renderer::TextureViewPtr depthView;
+	};
 
 	static wxString const AppName = wxT( "04-DeferredRendering" );
 	static wxString const AppDesc = wxT( "Deferred Rendering" );
@@ -32,12 +32,31 @@ namespace vkapp
 
 	void RenderPanel::doUpdateOverlays( common::Gui const & overlay )
 	{
-		//if ( overlay.header( "Settings" ) )
-		//{
-		//	if ( overlay.checkBox( "Wireframe", &wireframe ) )
-		//	{
-		//		buildCommandBuffers();
-		//	}
-		//}
+		auto & renderTarget = static_cast< RenderTarget & >( *m_renderTarget );
+
+		if ( overlay.header( "G-buffer" ) )
+		{
+			auto layout = int32_t( renderTarget.getGBuffer().layout );
+
+			if ( overlay.comboBox( "Layout", &layout, { "Full", "Packed" } ) )
+			{
+				renderTarget.setGBufferLayout( GBufferLayout( layout ) );
+			}
+
+			auto & size = renderTarget.getColourView().getTexture().getDimensions();
+			auto pixelSize = renderTarget.getGBufferPixelSize();
+			overlay.text( "%u bytes/pixel, %.1f MB", pixelSize
+				, double( pixelSize ) * size.width * size.height / ( 1024.0 * 1024.0 ) );
+		}
+
+		if ( overlay.header( "Lighting" ) )
+		{
+			auto strategy = int32_t( renderTarget.getLightingStrategy() );
+
+			if ( overlay.comboBox( "Strategy", &strategy, { "Clustered", "Light volumes" } ) )
+			{
+				renderTarget.setLightingStrategy( LightingStrategy( strategy ) );
+			}
+		}
 	}
 }
@@ -31,11 +31,51 @@ namespace vkapp
 			, 1u
 			, renderer::BufferTarget::eTransferDst
 			, renderer::MemoryPropertyFlag::eDeviceLocal ) }
+		, m_lightClusters{ device, 1024u }
 	{
+		// The lights are needed by the lighting pass, when it records its draws.
 		doCreateGBuffer();
-		doInitialise();
 		doUpdateMatrixUbo( size );
 		doInitialiseLights();
+		doInitialise();
+	}
+
+	void RenderTarget::setGBufferLayout( GBufferLayout layout )
+	{
+		if ( layout != m_gbuffer.layout )
+		{
+			m_device.waitIdle();
+			m_gbuffer.layout = layout;
+			doCreateGBuffer();
+			doRecreateOpaqueRendering();
+		}
+	}
+
+	void RenderTarget::setLightingStrategy( LightingStrategy strategy )
+	{
+		if ( strategy != m_lightingStrategy )
+		{
+			m_lightingStrategy = strategy;
+			doRecreateOpaqueRendering();
+		}
+	}
+
+	uint32_t RenderTarget::getGBufferPixelSize()const
+	{
+		uint32_t result = 0u;
+
+		for ( auto & texture : m_gbuffer.textures )
+		{
+			result += renderer::getSize( texture.texture->getFormat() );
+		}
+
+		// The depth buffer is read back with the packed layout, instead of an additional target.
+		if ( m_gbuffer.layout == GBufferLayout::ePacked )
+		{
+			result += renderer::getSize( getDepthView().getFormat() );
+		}
+
+		return result;
 	}
 
 	void RenderTarget::doUpdate( std::chrono::microseconds const & duration )
@@ -54,6 +94,9 @@ namespace vkapp
 			, m_objectUbo->getDatas()
 			, *m_objectUbo
 			, renderer::PipelineStageFlag::eVertexShader );
+		auto & sceneData = m_sceneUbo->getData( 0u );
+		doCull( sceneData.mtxProjection * sceneData.mtxView
+			, m_objectUbo->getData( 0 ).mtxModel );
 	}
 
 	void RenderTarget::doResize( renderer::Extent2D const & size )
@@ -64,27 +107,34 @@ namespace vkapp
 
 	common::OpaqueRenderingPtr RenderTarget::doCreateOpaqueRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
 	{
 		return std::make_unique< OpaqueRendering >( std::make_unique< GeometryPass >( device
-				, common::getPath( common::getExecutableDirectory() ) / "share" / AppName / "Shaders" / "opaque_gp.frag"
+				, common::getPath( common::getExecutableDirectory() ) / "share" / AppName / "Shaders" / ( m_gbuffer.layout == GBufferLayout::ePacked
+					? "opaque_gp_packed.frag"
+					: "opaque_gp.frag" )
 				, m_gbuffer
 				, views[0].get().getFormat()
 				, *m_sceneUbo
 				, *m_objectUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, m_gbuffer
+			, m_lightingStrategy
 			, views
 			, textureNodes
 			, *m_sceneUbo
-			, *m_lightsUbo );
+			, *m_lightsUbo
+			, m_lightClusters );
 	}
 
 	common::TransparentRenderingPtr RenderTarget::doCreateTransparentRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -97,8 +147,10 @@ namespace vkapp
 				, *m_lightsUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
-			, textureNodes );
+			, textureNodes
+			, getTransparencyMode() );
 	}
 
 	void RenderTarget::doUpdateMatrixUbo( renderer::Extent2D const & size )
@@ -131,6 +183,10 @@ namespace vkapp
 			, width / height
 			, 0.01f
 			, 100.0f );
+		m_lightClusters.update( m_sceneUbo->getData( 0u ).mtxView
+			, m_sceneUbo->getData( 0u ).mtxProjection
+			, 0.01f
+			, 100.0f );
 #endif
 		m_stagingBuffer->uploadUniformData( *m_updateCommandBuffer
 			, m_sceneUbo->getDatas()
@@ -152,15 +208,27 @@ namespace vkapp
 		};
 		lights.directionalLights[0] = directional;
 
+		// The point and spot lights are only limited by the clusters capacity, or by MAX_LIGHTS without clustering.
+		common::PointLightArray pointLights;
+		common::SpotLightArray spotLights;
+		common::generateLights( { 0.0f, 0.0f, -5.0f }
+			, 2.5f
+			, 512u
+			, pointLights
+			, spotLights );
+		m_lightClusters.setLights( pointLights, spotLights );
+		m_lightClusters.fillLights( lights );
+
+		// Without clustering, the light volumes read their light from the UBO, in the vertex shader.
 		m_stagingBuffer->uploadUniformData( *m_updateCommandBuffer
 			, m_lightsUbo->getDatas()
 			, *m_lightsUbo
-			, renderer::PipelineStageFlag::eFragmentShader );
+			, renderer::PipelineStageFlag::eVertexShader | renderer::PipelineStageFlag::eFragmentShader );
 	}
 
 	void RenderTarget::doCreateGBuffer()
 	{
-		static renderer::Format const formats[]
+		static renderer::Format const fullFormats[]
 		{
 			renderer::Format::eR32_SFLOAT,
 			renderer::Format::eR32G32B32A32_SFLOAT,
@@ -168,20 +236,35 @@ namespace vkapp
 			renderer::Format::eR32G32B32A32_SFLOAT,
 			renderer::Format::eR32G32B32A32_SFLOAT,
 		};
-		size_t index = 0u;
-		renderer::Extent2D size
+		static renderer::Format const packedFormats[]
 		{
-			getColourView().getTexture().getDimensions().width,
-			getColourView().getTexture().getDimensions().height,
+			renderer::Format::eR8G8B8A8_UNORM,
+			renderer::Format::eR8G8B8A8_UNORM,
+			renderer::Format::eR8G8B8A8_UNORM,
+			renderer::Format::eR16G16_UNORM,
 		};
+		std::vector< renderer::Format > formats;
 
-		for ( auto & texture : m_gbuffer )
+		if ( m_gbuffer.layout == GBufferLayout::ePacked )
 		{
+			formats.assign( std::begin( packedFormats ), std::end( packedFormats ) );
+		}
+		else
+		{
+			formats.assign( std::begin( fullFormats ), std::end( fullFormats ) );
+		}
+
+		m_gbuffer.textures.clear();
+		m_gbuffer.depthView.reset();
+
+		for ( auto format : formats )
+		{
+			GeometryPassTexture texture;
 			texture.texture = m_device.createTexture(
 				{
 					0,
 					renderer::TextureType::e2D,
-					formats[index],
+					format,
 					getColourView().getTexture().getDimensions(),
 					1u,
 					1u,
@@ -192,7 +275,26 @@ namespace vkapp
 				, renderer::MemoryPropertyFlag::eDeviceLocal );
 			texture.view = texture.texture->createView( renderer::TextureViewType::e2D
 				, texture.texture->getFormat() );
-			++index;
+			m_gbuffer.textures.push_back( std::move( texture ) );
+		}
+
+		if ( m_gbuffer.layout == GBufferLayout::ePacked )
+		{
+			// Only the depth aspect can be sampled.
+			auto & depth = getDepthView().getTexture();
+			m_gbuffer.depthView = depth.createView(
+				{
+					renderer::TextureViewType::e2D,
+					depth.getFormat(),
+					renderer::ComponentMapping{},
+					{
+						renderer::ImageAspectFlag::eDepth,
+						0u,
+						1u,
+						0u,
+						1u,
+					}
+				} );
 		}
 	}
 }
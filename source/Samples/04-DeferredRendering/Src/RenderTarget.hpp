@@ -2,6 +2,7 @@
 
 #include "Prerequisites.hpp"
 
+#include <LightClusters.hpp>
 #include <RenderTarget.hpp>
 
 namespace vkapp
@@ -19,17 +20,51 @@ namespace vkapp
 		{
 			return m_gbuffer;
 		}
+		/**
+		*\~english
+		*\brief
+		*	Changes the G-buffer layout, recreating the G-buffer and the opaque rendering.
+		*\~french
+		*\brief
+		*	Change l'agencement du G-buffer, en recréant le G-buffer et le rendu opaque.
+		*/
+		void setGBufferLayout( GBufferLayout layout );
+		/**
+		*\~english
+		*\return
+		*	The bytes written per pixel by the geometry pass, and read back by the lighting pass.
+		*\~french
+		*\return
+		*	Les octets écrits par pixel par la passe géométrique, et relus par la passe d'éclairage.
+		*/
+		uint32_t getGBufferPixelSize()const;
+		/**
+		*\~english
+		*\brief
+		*	Changes the point and spot lights processing, recreating the opaque rendering.
+		*\~french
+		*\brief
+		*	Change le traitement des sources ponctuelles et des projecteurs, en recréant le rendu opaque.
+		*/
+		void setLightingStrategy( LightingStrategy strategy );
+
+		inline LightingStrategy getLightingStrategy()const
+		{
+			return m_lightingStrategy;
+		}
 
 	private:
 		void doUpdate( std::chrono::microseconds const & duration )override;
 		virtual void doResize( renderer::Extent2D const & size )override;
 		common::OpaqueRenderingPtr doCreateOpaqueRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::Scene const & scene
 			, common::TextureNodePtrArray const & textureNodes )override;
 		common::TransparentRenderingPtr doCreateTransparentRendering( renderer::Device const & device
 			, renderer::StagingBuffer & stagingBuffer
+			, renderer::DescriptorSetLayoutCache & descriptorCache
 			, renderer::TextureViewCRefArray const & views
 			, common::Scene const & scene
 			, common::TextureNodePtrArray const & textureNodes )override;
@@ -41,7 +76,9 @@ namespace vkapp
 		renderer::UniformBufferPtr< common::SceneData > m_sceneUbo;
 		renderer::UniformBufferPtr< common::ObjectData > m_objectUbo;
 		renderer::UniformBufferPtr< common::LightsData > m_lightsUbo;
+		common::LightClusters m_lightClusters;
 		renderer::Mat4 m_rotate;
 		GeometryPassResult m_gbuffer;
+		LightingStrategy m_lightingStrategy{ LightingStrategy::eClustered };
 	};
 }
@@ -62,6 +62,8 @@ namespace vkapp
 			, m_sceneUbo->getDatas()
 			, *m_sceneUbo
 			, renderer::PipelineStageFlag::eVertexShader );
+		doCull( data.mtxProjection * data.mtxView
+			, renderer::Mat4{} );
 	}
 
 	void RenderTarget::doResize( renderer::Extent2D const & size )
@@ -71,6 +73,7 @@ namespace vkapp
 
 	common::OpaqueRenderingPtr RenderTarget::doCreateOpaqueRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -83,12 +86,14 @@ namespace vkapp
 				, *m_sceneUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
 			, textureNodes );
 	}
 
 	common::TransparentRenderingPtr RenderTarget::doCreateTransparentRendering( renderer::Device const & device
 		, renderer::StagingBuffer & stagingBuffer
+		, renderer::DescriptorSetLayoutCache & descriptorCache
 		, renderer::TextureViewCRefArray const & views
 		, common::Scene const & scene
 		, common::TextureNodePtrArray const & textureNodes )
@@ -101,7 +106,9 @@ namespace vkapp
 				, *m_sceneUbo )
 			, scene
 			, stagingBuffer
+			, descriptorCache
 			, views
-			, textureNodes );
+			, textureNodes
+			, getTransparencyMode() );
 	}
 }
@@ -4,6 +4,7 @@ See LICENSE file in root folder
 #ifndef ___CASTOR_FILE_H___
 #define ___CASTOR_FILE_H___
 
+#include "MappedFile.hpp"
 #include "Prerequisites.hpp"
 
 #include <fstream>
@@ -0,0 +1,109 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#if RENDERLIB_WIN32
+
+#include <windows.h>
+
+#elif defined( __linux__ )
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <fcntl.h>
+
+#include <unistd.h>
+
+#endif
+
+namespace common
+{
+#if RENDERLIB_WIN32
+
+	MappedFile::MappedFile( std::string const & path )
+	{
+		m_file = ::CreateFileA( path.c_str()
+			, GENERIC_READ
+			, FILE_SHARE_READ
+			, nullptr
+			, OPEN_EXISTING
+			, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN
+			, nullptr );
+		LARGE_INTEGER size;
+
+		if ( m_file == INVALID_HANDLE_VALUE
+			|| !::GetFileSizeEx( m_file, &size ) )
+		{
+			throw std::runtime_error{ "Couldn't open file " + path };
+		}
+
+		m_size = size_t( size.QuadPart );
+		m_mapping = ::CreateFileMappingA( m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+		if ( m_mapping )
+		{
+			m_data = static_cast< uint8_t const * >( ::MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+		}
+
+		if ( !m_data )
+		{
+			if ( m_mapping )
+			{
+				::CloseHandle( m_mapping );
+			}
+
+			::CloseHandle( m_file );
+			throw std::runtime_error{ "Couldn't map file " + path };
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		::UnmapViewOfFile( m_data );
+		::CloseHandle( m_mapping );
+		::CloseHandle( m_file );
+	}
+
+#elif defined( __linux__ )
+
+	MappedFile::MappedFile( std::string const & path )
+	{
+		int fd = open( path.c_str(), O_RDONLY );
+		struct stat status;
+
+		if ( fd == -1
+			|| fstat( fd, &status ) == -1 )
+		{
+			if ( fd != -1 )
+			{
+				close( fd );
+			}
+
+			throw std::runtime_error{ "Couldn't open file " + path };
+		}
+
+		m_size = size_t( status.st_size );
+		void * data = m_size
+			? mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 )
+			: MAP_FAILED;
+		// The mapping keeps its own reference to the file.
+		close( fd );
+
+		if ( data == MAP_FAILED )
+		{
+			throw std::runtime_error{ "Couldn't map file " + path };
+		}
+
+		// The mapped files are read entirely, soon after being mapped.
+		madvise( data, m_size, MADV_WILLNEED );
+		m_data = static_cast< uint8_t const * >( data );
+	}
+
+	MappedFile::~MappedFile()
+	{
+		munmap( const_cast< uint8_t * >( m_data ), m_size );
+	}
+
+#endif
+}
@@ -0,0 +1,56 @@
+/*
+See LICENSE file in root folder
+*/
+#ifndef ___Common_MappedFile_HPP___
+#define ___Common_MappedFile_HPP___
+#pragma once
+
+#include <RendererPrerequisites.hpp>
+
+namespace common
+{
+	/**
+	*\~english
+	*\brief
+	*	A read-only memory mapping of a whole file.
+	*\~french
+	*\brief
+	*	Un mappage mémoire en lecture seule d'un fichier entier.
+	*/
+	class MappedFile
+	{
+	public:
+		/**
+		*\~english
+		*\brief
+		*	Maps the file, throws std::runtime_error on failure.
+		*\~french
+		*\brief
+		*	Mappe le fichier, lance une std::runtime_error en cas d'échec.
+		*/
+		explicit MappedFile( std::string const & path );
+		~MappedFile();
+		MappedFile( MappedFile const & ) = delete;
+		MappedFile & operator=( MappedFile const & ) = delete;
+
+		inline uint8_t const * getData()const
+		{
+			return m_data;
+		}
+
+		inline size_t getSize()const
+		{
+			return m_size;
+		}
+
+	private:
+		uint8_t const * m_data{ nullptr };
+		size_t m_size{ 0u };
+#if RENDERLIB_WIN32
+		void * m_file{ nullptr };
+		void * m_mapping{ nullptr };
+#endif
+	};
+}
+
+#endif
@@ -1,239 +1,574 @@
 #include "ObjLoader.hpp"
 
-#include <stdlib.h>
-#include <fstream>
-#include <sstream>
+#include "MappedFile.hpp"
 
-#include <StringUtils.hpp>
+#include <Parallel.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
 
 namespace common
 {
-	bool doPreloadFile( std::string const & fileContent
-		, uint16_t & nv
-		, uint16_t & nvt
-		, uint16_t & nvn
-		, uint16_t & nf
-		, uint16_t & ntf
-		, renderer::UInt16Array & faces )
+	namespace
 	{
-		std::istringstream file( fileContent );
-		std::string line;
-		std::string mtlfile;
+		uint32_t constexpr NoIndex = 0xFFFFFFFFu;
+		size_t constexpr MinChunkSize = 1024u * 1024u;
 
-		while ( std::getline( file, line ) )
+		enum class IndexKind
+			: uint32_t
 		{
-			utils::trimLeft( line );
-			std::stringstream stream( line );
-			std::string ident;
-			stream >> ident;
+			eNone,
+			eAbsolute,
+			// Relative to the current chunk's vertices, the value is then a signed index.
+			eRelative,
+		};
 
-			if ( ident == "v" )
-			{
-				if ( ntf )
-				{
-					faces.push_back( ntf );
-					ntf = 0u;
-				}
+		// A face corner attribute index.
+		struct CornerIndex
+		{
+			IndexKind kind;
+			uint32_t value;
+		};
 
-				++nv;
-			}
-			else if ( ident == "vt" )
+		struct ObjChunk
+		{
+			char const * begin;
+			char const * end;
+			utils::Vec3Array positions;
+			utils::Vec2Array texcoords;
+			// Position and texture coordinates indices, for each triangle corner.
+			std::vector< CornerIndex > corners;
+		};
+
+		inline bool doIsSpace( char c )
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		inline void doSkipSpaces( char const *& it
+			, char const * end )
+		{
+			while ( it != end && doIsSpace( *it ) )
 			{
-				++nvt;
+				++it;
 			}
-			else if ( ident == "vn" )
+		}
+
+		inline char const * doNextLine( char const * it
+			, char const * end )
+		{
+			auto eol = static_cast< char const * >( std::memchr( it, '\n', size_t( end - it ) ) );
+			return eol
+				? eol + 1
+				: end;
+		}
+
+		float doParseFloat( char const *& it
+			, char const * end )
+		{
+			static double const Powers[]
+			{
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+				1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+			};
+			doSkipSpaces( it, end );
+			bool negative = false;
+
+			if ( it != end && ( *it == '-' || *it == '+' ) )
 			{
-				++nvn;
+				negative = *it == '-';
+				++it;
 			}
-			else if ( ident == "f" )
+
+			uint64_t mantissa = 0u;
+			int exponent = 0;
+			int digits = 0;
+
+			// Only the first 18 significant digits are kept, which is beyond float precision.
+			for ( ; it != end && *it >= '0' && *it <= '9'; ++it )
 			{
-				++nf;
-				++ntf;
+				if ( digits < 18 )
+				{
+					mantissa = mantissa * 10u + uint64_t( *it - '0' );
+					digits += mantissa ? 1 : 0;
+				}
+				else
+				{
+					++exponent;
+				}
 			}
-			else if ( ident == "g" || ident == "usemtl" )
+
+			if ( it != end && *it == '.' )
 			{
-				if ( ntf )
+				for ( ++it; it != end && *it >= '0' && *it <= '9'; ++it )
 				{
-					faces.push_back( ntf );
-					ntf = 0u;
+					if ( digits < 18 )
+					{
+						mantissa = mantissa * 10u + uint64_t( *it - '0' );
+						digits += mantissa ? 1 : 0;
+						--exponent;
+					}
 				}
 			}
-			else if ( ident == "mtllib" )
+
+			if ( it != end && ( *it == 'e' || *it == 'E' ) )
 			{
-				mtlfile = line.substr( line.find_first_of( " " ) + 1 );
-				utils::trim( mtlfile );
+				++it;
+				bool negativeExponent = false;
+
+				if ( it != end && ( *it == '-' || *it == '+' ) )
+				{
+					negativeExponent = *it == '-';
+					++it;
+				}
+
+				int value = 0;
+
+				for ( ; it != end && *it >= '0' && *it <= '9'; ++it )
+				{
+					value = std::min( value * 10 + ( *it - '0' ), 1000 );
+				}
+
+				exponent += negativeExponent ? -value : value;
 			}
-		}
 
-		if ( ntf )
-		{
-			faces.push_back( ntf );
-		}
+			double result = double( mantissa );
 
-		std::clog << "    Vertex count: " << nv << std::endl;
-		std::clog << "    TexCoord count: " << nvt << std::endl;
-		std::clog << "    Normal count: " << nvn << std::endl;
-		std::clog << "    Group count: " << int( faces.size() ) << std::endl;
+			while ( exponent > 0 )
+			{
+				auto step = std::min( exponent, 18 );
+				result *= Powers[step];
+				exponent -= step;
+			}
 
-		return true;
-	}
+			while ( exponent < 0 )
+			{
+				auto step = std::min( -exponent, 18 );
+				result /= Powers[step];
+				exponent += step;
+			}
 
-	void loadObjFile( std::string const & fileContent
-		, std::vector< TexturedVertexData > & vboData
-		, renderer::UInt16Array & iboData )
-	{
-		uint16_t nv = 0u;
-		uint16_t nvt = 0u;
-		uint16_t nvn = 0u;
-		uint16_t nf = 0u;
-		uint16_t ntf = 0u;
-		renderer::UInt16Array faces;
-
-		if ( !doPreloadFile( fileContent
-			, nv
-			, nvt
-			, nvn
-			, nf
-			, ntf
-			, faces ) )
-		{
-			std::cerr << "Failed to load the OBJ file" << std::endl;
-			return;
+			return float( negative ? -result : result );
 		}
 
-		std::istringstream file( fileContent );
-		std::string line;
-		utils::Vec3Array allvtx( nv );
-		utils::Vec2Array alltex( nvt );
-		utils::Vec3Array allnml( nvn );
-		auto vtxit = allvtx.begin();
-		auto texit = alltex.begin();
-		auto nmlit = allnml.begin();
-
-		while ( std::getline( file, line ) )
+		bool doParseIndex( char const *& it
+			, char const * end
+			, int32_t & result )
 		{
-			utils::trim( line );
-			std::stringstream stream( line );
-			std::string ident;
-			stream >> ident;
+			bool negative = false;
 
-			if ( ident == "v" )
+			if ( it != end && *it == '-' )
 			{
-				stream >> vtxit->x >> vtxit->y >> vtxit->z;
-				++vtxit;
+				negative = true;
+				++it;
 			}
-			else if ( ident == "vt" )
+
+			if ( it == end || *it < '0' || *it > '9' )
 			{
-				stream >> texit->x >> texit->y;
-				++texit;
+				return false;
 			}
-			else if ( ident == "vn" )
+
+			int32_t value = 0;
+
+			for ( ; it != end && *it >= '0' && *it <= '9'; ++it )
 			{
-				stream >> nmlit->x >> nmlit->y >> nmlit->z;
-				++nmlit;
+				value = value * 10 + ( *it - '0' );
 			}
+
+			result = negative ? -value : value;
+			return true;
 		}
 
-		file.clear();
-		file.seekg( 0, std::ios::beg );
+		// OBJ indices are 1 based, and negative ones are relative to the last vertex read so far.
+		CornerIndex doMakeIndex( int32_t value
+			, size_t localCount )
+		{
+			if ( value > 0 )
+			{
+				return { IndexKind::eAbsolute, uint32_t( value - 1 ) };
+			}
+
+			if ( value < 0 )
+			{
+				return { IndexKind::eRelative, uint32_t( int32_t( localCount ) + value ) };
+			}
 
-		renderer::UInt16Array index( nf * 3 );
-		utils::Vec3Array vertex( nf * 3 );
-		utils::Vec3Array normal( nf * 3 );
-		utils::Vec2Array texcoord( nf * 3 );
-		auto idxit = index.begin();
-		vtxit = vertex.begin();
-		texit = texcoord.begin();
-		nmlit = normal.begin();
-		auto facesit = faces.end();
-		std::string mtlname;
-		uint16_t normalsCount = 0u;
+			return { IndexKind::eNone, NoIndex };
+		}
 
-		while ( std::getline( file, line ) )
+		void doParseFace( char const * it
+			, char const * end
+			, ObjChunk & chunk )
 		{
-			utils::trim( line );
-			std::stringstream stream( line );
-			std::string ident;
-			stream >> ident;
+			CornerIndex first[2];
+			CornerIndex previous[2];
+			uint32_t count = 0u;
+			doSkipSpaces( it, end );
 
-			if ( ident == "g" )
+			while ( it != end && *it != '\n' )
 			{
-				if ( facesit == faces.end() )
+				int32_t position;
+
+				if ( !doParseIndex( it, end, position ) )
 				{
-					facesit = faces.begin();
+					break;
 				}
-				else
+
+				int32_t texcoord = 0;
+
+				if ( it != end && *it == '/' )
+				{
+					++it;
+					doParseIndex( it, end, texcoord );
+
+					// The normal index is skipped.
+					if ( it != end && *it == '/' )
+					{
+						++it;
+						int32_t normal;
+						doParseIndex( it, end, normal );
+					}
+				}
+
+				CornerIndex corner[2]
+				{
+					doMakeIndex( position, chunk.positions.size() ),
+					doMakeIndex( texcoord, chunk.texcoords.size() ),
+				};
+
+				// Polygons are triangulated as fans.
+				if ( count == 0u )
+				{
+					first[0] = corner[0];
+					first[1] = corner[1];
+				}
+				else if ( count >= 2u )
+				{
+					chunk.corners.insert( chunk.corners.end()
+						, { first[0], first[1], previous[0], previous[1], corner[0], corner[1] } );
+				}
+
+				previous[0] = corner[0];
+				previous[1] = corner[1];
+				++count;
+				doSkipSpaces( it, end );
+			}
+		}
+
+		void doParseChunk( ObjChunk & chunk )
+		{
+			auto it = chunk.begin;
+
+			while ( it != chunk.end )
+			{
+				doSkipSpaces( it, chunk.end );
+				auto next = doNextLine( it, chunk.end );
+
+				if ( next - it > 2 )
+				{
+					if ( it[0] == 'v' && doIsSpace( it[1] ) )
+					{
+						++it;
+						utils::Vec3 position;
+						position.x = doParseFloat( it, next );
+						position.y = doParseFloat( it, next );
+						position.z = doParseFloat( it, next );
+						chunk.positions.push_back( position );
+					}
+					else if ( it[0] == 'v' && it[1] == 't' && doIsSpace( it[2] ) )
+					{
+						it += 2;
+						utils::Vec2 texcoord;
+						texcoord.x = doParseFloat( it, next );
+						texcoord.y = doParseFloat( it, next );
+						chunk.texcoords.push_back( texcoord );
+					}
+					else if ( it[0] == 'f' && doIsSpace( it[1] ) )
+					{
+						doParseFace( it + 1, next, chunk );
+					}
+				}
+
+				it = next;
+			}
+		}
+
+		/**
+		*\brief
+		*	Table de hachage à adressage ouvert, associant un couple d'indices (position, coordonnées de texture) à un sommet.
+		*/
+		class CornerMap
+		{
+		public:
+			explicit CornerMap( size_t count )
+			{
+				size_t size = 16u;
+
+				while ( size < count * 2u )
 				{
-					iboData.insert( iboData.end(), index.begin(), idxit );
-					idxit = index.begin();
-					++facesit;
+					size *= 2u;
 				}
 
-				std::clog << "    Group faces count: " << *facesit << std::endl;
+				doResize( size );
 			}
-			else if ( ident == "usemtl" )
+
+			template< typename CreatorT >
+			uint32_t find( uint64_t key
+				, CreatorT creator )
 			{
-				if ( facesit == faces.end() )
+				auto slot = doFindSlot( key );
+
+				if ( m_keys[slot] == key )
 				{
-					facesit = faces.begin();
+					return m_values[slot];
 				}
-				else if ( index.begin() != idxit )
+
+				// The load factor is kept under 0.5, so that the probing always ends on an empty slot.
+				if ( ( m_count + 1u ) * 2u > m_keys.size() )
 				{
-					iboData.insert( iboData.end(), index.begin(), idxit );
-					idxit = index.begin();
-					++facesit;
+					doResize( m_keys.size() * 2u );
+					slot = doFindSlot( key );
 				}
 
-				stream >> mtlname;
-				utils::trim( mtlname );
+				++m_count;
+				m_keys[slot] = key;
+				m_values[slot] = creator();
+				return m_values[slot];
 			}
-			else if ( ident == "f" )
+
+		private:
+			size_t doFindSlot( uint64_t key )const
 			{
-				for ( uint32_t i = 0u; i < 3u; i++ )
+				// 64 bits finalizer from MurmurHash3.
+				auto hash = key;
+				hash ^= hash >> 33;
+				hash *= 0xff51afd7ed558ccdull;
+				hash ^= hash >> 33;
+				auto slot = size_t( hash ) & m_mask;
+
+				while ( m_keys[slot] != Empty && m_keys[slot] != key )
 				{
-					std::string face;
-					stream >> face;
+					slot = ( slot + 1u ) & m_mask;
+				}
 
-					size_t index1 = face.find( '/' );
-					std::string component = face.substr( 0, index1 );
-					uint16_t iv = atoi( component.c_str() ) - 1;
-					*vtxit++ = allvtx[iv];
+				return slot;
+			}
 
-					++index1;
-					size_t index2 = face.find( '/', index1 );
+			void doResize( size_t size )
+			{
+				auto keys = std::move( m_keys );
+				auto values = std::move( m_values );
+				m_keys.assign( size, Empty );
+				m_values.resize( size );
+				m_mask = size - 1u;
 
-					if ( index2 > index1 )
+				for ( size_t index = 0u; index < keys.size(); ++index )
+				{
+					if ( keys[index] != Empty )
 					{
-						component = face.substr( index1, index2 - index1 );
-						uint32_t ivt = atoi( component.c_str() ) - 1;
-						texit->x = alltex[ivt].x;
-						texit->y = 1.0f - alltex[ivt].y;
-						++texit;
+						auto slot = doFindSlot( keys[index] );
+						m_keys[slot] = keys[index];
+						m_values[slot] = values[index];
 					}
+				}
+			}
+
+		private:
+			static uint64_t constexpr Empty = ~0ull;
+			std::vector< uint64_t > m_keys;
+			renderer::UInt32Array m_values;
+			size_t m_mask{ 0u };
+			size_t m_count{ 0u };
+		};
+	}
+
+	bool parseObj( char const * begin
+		, char const * end
+		, std::vector< TexturedVertexData > & vboData
+		, renderer::UInt32Array & iboData )
+	{
+		// Split the content in chunks of whole lines.
+		size_t size = size_t( end - begin );
+		size_t threads = std::max( std::thread::hardware_concurrency(), 1u );
+		size_t chunkCount = std::max< size_t >( 1u, std::min( threads, size / MinChunkSize ) );
+		std::vector< ObjChunk > chunks( chunkCount );
+		auto it = begin;
 
-					++index2;
-					component = face.substr( index2 );
-					uint32_t ivn = atoi( component.c_str() ) - 1;
-					*nmlit++ = allnml[ivn];
+		for ( size_t index = 0u; index < chunkCount; ++index )
+		{
+			chunks[index].begin = it;
+			it = index + 1u == chunkCount
+				? end
+				: doNextLine( std::max( it, begin + size * ( index + 1u ) / chunkCount ), end );
+			chunks[index].end = it;
+		}
 
-					*idxit++ = normalsCount;
-					normalsCount++;
+		utils::parallelFor( chunkCount
+			, 1u
+			, [&chunks]( size_t first, size_t last )
+			{
+				for ( auto index = first; index < last; ++index )
+				{
+					doParseChunk( chunks[index] );
 				}
-			}
+			} );
+
+		// Merge the chunks attributes, and resolve the relative indices.
+		size_t positionCount = 0u;
+		size_t texcoordCount = 0u;
+		size_t cornerCount = 0u;
+		std::vector< size_t > positionOffsets;
+		std::vector< size_t > texcoordOffsets;
+
+		for ( auto & chunk : chunks )
+		{
+			positionOffsets.push_back( positionCount );
+			texcoordOffsets.push_back( texcoordCount );
+			positionCount += chunk.positions.size();
+			texcoordCount += chunk.texcoords.size();
+			cornerCount += chunk.corners.size() / 2u;
 		}
 
-		if ( idxit != index.begin()
-			&& facesit != faces.end() )
+		utils::Vec3Array positions( positionCount );
+		utils::Vec2Array texcoords( texcoordCount );
+		std::atomic< bool > valid{ true };
+
+		utils::parallelFor( chunkCount
+			, 1u
+			, [&]( size_t first, size_t last )
+			{
+				for ( auto index = first; index < last; ++index )
+				{
+					auto & chunk = chunks[index];
+					std::copy( chunk.positions.begin(), chunk.positions.end(), positions.begin() + positionOffsets[index] );
+					std::copy( chunk.texcoords.begin(), chunk.texcoords.end(), texcoords.begin() + texcoordOffsets[index] );
+					size_t const offsets[2]{ positionOffsets[index], texcoordOffsets[index] };
+					size_t const counts[2]{ positionCount, texcoordCount };
+
+					for ( size_t corner = 0u; corner < chunk.corners.size(); ++corner )
+					{
+						auto & index = chunk.corners[corner];
+						auto attribute = corner % 2u;
+
+						if ( index.kind == IndexKind::eNone )
+						{
+							// The texture coordinates are optional, not the positions.
+							if ( !attribute )
+							{
+								valid = false;
+							}
+
+							continue;
+						}
+
+						if ( index.kind == IndexKind::eRelative )
+						{
+							auto absolute = int64_t( offsets[attribute] ) + int32_t( index.value );
+							index.kind = IndexKind::eAbsolute;
+							index.value = absolute < 0
+								? NoIndex
+								: uint32_t( absolute );
+						}
+
+						if ( index.value >= counts[attribute] )
+						{
+							valid = false;
+						}
+					}
+				}
+			} );
+
+		if ( !valid )
 		{
-			iboData.insert( iboData.end(), index.begin(), idxit );
-			auto size = size_t( std::distance( vertex.begin(), vtxit ) );
+			std::cerr << "Invalid OBJ content: face index out of range" << std::endl;
+			return false;
+		}
 
-			for ( size_t i = 0; i < size; ++i )
+		// Build the indexed mesh, sharing the vertices with the same attributes.
+		// The map starts from the usual unique vertices count, and grows if there are more.
+		CornerMap map{ std::min( cornerCount, positionCount * 4u ) };
+		vboData.reserve( vboData.size() + positionCount );
+		iboData.reserve( iboData.size() + cornerCount );
+		auto base = uint32_t( vboData.size() );
+
+		for ( auto & chunk : chunks )
+		{
+			for ( size_t corner = 0u; corner < chunk.corners.size(); corner += 2u )
 			{
-				auto & vtx = vertex[i];
-				auto & tex = texcoord[i];
-				vboData.push_back( { { vtx[0], vtx[1], vtx[2] - 3.0f, 1.0f }, { tex[0], tex[1] } } );
+				auto position = chunk.corners[corner].value;
+				auto texcoord = chunk.corners[corner + 1u].value;
+				iboData.push_back( map.find( ( uint64_t( position ) << 32 ) | texcoord
+					, [&]()
+					{
+						auto & vtx = positions[position];
+						utils::Vec2 tex{ 0.0f, 0.0f };
+
+						if ( texcoord != NoIndex )
+						{
+							tex = { texcoords[texcoord].x, 1.0f - texcoords[texcoord].y };
+						}
+
+						vboData.push_back( { { vtx[0], vtx[1], vtx[2] - 3.0f, 1.0f }, { tex[0], tex[1] } } );
+						return uint32_t( vboData.size() - 1u );
+					} ) );
 			}
 		}
+
+		std::clog << "    Vertex count: " << positionCount << std::endl;
+		std::clog << "    TexCoord count: " << texcoordCount << std::endl;
+		std::clog << "    Triangle count: " << cornerCount / 3u << std::endl;
+		std::clog << "    Unique vertex count: " << vboData.size() - base << std::endl;
+		return true;
+	}
+
+	bool loadObjMesh( std::string const & filePath
+		, std::vector< TexturedVertexData > & vboData
+		, renderer::UInt32Array & iboData )
+	{
+		try
+		{
+			MappedFile file{ filePath };
+			auto data = reinterpret_cast< char const * >( file.getData() );
+			return parseObj( data
+				, data + file.getSize()
+				, vboData
+				, iboData );
+		}
+		catch ( std::exception & exc )
+		{
+			std::cerr << "Failed to load the OBJ file: " << exc.what() << std::endl;
+			return false;
+		}
+	}
+
+	void loadObjFile( std::string const & fileContent
+		, std::vector< TexturedVertexData > & vboData
+		, renderer::UInt16Array & iboData )
+	{
+		renderer::UInt32Array indices;
+		auto first = vboData.size();
+
+		if ( !parseObj( fileContent.data()
+			, fileContent.data() + fileContent.size()
+			, vboData
+			, indices ) )
+		{
+			std::cerr << "Failed to load the OBJ file" << std::endl;
+			return;
+		}
+
+		if ( vboData.size() - first > 0x10000u )
+		{
+			std::cerr << "Failed to load the OBJ file: too many vertices for 16 bits indices" << std::endl;
+			vboData.resize( first );
+			return;
+		}
+
+		for ( auto index : indices )
+		{
+			iboData.push_back( uint16_t( index - first ) );
+		}
 	}
 }
@@ -8,7 +8,9 @@
 #define ___ObjLoader_HPP___
 #pragma once
 
-#include "Prerequisites.hpp"
+#include <Vec3.hpp>
+
+#include <Utils/Vec4.hpp>
 
 namespace common
 {
@@ -27,19 +29,49 @@ namespace common
 	};
 	/**
 	*\brief
-	*	Charge un objet depuis un fichier OBJ.
-	*\param[in] name
-	*	Le nom de l'objet.
-	*\param[in] fileContent
+	*	Analyse le contenu d'un fichier OBJ, en un maillage indexé.
+	*\remarks
+	*	Le contenu est découpé en morceaux de lignes entières, analysés en parallèle puis fusionnés.
+	*	Les sommets partageant la même position et les mêmes coordonnées de texture sont dédoublonnés.
+	*	Les faces de plus de 3 sommets sont triangulées en éventail, les indices négatifs (relatifs) sont supportés.
+	*	Seules les lignes v, vt et f sont utilisées, les normales ne faisant pas partie des sommets produits.
+	*\param[in] begin, end
 	*	Le contenu du fichier OBJ.
-	*\param[in,out] materialsList
-	*	Reçoit les matériaux chargés.
-	*\param[in,out] texturesList
-	*	Reçoit les textures chargées.
-	*\param[in,out] meshesList
-	*	Reçoit les maillages chargés.
+	*\param[out] vboData
+	*	Reçoit les sommets.
+	*\param[out] iboData
+	*	Reçoit les indices, 3 par triangle.
+	*\return
+	*	\p false si le contenu est invalide (indice hors limites).
+	*/
+	bool parseObj( char const * begin
+		, char const * end
+		, std::vector< TexturedVertexData > & vboData
+		, renderer::UInt32Array & iboData );
+	/**
+	*\brief
+	*	Charge un objet depuis un fichier OBJ, mappé en mémoire.
+	*\param[in] filePath
+	*	Le chemin d'accès au fichier OBJ.
+	*\param[out] vboData
+	*	Reçoit les sommets.
+	*\param[out] iboData
+	*	Reçoit les indices, 3 par triangle.
 	*\return
-	*	L'objet chargé.
+	*	\p false si le fichier n'a pas pu être chargé.
+	*/
+	bool loadObjMesh( std::string const & filePath
+		, std::vector< TexturedVertexData > & vboData
+		, renderer::UInt32Array & iboData );
+	/**
+	*\brief
+	*	Charge un objet depuis le contenu d'un fichier OBJ.
+	*\param[in] fileContent
+	*	Le contenu du fichier OBJ.
+	*\param[out] vboData
+	*	Reçoit les sommets.
+	*\param[out] iboData
+	*	Reçoit les indices, l'objet doit donc avoir moins de 65536 sommets.
 	*/
 	void loadObjFile( std::string const & fileContent
 		, std::vector< TexturedVertexData > & vboData
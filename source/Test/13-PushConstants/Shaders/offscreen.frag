@@ -5,6 +5,11 @@ layout( push_constant ) uniform Colour
 {
 	vec4 colour;
 } colour;
+#elif defined( RENDERER_PUSH_CONSTANTS_BINDING )
+layout( std140, binding=RENDERER_PUSH_CONSTANTS_BINDING ) uniform Colour
+{
+	vec4 colour;
+};
 #else
 layout( location=3 ) uniform vec4 colour;
 #endif
@@ -0,0 +1,221 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <Command/IndirectDrawCuller.hpp>
+
+#include <Angle.hpp>
+#include <Transform.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	static float constexpr NearPlane = 0.1f;
+	static float constexpr FarPlane = 100.0f;
+	// The plane distances are computed in single precision by the culler, the objects this close to a plane may go either way.
+	static double constexpr Tolerance = 1.0e-3;
+
+	using Position = std::array< double, 3u >;
+
+	struct Camera
+	{
+		Position eye;
+		Position right;
+		Position up;
+		Position forward;
+		double tanHalfFovX;
+		double tanHalfFovY;
+	};
+
+	double doDot( Position const & lhs
+		, Position const & rhs )
+	{
+		return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+	}
+
+	bool doCheck( bool condition, char const * const message )
+	{
+		if ( !condition )
+		{
+			std::cerr << "Check failed: " << message << std::endl;
+		}
+
+		return condition;
+	}
+	/**
+	*\brief
+	*	The signed distances from a point to the six planes of the camera frustum, built from the camera basis,
+	*	independently from the view projection matrix.
+	*\remarks
+	*	The projection has a [0, 1] depth range, but the culler uses the near plane of a [-1, 1] one,
+	*	which lies at zFar * zNear / ( 2 * zFar - zNear ) behind the eye.
+	*/
+	std::array< double, 6u > doGetDistances( Camera const & camera
+		, Position const & point )
+	{
+		Position offset{ point[0] - camera.eye[0], point[1] - camera.eye[1], point[2] - camera.eye[2] };
+		auto x = doDot( offset, camera.right );
+		auto y = doDot( offset, camera.up );
+		auto depth = doDot( offset, camera.forward );
+		auto scaleX = std::sqrt( 1.0 + camera.tanHalfFovX * camera.tanHalfFovX );
+		auto scaleY = std::sqrt( 1.0 + camera.tanHalfFovY * camera.tanHalfFovY );
+		double nearDepth = -double( FarPlane ) * NearPlane / ( 2.0 * FarPlane - NearPlane );
+		return
+		{
+			( depth * camera.tanHalfFovX + x ) / scaleX,	// Left
+			( depth * camera.tanHalfFovX - x ) / scaleX,	// Right
+			( depth * camera.tanHalfFovY + y ) / scaleY,	// Bottom
+			( depth * camera.tanHalfFovY - y ) / scaleY,	// Top
+			depth - nearDepth,								// Near
+			FarPlane - depth,								// Far
+		};
+	}
+	/**
+	*\brief
+	*	Checks that the commands are the ones of the objects intersecting all the frustum planes, in the objects order.
+	*\remarks
+	*	The objects are identified by their firstInstance, which is their index.
+	*/
+	bool doCheckView( Camera const & camera
+		, renderer::IndirectDrawObjectArray const & objects
+		, renderer::DrawIndexedIndirectCommandArray const & commands
+		, size_t & visible
+		, size_t & ambiguous )
+	{
+		auto command = commands.begin();
+		size_t missing = 0u;
+		size_t extras = 0u;
+
+		for ( auto & object : objects )
+		{
+			auto & sphere = object.boundingSphere;
+			auto distances = doGetDistances( camera, Position{ sphere[0], sphere[1], sphere[2] } );
+			bool inside = true;
+			bool close = false;
+
+			for ( auto distance : distances )
+			{
+				inside &= distance >= -sphere[3];
+				close |= std::abs( distance + sphere[3] ) < Tolerance * ( 1.0 + std::abs( distance ) );
+			}
+
+			bool drawn = command != commands.end()
+				&& command->firstInstance == object.command.firstInstance;
+
+			if ( drawn )
+			{
+				++visible;
+				++command;
+			}
+
+			if ( drawn != inside )
+			{
+				if ( close )
+				{
+					++ambiguous;
+				}
+				else if ( inside )
+				{
+					++missing;
+				}
+				else
+				{
+					++extras;
+				}
+			}
+		}
+
+		extras += size_t( std::distance( command, commands.end() ) );
+
+		if ( missing || extras )
+		{
+			std::cerr << missing << " object(s) missing, " << extras << " extra object(s)" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+}
+/**
+*\brief
+*	Checks the commands generated by the CPU reference implementation of the indirect draws culling,
+*	against a frustum test built from the camera basis, from several points of view.
+*\remarks
+*	Usage: Test-IndirectDrawCuller [<objects count>] [<views count>]
+*	The defaults are 4096 objects, seen from 64 points of view.
+*/
+int main( int argc, char * argv[] )
+{
+	uint32_t objectsCount = argc > 1
+		? uint32_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 4096u;
+	uint32_t viewsCount = argc > 2
+		? uint32_t( std::strtoul( argv[2], nullptr, 10 ) )
+		: 64u;
+
+	if ( !objectsCount || !viewsCount )
+	{
+		std::cerr << "Usage: Test-IndirectDrawCuller [<objects count>] [<views count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::mt19937 engine{ 42u };
+	std::uniform_real_distribution< float > positions{ -50.0f, 50.0f };
+	std::uniform_real_distribution< float > radii{ 0.1f, 5.0f };
+	std::uniform_real_distribution< float > directions{ -1.0f, 1.0f };
+	// From 30 to 120 degrees.
+	std::uniform_real_distribution< float > fovs{ 0.5236f, 2.0944f };
+	renderer::IndirectDrawObjectArray objects;
+	objects.reserve( objectsCount );
+
+	for ( auto index = 0u; index < objectsCount; ++index )
+	{
+		renderer::IndirectDrawObject object{};
+		object.boundingSphere = { positions( engine ), positions( engine ), positions( engine ), radii( engine ) };
+		object.command = renderer::DrawIndexedIndirectCommand{ 36u, 1u, 0u, 0, index };
+		objects.push_back( object );
+	}
+
+	size_t visible = 0u;
+	size_t ambiguous = 0u;
+	bool result = true;
+
+	for ( auto view = 0u; view < viewsCount; ++view )
+	{
+		utils::Vec3 eye{ positions( engine ), positions( engine ), positions( engine ) };
+		utils::Vec3 direction{ directions( engine ), directions( engine ), directions( engine ) };
+		utils::Vec3 const up{ 0.0f, 1.0f, 0.0f };
+		auto forward = utils::normalize( direction );
+		auto right = utils::normalize( utils::cross( forward, up ) );
+		auto cameraUp = utils::cross( right, forward );
+		utils::Radians fovY{ fovs( engine ) };
+		auto aspect = 16.0f / 9.0f;
+		auto viewProjection = utils::perspective( fovY, aspect, NearPlane, FarPlane )
+			* utils::lookAt( eye, eye + forward, up );
+		Camera camera
+		{
+			Position{ eye.x, eye.y, eye.z },
+			Position{ right.x, right.y, right.z },
+			Position{ cameraUp.x, cameraUp.y, cameraUp.z },
+			Position{ forward.x, forward.y, forward.z },
+			std::tan( double( float( fovY ) ) / 2.0 ) * aspect,
+			std::tan( double( float( fovY ) ) / 2.0 ),
+		};
+		auto commands = renderer::IndirectDrawCuller::cullObjects( renderer::IndirectDrawCuller::getFrustumPlanes( viewProjection )
+			, objects );
+		result &= doCheck( commands.size() <= objects.size(), "commands count" )
+			&& doCheckView( camera, objects, commands, visible, ambiguous );
+	}
+
+	std::cout << visible << " visible object(s) in " << viewsCount << " view(s), "
+		<< ambiguous << " ambiguous object(s)" << std::endl;
+
+	return result
+		? EXIT_SUCCESS
+		: EXIT_FAILURE;
+}
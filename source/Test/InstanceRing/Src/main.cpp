@@ -0,0 +1,192 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <Buffer/InstanceRing.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// The number of acquired ranges held by the consumer before their release, as frames in flight.
+	static size_t constexpr FramesInFlight = 3u;
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+
+	bool doCheck( bool condition, char const * const message )
+	{
+		if ( !condition )
+		{
+			std::cerr << "Check failed: " << message << std::endl;
+		}
+
+		return condition;
+	}
+	/**
+	*\brief
+	*	Checks the capacity rounding, the full ring, and the segments of a wrapping range, on one thread.
+	*/
+	bool doCheckSegments()
+	{
+		bool result = true;
+		result &= doCheck( renderer::InstanceRing{ 0u }.getCapacity() == 1u, "null capacity" );
+		result &= doCheck( renderer::InstanceRing{ 5u }.getCapacity() == 8u, "capacity rounding" );
+
+		renderer::InstanceRing ring{ 8u };
+		std::vector< std::pair< uint32_t, uint32_t > > segments;
+		auto record = [&segments]( uint32_t first, uint32_t size )
+		{
+			segments.emplace_back( first, size );
+		};
+		result &= doCheck( ring.push( 6u, record ) == 6u, "first push" );
+		auto range = ring.acquire();
+		result &= doCheck( range.begin == 0u && range.end == 6u, "first range" );
+		result &= doCheck( ring.push( 6u, record ) == 2u, "push in a full ring" );
+		ring.release( range );
+		ring.acquire();
+		segments.clear();
+		result &= doCheck( ring.push( 6u, record ) == 6u, "push past the end" );
+		result &= doCheck( segments.size() == 1u
+				&& segments[0] == std::make_pair( 0u, 6u )
+			, "push past the end segments" );
+		segments.clear();
+		range = ring.acquire();
+		result &= doCheck( range.begin == 8u && range.end == 14u, "range past the end" );
+		ring.forEachSegment( renderer::InstanceRange{ 6u, 14u }, record );
+		result &= doCheck( segments.size() == 2u
+				&& segments[0] == std::make_pair( 6u, 2u )
+				&& segments[1] == std::make_pair( 0u, 6u )
+			, "wrapping range segments" );
+		return result;
+	}
+	/**
+	*\brief
+	*	A producer thread pushes increasing values in batches of random sizes, the consumer checks it acquires them in order,
+	*	and releases them with a few frames of latency.
+	*/
+	bool doCheckThreads( uint32_t capacity
+		, uint32_t valuesCount
+		, double & time )
+	{
+		renderer::InstanceRing ring{ capacity };
+		std::vector< uint32_t > storage( ring.getCapacity() );
+		uint32_t errors = 0u;
+		time = doMeasure( [&]()
+			{
+				std::thread producer{ [&ring, &storage, valuesCount]()
+				{
+					std::mt19937 engine{ 42u };
+					std::uniform_int_distribution< uint32_t > sizes{ 1u, ring.getCapacity() / 2u };
+					uint32_t next = 0u;
+
+					while ( next < valuesCount )
+					{
+						auto count = std::min( sizes( engine ), valuesCount - next );
+						auto pushed = ring.push( count
+							, [&storage, &next]( uint32_t first, uint32_t size )
+							{
+								for ( auto index = first; index < first + size; ++index )
+								{
+									storage[index] = next++;
+								}
+							} );
+
+						if ( !pushed )
+						{
+							std::this_thread::yield();
+						}
+					}
+				} };
+
+				std::deque< renderer::InstanceRange > inFlight;
+				uint32_t expected = 0u;
+
+				// Each iteration is a frame, the ranges are released once the frames in flight are done.
+				while ( expected < valuesCount )
+				{
+					auto range = ring.acquire();
+					ring.forEachSegment( range
+						, [&storage, &expected, &errors]( uint32_t first, uint32_t size )
+						{
+							for ( auto index = first; index < first + size; ++index )
+							{
+								errors += storage[index] == expected++ ? 0u : 1u;
+							}
+						} );
+					inFlight.push_back( range );
+
+					if ( inFlight.size() > FramesInFlight )
+					{
+						ring.release( inFlight.front() );
+						inFlight.pop_front();
+					}
+
+					if ( range.begin == range.end )
+					{
+						std::this_thread::yield();
+					}
+				}
+
+				for ( auto & range : inFlight )
+				{
+					ring.release( range );
+				}
+
+				producer.join();
+				errors += expected == valuesCount ? 0u : 1u;
+			} );
+
+		if ( errors )
+		{
+			std::cerr << errors << " value(s) out of order, with a capacity of " << ring.getCapacity() << std::endl;
+		}
+
+		return errors == 0u;
+	}
+}
+/**
+*\brief
+*	Checks the single producer, single consumer ring of renderer::InstanceStream, on one thread then between two threads,
+*	for several capacities.
+*\remarks
+*	Usage: Test-InstanceRing [<values count>]
+*	The default is 1000000 values, streamed through each capacity.
+*/
+int main( int argc, char * argv[] )
+{
+	uint32_t valuesCount = argc > 1
+		? uint32_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 1000000u;
+
+	if ( !valuesCount )
+	{
+		std::cerr << "Usage: Test-InstanceRing [<values count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	bool result = doCheckSegments();
+
+	for ( uint32_t capacity : { 2u, 64u, 4096u } )
+	{
+		double time = 0.0;
+		result &= doCheckThreads( capacity, valuesCount, time );
+		std::cout << "Capacity " << capacity << ": " << time * 1.0e9 / valuesCount << " ns per value" << std::endl;
+	}
+
+	return result
+		? EXIT_SUCCESS
+		: EXIT_FAILURE;
+}
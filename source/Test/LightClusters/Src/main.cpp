@@ -0,0 +1,374 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <LightBinning.hpp>
+
+#include <Angle.hpp>
+#include <Transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	static float constexpr NearPlane = 0.1f;
+	static float constexpr FarPlane = 100.0f;
+	// The brute force distances are approximate, the lights closer than this ratio of their range must be binned.
+	static double constexpr RangeTolerance = 0.99;
+
+	using Position = std::array< double, 3u >;
+	/**
+	*\brief
+	*	The half-space n.x + d >= 0.
+	*/
+	struct HalfSpace
+	{
+		Position n;
+		double d;
+	};
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+
+	double doDot( Position const & lhs
+		, Position const & rhs )
+	{
+		return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+	}
+	/**
+	*\brief
+	*	The six planes bounding a froxel, in view space, computed from the projection scales and the exponential slices.
+	*\remarks
+	*	The projection must be symmetric.
+	*/
+	std::array< HalfSpace, 6u > doGetFroxel( common::ClustersConfig const & config
+		, uint32_t x
+		, uint32_t y
+		, uint32_t z )
+	{
+		auto const & projection = config.mtxProjection;
+		// x / -z = ndcX / P[0][0], y / -z = ndcY / P[1][1].
+		double slopesX[2]
+		{
+			( double( x ) / config.gridSize[0] * 2.0 - 1.0 ) / projection[0][0],
+			( double( x + 1u ) / config.gridSize[0] * 2.0 - 1.0 ) / projection[0][0],
+		};
+		double slopesY[2]
+		{
+			( double( y ) / config.gridSize[1] * 2.0 - 1.0 ) / projection[1][1],
+			( double( y + 1u ) / config.gridSize[1] * 2.0 - 1.0 ) / projection[1][1],
+		};
+		std::sort( std::begin( slopesX ), std::end( slopesX ) );
+		std::sort( std::begin( slopesY ), std::end( slopesY ) );
+		auto ratio = double( FarPlane ) / NearPlane;
+		double depths[2]
+		{
+			NearPlane * std::pow( ratio, double( z ) / config.gridSize[2] ),
+			NearPlane * std::pow( ratio, double( z + 1u ) / config.gridSize[2] ),
+		};
+		return
+		{
+			HalfSpace{ Position{ 1.0, 0.0, slopesX[0] }, 0.0 },
+			HalfSpace{ Position{ -1.0, 0.0, -slopesX[1] }, 0.0 },
+			HalfSpace{ Position{ 0.0, 1.0, slopesY[0] }, 0.0 },
+			HalfSpace{ Position{ 0.0, -1.0, -slopesY[1] }, 0.0 },
+			HalfSpace{ Position{ 0.0, 0.0, -1.0 }, -depths[0] },
+			HalfSpace{ Position{ 0.0, 0.0, 1.0 }, depths[1] },
+		};
+	}
+	/**
+	*\brief
+	*	The distance from a point to a froxel, using Dykstra's alternating projections onto its half-spaces.
+	*/
+	double doGetDistance( std::array< HalfSpace, 6u > const & froxel
+		, Position const & point )
+	{
+		Position current = point;
+		Position increments[6]{};
+
+		for ( uint32_t iteration = 0u; iteration < 200u; ++iteration )
+		{
+			double moved = 0.0;
+
+			for ( size_t plane = 0u; plane < froxel.size(); ++plane )
+			{
+				auto & halfSpace = froxel[plane];
+				Position shifted
+				{
+					current[0] + increments[plane][0],
+					current[1] + increments[plane][1],
+					current[2] + increments[plane][2],
+				};
+				auto projected = shifted;
+				auto side = doDot( halfSpace.n, shifted ) + halfSpace.d;
+
+				if ( side < 0.0 )
+				{
+					auto scale = side / doDot( halfSpace.n, halfSpace.n );
+
+					for ( size_t c = 0u; c < 3u; ++c )
+					{
+						projected[c] -= scale * halfSpace.n[c];
+					}
+				}
+
+				for ( size_t c = 0u; c < 3u; ++c )
+				{
+					increments[plane][c] = shifted[c] - projected[c];
+					moved += std::abs( projected[c] - current[c] );
+				}
+
+				current = projected;
+			}
+
+			if ( moved < 1.0e-9 )
+			{
+				break;
+			}
+		}
+
+		Position offset{ current[0] - point[0], current[1] - point[1], current[2] - point[2] };
+		return std::sqrt( doDot( offset, offset ) );
+	}
+
+	struct Sphere
+	{
+		Position center;
+		double radius;
+		uint32_t id;
+	};
+	/**
+	*\brief
+	*	Bins the lights by measuring their distance to each froxel.
+	*/
+	std::vector< std::vector< uint32_t > > doBruteForce( common::ClustersConfig const & config
+		, std::vector< Sphere > const & spheres )
+	{
+		std::vector< std::vector< uint32_t > > result( config.gridSize[0] * config.gridSize[1] * config.gridSize[2] );
+
+		for ( uint32_t z = 0u; z < config.gridSize[2]; ++z )
+		{
+			for ( uint32_t y = 0u; y < config.gridSize[1]; ++y )
+			{
+				for ( uint32_t x = 0u; x < config.gridSize[0]; ++x )
+				{
+					auto froxel = doGetFroxel( config, x, y, z );
+					auto & cluster = result[x + config.gridSize[0] * ( y + config.gridSize[1] * z )];
+					auto nearDepth = -froxel[4].d;
+					auto farDepth = froxel[5].d;
+
+					for ( auto & sphere : spheres )
+					{
+						// Cheap rejection on the depth alone.
+						if ( -sphere.center[2] + sphere.radius < nearDepth
+							|| -sphere.center[2] - sphere.radius > farDepth )
+						{
+							continue;
+						}
+
+						if ( doGetDistance( froxel, sphere.center ) < sphere.radius * RangeTolerance )
+						{
+							cluster.push_back( sphere.id );
+						}
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+	bool doCheckScene( common::ClustersConfig const & config
+		, common::PointLightArray const & pointLights
+		, common::SpotLightArray const & spotLights
+		, double & binTime
+		, double & bruteForceTime
+		, size_t & extras
+		, size_t & binned )
+	{
+		std::vector< Sphere > spheres;
+
+		for ( uint32_t index = 0u; index < pointLights.size() + spotLights.size(); ++index )
+		{
+			auto & light = index < pointLights.size()
+				? pointLights[index]
+				: spotLights[index - pointLights.size()].base;
+			auto position = config.mtxView * renderer::Vec4{ light.position[0], light.position[1], light.position[2], 1.0f };
+			spheres.push_back( Sphere
+			{
+				Position{ position[0], position[1], position[2] },
+				light.position[3],
+				index < pointLights.size()
+					? index
+					: uint32_t( index - pointLights.size() ) | common::LightBinning::SpotLightFlag,
+			} );
+		}
+
+		renderer::UInt32Array clusters;
+		binTime += doMeasure( [&]()
+			{
+				clusters = common::LightBinning::binLights( config, pointLights, spotLights );
+			} );
+		std::vector< std::vector< uint32_t > > expected;
+		bruteForceTime += doMeasure( [&]()
+			{
+				expected = doBruteForce( config, spheres );
+			} );
+		auto clusterSize = config.gridSize[3] + 1u;
+		size_t missing = 0u;
+		size_t invalid = 0u;
+
+		for ( size_t index = 0u; index < expected.size(); ++index )
+		{
+			auto cluster = clusters.data() + index * clusterSize;
+			auto count = cluster[0];
+
+			if ( count > config.gridSize[3] )
+			{
+				++invalid;
+				continue;
+			}
+
+			std::vector< uint32_t > ids( cluster + 1u, cluster + 1u + count );
+			std::sort( ids.begin(), ids.end() );
+
+			if ( std::adjacent_find( ids.begin(), ids.end() ) != ids.end() )
+			{
+				++invalid;
+			}
+
+			binned += count;
+
+			// A full cluster drops the lights found after its last slot.
+			if ( count < config.gridSize[3] )
+			{
+				auto & expectedIds = expected[index];
+				std::sort( expectedIds.begin(), expectedIds.end() );
+
+				for ( auto id : expectedIds )
+				{
+					missing += std::binary_search( ids.begin(), ids.end(), id ) ? 0u : 1u;
+				}
+
+				for ( auto id : ids )
+				{
+					extras += std::binary_search( expectedIds.begin(), expectedIds.end(), id ) ? 0u : 1u;
+				}
+			}
+		}
+
+		if ( missing || invalid )
+		{
+			std::cerr << missing << " light(s) missing, " << invalid << " invalid cluster(s)" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+}
+/**
+*\brief
+*	Checks the CPU lights binning of the clustered lighting against a brute force one,
+*	measuring the exact distance from each light to each froxel, from several points of view.
+*\remarks
+*	Usage: Test-LightClusters [<lights count>] [<views count>]
+*	The defaults are 1024 lights, seen from 8 points of view.
+*/
+int main( int argc, char * argv[] )
+{
+	uint32_t lightsCount = argc > 1
+		? uint32_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 1024u;
+	uint32_t viewsCount = argc > 2
+		? uint32_t( std::strtoul( argv[2], nullptr, 10 ) )
+		: 8u;
+
+	if ( !lightsCount || !viewsCount )
+	{
+		std::cerr << "Usage: Test-LightClusters [<lights count>] [<views count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	common::PointLightArray pointLights;
+	common::SpotLightArray spotLights;
+	common::generateLights( utils::Vec3{ 0.0f, 0.0f, 0.0f }
+		, 10.0f
+		, lightsCount
+		, pointLights
+		, spotLights );
+
+	for ( auto & light : pointLights )
+	{
+		light.position[3] = common::LightBinning::getRange( light );
+	}
+
+	for ( auto & light : spotLights )
+	{
+		light.base.position[3] = common::LightBinning::getRange( light.base );
+	}
+
+	common::ClustersConfig config{};
+	config.mtxProjection = utils::perspective( utils::toRadians( 90.0_degrees )
+		, 16.0f / 9.0f
+		, NearPlane
+		, FarPlane );
+	config.mtxInvProjection = renderer::inverse( config.mtxProjection );
+	config.gridSize = utils::UIVec4
+	{
+		common::LightBinning::GridWidth,
+		common::LightBinning::GridHeight,
+		common::LightBinning::GridDepth,
+		common::LightBinning::MaxLightsPerCluster,
+	};
+	config.depthRange = utils::Vec4{ NearPlane, FarPlane, std::log( FarPlane / NearPlane ), 0.0f };
+	config.lightsCount = utils::UIVec4{ uint32_t( pointLights.size() ), uint32_t( spotLights.size() ), 0u, 0u };
+
+	std::mt19937 engine{ 42u };
+	std::uniform_real_distribution< float > distribution{ -1.0f, 1.0f };
+	double binTime = 0.0;
+	double bruteForceTime = 0.0;
+	size_t extras = 0u;
+	size_t binned = 0u;
+	bool result = true;
+
+	for ( uint32_t view = 0u; view < viewsCount; ++view )
+	{
+		// From the center of the lights sphere, or from outside of it.
+		auto distance = view % 2u
+			? 25.0f
+			: 0.0f;
+		utils::Vec3 eye{ distribution( engine ), distribution( engine ), distribution( engine ) };
+		eye = utils::normalize( eye ) * distance;
+		utils::Vec3 target{ distribution( engine ), distribution( engine ), distribution( engine ) };
+		config.mtxView = utils::lookAt( eye
+			, distance > 0.0f ? utils::Vec3{ 0.0f, 0.0f, 0.0f } : target
+			, utils::Vec3{ 0.0f, 1.0f, 0.0f } );
+		result &= doCheckScene( config
+			, pointLights
+			, spotLights
+			, binTime
+			, bruteForceTime
+			, extras
+			, binned );
+	}
+
+	std::cout << "binLights: " << binTime * 1.0e3 / viewsCount << " ms per view"
+		<< ", brute force: " << bruteForceTime * 1.0e3 / viewsCount << " ms per view" << std::endl;
+	std::cout << binned << " binned lights, " << extras << " conservative extra(s)" << std::endl;
+
+	return result
+		? EXIT_SUCCESS
+		: EXIT_FAILURE;
+}
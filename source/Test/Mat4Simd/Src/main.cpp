@@ -0,0 +1,271 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <Utils/Mat4.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	/**
+	*\brief
+	*	A float wrapper, for which Mat4T uses the generic scalar implementations of Mat4.inl,
+	*	while Mat4T< float > uses the ones of Mat4Simd.inl.
+	*/
+	struct Scalar
+	{
+		Scalar() = default;
+
+		template< typename T >
+		constexpr Scalar( T value )
+			: value{ float( value ) }
+		{
+		}
+
+		float value;
+	};
+
+	inline Scalar operator-( Scalar rhs )
+	{
+		return Scalar{ -rhs.value };
+	}
+
+	inline Scalar operator+( Scalar lhs, Scalar rhs )
+	{
+		return Scalar{ lhs.value + rhs.value };
+	}
+
+	inline Scalar operator-( Scalar lhs, Scalar rhs )
+	{
+		return Scalar{ lhs.value - rhs.value };
+	}
+
+	inline Scalar operator*( Scalar lhs, Scalar rhs )
+	{
+		return Scalar{ lhs.value * rhs.value };
+	}
+
+	inline Scalar operator/( Scalar lhs, Scalar rhs )
+	{
+		return Scalar{ lhs.value / rhs.value };
+	}
+
+	inline bool operator==( Scalar lhs, Scalar rhs )
+	{
+		return lhs.value == rhs.value;
+	}
+
+	inline bool operator!=( Scalar lhs, Scalar rhs )
+	{
+		return lhs.value != rhs.value;
+	}
+
+	using Mat4 = renderer::Mat4T< float >;
+	using Vec4 = renderer::Vec4T< float >;
+	using ScalarMat4 = renderer::Mat4T< Scalar >;
+	using ScalarVec4 = renderer::Vec4T< Scalar >;
+
+	ScalarMat4 doToScalar( Mat4 const & matrix )
+	{
+		ScalarMat4 result;
+
+		for ( size_t col = 0u; col < 4u; ++col )
+		{
+			for ( size_t row = 0u; row < 4u; ++row )
+			{
+				result[col][row] = matrix[col][row];
+			}
+		}
+
+		return result;
+	}
+
+	ScalarVec4 doToScalar( Vec4 const & vector )
+	{
+		return ScalarVec4{ vector[0], vector[1], vector[2], vector[3] };
+	}
+
+	bool doCompare( Vec4 const & lhs
+		, ScalarVec4 const & rhs )
+	{
+		for ( size_t index = 0u; index < 4u; ++index )
+		{
+			// Bitwise comparison, so that the NaNs and the zeroes signs are compared too.
+			if ( std::memcmp( &lhs[index], &rhs[index].value, sizeof( float ) ) )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool doCompare( Mat4 const & lhs
+		, ScalarMat4 const & rhs )
+	{
+		for ( size_t col = 0u; col < 4u; ++col )
+		{
+			if ( !doCompare( lhs[col], rhs[col] ) )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+
+	template< typename MatrixT, typename VectorT >
+	struct Results
+	{
+		std::vector< MatrixT > products;
+		std::vector< VectorT > transforms;
+		std::vector< MatrixT > inverses;
+		std::vector< MatrixT > transposes;
+		double times[4];
+	};
+
+	template< typename MatrixT, typename VectorT >
+	Results< MatrixT, VectorT > doRun( std::vector< MatrixT > const & lhs
+		, std::vector< MatrixT > const & rhs
+		, std::vector< VectorT > const & vectors )
+	{
+		auto count = lhs.size();
+		Results< MatrixT, VectorT > result;
+		result.products.resize( count );
+		result.transforms.resize( count );
+		result.inverses.resize( count );
+		result.transposes.resize( count );
+		result.times[0] = doMeasure( [&]()
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					result.products[index] = lhs[index] * rhs[index];
+				}
+			} );
+		result.times[1] = doMeasure( [&]()
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					result.transforms[index] = lhs[index] * vectors[index];
+				}
+			} );
+		result.times[2] = doMeasure( [&]()
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					result.inverses[index] = renderer::inverse( lhs[index] );
+				}
+			} );
+		result.times[3] = doMeasure( [&]()
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					result.transposes[index] = renderer::transpose( lhs[index] );
+				}
+			} );
+		return result;
+	}
+}
+/**
+*\brief
+*	Checks that the SIMD Mat4T< float > operations give the same results as the scalar ones, bit to bit,
+*	and compares their timings.
+*\remarks
+*	Usage: Test-Mat4Simd [<matrices count>]
+*	The matrices count defaults to 1000000.
+*/
+int main( int argc, char * argv[] )
+{
+	size_t count = argc > 1
+		? size_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 1000000u;
+
+	if ( !count )
+	{
+		std::cerr << "Usage: Test-Mat4Simd [<matrices count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+#if defined( RENDERLIB_SIMD_AVX )
+	std::cout << "Instruction set: AVX" << std::endl;
+#elif defined( RENDERLIB_SIMD_SSE2 )
+	std::cout << "Instruction set: SSE2" << std::endl;
+#else
+	std::cout << "Instruction set: none, both implementations are scalar" << std::endl;
+#endif
+
+	std::mt19937 engine{ 42u };
+	std::uniform_real_distribution< float > distribution{ -10.0f, 10.0f };
+	std::vector< Mat4 > lhs( count );
+	std::vector< Mat4 > rhs( count );
+	std::vector< Vec4 > vectors( count );
+	std::vector< ScalarMat4 > scalarLhs( count );
+	std::vector< ScalarMat4 > scalarRhs( count );
+	std::vector< ScalarVec4 > scalarVectors( count );
+
+	for ( size_t index = 0u; index < count; ++index )
+	{
+		for ( size_t col = 0u; col < 4u; ++col )
+		{
+			for ( size_t row = 0u; row < 4u; ++row )
+			{
+				lhs[index][col][row] = distribution( engine );
+				rhs[index][col][row] = distribution( engine );
+			}
+
+			vectors[index][col] = distribution( engine );
+		}
+
+		scalarLhs[index] = doToScalar( lhs[index] );
+		scalarRhs[index] = doToScalar( rhs[index] );
+		scalarVectors[index] = doToScalar( vectors[index] );
+	}
+
+	auto simd = doRun( lhs, rhs, vectors );
+	auto scalar = doRun( scalarLhs, scalarRhs, scalarVectors );
+	char const * const names[]
+	{
+		"Mat4 * Mat4",
+		"Mat4 * Vec4",
+		"inverse",
+		"transpose",
+	};
+	size_t errors[4]{};
+
+	for ( size_t index = 0u; index < count; ++index )
+	{
+		errors[0] += doCompare( simd.products[index], scalar.products[index] ) ? 0u : 1u;
+		errors[1] += doCompare( simd.transforms[index], scalar.transforms[index] ) ? 0u : 1u;
+		errors[2] += doCompare( simd.inverses[index], scalar.inverses[index] ) ? 0u : 1u;
+		errors[3] += doCompare( simd.transposes[index], scalar.transposes[index] ) ? 0u : 1u;
+	}
+
+	bool result = true;
+
+	for ( size_t index = 0u; index < 4u; ++index )
+	{
+		std::cout << names[index] << ": scalar " << scalar.times[index] * 1.0e9 / count << " ns"
+			<< ", SIMD " << simd.times[index] * 1.0e9 / count << " ns"
+			<< ", " << errors[index] << " mismatch(es)" << std::endl;
+		result &= errors[index] == 0u;
+	}
+
+	return result
+		? EXIT_SUCCESS
+		: EXIT_FAILURE;
+}
@@ -0,0 +1,322 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <MappedFile.hpp>
+#include <ObjLoader.hpp>
+
+#include <StringUtils.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	/**
+	*\brief
+	*	Writes a grid of \p size x \p size quads, split in triangles, with positions, texture coordinates and normals.
+	*/
+	void doGenerateObj( std::string const & filePath
+		, uint32_t size )
+	{
+		std::ofstream file{ filePath, std::ios::binary };
+		char line[256];
+		file << "# Generated by ObjLoaderBenchmark\n";
+		file << "g grid\n";
+
+		for ( uint32_t y = 0u; y <= size; ++y )
+		{
+			for ( uint32_t x = 0u; x <= size; ++x )
+			{
+				auto u = float( x ) / size;
+				auto v = float( y ) / size;
+				std::snprintf( line, sizeof( line )
+					, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0.000000 1.000000 0.000000\n"
+					, u * 2.0f - 1.0f
+					, std::sin( u * 12.0f ) * std::cos( v * 7.0f ) * 0.1f
+					, v * 2.0f - 1.0f
+					, u
+					, v );
+				file << line;
+			}
+		}
+
+		for ( uint32_t y = 0u; y < size; ++y )
+		{
+			for ( uint32_t x = 0u; x < size; ++x )
+			{
+				auto i0 = y * ( size + 1u ) + x + 1u;
+				auto i1 = i0 + 1u;
+				auto i2 = i0 + size + 1u;
+				auto i3 = i2 + 1u;
+				std::snprintf( line, sizeof( line )
+					, "f %u/%u/%u %u/%u/%u %u/%u/%u\nf %u/%u/%u %u/%u/%u %u/%u/%u\n"
+					, i0, i0, i0, i2, i2, i2, i1, i1, i1
+					, i1, i1, i1, i2, i2, i2, i3, i3, i3 );
+				file << line;
+			}
+		}
+	}
+	/**
+	*\brief
+	*	The previous iostream based loader, with 32 bits counters, used as reference.
+	*/
+	void doLoadLegacy( std::string const & fileContent
+		, std::vector< common::TexturedVertexData > & vboData
+		, renderer::UInt32Array & iboData )
+	{
+		uint32_t nv = 0u;
+		uint32_t nvt = 0u;
+		uint32_t nvn = 0u;
+		uint32_t nf = 0u;
+		uint32_t ntf = 0u;
+		renderer::UInt32Array faces;
+		{
+			std::istringstream file( fileContent );
+			std::string line;
+
+			while ( std::getline( file, line ) )
+			{
+				utils::trimLeft( line );
+				std::stringstream stream( line );
+				std::string ident;
+				stream >> ident;
+
+				if ( ident == "v" )
+				{
+					if ( ntf )
+					{
+						faces.push_back( ntf );
+						ntf = 0u;
+					}
+
+					++nv;
+				}
+				else if ( ident == "vt" )
+				{
+					++nvt;
+				}
+				else if ( ident == "vn" )
+				{
+					++nvn;
+				}
+				else if ( ident == "f" )
+				{
+					++nf;
+					++ntf;
+				}
+				else if ( ident == "g" || ident == "usemtl" )
+				{
+					if ( ntf )
+					{
+						faces.push_back( ntf );
+						ntf = 0u;
+					}
+				}
+			}
+
+			if ( ntf )
+			{
+				faces.push_back( ntf );
+			}
+		}
+
+		std::istringstream file( fileContent );
+		std::string line;
+		utils::Vec3Array allvtx( nv );
+		utils::Vec2Array alltex( nvt );
+		utils::Vec3Array allnml( nvn );
+		auto vtxit = allvtx.begin();
+		auto texit = alltex.begin();
+		auto nmlit = allnml.begin();
+
+		while ( std::getline( file, line ) )
+		{
+			utils::trim( line );
+			std::stringstream stream( line );
+			std::string ident;
+			stream >> ident;
+
+			if ( ident == "v" )
+			{
+				stream >> vtxit->x >> vtxit->y >> vtxit->z;
+				++vtxit;
+			}
+			else if ( ident == "vt" )
+			{
+				stream >> texit->x >> texit->y;
+				++texit;
+			}
+			else if ( ident == "vn" )
+			{
+				stream >> nmlit->x >> nmlit->y >> nmlit->z;
+				++nmlit;
+			}
+		}
+
+		file.clear();
+		file.seekg( 0, std::ios::beg );
+
+		utils::Vec3Array vertex( nf * 3 );
+		utils::Vec2Array texcoord( nf * 3 );
+		vtxit = vertex.begin();
+		texit = texcoord.begin();
+		uint32_t count = 0u;
+
+		while ( std::getline( file, line ) )
+		{
+			utils::trim( line );
+			std::stringstream stream( line );
+			std::string ident;
+			stream >> ident;
+
+			if ( ident == "f" )
+			{
+				for ( uint32_t i = 0u; i < 3u; i++ )
+				{
+					std::string face;
+					stream >> face;
+
+					size_t index1 = face.find( '/' );
+					std::string component = face.substr( 0, index1 );
+					uint32_t iv = atoi( component.c_str() ) - 1;
+					*vtxit++ = allvtx[iv];
+
+					++index1;
+					size_t index2 = face.find( '/', index1 );
+
+					if ( index2 > index1 )
+					{
+						component = face.substr( index1, index2 - index1 );
+						uint32_t ivt = atoi( component.c_str() ) - 1;
+						texit->x = alltex[ivt].x;
+						texit->y = 1.0f - alltex[ivt].y;
+						++texit;
+					}
+
+					iboData.push_back( count++ );
+				}
+			}
+		}
+
+		for ( uint32_t i = 0; i < count; ++i )
+		{
+			auto & vtx = vertex[i];
+			auto & tex = texcoord[i];
+			vboData.push_back( { { vtx[0], vtx[1], vtx[2] - 3.0f, 1.0f }, { tex[0], tex[1] } } );
+		}
+	}
+
+	bool doCompare( std::vector< common::TexturedVertexData > const & lhsVbo
+		, renderer::UInt32Array const & lhsIbo
+		, std::vector< common::TexturedVertexData > const & rhsVbo
+		, renderer::UInt32Array const & rhsIbo )
+	{
+		if ( lhsIbo.size() != rhsIbo.size() )
+		{
+			return false;
+		}
+
+		for ( size_t i = 0u; i < lhsIbo.size(); ++i )
+		{
+			auto & lhs = lhsVbo[lhsIbo[i]];
+			auto & rhs = rhsVbo[rhsIbo[i]];
+
+			for ( size_t c = 0u; c < 4u; ++c )
+			{
+				if ( std::abs( lhs.position[c] - rhs.position[c] ) > 1.0e-6f )
+				{
+					return false;
+				}
+			}
+
+			for ( size_t c = 0u; c < 2u; ++c )
+			{
+				if ( std::abs( lhs.uv[c] - rhs.uv[c] ) > 1.0e-6f )
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+}
+/**
+*\brief
+*	Compares the OBJ loaders throughput, on a generated grid.
+*\remarks
+*	Usage: Test-ObjLoaderBenchmark [<grid size>] [<file path>]
+*	The grid size defaults to 1000, for 2 millions triangles (around 200 MB).
+*/
+int main( int argc, char * argv[] )
+{
+	uint32_t size = argc > 1
+		? uint32_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 1000u;
+	std::string filePath = argc > 2
+		? std::string{ argv[2] }
+		: std::string{ "ObjLoaderBenchmark.obj" };
+
+	if ( !size )
+	{
+		std::cerr << "Usage: Test-ObjLoaderBenchmark [<grid size>] [<file path>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	doGenerateObj( filePath, size );
+	std::vector< common::TexturedVertexData > legacyVbo;
+	renderer::UInt32Array legacyIbo;
+	std::vector< common::TexturedVertexData > vbo;
+	renderer::UInt32Array ibo;
+	double megaBytes = 0.0;
+
+	auto legacy = doMeasure( [&]()
+		{
+			// The legacy loader needs the whole content, its read is part of the measure.
+			common::MappedFile file{ filePath };
+			std::string content{ reinterpret_cast< char const * >( file.getData() ), file.getSize() };
+			megaBytes = content.size() / ( 1024.0 * 1024.0 );
+			doLoadLegacy( content, legacyVbo, legacyIbo );
+		} );
+	bool loaded{ false };
+	auto current = doMeasure( [&]()
+		{
+			loaded = common::loadObjMesh( filePath, vbo, ibo );
+		} );
+	std::remove( filePath.c_str() );
+
+	if ( !loaded )
+	{
+		std::cerr << "Couldn't load " << filePath << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "File size: " << megaBytes << " MB" << std::endl;
+	std::cout << "Legacy loader: " << legacy << " s, " << megaBytes / legacy << " MB/s, "
+		<< legacyVbo.size() << " vertices" << std::endl;
+	std::cout << "Streaming loader: " << current << " s, " << megaBytes / current << " MB/s, "
+		<< vbo.size() << " vertices" << std::endl;
+
+	if ( !doCompare( legacyVbo, legacyIbo, vbo, ibo ) )
+	{
+		std::cerr << "The loaders results differ" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
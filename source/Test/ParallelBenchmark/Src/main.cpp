@@ -0,0 +1,259 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <Parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/**
+	*\brief
+	*	The previous parallelFor, spawning and joining its threads at each call, used as reference.
+	*/
+	template< typename FuncT >
+	void legacyParallelFor( size_t count
+		, size_t grain
+		, FuncT function )
+	{
+		grain = std::max< size_t >( grain, 1u );
+		size_t const threads = std::min< size_t >( std::max( std::thread::hardware_concurrency(), 1u )
+			, ( count + grain - 1u ) / grain );
+
+		if ( threads <= 1u )
+		{
+			if ( count )
+			{
+				function( size_t{ 0u }, count );
+			}
+
+			return;
+		}
+
+		size_t chunk = ( count + threads - 1u ) / threads;
+		chunk = ( ( chunk + grain - 1u ) / grain ) * grain;
+		std::vector< std::thread > workers;
+		workers.reserve( threads - 1u );
+
+		for ( size_t begin = chunk; begin < count; begin += chunk )
+		{
+			workers.emplace_back( [&function, begin, chunk, count]()
+			{
+				function( begin, std::min( begin + chunk, count ) );
+			} );
+		}
+
+		function( size_t{ 0u }, std::min( chunk, count ) );
+
+		for ( auto & worker : workers )
+		{
+			worker.join();
+		}
+	}
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+
+	bool doCheck( bool condition, char const * const message )
+	{
+		if ( !condition )
+		{
+			std::cerr << "Check failed: " << message << std::endl;
+		}
+
+		return condition;
+	}
+	/**
+	*\brief
+	*	Checks that each index is processed once, for single, nested and simultaneous calls.
+	*/
+	bool doCheckCoverage()
+	{
+		bool result = true;
+		std::vector< std::atomic< uint32_t > > hits( 100003u );
+		auto process = [&hits]( size_t begin, size_t end )
+		{
+			for ( auto index = begin; index < end; ++index )
+			{
+				++hits[index];
+			}
+		};
+		auto count = [&hits]( uint32_t expected )
+		{
+			bool same = true;
+
+			for ( auto & hit : hits )
+			{
+				same &= hit.exchange( 0u ) == expected;
+			}
+
+			return same;
+		};
+
+		for ( size_t grain : { size_t{ 1u }, size_t{ 7u }, size_t{ 1000u }, hits.size() } )
+		{
+			utils::parallelFor( hits.size(), grain, process );
+			result &= doCheck( count( 1u ), "single call" );
+		}
+
+		// Each outer chunk runs a whole inner call.
+		utils::parallelFor( 16u
+			, 1u
+			, [&hits, &process]( size_t begin, size_t end )
+			{
+				for ( auto index = begin; index < end; ++index )
+				{
+					utils::parallelFor( hits.size(), 64u, process );
+				}
+			} );
+		result &= doCheck( count( 16u ), "nested calls" );
+
+		std::vector< std::thread > callers;
+
+		for ( auto index = 0u; index < 4u; ++index )
+		{
+			callers.emplace_back( [&hits, &process]()
+			{
+				for ( auto call = 0u; call < 50u; ++call )
+				{
+					utils::parallelFor( hits.size(), 256u, process );
+				}
+			} );
+		}
+
+		for ( auto & caller : callers )
+		{
+			caller.join();
+		}
+
+		result &= doCheck( count( 200u ), "simultaneous calls" );
+		return result;
+	}
+	/**
+	*\brief
+	*	Checks that an exception thrown by a chunk reaches the caller, and that the pool still works afterwards.
+	*/
+	bool doCheckExceptions()
+	{
+		bool result = true;
+		std::atomic< uint32_t > processed{ 0u };
+		bool caught = false;
+
+		try
+		{
+			utils::parallelFor( 100003u
+				, 1000u
+				, [&processed]( size_t begin, size_t end )
+				{
+					if ( begin <= 50000u && 50000u < end )
+					{
+						throw std::runtime_error{ "chunk failure" };
+					}
+
+					processed += uint32_t( end - begin );
+				} );
+		}
+		catch ( std::runtime_error const & )
+		{
+			caught = true;
+		}
+
+		result &= doCheck( caught, "exception propagation" );
+		result &= doCheck( processed < 100003u, "failed call" );
+
+		processed = 0u;
+		utils::parallelFor( 100003u
+			, 1000u
+			, [&processed]( size_t begin, size_t end )
+			{
+				processed += uint32_t( end - begin );
+			} );
+		result &= doCheck( processed == 100003u, "call after a failure" );
+		return result;
+	}
+}
+/**
+*\brief
+*	Checks the parallelFor coverage and exceptions, then compares the calls overhead of its threads pool
+*	with the one of the previous implementation, on small workloads.
+*\remarks
+*	Usage: Test-ParallelBenchmark [<values count>] [<calls count>]
+*	The defaults are 65536 values, summed 10000 times.
+*/
+int main( int argc, char * argv[] )
+{
+	size_t valuesCount = argc > 1
+		? size_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 65536u;
+	uint32_t callsCount = argc > 2
+		? uint32_t( std::strtoul( argv[2], nullptr, 10 ) )
+		: 10000u;
+
+	if ( !valuesCount || !callsCount )
+	{
+		std::cerr << "Usage: Test-ParallelBenchmark [<values count>] [<calls count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if ( !doCheckCoverage()
+		|| !doCheckExceptions() )
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::vector< uint32_t > values( valuesCount );
+	std::iota( values.begin(), values.end(), 0u );
+	std::atomic< uint64_t > legacySum{ 0u };
+	std::atomic< uint64_t > sum{ 0u };
+	auto legacyTime = doMeasure( [&]()
+		{
+			for ( auto call = 0u; call < callsCount; ++call )
+			{
+				legacyParallelFor( values.size()
+					, 1024u
+					, [&values, &legacySum]( size_t begin, size_t end )
+					{
+						legacySum += std::accumulate( values.data() + begin, values.data() + end, uint64_t{ 0u } );
+					} );
+			}
+		} );
+	auto time = doMeasure( [&]()
+		{
+			for ( auto call = 0u; call < callsCount; ++call )
+			{
+				utils::parallelFor( values.size()
+					, 1024u
+					, [&values, &sum]( size_t begin, size_t end )
+					{
+						sum += std::accumulate( values.data() + begin, values.data() + end, uint64_t{ 0u } );
+					} );
+			}
+		} );
+
+	std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << "Threads per call: " << legacyTime * 1.0e6 / callsCount << " us per call" << std::endl;
+	std::cout << "Threads pool: " << time * 1.0e6 / callsCount << " us per call" << std::endl;
+
+	if ( legacySum != sum )
+	{
+		std::cerr << "The results differ" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
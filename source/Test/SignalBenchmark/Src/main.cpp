@@ -0,0 +1,238 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <RendererPrerequisites.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	using Function = std::function< void( uint32_t ) >;
+	using Signal = renderer::Signal< Function >;
+	using Connection = renderer::SignalConnection< Signal >;
+	/**
+	*\brief
+	*	The previous signal, with its slots in a map copied at each emission and a mutex, used as reference.
+	*/
+	class LegacySignal
+	{
+	public:
+		uint32_t connect( Function function )
+		{
+			std::unique_lock< std::recursive_mutex > lock( m_mutex );
+			uint32_t index = ++m_lastId;
+			m_slots.emplace( index, function );
+			return index;
+		}
+
+		void disconnect( uint32_t index )
+		{
+			std::unique_lock< std::recursive_mutex > lock( m_mutex );
+			m_slots.erase( index );
+		}
+
+		void operator()( uint32_t value )const
+		{
+			for ( auto it : m_slots )
+			{
+				it.second( value );
+			}
+		}
+
+	private:
+		std::map< uint32_t, Function > m_slots;
+		std::recursive_mutex m_mutex;
+		uint32_t m_lastId{ 0u };
+	};
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+
+	bool doCheck( bool condition, char const * const message )
+	{
+		if ( !condition )
+		{
+			std::cerr << "Check failed: " << message << std::endl;
+		}
+
+		return condition;
+	}
+	/**
+	*\brief
+	*	Checks the connections and disconnections made while the signal is emitted.
+	*/
+	bool doCheckReentrance()
+	{
+		bool result = true;
+		std::vector< uint32_t > calls;
+		{
+			// Declared before the signal, the connections are detached by its destruction.
+			std::vector< std::unique_ptr< Connection > > connections( 4u );
+			Signal signal;
+
+			// The first slot disconnects two slots found after it, in reverse order.
+			connections[0] = std::make_unique< Connection >( signal.connect( [&]( uint32_t value )
+				{
+					calls.push_back( value * 10u + 0u );
+					connections[2].reset();
+					connections[1].reset();
+				} ) );
+
+			for ( uint32_t index = 1u; index < 4u; ++index )
+			{
+				connections[index] = std::make_unique< Connection >( signal.connect( [&calls, index]( uint32_t value )
+					{
+						calls.push_back( value * 10u + index );
+					} ) );
+			}
+
+			signal( 1u );
+			result &= doCheck( calls == std::vector< uint32_t >{ 10u, 13u }, "disconnections during emission" );
+
+			// A slot connected during emission is called from the next one.
+			std::unique_ptr< Connection > added;
+			Connection once = signal.connect( [&]( uint32_t )
+				{
+					if ( !added )
+					{
+						added = std::make_unique< Connection >( signal.connect( [&calls]( uint32_t value )
+							{
+								calls.push_back( value * 10u + 9u );
+							} ) );
+					}
+				} );
+			calls.clear();
+			signal( 2u );
+			result &= doCheck( calls == std::vector< uint32_t >{ 20u, 23u }, "connection during emission" );
+			calls.clear();
+			signal( 3u );
+			result &= doCheck( calls == std::vector< uint32_t >{ 30u, 33u, 39u }, "pending connection" );
+
+			// Outside emission, the disconnected slots are removed once they are the majority.
+			once.disconnect();
+			connections[3].reset();
+			calls.clear();
+			signal( 4u );
+			result &= doCheck( calls == std::vector< uint32_t >{ 40u, 49u }, "disconnections outside emission" );
+		}
+
+		return result;
+	}
+}
+/**
+*\brief
+*	Checks the signal reentrance, then compares the signals connect, emit and disconnect throughputs.
+*\remarks
+*	Usage: Test-SignalBenchmark [<slots count>] [<emissions count>]
+*	The defaults are 64 slots, for 100000 emissions.
+*/
+int main( int argc, char * argv[] )
+{
+	uint32_t slotsCount = argc > 1
+		? uint32_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 64u;
+	uint32_t emitsCount = argc > 2
+		? uint32_t( std::strtoul( argv[2], nullptr, 10 ) )
+		: 100000u;
+
+	if ( !slotsCount || !emitsCount )
+	{
+		std::cerr << "Usage: Test-SignalBenchmark [<slots count>] [<emissions count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if ( !doCheckReentrance() )
+	{
+		return EXIT_FAILURE;
+	}
+
+	uint32_t legacySum = 0u;
+	uint32_t sum = 0u;
+	double legacyTimes[3];
+	double times[3];
+	{
+		LegacySignal signal;
+		std::vector< uint32_t > connections( slotsCount );
+		legacyTimes[0] = doMeasure( [&]()
+			{
+				for ( auto & connection : connections )
+				{
+					connection = signal.connect( [&legacySum]( uint32_t value )
+						{
+							legacySum += value;
+						} );
+				}
+			} );
+		legacyTimes[1] = doMeasure( [&]()
+			{
+				for ( uint32_t index = 0u; index < emitsCount; ++index )
+				{
+					signal( index & 0xFFu );
+				}
+			} );
+		legacyTimes[2] = doMeasure( [&]()
+			{
+				for ( auto & connection : connections )
+				{
+					signal.disconnect( connection );
+				}
+			} );
+	}
+	{
+		Signal signal;
+		std::vector< Connection > connections( slotsCount );
+		times[0] = doMeasure( [&]()
+			{
+				for ( auto & connection : connections )
+				{
+					connection = signal.connect( [&sum]( uint32_t value )
+						{
+							sum += value;
+						} );
+				}
+			} );
+		times[1] = doMeasure( [&]()
+			{
+				for ( uint32_t index = 0u; index < emitsCount; ++index )
+				{
+					signal( index & 0xFFu );
+				}
+			} );
+		times[2] = doMeasure( [&]()
+			{
+				for ( auto & connection : connections )
+				{
+					connection.disconnect();
+				}
+			} );
+	}
+
+	auto calls = double( slotsCount ) * emitsCount;
+	std::cout << "Legacy signal: connect " << legacyTimes[0] * 1.0e9 / slotsCount << " ns, "
+		<< "emit " << legacyTimes[1] * 1.0e9 / calls << " ns per call, "
+		<< "disconnect " << legacyTimes[2] * 1.0e9 / slotsCount << " ns" << std::endl;
+	std::cout << "Contiguous signal: connect " << times[0] * 1.0e9 / slotsCount << " ns, "
+		<< "emit " << times[1] * 1.0e9 / calls << " ns per call, "
+		<< "disconnect " << times[2] * 1.0e9 / slotsCount << " ns" << std::endl;
+
+	if ( legacySum != sum )
+	{
+		std::cerr << "The signals results differ" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
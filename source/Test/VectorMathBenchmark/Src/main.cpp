@@ -0,0 +1,213 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <VectorMath.hpp>
+
+#include <Utils/Vec4.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using ArrayFunction = void( * )( float const *, float *, size_t );
+	using ScalarFunction = float( * )( float );
+	using VectorFunction = utils::Vec4( * )( utils::Vec4 const & );
+
+	struct Kernel
+	{
+		char const * name;
+		ArrayFunction array;
+		VectorFunction vector;
+		ScalarFunction reference;
+		float low;
+		float high;
+		//! The maximal error documented in VectorMath.hpp, in ULP.
+		double maxUlps;
+	};
+
+	template< typename FuncT >
+	double doMeasure( FuncT function )
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >( end - begin ).count();
+	}
+	/**
+	*\brief
+	*	The distance in ULP between a result and the reference computed in double precision.
+	*/
+	double doGetUlps( float value
+		, double reference )
+	{
+		if ( std::isnan( reference ) )
+		{
+			return std::isnan( value ) ? 0.0 : 1.0e9;
+		}
+
+		auto const exact = float( reference );
+		auto const ulp = std::nextafter( std::abs( exact ), INFINITY ) - std::abs( exact );
+		return std::abs( double( value ) - reference ) / double( ulp );
+	}
+
+	double doGetReference( char const * name
+		, float value )
+	{
+		if ( !std::strcmp( name, "sqrt" ) )
+		{
+			return std::sqrt( double( value ) );
+		}
+
+		if ( !std::strcmp( name, "inverseSqrt" ) )
+		{
+			return 1.0 / std::sqrt( double( value ) );
+		}
+
+		if ( !std::strcmp( name, "sin" ) )
+		{
+			return std::sin( double( value ) );
+		}
+
+		if ( !std::strcmp( name, "cos" ) )
+		{
+			return std::cos( double( value ) );
+		}
+
+		if ( !std::strcmp( name, "exp" ) )
+		{
+			return std::exp( double( value ) );
+		}
+
+		return std::log( double( value ) );
+	}
+
+	bool doBenchmark( Kernel const & kernel
+		, size_t count )
+	{
+		std::mt19937 engine{ 42u };
+		std::uniform_real_distribution< float > distribution{ kernel.low, kernel.high };
+		std::vector< float > values( count );
+		std::vector< float > result( count );
+		std::vector< float > reference( count );
+
+		for ( auto & value : values )
+		{
+			value = distribution( engine );
+		}
+
+		auto arrayTime = doMeasure( [&]()
+			{
+				kernel.array( values.data(), result.data(), count );
+			} );
+		auto referenceTime = doMeasure( [&]()
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					reference[index] = kernel.reference( values[index] );
+				}
+			} );
+		double maxUlps = 0.0;
+		bool same = true;
+
+		for ( size_t index = 0u; index < count; ++index )
+		{
+			auto exact = doGetReference( kernel.name, values[index] );
+			// Under 0.5, sin and cos are bounded in absolute error.
+			if ( ( !std::strcmp( kernel.name, "sin" ) || !std::strcmp( kernel.name, "cos" ) )
+				&& std::abs( exact ) < 0.5 )
+			{
+				if ( std::abs( double( result[index] ) - exact ) > 5.0e-8 )
+				{
+					maxUlps = 1.0e9;
+				}
+
+				continue;
+			}
+
+			maxUlps = std::max( maxUlps, doGetUlps( result[index], exact ) );
+		}
+
+		// The Vec4 versions must give the same results as the array ones.
+		double vectorTime = doMeasure( [&]()
+			{
+				for ( size_t index = 0u; index + 4u <= count; index += 4u )
+				{
+					utils::Vec4 value{ values[index], values[index + 1u], values[index + 2u], values[index + 3u] };
+					auto computed = kernel.vector( value );
+					std::memcpy( &reference[index], &computed[0], 4u * sizeof( float ) );
+				}
+			} );
+
+		for ( size_t index = 0u; index < count - count % 4u; ++index )
+		{
+			same &= std::memcmp( &reference[index], &result[index], sizeof( float ) ) == 0;
+		}
+
+		std::cout << kernel.name
+			<< ": array " << arrayTime * 1.0e9 / count << " ns"
+			<< ", Vec4 " << vectorTime * 1.0e9 / count << " ns"
+			<< ", std " << referenceTime * 1.0e9 / count << " ns"
+			<< ", max error " << maxUlps << " ULP" << std::endl;
+
+		if ( maxUlps > kernel.maxUlps )
+		{
+			std::cerr << kernel.name << ": the error exceeds the documented bound (" << kernel.maxUlps << " ULP)" << std::endl;
+			return false;
+		}
+
+		if ( !same )
+		{
+			std::cerr << kernel.name << ": the Vec4 and array results differ" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+}
+/**
+*\brief
+*	Compares the VectorMath.hpp vectorised functions with the standard library ones, in time and accuracy.
+*\remarks
+*	Usage: Test-VectorMathBenchmark [<values count>]
+*	The values count defaults to 4 millions.
+*/
+int main( int argc, char * argv[] )
+{
+	size_t count = argc > 1
+		? size_t( std::strtoul( argv[1], nullptr, 10 ) )
+		: 4u * 1024u * 1024u;
+
+	if ( !count )
+	{
+		std::cerr << "Usage: Test-VectorMathBenchmark [<values count>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Kernel const kernels[]
+	{
+		{ "sqrt", &utils::sqrt, &utils::sqrt, []( float v ){ return std::sqrt( v ); }, 0.0f, 1.0e6f, 0.5 },
+		{ "inverseSqrt", &utils::inverseSqrt, &utils::inverseSqrt, []( float v ){ return 1.0f / std::sqrt( v ); }, 1.0e-6f, 1.0e6f, 1.5 },
+		{ "sin", &utils::sin, &utils::sin, []( float v ){ return std::sin( v ); }, -8192.0f, 8192.0f, 1.5 },
+		{ "cos", &utils::cos, &utils::cos, []( float v ){ return std::cos( v ); }, -8192.0f, 8192.0f, 1.5 },
+		{ "exp", &utils::exp, &utils::exp, []( float v ){ return std::exp( v ); }, -87.3f, 88.3f, 1.0 },
+		{ "log", &utils::log, &utils::log, []( float v ){ return std::log( v ); }, 1.0e-30f, 1.0e30f, 1.0 },
+	};
+	bool result = true;
+
+	for ( auto & kernel : kernels )
+	{
+		result &= doBenchmark( kernel, count );
+	}
+
+	return result
+		? EXIT_SUCCESS
+		: EXIT_FAILURE;
+}
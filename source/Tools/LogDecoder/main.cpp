@@ -0,0 +1,58 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <Miscellaneous/Log.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+/**
+*\brief
+*	Converts a binary log dump, written by renderer::Logger::setDumpFile, to text.
+*\remarks
+*	Usage: LogDecoder <dump file> [<output file>]
+*	The text is written to the standard output when no output file is given.
+*/
+int main( int argc, char * argv[] )
+{
+	if ( argc < 2 )
+	{
+		std::cerr << "Usage: LogDecoder <dump file> [<output file>]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::ifstream input{ argv[1], std::ios::binary };
+
+	if ( !input )
+	{
+		std::cerr << "Couldn't open " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::ofstream file;
+
+	if ( argc > 2 )
+	{
+		file.open( argv[2] );
+
+		if ( !file )
+		{
+			std::cerr << "Couldn't open " << argv[2] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::ostream & output = argc > 2
+		? static_cast< std::ostream & >( file )
+		: std::cout;
+
+	if ( !renderer::Logger::decodeDump( input, output ) )
+	{
+		std::cerr << "Invalid or truncated dump " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include "BlockCompression.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace baker
+{
+	namespace
+	{
+		using Block = uint8_t[64];
+
+		void doExtractBlock( Level const & level
+			, uint32_t blockX
+			, uint32_t blockY
+			, Block & block )
+		{
+			for ( uint32_t y = 0u; y < 4u; ++y )
+			{
+				auto srcY = std::min( blockY * 4u + y, level.height - 1u );
+
+				for ( uint32_t x = 0u; x < 4u; ++x )
+				{
+					auto srcX = std::min( blockX * 4u + x, level.width - 1u );
+					auto src = &level.data[( size_t( srcY ) * level.width + srcX ) * 4u];
+					std::copy( src, src + 4u, &block[( y * 4u + x ) * 4u] );
+				}
+			}
+		}
+
+		uint16_t doPack565( uint8_t const * colour )
+		{
+			return uint16_t( ( ( colour[0] >> 3 ) << 11 )
+				| ( ( colour[1] >> 2 ) << 5 )
+				| ( colour[2] >> 3 ) );
+		}
+
+		void doUnpack565( uint16_t value
+			, int * colour )
+		{
+			auto r = ( value >> 11 ) & 0x1F;
+			auto g = ( value >> 5 ) & 0x3F;
+			auto b = value & 0x1F;
+			colour[0] = ( r << 3 ) | ( r >> 2 );
+			colour[1] = ( g << 2 ) | ( g >> 4 );
+			colour[2] = ( b << 3 ) | ( b >> 2 );
+		}
+
+		void doWrite16( uint8_t *& out
+			, uint16_t value )
+		{
+			*out++ = uint8_t( value & 0xFF );
+			*out++ = uint8_t( value >> 8 );
+		}
+
+		void doEncodeColour( Block const & block
+			, uint8_t *& out )
+		{
+			uint8_t min[3]{ 255u, 255u, 255u };
+			uint8_t max[3]{ 0u, 0u, 0u };
+
+			for ( uint32_t i = 0u; i < 16u; ++i )
+			{
+				for ( uint32_t c = 0u; c < 3u; ++c )
+				{
+					min[c] = std::min( min[c], block[i * 4u + c] );
+					max[c] = std::max( max[c], block[i * 4u + c] );
+				}
+			}
+
+			for ( uint32_t c = 0u; c < 3u; ++c )
+			{
+				auto inset = uint8_t( ( max[c] - min[c] ) >> 4 );
+				min[c] = uint8_t( min[c] + inset );
+				max[c] = uint8_t( max[c] - inset );
+			}
+
+			auto colour0 = doPack565( max );
+			auto colour1 = doPack565( min );
+
+			// colour0 > colour1 selects the 4 colours mode, for BC1.
+			if ( colour0 < colour1 )
+			{
+				std::swap( colour0, colour1 );
+			}
+
+			int palette[4][3];
+			doUnpack565( colour0, palette[0] );
+			doUnpack565( colour1, palette[1] );
+
+			for ( uint32_t c = 0u; c < 3u; ++c )
+			{
+				palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+				palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+			}
+
+			uint32_t indices{ 0u };
+
+			if ( colour0 != colour1 )
+			{
+				for ( uint32_t i = 0u; i < 16u; ++i )
+				{
+					uint32_t best{ 0u };
+					int bestDistance{ std::numeric_limits< int >::max() };
+
+					for ( uint32_t p = 0u; p < 4u; ++p )
+					{
+						int distance{ 0 };
+
+						for ( uint32_t c = 0u; c < 3u; ++c )
+						{
+							auto diff = int( block[i * 4u + c] ) - palette[p][c];
+							distance += diff * diff;
+						}
+
+						if ( distance < bestDistance )
+						{
+							bestDistance = distance;
+							best = p;
+						}
+					}
+
+					indices |= best << ( i * 2u );
+				}
+			}
+
+			doWrite16( out, colour0 );
+			doWrite16( out, colour1 );
+			doWrite16( out, uint16_t( indices & 0xFFFF ) );
+			doWrite16( out, uint16_t( indices >> 16 ) );
+		}
+
+		void doEncodeAlpha( Block const & block
+			, uint8_t *& out )
+		{
+			int alpha0{ 0 };
+			int alpha1{ 255 };
+
+			for ( uint32_t i = 0u; i < 16u; ++i )
+			{
+				alpha0 = std::max( alpha0, int( block[i * 4u + 3u] ) );
+				alpha1 = std::min( alpha1, int( block[i * 4u + 3u] ) );
+			}
+
+			// alpha0 > alpha1 selects the 8 alphas mode.
+			int palette[8]{ alpha0, alpha1 };
+
+			for ( int p = 2; p < 8; ++p )
+			{
+				palette[p] = ( ( 8 - p ) * alpha0 + ( p - 1 ) * alpha1 ) / 7;
+			}
+
+			uint64_t indices{ 0u };
+
+			if ( alpha0 != alpha1 )
+			{
+				for ( uint32_t i = 0u; i < 16u; ++i )
+				{
+					uint64_t best{ 0u };
+					int bestDistance{ 256 };
+
+					for ( uint32_t p = 0u; p < 8u; ++p )
+					{
+						auto distance = std::abs( int( block[i * 4u + 3u] ) - palette[p] );
+
+						if ( distance < bestDistance )
+						{
+							bestDistance = distance;
+							best = p;
+						}
+					}
+
+					indices |= best << ( i * 3u );
+				}
+			}
+
+			*out++ = uint8_t( alpha0 );
+			*out++ = uint8_t( alpha1 );
+
+			for ( uint32_t i = 0u; i < 6u; ++i )
+			{
+				*out++ = uint8_t( ( indices >> ( i * 8u ) ) & 0xFF );
+			}
+		}
+
+		template< typename EncoderT >
+		std::vector< uint8_t > doCompress( Level const & level
+			, size_t blockSize
+			, EncoderT encoder )
+		{
+			uint32_t blocksX = ( level.width + 3u ) / 4u;
+			uint32_t blocksY = ( level.height + 3u ) / 4u;
+			std::vector< uint8_t > result( size_t( blocksX ) * blocksY * blockSize );
+			auto out = result.data();
+			Block block;
+
+			for ( uint32_t y = 0u; y < blocksY; ++y )
+			{
+				for ( uint32_t x = 0u; x < blocksX; ++x )
+				{
+					doExtractBlock( level, x, y, block );
+					encoder( block, out );
+				}
+			}
+
+			return result;
+		}
+	}
+
+	Level generateMip( Level const & level )
+	{
+		Level result;
+		result.width = std::max( 1u, level.width / 2u );
+		result.height = std::max( 1u, level.height / 2u );
+		result.data.resize( size_t( result.width ) * result.height * 4u );
+		auto dst = result.data.data();
+
+		for ( uint32_t y = 0u; y < result.height; ++y )
+		{
+			auto y0 = std::min( y * 2u, level.height - 1u );
+			auto y1 = std::min( y * 2u + 1u, level.height - 1u );
+
+			for ( uint32_t x = 0u; x < result.width; ++x )
+			{
+				auto x0 = std::min( x * 2u, level.width - 1u );
+				auto x1 = std::min( x * 2u + 1u, level.width - 1u );
+				auto t00 = &level.data[( size_t( y0 ) * level.width + x0 ) * 4u];
+				auto t01 = &level.data[( size_t( y0 ) * level.width + x1 ) * 4u];
+				auto t10 = &level.data[( size_t( y1 ) * level.width + x0 ) * 4u];
+				auto t11 = &level.data[( size_t( y1 ) * level.width + x1 ) * 4u];
+
+				for ( uint32_t c = 0u; c < 4u; ++c )
+				{
+					*dst++ = uint8_t( ( t00[c] + t01[c] + t10[c] + t11[c] + 2u ) / 4u );
+				}
+			}
+		}
+
+		return result;
+	}
+
+	std::vector< uint8_t > compressBC1( Level const & level )
+	{
+		return doCompress( level
+			, 8u
+			, []( Block const & block, uint8_t *& out )
+			{
+				doEncodeColour( block, out );
+			} );
+	}
+
+	std::vector< uint8_t > compressBC3( Level const & level )
+	{
+		return doCompress( level
+			, 16u
+			, []( Block const & block, uint8_t *& out )
+			{
+				doEncodeAlpha( block, out );
+				doEncodeColour( block, out );
+			} );
+	}
+}
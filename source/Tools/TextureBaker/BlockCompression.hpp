@@ -0,0 +1,40 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace baker
+{
+	/**
+	*\brief
+	*	An RGBA8 image, without row padding.
+	*/
+	struct Level
+	{
+		uint32_t width;
+		uint32_t height;
+		std::vector< uint8_t > data;
+	};
+	/**
+	*\brief
+	*	Computes the next mip level, with a 2x2 box filter.
+	*\remarks
+	*	The odd dimensions are halved by rounding down, the last row or column being reused.
+	*/
+	Level generateMip( Level const & level );
+	/**
+	*\brief
+	*	Compresses an RGBA8 level to BC1 (RGB, 8 bytes per 4x4 block) or BC3 (RGBA, 16 bytes per 4x4 block).
+	*\remarks
+	*	Each block's endpoints are its colour bounding box, inset by 1/16th, and each texel uses the nearest palette entry.
+	*	This is fast, but of a lower quality than the exhaustive search of dedicated compressors.
+	*	The blocks overlapping the level's borders repeat the last row and column.
+	*/
+	std::vector< uint8_t > compressBC1( Level const & level );
+	std::vector< uint8_t > compressBC3( Level const & level );
+}
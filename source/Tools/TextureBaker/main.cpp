@@ -0,0 +1,231 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include "BlockCompression.hpp"
+
+#include <wx/image.h>
+#include <wx/init.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	// KTX 1.1 container, as read by common::loadImage.
+	uint8_t const KtxIdentifier[12]
+	{
+		0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+	};
+	uint32_t constexpr KtxEndianness = 0x04030201u;
+	uint32_t constexpr GlUnsignedByte = 0x1401u;
+	uint32_t constexpr GlRGB = 0x1907u;
+	uint32_t constexpr GlRGBA = 0x1908u;
+	uint32_t constexpr GlRGBA8 = 0x8058u;
+	uint32_t constexpr GlCompressedRgbS3tcDxt1 = 0x83F0u;
+	uint32_t constexpr GlCompressedRgbaS3tcDxt5 = 0x83F3u;
+	char const KtxOpacityKey[] = "RendererLib.opacity";
+
+	struct KtxHeader
+	{
+		uint8_t identifier[12];
+		uint32_t endianness;
+		uint32_t glType;
+		uint32_t glTypeSize;
+		uint32_t glFormat;
+		uint32_t glInternalFormat;
+		uint32_t glBaseInternalFormat;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t numberOfArrayElements;
+		uint32_t numberOfFaces;
+		uint32_t numberOfMipmapLevels;
+		uint32_t bytesOfKeyValueData;
+	};
+
+	void doWriteUInt32( std::ostream & stream
+		, uint32_t value )
+	{
+		stream.write( reinterpret_cast< char const * >( &value ), sizeof( value ) );
+	}
+
+	bool doLoadSource( std::string const & path
+		, baker::Level & level
+		, bool & opacity )
+	{
+		wxImage image;
+
+		if ( !image.LoadFile( wxString( path ) ) )
+		{
+			return false;
+		}
+
+		level.width = uint32_t( image.GetWidth() );
+		level.height = uint32_t( image.GetHeight() );
+		level.data.resize( size_t( level.width ) * level.height * 4u );
+		opacity = image.HasAlpha();
+		uint8_t const * rgb = image.GetData();
+		uint8_t const * alpha = image.GetAlpha();
+		auto it = level.data.begin();
+
+		for ( size_t i = 0u; i < size_t( level.width ) * level.height; ++i )
+		{
+			*it++ = *rgb++;
+			*it++ = *rgb++;
+			*it++ = *rgb++;
+			*it++ = alpha ? *alpha++ : 0xFF;
+		}
+
+		return true;
+	}
+
+	bool doBake( std::string const & input
+		, std::string const & output
+		, bool compress )
+	{
+		baker::Level level;
+		bool opacity;
+
+		if ( !doLoadSource( input, level, opacity ) )
+		{
+			std::cerr << "Couldn't load " << input << std::endl;
+			return false;
+		}
+
+		std::ofstream file{ output, std::ios::binary };
+
+		if ( !file )
+		{
+			std::cerr << "Couldn't open " << output << std::endl;
+			return false;
+		}
+
+		uint32_t levels = 1u;
+
+		for ( auto size = std::max( level.width, level.height ); size > 1u; size /= 2u )
+		{
+			++levels;
+		}
+
+		// The key and its null terminator, then the value and its null terminator, padded to 4 bytes.
+		uint32_t keyValueSize = uint32_t( sizeof( KtxOpacityKey ) + 2u );
+		uint32_t keyValuePadding = ( 4u - keyValueSize % 4u ) % 4u;
+		KtxHeader header{};
+		std::memcpy( header.identifier, KtxIdentifier, sizeof( KtxIdentifier ) );
+		header.endianness = KtxEndianness;
+		header.glTypeSize = 1u;
+		header.pixelWidth = level.width;
+		header.pixelHeight = level.height;
+		header.numberOfFaces = 1u;
+		header.numberOfMipmapLevels = levels;
+		header.bytesOfKeyValueData = uint32_t( sizeof( uint32_t ) ) + keyValueSize + keyValuePadding;
+
+		if ( !compress )
+		{
+			header.glType = GlUnsignedByte;
+			header.glFormat = GlRGBA;
+			header.glInternalFormat = GlRGBA8;
+			header.glBaseInternalFormat = GlRGBA;
+		}
+		else if ( opacity )
+		{
+			header.glInternalFormat = GlCompressedRgbaS3tcDxt5;
+			header.glBaseInternalFormat = GlRGBA;
+		}
+		else
+		{
+			header.glInternalFormat = GlCompressedRgbS3tcDxt1;
+			header.glBaseInternalFormat = GlRGB;
+		}
+
+		file.write( reinterpret_cast< char const * >( &header ), sizeof( header ) );
+		doWriteUInt32( file, keyValueSize );
+		file.write( KtxOpacityKey, sizeof( KtxOpacityKey ) );
+		file.write( opacity ? "1" : "0", 2u );
+		file.write( "\0\0\0", keyValuePadding );
+
+		for ( uint32_t index = 0u; index < levels; ++index )
+		{
+			if ( index )
+			{
+				level = baker::generateMip( level );
+			}
+
+			auto data = !compress
+				? level.data
+				: ( opacity
+					? baker::compressBC3( level )
+					: baker::compressBC1( level ) );
+			// All the levels sizes are multiples of 4, so no mip padding is needed.
+			doWriteUInt32( file, uint32_t( data.size() ) );
+			file.write( reinterpret_cast< char const * >( data.data() ), std::streamsize( data.size() ) );
+		}
+
+		if ( !file )
+		{
+			std::cerr << "Couldn't write " << output << std::endl;
+			return false;
+		}
+
+		std::cout << input << " -> " << output
+			<< " (" << header.pixelWidth << "x" << header.pixelHeight << ", " << levels << " levels)" << std::endl;
+		return true;
+	}
+}
+
+/**
+*\brief
+*	Bakes source images (PNG, JPG, TGA, ...) to KTX files, with all their mip levels precomputed.
+*\remarks
+*	Usage: TextureBaker [--bc] <image>...
+*	Each image is written next to its source, with the .ktx extension.
+*	With --bc, the levels are compressed to BC1 (opaque images) or BC3 (images with alpha).
+*	The samples load the .ktx files instead of their sources when they exist,
+*	by memory mapping them, and uploading the levels without decoding them.
+*/
+int main( int argc, char * argv[] )
+{
+	bool compress = false;
+	int first = 1;
+
+	if ( argc > 1 && std::string{ argv[1] } == "--bc" )
+	{
+		compress = true;
+		++first;
+	}
+
+	if ( first >= argc )
+	{
+		std::cerr << "Usage: TextureBaker [--bc] <image>..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	wxInitializer initializer;
+
+	if ( !initializer )
+	{
+		std::cerr << "Couldn't initialise wxWidgets" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	wxInitAllImageHandlers();
+	int result = EXIT_SUCCESS;
+
+	for ( int i = first; i < argc; ++i )
+	{
+		std::string input{ argv[i] };
+		auto output = input.substr( 0u, input.find_last_of( '.' ) ) + ".ktx";
+
+		if ( !doBake( input, output, compress ) )
+		{
+			result = EXIT_FAILURE;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,458 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#pragma once
+
+#include "UtilsPrerequisites.hpp"
+
+#include <Utils/Mat4.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace utils
+{
+	/**
+	*\brief
+	*	Opérations sur des paquets de flottants, permettant d'écrire un noyau de calcul une seule fois,
+	*	pour les registres SIMD et pour le scalaire (utilisé pour les éléments restants).
+	*\remarks
+	*	Le jeu d'instructions est celui sélectionné par Utils/Mat4Simd.inl.
+	*	Les masques sont des flottants dont tous les bits sont à 1 (vrai) ou à 0 (faux).
+	*/
+	template< typename PackT >
+	struct Lanes;
+	/**
+	*\brief
+	*	Spécialisation scalaire.
+	*/
+	template<>
+	struct Lanes< float >
+	{
+		using Int = int32_t;
+		static size_t constexpr count = 1u;
+
+		static inline float load( float const * data )
+		{
+			return *data;
+		}
+
+		static inline void store( float * data, float value )
+		{
+			*data = value;
+		}
+
+		static inline float set( float value )
+		{
+			return value;
+		}
+
+		// Same operands order as minps/maxps, for identical results with NaNs and signed zeros.
+		static inline float min( float lhs, float rhs )
+		{
+			return lhs < rhs ? lhs : rhs;
+		}
+
+		static inline float max( float lhs, float rhs )
+		{
+			return lhs > rhs ? lhs : rhs;
+		}
+
+		static inline float sqrt( float value )
+		{
+			return std::sqrt( value );
+		}
+
+		static inline Int castToInt( float value )
+		{
+			Int result;
+			std::memcpy( &result, &value, sizeof( result ) );
+			return result;
+		}
+
+		static inline float castToFloat( Int value )
+		{
+			float result;
+			std::memcpy( &result, &value, sizeof( result ) );
+			return result;
+		}
+
+		// Out of range values give INT32_MIN, like cvttps2dq.
+		static inline Int truncate( float value )
+		{
+			return ( value >= -2147483648.0f && value < 2147483648.0f )
+				? Int( value )
+				: std::numeric_limits< Int >::min();
+		}
+
+		static inline float toFloat( Int value )
+		{
+			return float( value );
+		}
+
+		static inline Int setInt( Int value )
+		{
+			return value;
+		}
+
+		static inline Int addInt( Int lhs, Int rhs )
+		{
+			return lhs + rhs;
+		}
+
+		static inline Int subInt( Int lhs, Int rhs )
+		{
+			return lhs - rhs;
+		}
+
+		static inline Int andInt( Int lhs, Int rhs )
+		{
+			return lhs & rhs;
+		}
+
+		static inline Int andNotInt( Int lhs, Int rhs )
+		{
+			return ~lhs & rhs;
+		}
+
+		static inline Int equalInt( Int lhs, Int rhs )
+		{
+			return lhs == rhs ? ~Int{ 0 } : Int{ 0 };
+		}
+
+		template< int Count >
+		static inline Int shiftLeft( Int value )
+		{
+			return Int( uint32_t( value ) << Count );
+		}
+
+		template< int Count >
+		static inline Int shiftRight( Int value )
+		{
+			return Int( uint32_t( value ) >> Count );
+		}
+
+		static inline float bitAnd( float lhs, float rhs )
+		{
+			return castToFloat( castToInt( lhs ) & castToInt( rhs ) );
+		}
+
+		static inline float bitAndNot( float lhs, float rhs )
+		{
+			return castToFloat( ~castToInt( lhs ) & castToInt( rhs ) );
+		}
+
+		static inline float bitOr( float lhs, float rhs )
+		{
+			return castToFloat( castToInt( lhs ) | castToInt( rhs ) );
+		}
+
+		static inline float bitXor( float lhs, float rhs )
+		{
+			return castToFloat( castToInt( lhs ) ^ castToInt( rhs ) );
+		}
+
+		static inline float less( float lhs, float rhs )
+		{
+			return castToFloat( lhs < rhs ? ~Int{ 0 } : Int{ 0 } );
+		}
+
+		static inline float lessEqual( float lhs, float rhs )
+		{
+			return castToFloat( lhs <= rhs ? ~Int{ 0 } : Int{ 0 } );
+		}
+
+		static inline float equal( float lhs, float rhs )
+		{
+			return castToFloat( lhs == rhs ? ~Int{ 0 } : Int{ 0 } );
+		}
+	};
+
+#if defined( RENDERLIB_SIMD_SSE2 )
+	/**
+	*\brief
+	*	Paquet de 4 flottants.
+	*/
+	struct Float4
+	{
+		__m128 value;
+	};
+
+	inline Float4 operator+( Float4 lhs, Float4 rhs )
+	{
+		return { _mm_add_ps( lhs.value, rhs.value ) };
+	}
+
+	inline Float4 operator-( Float4 lhs, Float4 rhs )
+	{
+		return { _mm_sub_ps( lhs.value, rhs.value ) };
+	}
+
+	inline Float4 operator*( Float4 lhs, Float4 rhs )
+	{
+		return { _mm_mul_ps( lhs.value, rhs.value ) };
+	}
+
+	inline Float4 operator/( Float4 lhs, Float4 rhs )
+	{
+		return { _mm_div_ps( lhs.value, rhs.value ) };
+	}
+	/**
+	*\brief
+	*	Spécialisation pour les paquets de 4 flottants.
+	*/
+	template<>
+	struct Lanes< Float4 >
+	{
+		struct Int
+		{
+			__m128i value;
+		};
+		static size_t constexpr count = 4u;
+
+		static inline Float4 load( float const * data )
+		{
+			return { _mm_loadu_ps( data ) };
+		}
+
+		static inline void store( float * data, Float4 value )
+		{
+			_mm_storeu_ps( data, value.value );
+		}
+
+		static inline Float4 set( float value )
+		{
+			return { _mm_set1_ps( value ) };
+		}
+
+		static inline Float4 min( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_min_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 max( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_max_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 sqrt( Float4 value )
+		{
+			return { _mm_sqrt_ps( value.value ) };
+		}
+
+		static inline Int castToInt( Float4 value )
+		{
+			return { _mm_castps_si128( value.value ) };
+		}
+
+		static inline Float4 castToFloat( Int value )
+		{
+			return { _mm_castsi128_ps( value.value ) };
+		}
+
+		static inline Int truncate( Float4 value )
+		{
+			return { _mm_cvttps_epi32( value.value ) };
+		}
+
+		static inline Float4 toFloat( Int value )
+		{
+			return { _mm_cvtepi32_ps( value.value ) };
+		}
+
+		static inline Int setInt( int32_t value )
+		{
+			return { _mm_set1_epi32( value ) };
+		}
+
+		static inline Int addInt( Int lhs, Int rhs )
+		{
+			return { _mm_add_epi32( lhs.value, rhs.value ) };
+		}
+
+		static inline Int subInt( Int lhs, Int rhs )
+		{
+			return { _mm_sub_epi32( lhs.value, rhs.value ) };
+		}
+
+		static inline Int andInt( Int lhs, Int rhs )
+		{
+			return { _mm_and_si128( lhs.value, rhs.value ) };
+		}
+
+		static inline Int andNotInt( Int lhs, Int rhs )
+		{
+			return { _mm_andnot_si128( lhs.value, rhs.value ) };
+		}
+
+		static inline Int equalInt( Int lhs, Int rhs )
+		{
+			return { _mm_cmpeq_epi32( lhs.value, rhs.value ) };
+		}
+
+		template< int Count >
+		static inline Int shiftLeft( Int value )
+		{
+			return { _mm_slli_epi32( value.value, Count ) };
+		}
+
+		template< int Count >
+		static inline Int shiftRight( Int value )
+		{
+			return { _mm_srli_epi32( value.value, Count ) };
+		}
+
+		static inline Float4 bitAnd( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_and_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 bitAndNot( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_andnot_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 bitOr( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_or_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 bitXor( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_xor_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 less( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_cmplt_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 lessEqual( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_cmple_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float4 equal( Float4 lhs, Float4 rhs )
+		{
+			return { _mm_cmpeq_ps( lhs.value, rhs.value ) };
+		}
+	};
+
+#endif
+#if defined( RENDERLIB_SIMD_AVX )
+	/**
+	*\brief
+	*	Paquet de 8 flottants.
+	*\remarks
+	*	AVX n'ayant pas d'opérations entières sur 256 bits, seules les opérations arithmétiques sont disponibles.
+	*/
+	struct Float8
+	{
+		__m256 value;
+	};
+
+	inline Float8 operator+( Float8 lhs, Float8 rhs )
+	{
+		return { _mm256_add_ps( lhs.value, rhs.value ) };
+	}
+
+	inline Float8 operator-( Float8 lhs, Float8 rhs )
+	{
+		return { _mm256_sub_ps( lhs.value, rhs.value ) };
+	}
+
+	inline Float8 operator*( Float8 lhs, Float8 rhs )
+	{
+		return { _mm256_mul_ps( lhs.value, rhs.value ) };
+	}
+
+	inline Float8 operator/( Float8 lhs, Float8 rhs )
+	{
+		return { _mm256_div_ps( lhs.value, rhs.value ) };
+	}
+	/**
+	*\brief
+	*	Spécialisation pour les paquets de 8 flottants.
+	*/
+	template<>
+	struct Lanes< Float8 >
+	{
+		static size_t constexpr count = 8u;
+
+		static inline Float8 load( float const * data )
+		{
+			return { _mm256_loadu_ps( data ) };
+		}
+
+		static inline void store( float * data, Float8 value )
+		{
+			_mm256_storeu_ps( data, value.value );
+		}
+
+		static inline Float8 set( float value )
+		{
+			return { _mm256_set1_ps( value ) };
+		}
+
+		static inline Float8 min( Float8 lhs, Float8 rhs )
+		{
+			return { _mm256_min_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float8 max( Float8 lhs, Float8 rhs )
+		{
+			return { _mm256_max_ps( lhs.value, rhs.value ) };
+		}
+
+		static inline Float8 sqrt( Float8 value )
+		{
+			return { _mm256_sqrt_ps( value.value ) };
+		}
+	};
+
+#endif
+	/**
+	*\name Paquets les plus larges disponibles.
+	*/
+	/**\{*/
+	//! Pour les noyaux purement arithmétiques.
+#if defined( RENDERLIB_SIMD_AVX )
+	using ArithmeticPack = Float8;
+#elif defined( RENDERLIB_SIMD_SSE2 )
+	using ArithmeticPack = Float4;
+#else
+	using ArithmeticPack = float;
+#endif
+	//! Pour les noyaux utilisant aussi les opérations binaires et entières.
+#if defined( RENDERLIB_SIMD_SSE2 )
+	using FloatPack = Float4;
+#else
+	using FloatPack = float;
+#endif
+	/**\}*/
+	/**
+	*\brief
+	*	Applique un noyau sur [begin, end), par paquets puis un par un pour le reste.
+	*\param[in] function
+	*	Le noyau, appelé avec un paquet (pour en déduire le type) et l'indice du premier élément.
+	*/
+	template< typename PackT, typename FuncT >
+	inline void forEachPack( size_t begin
+		, size_t end
+		, FuncT function )
+	{
+		size_t index = begin;
+
+		for ( ; index + Lanes< PackT >::count <= end; index += Lanes< PackT >::count )
+		{
+			function( PackT{}, index );
+		}
+
+		for ( ; index < end; ++index )
+		{
+			function( float{}, index );
+		}
+	}
+}
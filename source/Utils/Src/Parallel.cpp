@@ -0,0 +1,192 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include "Parallel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace utils
+{
+	namespace details
+	{
+		namespace
+		{
+			/**
+			*\brief
+			*	Un appel à parallelFor, dont les morceaux sont pris un à un par les threads qui y participent.
+			*/
+			struct Job
+			{
+				size_t count;
+				size_t chunk;
+				ChunkFunction invoke;
+				void * function;
+				std::atomic< size_t > next;
+				//! Le nombre de threads du pool travaillant sur ce job, protégé par le mutex du pool.
+				uint32_t users;
+				//! La première exception levée par un morceau, écrite par le seul thread ayant levé failed.
+				std::atomic< bool > failed;
+				std::exception_ptr error;
+
+				bool hasChunks()const
+				{
+					return next.load() < count;
+				}
+				/**
+				*\brief
+				*	Exécute des morceaux tant qu'il en reste.
+				*\remarks
+				*	Ne lève pas d'exception : la première levée par un morceau est conservée, et les morceaux restants abandonnés.
+				*/
+				void run()noexcept
+				{
+					try
+					{
+						for ( auto begin = next.fetch_add( chunk ); begin < count; begin = next.fetch_add( chunk ) )
+						{
+							invoke( function, begin, std::min( begin + chunk, count ) );
+						}
+					}
+					catch ( ... )
+					{
+						next.store( count );
+
+						if ( !failed.exchange( true ) )
+						{
+							error = std::current_exception();
+						}
+					}
+				}
+			};
+			/**
+			*\brief
+			*	Les threads exécutant les morceaux des appels à parallelFor, créés au premier appel et détruits
+			*	à la fin du programme.
+			*\remarks
+			*	Le thread appelant exécute lui aussi les morceaux de son job, et n'attend que ceux déjà pris
+			*	par le pool, les appels imbriqués ou simultanés avancent donc même quand tous les threads sont occupés.
+			*/
+			class ThreadPool
+			{
+			public:
+				ThreadPool()
+				{
+					auto count = std::max( std::thread::hardware_concurrency(), 1u ) - 1u;
+					m_threads.reserve( count );
+
+					for ( auto index = 0u; index < count; ++index )
+					{
+						m_threads.emplace_back( [this]()
+						{
+							doWork();
+						} );
+					}
+				}
+
+				~ThreadPool()
+				{
+					{
+						std::unique_lock< std::mutex > lock( m_mutex );
+						m_stopped = true;
+					}
+
+					m_workAvailable.notify_all();
+
+					for ( auto & thread : m_threads )
+					{
+						thread.join();
+					}
+				}
+
+				void run( Job & job )
+				{
+					{
+						std::unique_lock< std::mutex > lock( m_mutex );
+						m_jobs.push_back( &job );
+					}
+
+					m_workAvailable.notify_all();
+					job.run();
+					std::unique_lock< std::mutex > lock( m_mutex );
+					m_jobs.erase( std::find( m_jobs.begin(), m_jobs.end(), &job ) );
+					m_jobDone.wait( lock, [&job]()
+					{
+						return job.users == 0u;
+					} );
+
+					// Les threads du pool ont fini avec le job, l'exception peut être relancée dans le thread appelant.
+					if ( job.error )
+					{
+						std::rethrow_exception( job.error );
+					}
+				}
+
+			private:
+				Job * doFindJob()const
+				{
+					auto it = std::find_if( m_jobs.begin()
+						, m_jobs.end()
+						, []( Job const * job )
+						{
+							return job->hasChunks();
+						} );
+					return it == m_jobs.end()
+						? nullptr
+						: *it;
+				}
+
+				void doWork()
+				{
+					std::unique_lock< std::mutex > lock( m_mutex );
+
+					while ( true )
+					{
+						Job * job = nullptr;
+						m_workAvailable.wait( lock, [this, &job]()
+						{
+							job = doFindJob();
+							return m_stopped || job;
+						} );
+
+						if ( !job )
+						{
+							return;
+						}
+
+						++job->users;
+						lock.unlock();
+						job->run();
+						lock.lock();
+
+						if ( --job->users == 0u )
+						{
+							m_jobDone.notify_all();
+						}
+					}
+				}
+
+			private:
+				std::vector< std::thread > m_threads;
+				std::vector< Job * > m_jobs;
+				std::mutex m_mutex;
+				std::condition_variable m_workAvailable;
+				std::condition_variable m_jobDone;
+				bool m_stopped{ false };
+			};
+		}
+
+		void runChunks( size_t count
+			, size_t chunk
+			, ChunkFunction invoke
+			, void * function )
+		{
+			static ThreadPool pool;
+			Job job{ count, chunk, invoke, function, { 0u }, 0u, { false }, nullptr };
+			pool.run( job );
+		}
+	}
+}
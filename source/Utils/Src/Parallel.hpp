@@ -0,0 +1,33 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#pragma once
+
+#include "UtilsPrerequisites.hpp"
+
+namespace utils
+{
+	/**
+	*\brief
+	*	Exécute une fonction sur un intervalle d'indices, découpé entre plusieurs threads.
+	*\remarks
+	*	Les morceaux sont exécutés par le thread appelant et par un pool de threads, créé au premier appel,
+	*	le thread appelant attend la fin de tous les morceaux. Les appels imbriqués, ou depuis plusieurs threads,
+	*	sont permis. Si l'intervalle est trop petit pour être découpé, la fonction est exécutée directement.
+	*	Si la fonction lève une exception, les morceaux pas encore commencés sont abandonnés, et la première
+	*	exception est relancée dans le thread appelant une fois les morceaux en cours terminés.
+	*\param[in] count
+	*	Le nombre d'indices.
+	*\param[in] grain
+	*	Le nombre minimal d'indices par thread, les morceaux en sont des multiples.
+	*\param[in] function
+	*	La fonction, appelée avec les bornes [begin, end) de chaque morceau.
+	*/
+	template< typename FuncT >
+	inline void parallelFor( size_t count
+		, size_t grain
+		, FuncT function );
+}
+
+#include "Parallel.inl"
@@ -0,0 +1,61 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <algorithm>
+#include <thread>
+
+namespace utils
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	Appelle la fonction de parallelFor, sans en connaître le type.
+		*/
+		using ChunkFunction = void( * )( void * function, size_t begin, size_t end );
+		/**
+		*\brief
+		*	Répartit les morceaux entre le thread appelant et les threads du pool, et attend leur fin.
+		*/
+		void runChunks( size_t count
+			, size_t chunk
+			, ChunkFunction invoke
+			, void * function );
+
+		template< typename FuncT >
+		inline void invokeChunk( void * function
+			, size_t begin
+			, size_t end )
+		{
+			( *static_cast< FuncT * >( function ) )( begin, end );
+		}
+	}
+
+	template< typename FuncT >
+	inline void parallelFor( size_t count
+		, size_t grain
+		, FuncT function )
+	{
+		grain = std::max< size_t >( grain, 1u );
+		size_t const threads = std::min< size_t >( std::max( std::thread::hardware_concurrency(), 1u )
+			, ( count + grain - 1u ) / grain );
+
+		if ( threads <= 1u )
+		{
+			if ( count )
+			{
+				function( size_t{ 0u }, count );
+			}
+
+			return;
+		}
+
+		size_t chunk = ( count + threads - 1u ) / threads;
+		chunk = ( ( chunk + grain - 1u ) / grain ) * grain;
+		details::runChunks( count
+			, chunk
+			, &details::invokeChunk< FuncT >
+			, &function );
+	}
+}
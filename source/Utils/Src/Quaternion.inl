@@ -6,6 +6,8 @@ See LICENSE file in root folder
 
 #include <Utils/Mat4.hpp>
 
+#include "Vec3.hpp"
+
 namespace utils
 {
 	template< typename T >
@@ -50,9 +52,12 @@ namespace utils
 	template< typename T >
 	QuaternionT< T >::QuaternionT( Vec3T< RadiansT< T > > const & euler )noexcept
 	{
-		Vec3T< T > c{ vectorCall( utils::cos< T >, euler * T{ 0.5 } ) };
-		Vec3T< T > s{ vectorCall( utils::sin< T >, euler * T{ 0.5 } ) };
-		
+		Vec3T< RadiansT< T > > const halfAngles{ euler.x * T{ 0.5 }
+			, euler.y * T{ 0.5 }
+			, euler.z * T{ 0.5 } };
+		Vec3T< T > const c{ cos( halfAngles.x ), cos( halfAngles.y ), cos( halfAngles.z ) };
+		Vec3T< T > const s{ sin( halfAngles.x ), sin( halfAngles.y ), sin( halfAngles.z ) };
+
 		w = c.x * c.y * c.z + s.x * s.y * s.z;
 		x = s.x * c.y * c.z - c.x * s.y * s.z;
 		y = c.x * s.y * c.z + s.x * c.y * s.z;
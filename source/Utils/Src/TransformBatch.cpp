@@ -0,0 +1,363 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include "TransformBatch.hpp"
+
+#include "Lanes.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+
+namespace utils
+{
+	namespace
+	{
+		//! Le nombre minimal d'éléments traités par un thread.
+		static size_t constexpr Grain = 4096u;
+
+		template< typename PackT >
+		void doComposeTransforms( TransformArrays const & transforms
+			, size_t index
+			, renderer::Mat4 * result )
+		{
+			using LanesT = Lanes< PackT >;
+			PackT const one = LanesT::set( 1.0f );
+			PackT const two = LanesT::set( 2.0f );
+
+			PackT const qx = LanesT::load( &transforms.rotateX[index] );
+			PackT const qy = LanesT::load( &transforms.rotateY[index] );
+			PackT const qz = LanesT::load( &transforms.rotateZ[index] );
+			PackT const qw = LanesT::load( &transforms.rotateW[index] );
+			PackT const sx = LanesT::load( &transforms.scaleX[index] );
+			PackT const sy = LanesT::load( &transforms.scaleY[index] );
+			PackT const sz = LanesT::load( &transforms.scaleZ[index] );
+
+			PackT const qxx = qx * qx;
+			PackT const qyy = qy * qy;
+			PackT const qzz = qz * qz;
+			PackT const qxz = qx * qz;
+			PackT const qxy = qx * qy;
+			PackT const qyz = qy * qz;
+			PackT const qwx = qw * qx;
+			PackT const qwy = qw * qy;
+			PackT const qwz = qw * qz;
+
+			// The 3x3 upper left part, column major, the translation is copied as is.
+			float entries[9][LanesT::count];
+			LanesT::store( entries[0], ( one - two * ( qyy + qzz ) ) * sx );
+			LanesT::store( entries[1], ( two * ( qxy + qwz ) ) * sx );
+			LanesT::store( entries[2], ( two * ( qxz - qwy ) ) * sx );
+			LanesT::store( entries[3], ( two * ( qxy - qwz ) ) * sy );
+			LanesT::store( entries[4], ( one - two * ( qxx + qzz ) ) * sy );
+			LanesT::store( entries[5], ( two * ( qyz + qwx ) ) * sy );
+			LanesT::store( entries[6], ( two * ( qxz + qwy ) ) * sz );
+			LanesT::store( entries[7], ( two * ( qyz - qwx ) ) * sz );
+			LanesT::store( entries[8], ( one - two * ( qxx + qyy ) ) * sz );
+
+			for ( size_t lane = 0u; lane < LanesT::count; ++lane )
+			{
+				auto & matrix = result[index + lane];
+				matrix[0] = renderer::Vec4{ entries[0][lane], entries[1][lane], entries[2][lane], 0.0f };
+				matrix[1] = renderer::Vec4{ entries[3][lane], entries[4][lane], entries[5][lane], 0.0f };
+				matrix[2] = renderer::Vec4{ entries[6][lane], entries[7][lane], entries[8][lane], 0.0f };
+				matrix[3] = renderer::Vec4
+				{
+					transforms.translateX[index + lane],
+					transforms.translateY[index + lane],
+					transforms.translateZ[index + lane],
+					1.0f
+				};
+			}
+		}
+
+		template< typename PackT >
+		void doTransformPoints( renderer::Mat4 const & matrix
+			, PointArrays const & points
+			, size_t index
+			, PointArrays & result )
+		{
+			using LanesT = Lanes< PackT >;
+			PackT const x = LanesT::load( &points.x[index] );
+			PackT const y = LanesT::load( &points.y[index] );
+			PackT const z = LanesT::load( &points.z[index] );
+			LanesT::store( &result.x[index]
+				, LanesT::set( matrix[0][0] ) * x + LanesT::set( matrix[1][0] ) * y + LanesT::set( matrix[2][0] ) * z + LanesT::set( matrix[3][0] ) );
+			LanesT::store( &result.y[index]
+				, LanesT::set( matrix[0][1] ) * x + LanesT::set( matrix[1][1] ) * y + LanesT::set( matrix[2][1] ) * z + LanesT::set( matrix[3][1] ) );
+			LanesT::store( &result.z[index]
+				, LanesT::set( matrix[0][2] ) * x + LanesT::set( matrix[1][2] ) * y + LanesT::set( matrix[2][2] ) * z + LanesT::set( matrix[3][2] ) );
+		}
+
+		template< typename PackT >
+		void doTransformBoundingBoxes( renderer::Mat4 const & matrix
+			, BoundingBoxArrays const & boxes
+			, size_t index
+			, BoundingBoxArrays & result )
+		{
+			// Arvo's method: each transformed axis extent is the sum of the
+			// extremums of the source extents scaled by the matrix coefficients.
+			using LanesT = Lanes< PackT >;
+			PackT const min[3]
+			{
+				LanesT::load( &boxes.min.x[index] ),
+				LanesT::load( &boxes.min.y[index] ),
+				LanesT::load( &boxes.min.z[index] ),
+			};
+			PackT const max[3]
+			{
+				LanesT::load( &boxes.max.x[index] ),
+				LanesT::load( &boxes.max.y[index] ),
+				LanesT::load( &boxes.max.z[index] ),
+			};
+			std::vector< float > * const resultMin[3]{ &result.min.x, &result.min.y, &result.min.z };
+			std::vector< float > * const resultMax[3]{ &result.max.x, &result.max.y, &result.max.z };
+
+			for ( size_t row = 0u; row < 3u; ++row )
+			{
+				PackT newMin = LanesT::set( matrix[3][row] );
+				PackT newMax = newMin;
+
+				for ( size_t col = 0u; col < 3u; ++col )
+				{
+					PackT const coef = LanesT::set( matrix[col][row] );
+					PackT const a = coef * min[col];
+					PackT const b = coef * max[col];
+					newMin = newMin + LanesT::min( a, b );
+					newMax = newMax + LanesT::max( a, b );
+				}
+
+				LanesT::store( &( *resultMin[row] )[index], newMin );
+				LanesT::store( &( *resultMax[row] )[index], newMax );
+			}
+		}
+
+		template< typename PackT >
+		void doCullBoundingBoxes( renderer::Vec4 const * planes
+			, BoundingBoxArrays const & boxes
+			, size_t index
+			, ByteArray & visible )
+		{
+			using LanesT = Lanes< PackT >;
+			PackT const half = LanesT::set( 0.5f );
+			PackT const minX = LanesT::load( &boxes.min.x[index] );
+			PackT const minY = LanesT::load( &boxes.min.y[index] );
+			PackT const minZ = LanesT::load( &boxes.min.z[index] );
+			PackT const maxX = LanesT::load( &boxes.max.x[index] );
+			PackT const maxY = LanesT::load( &boxes.max.y[index] );
+			PackT const maxZ = LanesT::load( &boxes.max.z[index] );
+			PackT const centerX = ( minX + maxX ) * half;
+			PackT const centerY = ( minY + maxY ) * half;
+			PackT const centerZ = ( minZ + maxZ ) * half;
+			PackT const extentX = ( maxX - minX ) * half;
+			PackT const extentY = ( maxY - minY ) * half;
+			PackT const extentZ = ( maxZ - minZ ) * half;
+			PackT distance = LanesT::set( std::numeric_limits< float >::max() );
+
+			for ( size_t plane = 0u; plane < 6u; ++plane )
+			{
+				// The signed distance of the most advanced vertex, along the plane normal.
+				auto & equation = planes[plane];
+				PackT const planeDistance = LanesT::set( equation[0] ) * centerX
+					+ LanesT::set( equation[1] ) * centerY
+					+ LanesT::set( equation[2] ) * centerZ
+					+ LanesT::set( std::abs( equation[0] ) ) * extentX
+					+ LanesT::set( std::abs( equation[1] ) ) * extentY
+					+ LanesT::set( std::abs( equation[2] ) ) * extentZ
+					+ LanesT::set( equation[3] );
+				distance = LanesT::min( distance, planeDistance );
+			}
+
+			float distances[LanesT::count];
+			LanesT::store( distances, distance );
+
+			for ( size_t lane = 0u; lane < LanesT::count; ++lane )
+			{
+				visible[index + lane] = distances[lane] >= 0.0f ? 1u : 0u;
+			}
+		}
+	}
+
+	void TransformArrays::resize( size_t count )
+	{
+		translateX.resize( count, 0.0f );
+		translateY.resize( count, 0.0f );
+		translateZ.resize( count, 0.0f );
+		rotateX.resize( count, 0.0f );
+		rotateY.resize( count, 0.0f );
+		rotateZ.resize( count, 0.0f );
+		rotateW.resize( count, 1.0f );
+		scaleX.resize( count, 1.0f );
+		scaleY.resize( count, 1.0f );
+		scaleZ.resize( count, 1.0f );
+	}
+
+	void TransformArrays::set( size_t index
+		, Vec3 const & translate
+		, Quaternion const & rotate
+		, Vec3 const & scale )
+	{
+		translateX[index] = translate.x;
+		translateY[index] = translate.y;
+		translateZ[index] = translate.z;
+		rotateX[index] = rotate.x;
+		rotateY[index] = rotate.y;
+		rotateZ[index] = rotate.z;
+		rotateW[index] = rotate.w;
+		scaleX[index] = scale.x;
+		scaleY[index] = scale.y;
+		scaleZ[index] = scale.z;
+	}
+
+	void PointArrays::resize( size_t count )
+	{
+		x.resize( count );
+		y.resize( count );
+		z.resize( count );
+	}
+
+	void BoundingBoxArrays::resize( size_t count )
+	{
+		min.resize( count );
+		max.resize( count );
+	}
+
+	void composeTransforms( TransformArrays const & transforms
+		, renderer::Mat4 * result )
+	{
+		parallelFor( transforms.size()
+			, Grain
+			, [&transforms, result]( size_t begin, size_t end )
+			{
+				forEachPack< ArithmeticPack >( begin
+					, end
+					, [&transforms, result]( auto pack, size_t index )
+					{
+						doComposeTransforms< decltype( pack ) >( transforms, index, result );
+					} );
+			} );
+	}
+
+	void transformPoints( renderer::Mat4 const & matrix
+		, PointArrays const & points
+		, PointArrays & result )
+	{
+		result.resize( points.size() );
+		parallelFor( points.size()
+			, Grain
+			, [&matrix, &points, &result]( size_t begin, size_t end )
+			{
+				forEachPack< ArithmeticPack >( begin
+					, end
+					, [&matrix, &points, &result]( auto pack, size_t index )
+					{
+						doTransformPoints< decltype( pack ) >( matrix, points, index, result );
+					} );
+			} );
+	}
+
+	void transformBoundingBoxes( renderer::Mat4 const & matrix
+		, BoundingBoxArrays const & boxes
+		, BoundingBoxArrays & result )
+	{
+		result.resize( boxes.size() );
+		parallelFor( boxes.size()
+			, Grain
+			, [&matrix, &boxes, &result]( size_t begin, size_t end )
+			{
+				forEachPack< ArithmeticPack >( begin
+					, end
+					, [&matrix, &boxes, &result]( auto pack, size_t index )
+					{
+						doTransformBoundingBoxes< decltype( pack ) >( matrix, boxes, index, result );
+					} );
+			} );
+	}
+
+	size_t cullBoundingBoxes( renderer::Mat4 const & matrix
+		, BoundingBoxArrays const & boxes
+		, ByteArray & visible )
+	{
+		// The planes are the sums and differences of the fourth row with the three others.
+		renderer::Vec4 planes[6];
+
+		for ( size_t row = 0u; row < 3u; ++row )
+		{
+			for ( size_t col = 0u; col < 4u; ++col )
+			{
+				planes[row * 2u + 0u][col] = matrix[col][3] + matrix[col][row];
+				planes[row * 2u + 1u][col] = matrix[col][3] - matrix[col][row];
+			}
+		}
+
+		visible.resize( boxes.size() );
+		parallelFor( boxes.size()
+			, Grain
+			, [&planes, &boxes, &visible]( size_t begin, size_t end )
+			{
+				forEachPack< ArithmeticPack >( begin
+					, end
+					, [&planes, &boxes, &visible]( auto pack, size_t index )
+					{
+						doCullBoundingBoxes< decltype( pack ) >( planes, boxes, index, visible );
+					} );
+			} );
+		return size_t( std::count( visible.begin(), visible.end(), uint8_t( 1u ) ) );
+	}
+
+	void multiplyMatrices( renderer::Mat4 const * lhs
+		, renderer::Mat4 const * rhs
+		, renderer::Mat4 * result
+		, size_t count )
+	{
+		parallelFor( count
+			, Grain
+			, [lhs, rhs, result]( size_t begin, size_t end )
+			{
+				for ( size_t index = begin; index < end; ++index )
+				{
+					result[index] = lhs[index] * rhs[index];
+				}
+			} );
+	}
+
+	void updateHierarchy( UInt32Array const & parents
+		, renderer::Mat4 const * locals
+		, renderer::Mat4 * worlds )
+	{
+		static uint32_t constexpr NoParent = ~( 0u );
+		size_t const count = parents.size();
+		size_t levelBegin = 0u;
+
+		auto processLevel = [&parents, locals, worlds]( size_t begin, size_t end )
+		{
+			parallelFor( end - begin
+				, Grain
+				, [&parents, locals, worlds, begin]( size_t first, size_t last )
+				{
+					for ( size_t index = begin + first; index < begin + last; ++index )
+					{
+						auto parent = parents[index];
+						worlds[index] = parent == NoParent
+							? locals[index]
+							: worlds[parent] * locals[index];
+					}
+				} );
+		};
+
+		for ( size_t index = 0u; index < count; ++index )
+		{
+			auto parent = parents[index];
+			assert( ( parent == NoParent || parent < index )
+				&& "The nodes must be sorted so that parents precede their children" );
+
+			if ( parent != NoParent && parent >= levelBegin )
+			{
+				processLevel( levelBegin, index );
+				levelBegin = index;
+			}
+		}
+
+		processLevel( levelBegin, count );
+	}
+}
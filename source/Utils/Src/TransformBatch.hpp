@@ -0,0 +1,192 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#pragma once
+
+#include "Quaternion.hpp"
+#include "Vec3.hpp"
+
+namespace utils
+{
+	/**
+	*\brief
+	*	Transformations TRS (translation, rotation, mise à l'échelle) de plusieurs noeuds,
+	*	stockées en structure de tableaux.
+	*/
+	struct TransformArrays
+	{
+		/**
+		*\brief
+		*	Redimensionne tous les tableaux.
+		*/
+		void resize( size_t count );
+		/**
+		*\brief
+		*	Définit la transformation d'un noeud.
+		*\param[in] index
+		*	L'indice du noeud.
+		*\param[in] translate
+		*	La translation.
+		*\param[in] rotate
+		*	La rotation, doit être normalisée.
+		*\param[in] scale
+		*	La mise à l'échelle.
+		*/
+		void set( size_t index
+			, Vec3 const & translate
+			, Quaternion const & rotate
+			, Vec3 const & scale );
+		/**
+		*\return
+		*	Le nombre de noeuds.
+		*/
+		inline size_t size()const
+		{
+			return translateX.size();
+		}
+
+		std::vector< float > translateX;
+		std::vector< float > translateY;
+		std::vector< float > translateZ;
+		std::vector< float > rotateX;
+		std::vector< float > rotateY;
+		std::vector< float > rotateZ;
+		std::vector< float > rotateW;
+		std::vector< float > scaleX;
+		std::vector< float > scaleY;
+		std::vector< float > scaleZ;
+	};
+	/**
+	*\brief
+	*	Points stockés en structure de tableaux.
+	*/
+	struct PointArrays
+	{
+		/**
+		*\brief
+		*	Redimensionne tous les tableaux.
+		*/
+		void resize( size_t count );
+		/**
+		*\return
+		*	Le nombre de points.
+		*/
+		inline size_t size()const
+		{
+			return x.size();
+		}
+
+		std::vector< float > x;
+		std::vector< float > y;
+		std::vector< float > z;
+	};
+	/**
+	*\brief
+	*	Boîtes englobantes alignées sur les axes, stockées en structure de tableaux.
+	*/
+	struct BoundingBoxArrays
+	{
+		/**
+		*\brief
+		*	Redimensionne tous les tableaux.
+		*/
+		void resize( size_t count );
+		/**
+		*\return
+		*	Le nombre de boîtes.
+		*/
+		inline size_t size()const
+		{
+			return min.size();
+		}
+
+		PointArrays min;
+		PointArrays max;
+	};
+	/**
+	*\brief
+	*	Calcule les matrices translate * rotate * scale de plusieurs noeuds.
+	*\remarks
+	*	Donne le même résultat que utils::translate( mat, t ) * utils::toMat4( r ) * utils::scale( mat, s ),
+	*	mais traite 4 ou 8 noeuds à la fois, selon le jeu d'instructions (cf. Utils/Mat4Simd.inl),
+	*	et répartit les grands lots entre plusieurs threads.
+	*\param[in] transforms
+	*	Les transformations.
+	*\param[out] result
+	*	Reçoit les matrices, doit pouvoir en contenir transforms.size().
+	*/
+	void composeTransforms( TransformArrays const & transforms
+		, renderer::Mat4 * result );
+	/**
+	*\brief
+	*	Transforme des positions par une matrice (w = 1, sans division perspective).
+	*\param[in] matrix
+	*	La matrice.
+	*\param[in] points
+	*	Les positions.
+	*\param[out] result
+	*	Reçoit les positions transformées, redimensionné si nécessaire.
+	*/
+	void transformPoints( renderer::Mat4 const & matrix
+		, PointArrays const & points
+		, PointArrays & result );
+	/**
+	*\brief
+	*	Calcule les boîtes englobantes alignées sur les axes de boîtes transformées par une matrice affine.
+	*\param[in] matrix
+	*	La matrice.
+	*\param[in] boxes
+	*	Les boîtes.
+	*\param[out] result
+	*	Reçoit les boîtes transformées, redimensionné si nécessaire.
+	*/
+	void transformBoundingBoxes( renderer::Mat4 const & matrix
+		, BoundingBoxArrays const & boxes
+		, BoundingBoxArrays & result );
+	/**
+	*\brief
+	*	Teste des boîtes englobantes alignées sur les axes contre le frustum d'une matrice de projection.
+	*\remarks
+	*	Les plans sont extraits de la matrice (méthode de Gribb et Hartmann), et chaque plan est testé
+	*	contre le sommet de la boîte le plus avancé selon sa normale, pour 4 ou 8 boîtes à la fois.
+	*	Le plan proche est celui de l'intervalle de profondeur [-w, w], conservatif pour l'intervalle [0, w].
+	*	Le test est conservatif : une boîte proche d'une arête du frustum peut être considérée visible.
+	*\param[in] matrix
+	*	La matrice de projection (modèle-vue-projection pour des boîtes en espace objet).
+	*\param[in] boxes
+	*	Les boîtes.
+	*\param[out] visible
+	*	Reçoit 1 pour les boîtes visibles, 0 pour les autres, redimensionné si nécessaire.
+	*\return
+	*	Le nombre de boîtes visibles.
+	*/
+	size_t cullBoundingBoxes( renderer::Mat4 const & matrix
+		, BoundingBoxArrays const & boxes
+		, ByteArray & visible );
+	/**
+	*\brief
+	*	Calcule result[i] = lhs[i] * rhs[i] pour count matrices.
+	*/
+	void multiplyMatrices( renderer::Mat4 const * lhs
+		, renderer::Mat4 const * rhs
+		, renderer::Mat4 * result
+		, size_t count );
+	/**
+	*\brief
+	*	Calcule les matrices monde d'une hiérarchie de noeuds.
+	*\remarks
+	*	Les noeuds doivent être triés de sorte que le parent d'un noeud le précède (parents[i] < i).
+	*	Les noeuds sont traités par niveaux consécutifs, dont les noeuds sont indépendants entre eux,
+	*	et chaque niveau est réparti entre plusieurs threads.
+	*\param[in] parents
+	*	L'indice du parent de chaque noeud, ~0u pour les racines.
+	*\param[in] locals
+	*	Les matrices locales des noeuds.
+	*\param[out] worlds
+	*	Reçoit les matrices monde des noeuds, doit pouvoir en contenir parents.size().
+	*/
+	void updateHierarchy( UInt32Array const & parents
+		, renderer::Mat4 const * locals
+		, renderer::Mat4 * worlds );
+}
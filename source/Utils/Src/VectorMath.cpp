@@ -0,0 +1,140 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include "VectorMath.hpp"
+
+namespace utils
+{
+	namespace
+	{
+		template< typename FuncT >
+		void doApply( float const * values
+			, float * result
+			, size_t count
+			, FuncT function )
+		{
+			forEachPack< FloatPack >( 0u
+				, count
+				, [&]( auto pack, size_t index )
+				{
+					using LanesT = Lanes< decltype( pack ) >;
+					LanesT::store( result + index, function( LanesT::load( values + index ) ) );
+				} );
+		}
+
+		template< typename FuncT >
+		void doApply( float const * lhs
+			, float const * rhs
+			, float * result
+			, size_t count
+			, FuncT function )
+		{
+			forEachPack< FloatPack >( 0u
+				, count
+				, [&]( auto pack, size_t index )
+				{
+					using LanesT = Lanes< decltype( pack ) >;
+					LanesT::store( result + index
+						, function( LanesT::load( lhs + index )
+							, LanesT::load( rhs + index ) ) );
+				} );
+		}
+
+		template< typename FuncT >
+		void doApply( float const * first
+			, float const * second
+			, float const * third
+			, float * result
+			, size_t count
+			, FuncT function )
+		{
+			forEachPack< FloatPack >( 0u
+				, count
+				, [&]( auto pack, size_t index )
+				{
+					using LanesT = Lanes< decltype( pack ) >;
+					LanesT::store( result + index
+						, function( LanesT::load( first + index )
+							, LanesT::load( second + index )
+							, LanesT::load( third + index ) ) );
+				} );
+		}
+	}
+
+	void sqrt( float const * values
+		, float * result
+		, size_t count )
+	{
+		doApply( values, result, count, []( auto pack ){ return details::sqrt( pack ); } );
+	}
+
+	void inverseSqrt( float const * values
+		, float * result
+		, size_t count )
+	{
+		doApply( values, result, count, []( auto pack ){ return details::inverseSqrt( pack ); } );
+	}
+
+	void sin( float const * values
+		, float * result
+		, size_t count )
+	{
+		doApply( values, result, count, []( auto pack ){ return details::sin( pack ); } );
+	}
+
+	void cos( float const * values
+		, float * result
+		, size_t count )
+	{
+		doApply( values, result, count, []( auto pack ){ return details::cos( pack ); } );
+	}
+
+	void exp( float const * values
+		, float * result
+		, size_t count )
+	{
+		doApply( values, result, count, []( auto pack ){ return details::exp( pack ); } );
+	}
+
+	void log( float const * values
+		, float * result
+		, size_t count )
+	{
+		doApply( values, result, count, []( auto pack ){ return details::log( pack ); } );
+	}
+
+	void min( float const * lhs
+		, float const * rhs
+		, float * result
+		, size_t count )
+	{
+		doApply( lhs, rhs, result, count, []( auto l, auto r ){ return details::min( l, r ); } );
+	}
+
+	void max( float const * lhs
+		, float const * rhs
+		, float * result
+		, size_t count )
+	{
+		doApply( lhs, rhs, result, count, []( auto l, auto r ){ return details::max( l, r ); } );
+	}
+
+	void clamp( float const * values
+		, float const * low
+		, float const * high
+		, float * result
+		, size_t count )
+	{
+		doApply( values, low, high, result, count, []( auto v, auto l, auto h ){ return details::clamp( v, l, h ); } );
+	}
+
+	void mix( float const * lhs
+		, float const * rhs
+		, float const * factor
+		, float * result
+		, size_t count )
+	{
+		doApply( lhs, rhs, factor, result, count, []( auto l, auto r, auto f ){ return details::mix( l, r, f ); } );
+	}
+}
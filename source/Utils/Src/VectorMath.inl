@@ -0,0 +1,361 @@
+/*
+This file belongs to RendererLib.
+See LICENSE file in root folder
+*/
+#include <array>
+
+namespace utils
+{
+	namespace details
+	{
+		/**
+		*\name Noyaux de calcul, pour un paquet de flottants.
+		*\remarks
+		*	exp, log et sinCos sont les approximations polynomiales de Cephes.
+		*/
+		/**\{*/
+		template< typename PackT >
+		inline PackT sqrt( PackT value )
+		{
+			return Lanes< PackT >::sqrt( value );
+		}
+
+		template< typename PackT >
+		inline PackT inverseSqrt( PackT value )
+		{
+			using LanesT = Lanes< PackT >;
+			return LanesT::set( 1.0f ) / LanesT::sqrt( value );
+		}
+
+		template< typename PackT >
+		inline PackT exp( PackT x )
+		{
+			using LanesT = Lanes< PackT >;
+			PackT const one = LanesT::set( 1.0f );
+			PackT const nan = LanesT::bitAndNot( LanesT::equal( x, x ), LanesT::castToFloat( LanesT::setInt( ~0 ) ) );
+			x = LanesT::min( x, LanesT::set( 88.3762626647949f ) );
+			x = LanesT::max( x, LanesT::set( -88.3762626647949f ) );
+
+			// exp( x ) = 2^n * exp( g ), with n = floor( x / log( 2 ) + 0.5 ).
+			PackT fx = x * LanesT::set( 1.44269504088896341f ) + LanesT::set( 0.5f );
+			PackT const truncated = LanesT::toFloat( LanesT::truncate( fx ) );
+			fx = truncated - LanesT::bitAnd( LanesT::less( fx, truncated ), one );
+			x = x - fx * LanesT::set( 0.693359375f );
+			x = x - fx * LanesT::set( -2.12194440e-4f );
+
+			PackT const z = x * x;
+			PackT y = LanesT::set( 1.9875691500e-4f );
+			y = y * x + LanesT::set( 1.3981999507e-3f );
+			y = y * x + LanesT::set( 8.3334519073e-3f );
+			y = y * x + LanesT::set( 4.1665795894e-2f );
+			y = y * x + LanesT::set( 1.6666665459e-1f );
+			y = y * x + LanesT::set( 5.0000001201e-1f );
+			y = y * z + x + one;
+
+			auto exponent = LanesT::addInt( LanesT::truncate( fx ), LanesT::setInt( 0x7f ) );
+			return LanesT::bitOr( y * LanesT::castToFloat( LanesT::template shiftLeft< 23 >( exponent ) ), nan );
+		}
+
+		template< typename PackT >
+		inline PackT log( PackT x )
+		{
+			using LanesT = Lanes< PackT >;
+			PackT const zero = LanesT::set( 0.0f );
+			PackT const one = LanesT::set( 1.0f );
+			PackT const infinity = LanesT::set( std::numeric_limits< float >::infinity() );
+			PackT const invalid = LanesT::bitOr( LanesT::less( x, zero )
+				, LanesT::bitAndNot( LanesT::equal( x, x ), LanesT::castToFloat( LanesT::setInt( ~0 ) ) ) );
+			PackT const null = LanesT::equal( x, zero );
+			PackT const infinite = LanesT::equal( x, infinity );
+
+			// log( x ) = log( m ) + e * log( 2 ), with x = m * 2^e, m in [sqrt( 0.5 ), sqrt( 2 )[.
+			x = LanesT::max( x, LanesT::castToFloat( LanesT::setInt( 0x00800000 ) ) );
+			auto bits = LanesT::castToInt( x );
+			PackT e = LanesT::toFloat( LanesT::subInt( LanesT::template shiftRight< 23 >( bits )
+				, LanesT::setInt( 0x7f ) ) ) + one;
+			x = LanesT::castToFloat( LanesT::andInt( bits, LanesT::setInt( ~0x7f800000 ) ) );
+			x = LanesT::bitOr( x, LanesT::set( 0.5f ) );
+
+			PackT const mask = LanesT::less( x, LanesT::set( 0.707106781186547524f ) );
+			PackT const tmp = LanesT::bitAnd( x, mask );
+			x = x - one;
+			e = e - LanesT::bitAnd( one, mask );
+			x = x + tmp;
+
+			PackT const z = x * x;
+			PackT y = LanesT::set( 7.0376836292e-2f );
+			y = y * x + LanesT::set( -1.1514610310e-1f );
+			y = y * x + LanesT::set( 1.1676998740e-1f );
+			y = y * x + LanesT::set( -1.2420140846e-1f );
+			y = y * x + LanesT::set( 1.4249322787e-1f );
+			y = y * x + LanesT::set( -1.6668057665e-1f );
+			y = y * x + LanesT::set( 2.0000714765e-1f );
+			y = y * x + LanesT::set( -2.4999993993e-1f );
+			y = y * x + LanesT::set( 3.3333331174e-1f );
+			y = y * x * z;
+			y = y + e * LanesT::set( -2.12194440e-4f );
+			y = y - z * LanesT::set( 0.5f );
+			x = x + y;
+			x = x + e * LanesT::set( 0.693359375f );
+
+			x = LanesT::bitOr( LanesT::bitAndNot( null, x ), LanesT::bitAnd( null, LanesT::set( -std::numeric_limits< float >::infinity() ) ) );
+			x = LanesT::bitOr( LanesT::bitAndNot( infinite, x ), LanesT::bitAnd( infinite, infinity ) );
+			return LanesT::bitOr( x, invalid );
+		}
+
+		template< typename PackT >
+		inline void sinCos( PackT x
+			, PackT & sin
+			, PackT & cos )
+		{
+			using LanesT = Lanes< PackT >;
+			PackT const signMask = LanesT::set( -0.0f );
+			PackT const one = LanesT::set( 1.0f );
+			PackT signSin = LanesT::bitAnd( x, signMask );
+			x = LanesT::bitAndNot( signMask, x );
+
+			// Octant of |x|, rounded to an even value, so the reduced x is in [-pi/4, pi/4].
+			auto octant = LanesT::truncate( x * LanesT::set( 1.27323954473516f ) );
+			octant = LanesT::addInt( octant, LanesT::setInt( 1 ) );
+			octant = LanesT::andInt( octant, LanesT::setInt( ~1 ) );
+			PackT const y = LanesT::toFloat( octant );
+
+			PackT const swapSignSin = LanesT::castToFloat( LanesT::template shiftLeft< 29 >( LanesT::andInt( octant, LanesT::setInt( 4 ) ) ) );
+			PackT const polyMask = LanesT::castToFloat( LanesT::equalInt( LanesT::andInt( octant, LanesT::setInt( 2 ) ), LanesT::setInt( 0 ) ) );
+			PackT const signCos = LanesT::castToFloat( LanesT::template shiftLeft< 29 >( LanesT::andNotInt( LanesT::subInt( octant, LanesT::setInt( 2 ) ), LanesT::setInt( 4 ) ) ) );
+			signSin = LanesT::bitXor( signSin, swapSignSin );
+
+			// Extended precision modular arithmetic: x = ( ( x - y * DP1 ) - y * DP2 ) - y * DP3.
+			x = x + y * LanesT::set( -0.78515625f );
+			x = x + y * LanesT::set( -2.4187564849853515625e-4f );
+			x = x + y * LanesT::set( -3.77489497744594108e-8f );
+
+			PackT const z = x * x;
+			PackT cosPoly = LanesT::set( 2.443315711809948e-5f );
+			cosPoly = cosPoly * z + LanesT::set( -1.388731625493765e-3f );
+			cosPoly = cosPoly * z + LanesT::set( 4.166664568298827e-2f );
+			cosPoly = cosPoly * z * z;
+			cosPoly = cosPoly - z * LanesT::set( 0.5f );
+			cosPoly = cosPoly + one;
+
+			PackT sinPoly = LanesT::set( -1.9515295891e-4f );
+			sinPoly = sinPoly * z + LanesT::set( 8.3321608736e-3f );
+			sinPoly = sinPoly * z + LanesT::set( -1.6666654611e-1f );
+			sinPoly = sinPoly * z * x + x;
+
+			sin = LanesT::bitXor( LanesT::bitOr( LanesT::bitAnd( polyMask, sinPoly ), LanesT::bitAndNot( polyMask, cosPoly ) )
+				, signSin );
+			cos = LanesT::bitXor( LanesT::bitOr( LanesT::bitAnd( polyMask, cosPoly ), LanesT::bitAndNot( polyMask, sinPoly ) )
+				, signCos );
+		}
+
+		template< typename PackT >
+		inline PackT sin( PackT value )
+		{
+			PackT sin;
+			PackT cos;
+			sinCos( value, sin, cos );
+			return sin;
+		}
+
+		template< typename PackT >
+		inline PackT cos( PackT value )
+		{
+			PackT sin;
+			PackT cos;
+			sinCos( value, sin, cos );
+			return cos;
+		}
+
+		template< typename PackT >
+		inline PackT min( PackT lhs, PackT rhs )
+		{
+			return Lanes< PackT >::min( lhs, rhs );
+		}
+
+		template< typename PackT >
+		inline PackT max( PackT lhs, PackT rhs )
+		{
+			return Lanes< PackT >::max( lhs, rhs );
+		}
+
+		template< typename PackT >
+		inline PackT clamp( PackT value, PackT low, PackT high )
+		{
+			using LanesT = Lanes< PackT >;
+			return LanesT::min( LanesT::max( value, low ), high );
+		}
+
+		template< typename PackT >
+		inline PackT mix( PackT lhs, PackT rhs, PackT factor )
+		{
+			return lhs + ( rhs - lhs ) * factor;
+		}
+		/**\}*/
+		/**
+		*\name Conversions entre vecteurs et tableaux de 4 flottants.
+		*\remarks
+		*	Les composantes manquantes sont complétées avec des composantes existantes,
+		*	pour ne pas générer de valeurs spéciales dans les voies inutilisées.
+		*/
+		/**\{*/
+		using Float4Array = std::array< float, 4u >;
+
+		inline Float4Array toArray( Vec2 const & value )
+		{
+			return { value.x, value.y, value.x, value.y };
+		}
+
+		inline Float4Array toArray( Vec3 const & value )
+		{
+			return { value.x, value.y, value.z, value.x };
+		}
+
+		inline Float4Array toArray( Vec4 const & value )
+		{
+			return { value.x, value.y, value.z, value.w };
+		}
+
+		inline void fromArray( Float4Array const & value, Vec2 & result )
+		{
+			result = Vec2{ value[0], value[1] };
+		}
+
+		inline void fromArray( Float4Array const & value, Vec3 & result )
+		{
+			result = Vec3{ value[0], value[1], value[2] };
+		}
+
+		inline void fromArray( Float4Array const & value, Vec4 & result )
+		{
+			result = Vec4{ value[0], value[1], value[2], value[3] };
+		}
+		/**\}*/
+		/**
+		*\name Application d'un noyau à toutes les composantes de vecteurs.
+		*/
+		/**\{*/
+		template< typename VecT, typename FuncT >
+		inline VecT apply( VecT const & value
+			, FuncT function )
+		{
+			Float4Array const input = toArray( value );
+			Float4Array output;
+			forEachPack< FloatPack >( 0u
+				, 4u
+				, [&]( auto pack, size_t index )
+				{
+					using LanesT = Lanes< decltype( pack ) >;
+					LanesT::store( &output[index], function( LanesT::load( &input[index] ) ) );
+				} );
+			VecT result{ renderer::noInit };
+			fromArray( output, result );
+			return result;
+		}
+
+		template< typename VecT, typename FuncT >
+		inline VecT apply( VecT const & lhs
+			, VecT const & rhs
+			, FuncT function )
+		{
+			Float4Array const inputL = toArray( lhs );
+			Float4Array const inputR = toArray( rhs );
+			Float4Array output;
+			forEachPack< FloatPack >( 0u
+				, 4u
+				, [&]( auto pack, size_t index )
+				{
+					using LanesT = Lanes< decltype( pack ) >;
+					LanesT::store( &output[index]
+						, function( LanesT::load( &inputL[index] )
+							, LanesT::load( &inputR[index] ) ) );
+				} );
+			VecT result{ renderer::noInit };
+			fromArray( output, result );
+			return result;
+		}
+
+		template< typename VecT, typename FuncT >
+		inline VecT apply( VecT const & first
+			, VecT const & second
+			, VecT const & third
+			, FuncT function )
+		{
+			Float4Array const input1 = toArray( first );
+			Float4Array const input2 = toArray( second );
+			Float4Array const input3 = toArray( third );
+			Float4Array output;
+			forEachPack< FloatPack >( 0u
+				, 4u
+				, [&]( auto pack, size_t index )
+				{
+					using LanesT = Lanes< decltype( pack ) >;
+					LanesT::store( &output[index]
+						, function( LanesT::load( &input1[index] )
+							, LanesT::load( &input2[index] )
+							, LanesT::load( &input3[index] ) ) );
+				} );
+			VecT result{ renderer::noInit };
+			fromArray( output, result );
+			return result;
+		}
+		/**\}*/
+	}
+
+#define Utils_VectorMath_Unary( Name )\
+	inline Vec2 Name( Vec2 const & value )\
+	{\
+		return details::apply( value, []( auto pack ){ return details::Name( pack ); } );\
+	}\
+	inline Vec3 Name( Vec3 const & value )\
+	{\
+		return details::apply( value, []( auto pack ){ return details::Name( pack ); } );\
+	}\
+	inline Vec4 Name( Vec4 const & value )\
+	{\
+		return details::apply( value, []( auto pack ){ return details::Name( pack ); } );\
+	}
+
+#define Utils_VectorMath_Binary( Name )\
+	inline Vec2 Name( Vec2 const & lhs, Vec2 const & rhs )\
+	{\
+		return details::apply( lhs, rhs, []( auto l, auto r ){ return details::Name( l, r ); } );\
+	}\
+	inline Vec3 Name( Vec3 const & lhs, Vec3 const & rhs )\
+	{\
+		return details::apply( lhs, rhs, []( auto l, auto r ){ return details::Name( l, r ); } );\
+	}\
+	inline Vec4 Name( Vec4 const & lhs, Vec4 const & rhs )\
+	{\
+		return details::apply( lhs, rhs, []( auto l, auto r ){ return details::Name( l, r ); } );\
+	}
+
+#define Utils_VectorMath_Ternary( Name )\
+	inline Vec2 Name( Vec2 const & first, Vec2 const & second, Vec2 const & third )\
+	{\
+		return details::apply( first, second, third, []( auto a, auto b, auto c ){ return details::Name( a, b, c ); } );\
+	}\
+	inline Vec3 Name( Vec3 const & first, Vec3 const & second, Vec3 const & third )\
+	{\
+		return details::apply( first, second, third, []( auto a, auto b, auto c ){ return details::Name( a, b, c ); } );\
+	}\
+	inline Vec4 Name( Vec4 const & first, Vec4 const & second, Vec4 const & third )\
+	{\
+		return details::apply( first, second, third, []( auto a, auto b, auto c ){ return details::Name( a, b, c ); } );\
+	}
+
+	Utils_VectorMath_Unary( sqrt )
+	Utils_VectorMath_Unary( inverseSqrt )
+	Utils_VectorMath_Unary( sin )
+	Utils_VectorMath_Unary( cos )
+	Utils_VectorMath_Unary( exp )
+	Utils_VectorMath_Unary( log )
+	Utils_VectorMath_Binary( min )
+	Utils_VectorMath_Binary( max )
+	Utils_VectorMath_Ternary( clamp )
+	Utils_VectorMath_Ternary( mix )
+
+#undef Utils_VectorMath_Ternary
+#undef Utils_VectorMath_Binary
+#undef Utils_VectorMath_Unary
+}